@@ -50,6 +50,7 @@
 #include <class_text_mod.h>
 #include <convert_basic_shapes_to_polygon.h>
 #include <trigo.h>
+#include <thread_pool.h>
 #include <utility>
 #include <vector>
 
@@ -865,10 +866,7 @@ void CINFO3D_VISU::createLayers( REPORTER *aStatusTextReporter )
     if( GetFlag( FL_RENDER_OPENGL_COPPER_THICKNESS ) &&
         (m_render_engine == RENDER_ENGINE_OPENGL_LEGACY) )
     {
-        const int nLayers = layer_id.size();
-
-        #pragma omp parallel for
-        for( signed int lIdx = 0; lIdx < nLayers; ++lIdx )
+        THREAD_POOL::GetInstance().ParallelFor( layer_id.size(), [&]( size_t lIdx )
         {
             const PCB_LAYER_ID curr_layer_id = layer_id[lIdx];
 
@@ -880,7 +878,7 @@ void CINFO3D_VISU::createLayers( REPORTER *aStatusTextReporter )
 
             // This will make a union of all added contourns
             layerPoly->Simplify( SHAPE_POLY_SET::PM_FAST );
-        }
+        } );
     }
 
 #ifdef PRINT_STATISTICS_3D_VIEWER
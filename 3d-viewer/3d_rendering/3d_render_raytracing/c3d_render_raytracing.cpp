@@ -28,7 +28,9 @@
  */
 
 #include <GL/glew.h>
+#include <atomic>
 #include <climits>
+#include <mutex>
 
 #include "c3d_render_raytracing.h"
 #include "mortoncodes.h"
@@ -37,15 +39,12 @@
 #include "3d_math.h"
 #include "../common_ogl/ogl_utils.h"
 #include <profile.h>        // To use GetRunningMicroSecs or another profiling utility
+#include <thread_pool.h>
 
 // This should be used in future for the function
 // convertLinearToSRGB
 //#include <glm/gtc/color_space.hpp>
 
-#ifdef _OPENMP
-#include <omp.h>
-#endif
-
 C3D_RENDER_RAYTRACING::C3D_RENDER_RAYTRACING( CINFO3D_VISU &aSettings ) :
                        C3D_RENDER_BASE( aSettings ),
                        m_postshader_ssao( aSettings.CameraGet() )
@@ -368,23 +367,20 @@ void C3D_RENDER_RAYTRACING::rt_render_tracing( GLubyte *ptrPBO ,
 
     const long nrBlocks = (long) m_blockPositions.size();
     const unsigned startTime = GetRunningMicroSecs();
-    bool breakLoop = false;
-    int numBlocksRendered = 0;
+    std::atomic_bool breakLoop( false );
+    std::atomic_int numBlocksRendered( 0 );
+    std::mutex checkProcessBlock;
 
-    #pragma omp parallel for schedule(dynamic) shared(breakLoop) \
-        firstprivate(ptrPBO) reduction(+:numBlocksRendered) default(none)
-    for( long iBlock = 0; iBlock < nrBlocks; iBlock++ )
+    THREAD_POOL::GetInstance().ParallelFor( nrBlocks, [&]( size_t iBlock )
     {
-
-        #pragma omp flush(breakLoop)
-        if( !breakLoop )
+        if( !breakLoop.load() )
         {
             bool process_block;
 
             // std::vector<bool> stuffs eight bools to each byte, so access to
             // them can never be natively atomic.
-            #pragma omp critical(checkProcessBlock)
             {
+                std::lock_guard<std::mutex> lock( checkProcessBlock );
                 process_block = !m_blockPositionsWasProcessed[iBlock];
                 m_blockPositionsWasProcessed[iBlock] = true;
             }
@@ -397,17 +393,11 @@ void C3D_RENDER_RAYTRACING::rt_render_tracing( GLubyte *ptrPBO ,
 
                 // Check if it spend already some time render and request to exit
                 // to display the progress
-                #ifdef _OPENMP
-                if( omp_get_thread_num() == 0 )
-                #endif
-                    if( (GetRunningMicroSecs() - startTime) > 150000 )
-                    {
-                        breakLoop = true;
-                        #pragma omp flush(breakLoop)
-                    }
+                if( (GetRunningMicroSecs() - startTime) > 150000 )
+                    breakLoop = true;
             }
         }
-    }
+    } );
 
     m_nrBlocksRenderProgress += numBlocksRendered;
 
@@ -926,9 +916,9 @@ void C3D_RENDER_RAYTRACING::rt_render_post_process_shade( GLubyte *ptrPBO,
             aStatusTextReporter->Report( _("Rendering: Post processing shader") );
 
         // Compute the shader value
-        #pragma omp parallel for schedule(dynamic)
-        for( signed int y = 0; y < (int)m_realBufferSize.y; ++y )
+        THREAD_POOL::GetInstance().ParallelFor( m_realBufferSize.y, [&]( size_t aRow )
         {
+            const signed int y = (int)aRow;
             SFVEC3F *ptr = &m_shaderBuffer[ y * m_realBufferSize.x ];
 
             for( signed int x = 0; x < (int)m_realBufferSize.x; ++x )
@@ -936,10 +926,7 @@ void C3D_RENDER_RAYTRACING::rt_render_post_process_shade( GLubyte *ptrPBO,
                 *ptr = m_postshader_ssao.Shade( SFVEC2I( x, y ) );
                 ptr++;
             }
-        }
-
-        // Wait for all threads to finish
-        #pragma omp barrier
+        } );
 
         // Set next state
         m_rt_render_state = RT_RENDER_STATE_POST_PROCESS_BLUR_AND_FINISH;
@@ -960,9 +947,9 @@ void C3D_RENDER_RAYTRACING::rt_render_post_process_blur_finish( GLubyte *ptrPBO,
     if( m_settings.GetFlag( FL_RENDER_RAYTRACING_POST_PROCESSING ) )
     {
         // Now blurs the shader result and compute the final color
-        #pragma omp parallel for schedule(dynamic)
-        for( signed int y = 0; y < (int)m_realBufferSize.y; ++y )
+        THREAD_POOL::GetInstance().ParallelFor( m_realBufferSize.y, [&]( size_t aRow )
         {
+            const signed int y = (int)aRow;
             GLubyte *ptr = &ptrPBO[ y * m_realBufferSize.x * 4 ];
 
             const SFVEC3F *ptrShaderY0 =
@@ -1041,10 +1028,7 @@ void C3D_RENDER_RAYTRACING::rt_render_post_process_blur_finish( GLubyte *ptrPBO,
 
                 ptr += 4;
             }
-        }
-
-        // Wait for all threads to finish
-        #pragma omp barrier
+        } );
 
         // Debug code
         //m_postshader_ssao.DebugBuffersOutputAsImages();
@@ -1061,8 +1045,7 @@ void C3D_RENDER_RAYTRACING::render_preview( GLubyte *ptrPBO )
 
     unsigned int nrBlocks = m_blockPositionsFast.size();
 
-    #pragma omp parallel for schedule(dynamic)
-    for( signed int iBlock = 0; iBlock < (int)nrBlocks; iBlock++ )
+    THREAD_POOL::GetInstance().ParallelFor( nrBlocks, [&]( size_t iBlock )
     {
         const SFVEC2UI &windowPosUI = m_blockPositionsFast[ iBlock ];
         const SFVEC2I windowsPos = SFVEC2I( windowPosUI.x + m_xoffset,
@@ -1663,10 +1646,7 @@ void C3D_RENDER_RAYTRACING::render_preview( GLubyte *ptrPBO )
                 SetPixel( ptr + 12, BlendColor( cRBC, BlendColor( cRB , cC ) ) );
             }
         }
-    }
-
-    // Wait for all threads to finish (not sure if this is need)
-    #pragma omp barrier
+    } );
 }
 
 
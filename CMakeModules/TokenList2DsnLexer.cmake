@@ -199,6 +199,121 @@ if( NOT ( tokensBefore EQUAL tokensAfter ) )
     message( FATAL_ERROR "Duplicate tokens found in file <${inputFile}>." )
 endif()
 
+# Build a perfect hash of the tokens, looked up by DSNLEXER::findToken() (see KEYWORD_HASH
+# in dsnlexer.h, which must compute the same hashes).  Each token gets two 16 bit hashes
+# h and g of its characters.  h selects a bucket, and the tokens of each bucket are put
+# in the slots ( ( ( g ^ d ) * 7919 + h ) % 65521 ) % slotCount, with the first
+# displacement d of the bucket giving free and distinct slots.  The largest buckets are
+# placed first.  Twice as many slots as tokens keep the search short.
+set( alphabet "abcdefghijklmnopqrstuvwxyz0123456789_" )
+
+math( EXPR bucketCount "( ${tokensAfter} + 1 ) / 2" )
+math( EXPR slotCount "${tokensAfter} * 2" )
+set( maxBucketSize 0 )
+set( tokenIndex 0 )
+
+foreach( token ${tokens} )
+    string( LENGTH "${token}" tokenLength )
+    math( EXPR lastChar "${tokenLength} - 1" )
+    set( h 0 )
+    set( g 0 )
+
+    foreach( charIndex RANGE ${lastChar} )
+        string( SUBSTRING "${token}" ${charIndex} 1 char )
+        string( FIND "${alphabet}" "${char}" code )
+        math( EXPR h "( ${h} * 31 + ${code} + 1 ) & 65535" )
+        math( EXPR g "( ${g} * 37 + ${code} + 1 ) & 65535" )
+    endforeach()
+
+    math( EXPR bucket "${h} % ${bucketCount}" )
+    list( APPEND bucket_${bucket} ${tokenIndex} )
+    list( LENGTH bucket_${bucket} bucketSize )
+
+    if( bucketSize GREATER maxBucketSize )
+        set( maxBucketSize ${bucketSize} )
+    endif()
+
+    set( h_${tokenIndex} ${h} )
+    set( g_${tokenIndex} ${g} )
+    math( EXPR tokenIndex "${tokenIndex} + 1" )
+endforeach()
+
+math( EXPR lastBucket "${bucketCount} - 1" )
+set( bucketSize ${maxBucketSize} )
+
+while( bucketSize GREATER 0 )
+    foreach( bucket RANGE ${lastBucket} )
+        set( members "" )
+
+        if( DEFINED bucket_${bucket} )
+            set( members ${bucket_${bucket}} )
+        endif()
+
+        list( LENGTH members memberCount )
+
+        if( memberCount EQUAL bucketSize )
+            set( displacement 0 )
+            set( placed FALSE )
+
+            while( NOT placed )
+                if( displacement GREATER 65535 )
+                    message( FATAL_ERROR "${dsnErrorMsg} no perfect hash found for <${inputFile}>." )
+                endif()
+
+                set( placed TRUE )
+                set( bucketSlots "" )
+
+                foreach( member ${members} )
+                    math( EXPR slot "( ( ( ${g_${member}} ^ ${displacement} ) * 7919 + ${h_${member}} ) % 65521 ) % ${slotCount}" )
+                    list( FIND bucketSlots ${slot} found )
+
+                    if( DEFINED slot_${slot} OR NOT found EQUAL -1 )
+                        set( placed FALSE )
+                        break()
+                    endif()
+
+                    list( APPEND bucketSlots ${slot} )
+                endforeach()
+
+                if( NOT placed )
+                    math( EXPR displacement "${displacement} + 1" )
+                endif()
+            endwhile()
+
+            set( displacement_${bucket} ${displacement} )
+            set( memberIndex 0 )
+
+            foreach( slot ${bucketSlots} )
+                list( GET members ${memberIndex} slot_${slot} )
+                math( EXPR memberIndex "${memberIndex} + 1" )
+            endforeach()
+        endif()
+    endforeach()
+
+    math( EXPR bucketSize "${bucketSize} - 1" )
+endwhile()
+
+set( displacementTable "" )
+
+foreach( bucket RANGE ${lastBucket} )
+    if( NOT DEFINED displacement_${bucket} )
+        set( displacement_${bucket} 0 )
+    endif()
+
+    set( displacementTable "${displacementTable}    ${displacement_${bucket}},\n" )
+endforeach()
+
+set( slotTable "" )
+math( EXPR lastSlot "${slotCount} - 1" )
+
+foreach( slot RANGE ${lastSlot} )
+    if( NOT DEFINED slot_${slot} )
+        set( slot_${slot} -1 )
+    endif()
+
+    set( slotTable "${slotTable}    ${slot_${slot}},\n" )
+endforeach()
+
 file( WRITE "${outHeaderFile}" "${includeFileHeader}" )
 file( WRITE "${outCppFile}" "${sourceFileHeader}" )
 
@@ -240,6 +355,11 @@ class ${LEXERCLASS} : public DSNLEXER
     static const KEYWORD  keywords[];
     static const unsigned keyword_count;
 
+    /// Auto generated perfect hash of the keywords:
+    static const unsigned short keyword_displacements[];
+    static const short          keyword_slots[];
+    static const KEYWORD_HASH   keyword_perfect_hash;
+
 public:
     /**
      * Constructor ( const std::string&, const wxString& )
@@ -248,7 +368,7 @@ public:
      *   If left empty, then _(\"clipboard\") is used.
      */
     ${LEXERCLASS}( const std::string& aSExpression, const wxString& aSource = wxEmptyString ) :
-        DSNLEXER( keywords, keyword_count, aSExpression, aSource )
+        DSNLEXER( keywords, keyword_count, aSExpression, aSource, &keyword_perfect_hash )
     {
     }
 
@@ -262,7 +382,7 @@ public:
      * @param aFilename is the name of the opened file, needed for error reporting.
      */
     ${LEXERCLASS}( FILE* aFile, const wxString& aFilename ) :
-        DSNLEXER( keywords, keyword_count, aFile, aFilename )
+        DSNLEXER( keywords, keyword_count, aFile, aFilename, &keyword_perfect_hash )
     {
     }
 
@@ -278,7 +398,7 @@ public:
      *  STRING_LINE_READER or FILE_LINE_READER.  No ownership is taken of aLineReader.
      */
     ${LEXERCLASS}( LINE_READER* aLineReader ) :
-        DSNLEXER( keywords, keyword_count, aLineReader )
+        DSNLEXER( keywords, keyword_count, aLineReader, &keyword_perfect_hash )
     {
     }
 
@@ -370,6 +490,18 @@ file( APPEND "${outCppFile}"
 const unsigned ${LEXERCLASS}::keyword_count = unsigned( sizeof( ${LEXERCLASS}::keywords )/sizeof( ${LEXERCLASS}::keywords[0] ) );
 
 
+const unsigned short ${LEXERCLASS}::keyword_displacements[] = {
+${displacementTable}};
+
+const short ${LEXERCLASS}::keyword_slots[] = {
+${slotTable}};
+
+const KEYWORD_HASH ${LEXERCLASS}::keyword_perfect_hash = {
+    keyword_displacements, ${bucketCount},
+    keyword_slots, ${slotCount}
+};
+
+
 const char* ${LEXERCLASS}::TokenName( T aTok )
 {
     const char* ret;
@@ -27,6 +27,7 @@
 #include <cstdarg>
 #include <cstdio>
 #include <cstdlib>         // bsearch()
+#include <cstring>
 #include <cctype>
 
 #include <macros.h>
@@ -54,6 +55,10 @@ void DSNLEXER::init()
 
     curOffset = 0;
 
+    // the perfect hash generated with the keywords needs no table of its own
+    if( keywordPerfectHash )
+        return;
+
 #if 1
     if( keywordCount > 11 )
     {
@@ -74,14 +79,16 @@ void DSNLEXER::init()
 
 
 DSNLEXER::DSNLEXER( const KEYWORD* aKeywordTable, unsigned aKeywordCount,
-                    FILE* aFile, const wxString& aFilename ) :
+                    FILE* aFile, const wxString& aFilename,
+                    const KEYWORD_HASH* aKeywordHash ) :
     iOwnReaders( true ),
     start( NULL ),
     next( NULL ),
     limit( NULL ),
     reader( NULL ),
     keywords( aKeywordTable ),
-    keywordCount( aKeywordCount )
+    keywordCount( aKeywordCount ),
+    keywordPerfectHash( aKeywordHash )
 {
     FILE_LINE_READER* fileReader = new FILE_LINE_READER( aFile, aFilename );
     PushReader( fileReader );
@@ -90,14 +97,16 @@ DSNLEXER::DSNLEXER( const KEYWORD* aKeywordTable, unsigned aKeywordCount,
 
 
 DSNLEXER::DSNLEXER( const KEYWORD* aKeywordTable, unsigned aKeywordCount,
-                    const std::string& aClipboardTxt, const wxString& aSource ) :
+                    const std::string& aClipboardTxt, const wxString& aSource,
+                    const KEYWORD_HASH* aKeywordHash ) :
     iOwnReaders( true ),
     start( NULL ),
     next( NULL ),
     limit( NULL ),
     reader( NULL ),
     keywords( aKeywordTable ),
-    keywordCount( aKeywordCount )
+    keywordCount( aKeywordCount ),
+    keywordPerfectHash( aKeywordHash )
 {
     STRING_LINE_READER* stringReader = new STRING_LINE_READER( aClipboardTxt, aSource.IsEmpty() ?
                                         wxString( FMT_CLIPBOARD ) : aSource );
@@ -107,14 +116,15 @@ DSNLEXER::DSNLEXER( const KEYWORD* aKeywordTable, unsigned aKeywordCount,
 
 
 DSNLEXER::DSNLEXER( const KEYWORD* aKeywordTable, unsigned aKeywordCount,
-                    LINE_READER* aLineReader ) :
+                    LINE_READER* aLineReader, const KEYWORD_HASH* aKeywordHash ) :
     iOwnReaders( false ),
     start( NULL ),
     next( NULL ),
     limit( NULL ),
     reader( NULL ),
     keywords( aKeywordTable ),
-    keywordCount( aKeywordCount )
+    keywordCount( aKeywordCount ),
+    keywordPerfectHash( aKeywordHash )
 {
     if( aLineReader )
         PushReader( aLineReader );
@@ -131,7 +141,8 @@ DSNLEXER::DSNLEXER( const std::string& aSExpression, const wxString& aSource ) :
     limit( NULL ),
     reader( NULL ),
     keywords( empty_keywords ),
-    keywordCount( 0 )
+    keywordCount( 0 ),
+    keywordPerfectHash( NULL )
 {
     STRING_LINE_READER* stringReader = new STRING_LINE_READER( aSExpression, aSource.IsEmpty() ?
                                         wxString( FMT_CLIPBOARD ) : aSource );
@@ -257,8 +268,55 @@ int DSNLEXER::findToken( const std::string& tok )
 
 #else
 
+/**
+ * Function keywordCharCode
+ * returns the code of a character in the perfect hash of the keywords, which must be
+ * its index in "abcdefghijklmnopqrstuvwxyz0123456789_" as in TokenList2DsnLexer.cmake,
+ * or -1 if it cannot be part of a keyword.
+ */
+static inline int keywordCharCode( char cc )
+{
+    if( cc >= 'a' && cc <= 'z' )
+        return cc - 'a';
+
+    if( cc >= '0' && cc <= '9' )
+        return cc - '0' + 26;
+
+    if( cc == '_' )
+        return 36;
+
+    return -1;
+}
+
+
 inline int DSNLEXER::findToken( const std::string& tok )
 {
+    if( keywordPerfectHash )
+    {
+        unsigned h = 0;
+        unsigned g = 0;
+
+        for( char cc : tok )
+        {
+            int code = keywordCharCode( cc );
+
+            if( code < 0 )
+                return DSN_SYMBOL;
+
+            h = ( h * 31 + code + 1 ) & 0xFFFF;
+            g = ( g * 37 + code + 1 ) & 0xFFFF;
+        }
+
+        const KEYWORD_HASH& hash = *keywordPerfectHash;
+        unsigned displacement = hash.displacements[ h % hash.bucketCount ];
+        int slot = hash.slots[ ( ( ( g ^ displacement ) * 7919 + h ) % 65521 ) % hash.slotCount ];
+
+        if( slot >= 0 && !strcmp( keywords[slot].name, tok.c_str() ) )
+            return keywords[slot].token;
+
+        return DSN_SYMBOL;      // not a keyword, some arbitrary symbol.
+    }
+
     KEYWORD_MAP::const_iterator it = keyword_hash.find( tok.c_str() );
     if( it != keyword_hash.end() )
         return it->second;
@@ -697,7 +755,15 @@ L_read:
                 }
 
                 else
-                    curText += *head++;
+                {
+                    // copy the run of plain characters up to the next escape or quote at once
+                    const char* run = head;
+
+                    while( head<limit && *head != '\\' && *head != '"' )
+                        ++head;
+
+                    curText.append( run, head );
+                }
 
             }   // while
 
@@ -776,12 +842,12 @@ L_read:
         }
     }           // specctraMode
 
-    // non-quoted token, read it into curText.
-    curText.clear();
-
+    // non-quoted token, read it into curText with a single copy.
     head = cur;
     while( head<limit && !isSep( *head ) )
-        curText += *head++;
+        ++head;
+
+    curText.assign( cur, head );
 
     if( isNumber( curText.c_str(), curText.c_str() + curText.size() ) )
     {
@@ -808,6 +874,74 @@ exit:   // single point of exit, no returns elsewhere please.
 }
 
 
+void DSNLEXER::CopyList( std::string& aText )
+{
+    wxASSERT( !specctraMode );
+
+    aText += '(';
+    aText += curText;
+
+    const char* cur = next;
+    int         depth = 1;
+
+    for(;;)
+    {
+        const char* run = cur;
+        bool        inString = false;   // quoted strings cannot span lines
+
+        while( cur < limit && depth > 0 )
+        {
+            char cc = *cur++;
+
+            if( inString )
+            {
+                if( cc == '\\' && cur < limit )
+                    ++cur;
+                else if( cc == '"' )
+                    inString = false;
+            }
+            else if( cc == '"' )
+                inString = true;
+            else if( cc == '(' )
+                ++depth;
+            else if( cc == ')' )
+                --depth;
+        }
+
+        aText.append( run, cur );
+
+        if( depth == 0 )
+            break;
+
+        if( readLine() == 0 )
+        {
+            curTok = DSN_EOF;
+            Expecting( DSN_RIGHT );
+        }
+
+        cur = start;
+
+        // a line starting with '#' is a comment, see NextTok()
+        const char* first = cur;
+
+        while( first < limit && isSpace( *first ) )
+            ++first;
+
+        if( first < limit && *first == '#' )
+        {
+            aText.append( cur, limit );
+            cur = limit;
+        }
+    }
+
+    prevTok   = curTok;
+    curTok    = DSN_RIGHT;
+    curText   = ')';
+    curOffset = cur - 1 - start;
+    next      = cur;
+}
+
+
 wxArrayString* DSNLEXER::ReadCommentLines()
 {
     wxArrayString*  ret = 0;
@@ -0,0 +1,434 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <atomic>
+#include <cassert>
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstdlib>
+
+#if defined( __SSE2__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 2 )
+#define SEG_BATCH_HAVE_SSE2
+#include <emmintrin.h>
+#endif
+
+#if defined( SEG_BATCH_HAVE_AVX2 ) && defined( _MSC_VER )
+#include <intrin.h>
+#endif
+
+#include <geometry/seg_batch.h>
+
+#define SEG_BATCH_KERNEL_IMPLEMENTATION
+#include "seg_batch_kernel.h"
+
+
+void SegBatchKernelScalar( const int* aAx, const int* aAy, const int* aBx, const int* aBy,
+                           size_t aCount, const SEG_BATCH_QUERY& aQuery,
+                           double* aDist, unsigned char* aCross )
+{
+    segBatchKernel<SCALAR_OPS>( aAx, aAy, aBx, aBy, aCount, aQuery, aDist, aCross );
+}
+
+
+#ifdef SEG_BATCH_HAVE_SSE2
+
+namespace
+{
+
+struct SSE2_OPS
+{
+    typedef __m128d VEC;
+    typedef __m128d MASK;
+
+    static const size_t Width = 2;
+
+    static VEC Load( const int* aP )
+    {
+        return _mm_cvtepi32_pd( _mm_loadl_epi64( reinterpret_cast<const __m128i*>( aP ) ) );
+    }
+
+    static VEC Set( double aV )               { return _mm_set1_pd( aV ); }
+    static void Store( double* aP, VEC aV )   { _mm_storeu_pd( aP, aV ); }
+
+    static VEC Add( VEC aA, VEC aB )          { return _mm_add_pd( aA, aB ); }
+    static VEC Sub( VEC aA, VEC aB )          { return _mm_sub_pd( aA, aB ); }
+    static VEC Mul( VEC aA, VEC aB )          { return _mm_mul_pd( aA, aB ); }
+    static VEC Div( VEC aA, VEC aB )          { return _mm_div_pd( aA, aB ); }
+    static VEC Min( VEC aA, VEC aB )          { return _mm_min_pd( aA, aB ); }
+    static VEC Max( VEC aA, VEC aB )          { return _mm_max_pd( aA, aB ); }
+
+    static MASK Lt( VEC aA, VEC aB )          { return _mm_cmplt_pd( aA, aB ); }
+    static MASK Gt( VEC aA, VEC aB )          { return _mm_cmpgt_pd( aA, aB ); }
+    static MASK Le( VEC aA, VEC aB )          { return _mm_cmple_pd( aA, aB ); }
+    static MASK Ge( VEC aA, VEC aB )          { return _mm_cmpge_pd( aA, aB ); }
+    static MASK And( MASK aA, MASK aB )       { return _mm_and_pd( aA, aB ); }
+    static MASK Or( MASK aA, MASK aB )        { return _mm_or_pd( aA, aB ); }
+
+    static VEC Select( MASK aM, VEC aA, VEC aB )
+    {
+        return _mm_or_pd( _mm_and_pd( aM, aA ), _mm_andnot_pd( aM, aB ) );
+    }
+
+    static int Bits( MASK aM )                { return _mm_movemask_pd( aM ); }
+};
+
+}   // namespace
+
+
+void SegBatchKernelSSE2( const int* aAx, const int* aAy, const int* aBx, const int* aBy,
+                         size_t aCount, const SEG_BATCH_QUERY& aQuery,
+                         double* aDist, unsigned char* aCross )
+{
+    segBatchKernel<SSE2_OPS>( aAx, aAy, aBx, aBy, aCount, aQuery, aDist, aCross );
+}
+
+#endif  // SEG_BATCH_HAVE_SSE2
+
+
+/**
+ * Tells if SEG::PointCloserThan() may be off by more than a unit for a segment: it measures
+ * the distance to a 45 degree line for the nearly diagonal and nearly orthogonal segments,
+ * which is wrong for the segments of slope 1/n, n > 2, and its line coefficients overflow
+ * far from the origin.
+ */
+/**
+ * Absolute value of a coordinate or of a coordinate difference, which overflow an int (and
+ * std::abs( INT_MIN ) is undefined).
+ */
+static int64_t abs64( int64_t aValue )
+{
+    return aValue < 0 ? -aValue : aValue;
+}
+
+
+static bool isInexact( const SEG& aSeg )
+{
+    int64_t dx = abs64( (int64_t) aSeg.B.x - aSeg.A.x );
+    int64_t dy = abs64( (int64_t) aSeg.B.y - aSeg.A.y );
+
+    if( std::min( dx, dy ) == 1 && std::max( dx, dy ) >= 3 )
+        return true;
+
+    if( abs64( dx - dy ) <= 1 || dx <= 1 || dy <= 1 )
+        return abs64( aSeg.A.x ) + abs64( aSeg.A.y ) >= INT_MAX;
+
+    return false;
+}
+
+
+static SEG_BATCH::KERNEL detectKernel()
+{
+#ifdef SEG_BATCH_HAVE_AVX2
+#ifdef _MSC_VER
+    int info[4];
+
+    __cpuid( info, 1 );
+
+    // the OS must save the AVX registers
+    bool osSavesAvx = ( info[2] & ( 1 << 27 ) ) && ( _xgetbv( 0 ) & 6 ) == 6;
+
+    __cpuidex( info, 7, 0 );
+
+    if( osSavesAvx && ( info[1] & ( 1 << 5 ) ) )
+        return SEG_BATCH::KERNEL_AVX2;
+#else
+    __builtin_cpu_init();
+
+    if( __builtin_cpu_supports( "avx2" ) )
+        return SEG_BATCH::KERNEL_AVX2;
+#endif
+#endif
+
+#ifdef SEG_BATCH_HAVE_SSE2
+    return SEG_BATCH::KERNEL_SSE2;
+#else
+    return SEG_BATCH::KERNEL_SCALAR;
+#endif
+}
+
+
+static std::atomic<int> s_kernel( -1 );
+
+
+SEG_BATCH::KERNEL SEG_BATCH::BestKernel()
+{
+    static const KERNEL best = detectKernel();
+
+    return best;
+}
+
+
+SEG_BATCH::KERNEL SEG_BATCH::GetKernel()
+{
+    int kernel = s_kernel.load();
+
+    return kernel < 0 ? BestKernel() : (KERNEL) kernel;
+}
+
+
+void SEG_BATCH::SetKernel( KERNEL aKernel )
+{
+    s_kernel.store( std::min( aKernel, BestKernel() ) );
+}
+
+
+// std::min() takes it by reference
+const size_t SEG_BATCH::ChunkSize;
+
+
+SEG_BATCH::SEG_BATCH() :
+    m_extent( 0 )
+{
+}
+
+
+void SEG_BATCH::Clear()
+{
+    m_ax.clear();
+    m_ay.clear();
+    m_bx.clear();
+    m_by.clear();
+    m_inexact.clear();
+    m_extent = 0;
+}
+
+
+void SEG_BATCH::Reserve( size_t aSize )
+{
+    m_ax.reserve( aSize );
+    m_ay.reserve( aSize );
+    m_bx.reserve( aSize );
+    m_by.reserve( aSize );
+    m_inexact.reserve( aSize );
+}
+
+
+void SEG_BATCH::Add( const SEG& aSeg )
+{
+    m_ax.push_back( aSeg.A.x );
+    m_ay.push_back( aSeg.A.y );
+    m_bx.push_back( aSeg.B.x );
+    m_by.push_back( aSeg.B.y );
+    m_inexact.push_back( isInexact( aSeg ) );
+
+    m_extent = std::max( { m_extent, abs64( aSeg.A.x ), abs64( aSeg.A.y ),
+                           abs64( aSeg.B.x ), abs64( aSeg.B.y ) } );
+}
+
+
+void SEG_BATCH::prepareQuery( const SEG& aSeg, SEG_BATCH_QUERY& aQuery, double& aMargin ) const
+{
+    double extent = std::max( { m_extent, abs64( aSeg.A.x ), abs64( aSeg.A.y ),
+                                abs64( aSeg.B.x ), abs64( aSeg.B.y ) } );
+
+    aQuery.m_ax = aSeg.A.x;
+    aQuery.m_ay = aSeg.A.y;
+    aQuery.m_bx = aSeg.B.x;
+    aQuery.m_by = aSeg.B.y;
+
+    // The coordinates relative to the query are below 2 * extent, and the products of the
+    // orientation tests below 16 * extent^2: the tolerance is far above their rounding error.
+    aQuery.m_orientTolerance = 1e-12 * 16.0 * extent * extent;
+
+    // SEG rounds the nearest points to the grid and approximates the nearly diagonal
+    // distances, both within a unit or two.  The kernel distances are much more precise.
+    aMargin = 4.0 + 1e-9 * 4.0 * extent;
+}
+
+
+void SEG_BATCH::runKernel( const SEG_BATCH_QUERY& aQuery, size_t aStart, size_t aCount,
+                           double* aDist, unsigned char* aCross ) const
+{
+    SEG_BATCH_KERNEL_FUNC func = SegBatchKernelScalar;
+
+    switch( GetKernel() )
+    {
+#ifdef SEG_BATCH_HAVE_AVX2
+    case KERNEL_AVX2: func = SegBatchKernelAVX2; break;
+#endif
+#ifdef SEG_BATCH_HAVE_SSE2
+    case KERNEL_SSE2: func = SegBatchKernelSSE2; break;
+#endif
+    default: break;
+    }
+
+    func( &m_ax[aStart], &m_ay[aStart], &m_bx[aStart], &m_by[aStart], aCount, aQuery,
+          aDist, aCross );
+}
+
+
+int SEG_BATCH::Collide( const SEG& aSeg, int aClearance, size_t aStart ) const
+{
+    return collide( aSeg, aClearance, aStart, nullptr );
+}
+
+
+void SEG_BATCH::CollideAll( const SEG& aSeg, int aClearance, std::vector<int>& aIndices ) const
+{
+    collide( aSeg, aClearance, 0, &aIndices );
+}
+
+
+int SEG_BATCH::collide( const SEG& aSeg, int aClearance, size_t aStart,
+                        std::vector<int>* aAll ) const
+{
+    int first = -1;
+
+    auto found = [&]( size_t aIndex )
+    {
+        if( first < 0 )
+            first = aIndex;
+
+        if( aAll )
+            aAll->push_back( aIndex );
+
+        return aAll != nullptr;
+    };
+
+    if( isInexact( aSeg ) )
+    {
+        for( size_t ii = aStart; ii < Size(); ii++ )
+        {
+            if( Get( ii ).Collide( aSeg, aClearance ) && !found( ii ) )
+                break;
+        }
+
+        return first;
+    }
+
+    SEG_BATCH_QUERY query;
+    double margin;
+
+    prepareQuery( aSeg, query, margin );
+
+    // the distances certainly below or above the clearance for SEG
+    double below = aClearance > margin ? ( aClearance - margin ) * ( aClearance - margin ) : -1.0;
+    double above = ( aClearance + margin ) * ( aClearance + margin );
+
+    double        dist[ChunkSize];
+    unsigned char cross[ChunkSize];
+
+    for( size_t start = aStart; start < Size(); start += ChunkSize )
+    {
+        size_t count = std::min( ChunkSize, Size() - start );
+
+        runKernel( query, start, count, dist, cross );
+
+        for( size_t ii = 0; ii < count; ii++ )
+        {
+            size_t index = start + ii;
+            bool   collides;
+
+            if( !m_inexact[index] && ( cross[ii] == SBC_YES || dist[ii] < below ) )
+                collides = true;
+            else if( !m_inexact[index] && cross[ii] == SBC_NO && dist[ii] > above )
+                collides = false;
+            else
+                collides = Get( index ).Collide( aSeg, aClearance );
+
+            if( collides && !found( index ) )
+                return first;
+        }
+    }
+
+    return first;
+}
+
+
+SEG_BATCH::ecoord SEG_BATCH::SquaredDistance( const SEG& aSeg, int* aIndex ) const
+{
+    assert( Size() > 0 );
+
+    SEG_BATCH_QUERY query;
+    double margin;
+
+    prepareQuery( aSeg, query, margin );
+
+    double        dist[ChunkSize];
+    unsigned char cross[ChunkSize];
+
+    // First pass: an upper bound of the distance, exact for the segments the kernel is
+    // unsure about
+    ecoord best = -1;
+    int    bestIndex = -1;
+    double bound = HUGE_VAL;
+
+    for( size_t start = 0; start < Size(); start += ChunkSize )
+    {
+        size_t count = std::min( ChunkSize, Size() - start );
+
+        runKernel( query, start, count, dist, cross );
+
+        for( size_t ii = 0; ii < count; ii++ )
+        {
+            if( cross[ii] != SBC_UNSURE )
+            {
+                bound = std::min( bound, dist[ii] );
+                continue;
+            }
+
+            ecoord d = Get( start + ii ).SquaredDistance( aSeg );
+
+            bound = std::min( bound, (double) d );
+
+            if( best < 0 || d < best )
+            {
+                best = d;
+                bestIndex = start + ii;
+            }
+        }
+    }
+
+    // Second pass: SEG measures the segments which can be at the smallest distance for it
+    double limit = std::sqrt( bound ) + 2.0 * margin;
+
+    limit *= limit;
+
+    for( size_t start = 0; start < Size(); start += ChunkSize )
+    {
+        size_t count = std::min( ChunkSize, Size() - start );
+
+        runKernel( query, start, count, dist, cross );
+
+        for( size_t ii = 0; ii < count; ii++ )
+        {
+            if( cross[ii] == SBC_UNSURE || dist[ii] > limit )
+                continue;
+
+            ecoord d = Get( start + ii ).SquaredDistance( aSeg );
+            int    index = start + ii;
+
+            if( best < 0 || d < best || ( d == best && index < bestIndex ) )
+            {
+                best = d;
+                bestIndex = index;
+            }
+        }
+    }
+
+    if( aIndex )
+        *aIndex = bestIndex;
+
+    return best;
+}
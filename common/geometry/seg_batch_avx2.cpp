@@ -0,0 +1,80 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file seg_batch_avx2.cpp
+ * @brief AVX2 kernel of SEG_BATCH.  This file is built with AVX2 enabled, its code is only
+ * run once SEG_BATCH has checked the CPU supports it.  Do not include any header with inline
+ * functions shared with other files here.
+ */
+
+#include <immintrin.h>
+
+#define SEG_BATCH_KERNEL_IMPLEMENTATION
+#include "seg_batch_kernel.h"
+
+namespace
+{
+
+struct AVX2_OPS
+{
+    typedef __m256d VEC;
+    typedef __m256d MASK;
+
+    static const size_t Width = 4;
+
+    static VEC Load( const int* aP )
+    {
+        return _mm256_cvtepi32_pd( _mm_loadu_si128( reinterpret_cast<const __m128i*>( aP ) ) );
+    }
+
+    static VEC Set( double aV )               { return _mm256_set1_pd( aV ); }
+    static void Store( double* aP, VEC aV )   { _mm256_storeu_pd( aP, aV ); }
+
+    static VEC Add( VEC aA, VEC aB )          { return _mm256_add_pd( aA, aB ); }
+    static VEC Sub( VEC aA, VEC aB )          { return _mm256_sub_pd( aA, aB ); }
+    static VEC Mul( VEC aA, VEC aB )          { return _mm256_mul_pd( aA, aB ); }
+    static VEC Div( VEC aA, VEC aB )          { return _mm256_div_pd( aA, aB ); }
+    static VEC Min( VEC aA, VEC aB )          { return _mm256_min_pd( aA, aB ); }
+    static VEC Max( VEC aA, VEC aB )          { return _mm256_max_pd( aA, aB ); }
+
+    static MASK Lt( VEC aA, VEC aB )          { return _mm256_cmp_pd( aA, aB, _CMP_LT_OQ ); }
+    static MASK Gt( VEC aA, VEC aB )          { return _mm256_cmp_pd( aA, aB, _CMP_GT_OQ ); }
+    static MASK Le( VEC aA, VEC aB )          { return _mm256_cmp_pd( aA, aB, _CMP_LE_OQ ); }
+    static MASK Ge( VEC aA, VEC aB )          { return _mm256_cmp_pd( aA, aB, _CMP_GE_OQ ); }
+    static MASK And( MASK aA, MASK aB )       { return _mm256_and_pd( aA, aB ); }
+    static MASK Or( MASK aA, MASK aB )        { return _mm256_or_pd( aA, aB ); }
+
+    static VEC Select( MASK aM, VEC aA, VEC aB ) { return _mm256_blendv_pd( aB, aA, aM ); }
+    static int Bits( MASK aM )                { return _mm256_movemask_pd( aM ); }
+};
+
+}   // namespace
+
+
+void SegBatchKernelAVX2( const int* aAx, const int* aAy, const int* aBx, const int* aBy,
+                         size_t aCount, const SEG_BATCH_QUERY& aQuery,
+                         double* aDist, unsigned char* aCross )
+{
+    segBatchKernel<AVX2_OPS>( aAx, aAy, aBx, aBy, aCount, aQuery, aDist, aCross );
+}
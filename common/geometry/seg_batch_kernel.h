@@ -0,0 +1,228 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file seg_batch_kernel.h
+ * @brief Kernels of SEG_BATCH, private to seg_batch.cpp and seg_batch_avx2.cpp.
+ *
+ * The kernel is written once over a set of vector operations (OPS) and instantiated for
+ * plain doubles, SSE2 and AVX2.  It must only use the OPS and its own inline functions, all
+ * with internal linkage: seg_batch_avx2.cpp is compiled with AVX2 enabled, and any inline
+ * function shared with other translation units could end up in AVX2 code run on any CPU.
+ */
+
+#ifndef SEG_BATCH_KERNEL_H
+#define SEG_BATCH_KERNEL_H
+
+#include <cstddef>
+
+/**
+ * The segment tested against a batch, and the tolerance of the orientation tests.
+ */
+struct SEG_BATCH_QUERY
+{
+    double m_ax, m_ay, m_bx, m_by;
+    double m_orientTolerance;
+};
+
+///> Crossing state of a segment of the batch with the query segment
+enum SEG_BATCH_CROSSING
+{
+    SBC_NO = 0,
+    SBC_YES,
+    SBC_UNSURE      ///< too close to collinear to tell in floating point
+};
+
+/**
+ * Computes, for each segment of the batch (in aAx..aBy[0, aCount)), the squared distance
+ * between its end points and the query segment, or 0 when it certainly crosses the query,
+ * in aDist, and the crossing state in aCross.
+ */
+typedef void (*SEG_BATCH_KERNEL_FUNC)( const int* aAx, const int* aAy,
+                                       const int* aBx, const int* aBy, size_t aCount,
+                                       const SEG_BATCH_QUERY& aQuery,
+                                       double* aDist, unsigned char* aCross );
+
+void SegBatchKernelScalar( const int* aAx, const int* aAy, const int* aBx, const int* aBy,
+                           size_t aCount, const SEG_BATCH_QUERY& aQuery,
+                           double* aDist, unsigned char* aCross );
+
+void SegBatchKernelSSE2( const int* aAx, const int* aAy, const int* aBx, const int* aBy,
+                         size_t aCount, const SEG_BATCH_QUERY& aQuery,
+                         double* aDist, unsigned char* aCross );
+
+void SegBatchKernelAVX2( const int* aAx, const int* aAy, const int* aBx, const int* aBy,
+                         size_t aCount, const SEG_BATCH_QUERY& aQuery,
+                         double* aDist, unsigned char* aCross );
+
+
+#ifdef SEG_BATCH_KERNEL_IMPLEMENTATION
+
+namespace
+{
+
+/**
+ * One lane operations, used by the scalar kernel and for the remainder of the vector ones.
+ */
+struct SCALAR_OPS
+{
+    typedef double VEC;
+    typedef bool   MASK;
+
+    static const size_t Width = 1;
+
+    static VEC Load( const int* aP )          { return *aP; }
+    static VEC Set( double aV )               { return aV; }
+    static void Store( double* aP, VEC aV )   { *aP = aV; }
+
+    static VEC Add( VEC aA, VEC aB )          { return aA + aB; }
+    static VEC Sub( VEC aA, VEC aB )          { return aA - aB; }
+    static VEC Mul( VEC aA, VEC aB )          { return aA * aB; }
+    static VEC Div( VEC aA, VEC aB )          { return aA / aB; }
+    static VEC Min( VEC aA, VEC aB )          { return aA < aB ? aA : aB; }
+    static VEC Max( VEC aA, VEC aB )          { return aA > aB ? aA : aB; }
+
+    static MASK Lt( VEC aA, VEC aB )          { return aA < aB; }
+    static MASK Gt( VEC aA, VEC aB )          { return aA > aB; }
+    static MASK Le( VEC aA, VEC aB )          { return aA <= aB; }
+    static MASK Ge( VEC aA, VEC aB )          { return aA >= aB; }
+    static MASK And( MASK aA, MASK aB )       { return aA && aB; }
+    static MASK Or( MASK aA, MASK aB )        { return aA || aB; }
+
+    static VEC Select( MASK aM, VEC aA, VEC aB ) { return aM ? aA : aB; }
+    static int Bits( MASK aM )                { return aM ? 1 : 0; }
+};
+
+
+/**
+ * Squared distance from the point (aWx, aWy) relative to the start of a segment, to the
+ * segment of direction (aDx, aDy) and squared length aLen.
+ */
+template <class OPS>
+inline typename OPS::VEC pointSegDist( typename OPS::VEC aWx, typename OPS::VEC aWy,
+                                       typename OPS::VEC aDx, typename OPS::VEC aDy,
+                                       typename OPS::VEC aLen )
+{
+    typedef typename OPS::VEC VEC;
+
+    VEC t = OPS::Add( OPS::Mul( aWx, aDx ), OPS::Mul( aWy, aDy ) );
+
+    VEC distA = OPS::Add( OPS::Mul( aWx, aWx ), OPS::Mul( aWy, aWy ) );
+
+    VEC ux = OPS::Sub( aWx, aDx );
+    VEC uy = OPS::Sub( aWy, aDy );
+    VEC distB = OPS::Add( OPS::Mul( ux, ux ), OPS::Mul( uy, uy ) );
+
+    // the cross product keeps the precision when the point is close to a long segment
+    VEC c = OPS::Sub( OPS::Mul( aDx, aWy ), OPS::Mul( aDy, aWx ) );
+    VEC distIn = OPS::Div( OPS::Mul( c, c ), OPS::Max( aLen, OPS::Set( 1.0 ) ) );
+
+    return OPS::Select( OPS::Le( t, OPS::Set( 0.0 ) ), distA,
+                        OPS::Select( OPS::Ge( t, aLen ), distB, distIn ) );
+}
+
+
+template <class OPS>
+inline void segBatchKernel( const int* aAx, const int* aAy, const int* aBx, const int* aBy,
+                            size_t aCount, const SEG_BATCH_QUERY& aQuery,
+                            double* aDist, unsigned char* aCross )
+{
+    typedef typename OPS::VEC  VEC;
+    typedef typename OPS::MASK MASK;
+
+    // everything is computed relative to the start of the query segment
+    const VEC qx = OPS::Set( aQuery.m_ax );
+    const VEC qy = OPS::Set( aQuery.m_ay );
+    const VEC ex = OPS::Set( aQuery.m_bx - aQuery.m_ax );
+    const VEC ey = OPS::Set( aQuery.m_by - aQuery.m_ay );
+    const VEC eLen = OPS::Add( OPS::Mul( ex, ex ), OPS::Mul( ey, ey ) );
+    const VEC zero = OPS::Set( 0.0 );
+    const VEC tol = OPS::Set( aQuery.m_orientTolerance );
+    const VEC negTol = OPS::Set( -aQuery.m_orientTolerance );
+
+    size_t ii = 0;
+
+    for( ; ii + OPS::Width <= aCount; ii += OPS::Width )
+    {
+        VEC p0x = OPS::Sub( OPS::Load( aAx + ii ), qx );
+        VEC p0y = OPS::Sub( OPS::Load( aAy + ii ), qy );
+        VEC p1x = OPS::Sub( OPS::Load( aBx + ii ), qx );
+        VEC p1y = OPS::Sub( OPS::Load( aBy + ii ), qy );
+        VEC fx = OPS::Sub( p1x, p0x );
+        VEC fy = OPS::Sub( p1y, p0y );
+        VEC fLen = OPS::Add( OPS::Mul( fx, fx ), OPS::Mul( fy, fy ) );
+
+        // sides of the batch segment ends from the query, and of the query ends from it
+        VEC o1 = OPS::Sub( OPS::Mul( ex, p0y ), OPS::Mul( ey, p0x ) );
+        VEC o2 = OPS::Sub( OPS::Mul( ex, p1y ), OPS::Mul( ey, p1x ) );
+        VEC o3 = OPS::Sub( OPS::Mul( fy, p0x ), OPS::Mul( fx, p0y ) );
+        VEC o4 = OPS::Sub( OPS::Mul( fx, OPS::Sub( ey, p0y ) ),
+                           OPS::Mul( fy, OPS::Sub( ex, p0x ) ) );
+
+        MASK pos1 = OPS::Gt( o1, tol ), neg1 = OPS::Lt( o1, negTol );
+        MASK pos2 = OPS::Gt( o2, tol ), neg2 = OPS::Lt( o2, negTol );
+        MASK pos3 = OPS::Gt( o3, tol ), neg3 = OPS::Lt( o3, negTol );
+        MASK pos4 = OPS::Gt( o4, tol ), neg4 = OPS::Lt( o4, negTol );
+
+        MASK crosses = OPS::And( OPS::Or( OPS::And( pos1, neg2 ), OPS::And( neg1, pos2 ) ),
+                                 OPS::Or( OPS::And( pos3, neg4 ), OPS::And( neg3, pos4 ) ) );
+
+        MASK apart = OPS::Or( OPS::Or( OPS::And( pos1, pos2 ), OPS::And( neg1, neg2 ) ),
+                              OPS::Or( OPS::And( pos3, pos4 ), OPS::And( neg3, neg4 ) ) );
+
+        VEC dist = OPS::Min( pointSegDist<OPS>( p0x, p0y, ex, ey, eLen ),
+                             pointSegDist<OPS>( p1x, p1y, ex, ey, eLen ) );
+
+        dist = OPS::Min( dist, pointSegDist<OPS>( OPS::Sub( zero, p0x ), OPS::Sub( zero, p0y ),
+                                                  fx, fy, fLen ) );
+        dist = OPS::Min( dist, pointSegDist<OPS>( OPS::Sub( ex, p0x ), OPS::Sub( ey, p0y ),
+                                                  fx, fy, fLen ) );
+
+        OPS::Store( aDist + ii, OPS::Select( crosses, zero, dist ) );
+
+        int crossBits = OPS::Bits( crosses );
+        int apartBits = OPS::Bits( apart );
+
+        for( size_t lane = 0; lane < OPS::Width; lane++ )
+        {
+            if( ( crossBits >> lane ) & 1 )
+                aCross[ii + lane] = SBC_YES;
+            else if( ( apartBits >> lane ) & 1 )
+                aCross[ii + lane] = SBC_NO;
+            else
+                aCross[ii + lane] = SBC_UNSURE;
+        }
+    }
+
+    if( ii < aCount && OPS::Width > 1 )
+    {
+        segBatchKernel<SCALAR_OPS>( aAx + ii, aAy + ii, aBx + ii, aBy + ii, aCount - ii,
+                                    aQuery, aDist + ii, aCross + ii );
+    }
+}
+
+}   // namespace
+
+#endif  // SEG_BATCH_KERNEL_IMPLEMENTATION
+
+#endif  // SEG_BATCH_KERNEL_H
@@ -0,0 +1,233 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <utility>
+
+#include <geometry/seg_grid.h>
+#include <geometry/shape_line_chain.h>
+
+///> Limit of the number of cells along each axis
+static const int MaxGridSize = 1024;
+
+
+SEG_GRID::SEG_GRID( const SHAPE_LINE_CHAIN& aChain )
+{
+    int segCount = aChain.SegmentCount();
+
+    m_bbox.Compute( aChain.CPoints() );
+
+    double w = (double) m_bbox.GetWidth() + 1.0;
+    double h = (double) m_bbox.GetHeight() + 1.0;
+
+    // About one cell per segment, not too many along a thin chain
+    m_cellSize = std::max( { std::sqrt( w * h / std::max( segCount, 1 ) ),
+                             std::max( w, h ) / MaxGridSize, 1.0 } );
+
+    m_cols = std::min( MaxGridSize, (int) ( w / m_cellSize ) + 1 );
+    m_rows = std::min( MaxGridSize, (int) ( h / m_cellSize ) + 1 );
+
+    // The (cell, segment) pairs of all the segments, sorted by cell below
+    std::vector<std::pair<int, int>> entries;
+
+    entries.reserve( 2 * segCount );
+    m_segments.Reserve( segCount );
+
+    for( int i = 0; i < segCount; i++ )
+    {
+        const SEG s = aChain.CSegment( i );
+
+        m_segments.Add( s );
+        double ymin = std::min( s.A.y, s.B.y );
+        double ymax = std::max( s.A.y, s.B.y );
+        int row0 = cellY( ymin );
+        int row1 = cellY( ymax );
+
+        for( int row = row0; row <= row1; row++ )
+        {
+            double xlo, xhi;
+
+            if( s.A.y == s.B.y )
+            {
+                xlo = std::min( s.A.x, s.B.x );
+                xhi = std::max( s.A.x, s.B.x );
+            }
+            else
+            {
+                // The part of the segment in this row
+                double rowTop = m_bbox.GetY() + row * m_cellSize;
+                double y0 = std::max( ymin, rowTop );
+                double y1 = std::min( ymax, rowTop + m_cellSize );
+                double slope = (double) ( s.B.x - s.A.x ) / ( s.B.y - s.A.y );
+                double x0 = s.A.x + slope * ( y0 - s.A.y );
+                double x1 = s.A.x + slope * ( y1 - s.A.y );
+
+                xlo = std::min( x0, x1 );
+                xhi = std::max( x0, x1 );
+            }
+
+            int col0 = cellX( xlo - 1.0 );
+            int col1 = cellX( xhi + 1.0 );
+
+            for( int col = col0; col <= col1; col++ )
+                entries.emplace_back( row * m_cols + col, i );
+        }
+    }
+
+    std::sort( entries.begin(), entries.end() );
+
+    m_cellStart.assign( m_cols * m_rows + 1, 0 );
+    m_cellSegs.reserve( entries.size() );
+
+    for( const auto& entry : entries )
+    {
+        m_cellStart[entry.first + 1]++;
+        m_cellSegs.push_back( entry.second );
+    }
+
+    for( size_t i = 1; i < m_cellStart.size(); i++ )
+        m_cellStart[i] += m_cellStart[i - 1];
+}
+
+
+int SEG_GRID::cellX( double aX ) const
+{
+    int col = (int) std::floor( ( aX - m_bbox.GetX() ) / m_cellSize );
+
+    return std::max( 0, std::min( m_cols - 1, col ) );
+}
+
+
+int SEG_GRID::cellY( double aY ) const
+{
+    int row = (int) std::floor( ( aY - m_bbox.GetY() ) / m_cellSize );
+
+    return std::max( 0, std::min( m_rows - 1, row ) );
+}
+
+
+void SEG_GRID::Query( const BOX2I& aBox, std::vector<int>& aSegments ) const
+{
+    size_t first = aSegments.size();
+
+    int col0 = cellX( aBox.GetLeft() );
+    int col1 = cellX( aBox.GetRight() );
+    int row0 = cellY( aBox.GetTop() );
+    int row1 = cellY( aBox.GetBottom() );
+
+    for( int row = row0; row <= row1; row++ )
+    {
+        int cell0 = row * m_cols + col0;
+        int cell1 = row * m_cols + col1;
+
+        aSegments.insert( aSegments.end(), m_cellSegs.begin() + m_cellStart[cell0],
+                          m_cellSegs.begin() + m_cellStart[cell1 + 1] );
+    }
+
+    std::sort( aSegments.begin() + first, aSegments.end() );
+    aSegments.erase( std::unique( aSegments.begin() + first, aSegments.end() ),
+                     aSegments.end() );
+}
+
+
+int SEG_GRID::NearestSegment( const SHAPE_LINE_CHAIN& aChain, const VECTOR2I& aP,
+                              int& aDist ) const
+{
+    int cx = cellX( aP.x );
+    int cy = cellY( aP.y );
+    int best = -1;
+
+    aDist = INT_MAX;
+
+    auto scanCell = [&]( int aCol, int aRow )
+    {
+        int cell = aRow * m_cols + aCol;
+
+        for( int i = m_cellStart[cell]; i < m_cellStart[cell + 1]; i++ )
+        {
+            int index = m_cellSegs[i];
+            int d = aChain.CSegment( index ).Distance( aP );
+
+            if( d < aDist || ( d == aDist && index < best ) )
+            {
+                aDist = d;
+                best = index;
+            }
+        }
+    };
+
+    // Scan the rings of cells around the one of aP, until the cells left are all further
+    // than the nearest segment found
+    for( int k = 0; ; k++ )
+    {
+        int col0 = cx - k, col1 = cx + k;
+        int row0 = cy - k, row1 = cy + k;
+
+        for( int col = std::max( col0, 0 ); col <= std::min( col1, m_cols - 1 ); col++ )
+        {
+            if( row0 >= 0 )
+                scanCell( col, row0 );
+
+            if( row1 < m_rows && k > 0 )
+                scanCell( col, row1 );
+        }
+
+        for( int row = std::max( row0 + 1, 0 ); row <= std::min( row1 - 1, m_rows - 1 ); row++ )
+        {
+            if( col0 >= 0 )
+                scanCell( col0, row );
+
+            if( col1 < m_cols && k > 0 )
+                scanCell( col1, row );
+        }
+
+        // Distance from aP to the cells not scanned yet
+        double left = m_bbox.GetX() + col0 * m_cellSize;
+        double top = m_bbox.GetY() + row0 * m_cellSize;
+        double unscanned = HUGE_VAL;
+
+        if( col0 > 0 )
+            unscanned = std::min( unscanned, aP.x - left );
+
+        if( col1 < m_cols - 1 )
+            unscanned = std::min( unscanned, left + ( 2 * k + 1 ) * m_cellSize - aP.x );
+
+        if( row0 > 0 )
+            unscanned = std::min( unscanned, aP.y - top );
+
+        if( row1 < m_rows - 1 )
+            unscanned = std::min( unscanned, top + ( 2 * k + 1 ) * m_cellSize - aP.y );
+
+        if( unscanned == HUGE_VAL )
+            break;
+
+        // SEG::Distance() rounds the nearest point: a farther segment could not come out
+        // nearer by more than a couple of units
+        if( best >= 0 && unscanned > (double) aDist + 2.0 )
+            break;
+    }
+
+    return best;
+}
@@ -27,6 +27,33 @@
 #include <common.h>
 #include <geometry/shape_line_chain.h>
 #include <geometry/shape_circle.h>
+#include <geometry/seg_grid.h>
+
+
+std::shared_ptr<const SEG_GRID> SHAPE_LINE_CHAIN::segGrid() const
+{
+    if( SegmentCount() < SegGridThreshold )
+        return nullptr;
+
+    std::shared_ptr<const SEG_GRID> grid = std::atomic_load( &m_segGrid );
+
+    if( grid )
+        return grid;
+
+    // Several threads may build it at once, the first one stored is kept
+    std::shared_ptr<const SEG_GRID> built = std::make_shared<const SEG_GRID>( *this );
+
+    if( std::atomic_compare_exchange_strong( &m_segGrid, &grid, built ) )
+        return built;
+
+    return grid;
+}
+
+
+const BOX2I& SHAPE_LINE_CHAIN::segGridBBox( const SEG_GRID& aGrid )
+{
+    return aGrid.BBox();
+}
 
 bool SHAPE_LINE_CHAIN::Collide( const VECTOR2I& aP, int aClearance ) const
 {
@@ -38,6 +65,8 @@ bool SHAPE_LINE_CHAIN::Collide( const VECTOR2I& aP, int aClearance ) const
 
 void SHAPE_LINE_CHAIN::Rotate( double aAngle, const VECTOR2I& aCenter )
 {
+    invalidateSegGrid();
+
     for( std::vector<VECTOR2I>::iterator i = m_points.begin(); i != m_points.end(); ++i )
     {
         (*i) -= aCenter;
@@ -52,29 +81,83 @@ bool SHAPE_LINE_CHAIN::Collide( const SEG& aSeg, int aClearance ) const
     BOX2I box_a( aSeg.A, aSeg.B - aSeg.A );
     BOX2I::ecoord_type dist_sq = (BOX2I::ecoord_type) aClearance * aClearance;
 
-    for( int i = 0; i < SegmentCount(); i++ )
+    auto collide = [&]( int aIndex )
     {
-        const SEG& s = CSegment( i );
+        const SEG& s = CSegment( aIndex );
         BOX2I box_b( s.A, s.B - s.A );
 
         BOX2I::ecoord_type d = box_a.SquaredDistance( box_b );
 
-        if( d < dist_sq )
+        return d < dist_sq && s.Collide( aSeg, aClearance );
+    };
+
+    if( auto grid = segGrid() )
+    {
+        std::vector<int> candidates;
+        grid->Query( BOX2I( box_a ).Inflate( std::max( aClearance, 0 ) + 1 ), candidates );
+
+        // A long segment or a large clearance takes a good part of the chain: the SIMD
+        // batch then tests all the segments faster than the loop over the candidates.
+        // (Nothing passes the bounding box test without clearance.)
+        const SEG_BATCH& batch = grid->Segments();
+
+        if( aClearance > 0 && candidates.size() * 4 > batch.Size() )
+        {
+            for( int i = batch.Collide( aSeg, aClearance ); i >= 0;
+                    i = batch.Collide( aSeg, aClearance, i + 1 ) )
+            {
+                const SEG& s = CSegment( i );
+
+                if( box_a.SquaredDistance( BOX2I( s.A, s.B - s.A ) ) < dist_sq )
+                    return true;
+            }
+
+            return false;
+        }
+
+        for( int i : candidates )
         {
-            if( s.Collide( aSeg, aClearance ) )
+            if( collide( i ) )
                 return true;
         }
+
+        return false;
+    }
+
+    for( int i = 0; i < SegmentCount(); i++ )
+    {
+        if( collide( i ) )
+            return true;
     }
 
     return false;
 }
 
 
+void SHAPE_LINE_CHAIN::SetArcTag( int aIndex, int aTag )
+{
+    if( m_arcTags.empty() )
+    {
+        if( aTag == 0 )
+            return;
+
+        m_arcTags.resize( m_points.size(), 0 );
+    }
+
+    if( aIndex < 0 )
+        aIndex += PointCount();
+
+    m_arcTags[aIndex] = aTag;
+}
+
+
 const SHAPE_LINE_CHAIN SHAPE_LINE_CHAIN::Reverse() const
 {
     SHAPE_LINE_CHAIN a( *this );
 
+    a.invalidateSegGrid();
     reverse( a.m_points.begin(), a.m_points.end() );
+    reverse( a.m_arcTags.begin(), a.m_arcTags.end() );
     a.m_closed = m_closed;
 
     return a;
@@ -94,6 +177,8 @@ int SHAPE_LINE_CHAIN::Length() const
 
 void SHAPE_LINE_CHAIN::Replace( int aStartIndex, int aEndIndex, const VECTOR2I& aP )
 {
+    invalidateSegGrid();
+
     if( aEndIndex < 0 )
         aEndIndex += PointCount();
 
@@ -106,18 +191,39 @@ void SHAPE_LINE_CHAIN::Replace( int aStartIndex, int aEndIndex, const VECTOR2I&
     {
         m_points.erase( m_points.begin() + aStartIndex + 1, m_points.begin() + aEndIndex + 1 );
         m_points[aStartIndex] = aP;
+
+        if( !m_arcTags.empty() )
+            m_arcTags.erase( m_arcTags.begin() + aStartIndex + 1,
+                             m_arcTags.begin() + aEndIndex + 1 );
     }
+
+    if( !m_arcTags.empty() )
+        m_arcTags[aStartIndex] = 0;
 }
 
 
 void SHAPE_LINE_CHAIN::Replace( int aStartIndex, int aEndIndex, const SHAPE_LINE_CHAIN& aLine )
 {
+    invalidateSegGrid();
+
     if( aEndIndex < 0 )
         aEndIndex += PointCount();
 
     if( aStartIndex < 0 )
         aStartIndex += PointCount();
 
+    if( HasArcTags() || aLine.HasArcTags() )
+    {
+        m_arcTags.resize( m_points.size(), 0 );
+        m_arcTags.erase( m_arcTags.begin() + aStartIndex, m_arcTags.begin() + aEndIndex + 1 );
+
+        if( aLine.HasArcTags() )
+            m_arcTags.insert( m_arcTags.begin() + aStartIndex, aLine.m_arcTags.begin(),
+                              aLine.m_arcTags.end() );
+        else
+            m_arcTags.insert( m_arcTags.begin() + aStartIndex, aLine.m_points.size(), 0 );
+    }
+
     m_points.erase( m_points.begin() + aStartIndex, m_points.begin() + aEndIndex + 1 );
     m_points.insert( m_points.begin() + aStartIndex, aLine.m_points.begin(), aLine.m_points.end() );
 }
@@ -125,6 +231,8 @@ void SHAPE_LINE_CHAIN::Replace( int aStartIndex, int aEndIndex, const SHAPE_LINE
 
 void SHAPE_LINE_CHAIN::Remove( int aStartIndex, int aEndIndex )
 {
+    invalidateSegGrid();
+
     if( aEndIndex < 0 )
         aEndIndex += PointCount();
 
@@ -132,6 +240,9 @@ void SHAPE_LINE_CHAIN::Remove( int aStartIndex, int aEndIndex )
         aStartIndex += PointCount();
 
     m_points.erase( m_points.begin() + aStartIndex, m_points.begin() + aEndIndex + 1 );
+
+    if( !m_arcTags.empty() )
+        m_arcTags.erase( m_arcTags.begin() + aStartIndex, m_arcTags.begin() + aEndIndex + 1 );
 }
 
 
@@ -142,6 +253,12 @@ int SHAPE_LINE_CHAIN::Distance( const VECTOR2I& aP, bool aOutlineOnly ) const
     if( IsClosed() && PointInside( aP ) && !aOutlineOnly )
         return 0;
 
+    if( auto grid = segGrid() )
+    {
+        grid->NearestSegment( *this, aP, d );
+        return d;
+    }
+
     for( int s = 0; s < SegmentCount(); s++ )
         d = std::min( d, CSegment( s ).Distance( aP ) );
 
@@ -178,6 +295,15 @@ int SHAPE_LINE_CHAIN::Split( const VECTOR2I& aP )
 
     if( ii >= 0 )
     {
+        invalidateSegGrid();
+
+        // The new point is on the approximation of the arc of the split segment, if any
+        if( !m_arcTags.empty() )
+        {
+            int tag = ArcTag( ii ) == ArcTag( ii + 1 ) ? ArcTag( ii ) : 0;
+            m_arcTags.insert( m_arcTags.begin() + ii + 1, tag );
+        }
+
         m_points.insert( m_points.begin() + ii + 1, aP );
 
         return ii + 1;
@@ -199,6 +325,20 @@ int SHAPE_LINE_CHAIN::Find( const VECTOR2I& aP ) const
 
 int SHAPE_LINE_CHAIN::FindSegment( const VECTOR2I& aP ) const
 {
+    if( auto grid = segGrid() )
+    {
+        std::vector<int> candidates;
+        grid->Query( BOX2I( aP, VECTOR2I( 0, 0 ) ).Inflate( 3 ), candidates );
+
+        for( int s : candidates )
+        {
+            if( CSegment( s ).Distance( aP ) <= 1 )
+                return s;
+        }
+
+        return -1;
+    }
+
     for( int s = 0; s < SegmentCount(); s++ )
         if( CSegment( s ).Distance( aP ) <= 1 )
             return s;
@@ -218,8 +358,13 @@ const SHAPE_LINE_CHAIN SHAPE_LINE_CHAIN::Slice( int aStartIndex, int aEndIndex )
         aStartIndex += PointCount();
 
     for( int i = aStartIndex; i <= aEndIndex; i++ )
+    {
         rv.Append( m_points[i] );
 
+        if( ArcTag( i ) )
+            rv.SetArcTag( rv.PointCount() - 1, ArcTag( i ) );
+    }
+
     return rv;
 }
 
@@ -241,7 +386,19 @@ struct compareOriginDistance
 
 int SHAPE_LINE_CHAIN::Intersect( const SEG& aSeg, INTERSECTIONS& aIp ) const
 {
-    for( int s = 0; s < SegmentCount(); s++ )
+    std::vector<int> candidates;
+
+    if( auto grid = segGrid() )
+    {
+        grid->Query( BOX2I( aSeg.A, aSeg.B - aSeg.A ).Inflate( 1 ), candidates );
+    }
+    else
+    {
+        for( int s = 0; s < SegmentCount(); s++ )
+            candidates.push_back( s );
+    }
+
+    for( int s : candidates )
     {
         OPT_VECTOR2I p = CSegment( s ).Intersect( aSeg );
 
@@ -265,6 +422,8 @@ int SHAPE_LINE_CHAIN::Intersect( const SEG& aSeg, INTERSECTIONS& aIp ) const
 int SHAPE_LINE_CHAIN::Intersect( const SHAPE_LINE_CHAIN& aChain, INTERSECTIONS& aIp ) const
 {
     BOX2I bb_other = aChain.BBox();
+    auto otherGrid = aChain.segGrid();
+    std::vector<int> candidates;
 
     for( int s1 = 0; s1 < SegmentCount(); s1++ )
     {
@@ -274,7 +433,19 @@ int SHAPE_LINE_CHAIN::Intersect( const SHAPE_LINE_CHAIN& aChain, INTERSECTIONS&
         if( !bb_other.Intersects( bb_cur ) )
             continue;
 
-        for( int s2 = 0; s2 < aChain.SegmentCount(); s2++ )
+        candidates.clear();
+
+        if( otherGrid )
+        {
+            otherGrid->Query( BOX2I( bb_cur ).Inflate( 2 ), candidates );
+        }
+        else
+        {
+            for( int s2 = 0; s2 < aChain.SegmentCount(); s2++ )
+                candidates.push_back( s2 );
+        }
+
+        for( int s2 : candidates )
         {
             const SEG& b = aChain.CSegment( s2 );
             INTERSECTION is;
@@ -336,6 +507,7 @@ bool SHAPE_LINE_CHAIN::PointInside( const VECTOR2I& aP ) const
         return false;
 
     bool inside = false;
+    auto grid = segGrid();
 
     /**
      * To check for interior points, we draw a line in the positive x direction from
@@ -345,14 +517,36 @@ bool SHAPE_LINE_CHAIN::PointInside( const VECTOR2I& aP ) const
      * Note: slope might be denormal here in the case of a horizontal line but we require our
      * y to move from above to below the point (or vice versa)
      */
-    for( int i = 0; i < PointCount(); i++ )
+    auto crosses = [&]( int i )
     {
         const VECTOR2D p1 = CPoint( i );
         const VECTOR2D p2 = CPoint( i + 1 ); // CPoint wraps, so ignore counts
         const VECTOR2D diff = p2 - p1;
 
-        if( ( ( p1.y > aP.y ) != ( p2.y > aP.y ) ) &&
-                ( aP.x - p1.x < ( diff.x / diff.y ) * ( aP.y - p1.y ) ) )
+        return ( ( p1.y > aP.y ) != ( p2.y > aP.y ) ) &&
+                ( aP.x - p1.x < ( diff.x / diff.y ) * ( aP.y - p1.y ) );
+    };
+
+    if( grid )
+    {
+        // Only the segments crossing the ray are needed
+        const BOX2I& bbox = grid->BBox();
+        std::vector<int> candidates;
+
+        grid->Query( BOX2I( aP, VECTOR2I( bbox.GetRight() - aP.x, 0 ) ), candidates );
+
+        for( int i : candidates )
+        {
+            if( crosses( i ) )
+                inside = !inside;
+        }
+
+        return inside;
+    }
+
+    for( int i = 0; i < PointCount(); i++ )
+    {
+        if( crosses( i ) )
             inside = !inside;
     }
 
@@ -398,14 +592,32 @@ bool SHAPE_LINE_CHAIN::CheckClearance( const VECTOR2I& aP, const int aDist) cons
     else if( PointCount() == 1 )
         return m_points[0] == aP;
 
-    for( int i = 0; i < SegmentCount(); i++ )
+    auto check = [&]( int aIndex )
     {
-        const SEG s = CSegment( i );
+        const SEG s = CSegment( aIndex );
 
-        if( s.A == aP || s.B == aP )
-            return true;
+        return s.A == aP || s.B == aP || s.Distance( aP ) <= aDist;
+    };
+
+    if( auto grid = segGrid() )
+    {
+        std::vector<int> candidates;
+        BOX2I box( aP, VECTOR2I( 0, 0 ) );
+
+        grid->Query( box.Inflate( std::max( aDist, 0 ) + 2 ), candidates );
+
+        for( int i : candidates )
+        {
+            if( check( i ) )
+                return true;
+        }
 
-        if( s.Distance( aP ) <= aDist )
+        return false;
+    }
+
+    for( int i = 0; i < SegmentCount(); i++ )
+    {
+        if( check( i ) )
             return true;
     }
 
@@ -415,9 +627,35 @@ bool SHAPE_LINE_CHAIN::CheckClearance( const VECTOR2I& aP, const int aDist) cons
 
 const OPT<SHAPE_LINE_CHAIN::INTERSECTION> SHAPE_LINE_CHAIN::SelfIntersecting() const
 {
+    auto grid = segGrid();
+    std::vector<int> candidates;
+
     for( int s1 = 0; s1 < SegmentCount(); s1++ )
     {
-        for( int s2 = s1 + 1; s2 < SegmentCount(); s2++ )
+        candidates.clear();
+
+        if( grid )
+        {
+            // SEG::Contains() measures the distance to a 45 degree line for the segments
+            // of slope 1/n, and may find points up to twice their length away
+            const SEG s = CSegment( s1 );
+            const VECTOR2I d = s.B - s.A;
+            int margin = 2;
+
+            if( std::min( std::abs( d.x ), std::abs( d.y ) ) == 1 )
+                margin += 2 * std::max( std::abs( d.x ), std::abs( d.y ) );
+
+            grid->Query( BOX2I( s.A, d ).Inflate( margin ), candidates );
+            candidates.erase( candidates.begin(), std::upper_bound( candidates.begin(),
+                                                                    candidates.end(), s1 ) );
+        }
+        else
+        {
+            for( int s2 = s1 + 1; s2 < SegmentCount(); s2++ )
+                candidates.push_back( s2 );
+        }
+
+        for( int s2 : candidates )
         {
             const VECTOR2I s2a = CSegment( s2 ).A, s2b = CSegment( s2 ).B;
 
@@ -465,6 +703,9 @@ SHAPE_LINE_CHAIN& SHAPE_LINE_CHAIN::Simplify()
 {
     std::vector<VECTOR2I> pts_unique;
 
+    invalidateSegGrid();
+    m_arcTags.clear();
+
     if( PointCount() < 2 )
     {
         return *this;
@@ -535,6 +776,12 @@ const VECTOR2I SHAPE_LINE_CHAIN::NearestPoint( const VECTOR2I& aP ) const
     int min_d = INT_MAX;
     int nearest = 0;
 
+    if( auto grid = segGrid() )
+    {
+        nearest = grid->NearestSegment( *this, aP, min_d );
+        return CSegment( nearest ).NearestPoint( aP );
+    }
+
     for( int i = 0; i < SegmentCount(); i++ )
     {
         int d = CSegment( i ).Distance( aP );
@@ -615,7 +862,9 @@ bool SHAPE_LINE_CHAIN::Parse( std::stringstream& aStream )
 {
     int n_pts;
 
+    invalidateSegGrid();
     m_points.clear();
+    m_arcTags.clear();
     aStream >> n_pts;
 
     // Rough sanity check, just make sure the loop bounds aren't absolutely outlandish
@@ -32,11 +32,14 @@
 #include <set>
 #include <list>
 #include <algorithm>
+#include <atomic>
+#include <unordered_map>
 #include <unordered_set>
 
 #include <common.h>
 #include <md5_hash.h>
 #include <map>
+#include <thread_pool.h>
 
 #include <geometry/geometry_utils.h>
 #include <geometry/shape.h>
@@ -54,7 +57,10 @@ SHAPE_POLY_SET::SHAPE_POLY_SET() :
 
 
 SHAPE_POLY_SET::SHAPE_POLY_SET( const SHAPE_POLY_SET& aOther ) :
-    SHAPE( SH_POLY_SET ), m_polys( aOther.m_polys )
+    SHAPE( SH_POLY_SET ), m_polys( aOther.m_polys ),
+    m_triangulatedPolys( aOther.m_triangulatedPolys ),
+    m_triangulationValid( aOther.m_triangulationValid ),
+    m_hash( aOther.m_hash )
 {
 }
 
@@ -487,31 +493,433 @@ const SHAPE_LINE_CHAIN SHAPE_POLY_SET::convertFromClipper( const Path& aPath )
 }
 
 
-void SHAPE_POLY_SET::booleanOp( ClipperLib::ClipType aType, const SHAPE_POLY_SET& aOtherShape,
-        POLYGON_MODE aFastMode )
+namespace
 {
-    Clipper c;
 
-    if( aFastMode == PM_STRICTLY_SIMPLE )
-        c.StrictlySimple( true );
+/**
+ * The arc tags (see SHAPE_LINE_CHAIN::SetArcTag()) of the operands of a boolean operation,
+ * to give them back to the vertices of the result: Clipper only keeps their coordinates.
+ * A vertex of the result gets the tag of the operand vertex at the same place, or else
+ * the tag of the operand segment it is on, if this segment joins two vertices of the same
+ * arc: the vertices added where another outline crosses an arc are on this arc.
+ */
+class ARC_TAG_MAP
+{
+public:
+    ARC_TAG_MAP() :
+        m_maxSegWidth( 0 )
+    {
+    }
 
-    for( const POLYGON& poly : m_polys )
+    void Add( const SHAPE_LINE_CHAIN& aChain )
     {
-        for( unsigned int i = 0; i < poly.size(); i++ )
-            c.AddPath( convertToClipper( poly[i], i > 0 ? false : true ), ptSubject, true );
+        if( !aChain.HasArcTags() )
+            return;
+
+        int count = aChain.PointCount();
+
+        for( int ii = 0; ii < count; ii++ )
+        {
+            int tag = aChain.ArcTag( ii );
+
+            if( tag == 0 )
+                continue;
+
+            m_vertices.insert( std::make_pair( key( aChain.CPoint( ii ) ), tag ) );
+
+            if( ( ii + 1 < count || aChain.IsClosed() ) && aChain.ArcTag( ii + 1 ) == tag )
+            {
+                SEG seg( aChain.CPoint( ii ), aChain.CPoint( ( ii + 1 ) % count ) );
+
+                if( seg.A.x > seg.B.x )
+                    std::swap( seg.A, seg.B );
+
+                m_segments.push_back( std::make_pair( seg, tag ) );
+                m_maxSegWidth = std::max( m_maxSegWidth, seg.B.x - seg.A.x );
+            }
+        }
     }
 
-    for( const POLYGON& poly : aOtherShape.m_polys )
+    bool Empty() const
     {
-        for( unsigned int i = 0; i < poly.size(); i++ )
-            c.AddPath( convertToClipper( poly[i], i > 0 ? false : true ), ptClip, true );
+        return m_vertices.empty();
     }
 
-    PolyTree solution;
+    /**
+     * Sorts the segments, to be called after the last Add().
+     */
+    void Prepare()
+    {
+        std::sort( m_segments.begin(), m_segments.end(),
+                   []( const TAGGED_SEG& aA, const TAGGED_SEG& aB )
+                   {
+                       return aA.first.A.x < aB.first.A.x;
+                   } );
+    }
 
-    c.Execute( aType, solution, pftNonZero, pftNonZero );
+    void Apply( SHAPE_LINE_CHAIN& aChain ) const
+    {
+        for( int ii = 0; ii < aChain.PointCount(); ii++ )
+        {
+            int tag = find( aChain.CPoint( ii ) );
 
-    importTree( &solution );
+            if( tag != 0 )
+                aChain.SetArcTag( ii, tag );
+        }
+    }
+
+private:
+    typedef std::pair<SEG, int> TAGGED_SEG;
+
+    static uint64_t key( const VECTOR2I& aP )
+    {
+        return ( (uint64_t) (uint32_t) aP.x << 32 ) | (uint32_t) aP.y;
+    }
+
+    int find( const VECTOR2I& aP ) const
+    {
+        auto vertex = m_vertices.find( key( aP ) );
+
+        if( vertex != m_vertices.end() )
+            return vertex->second;
+
+        // Clipper rounds the crossing points to the grid, within a unit of the segments
+        int64_t minX = (int64_t) aP.x - m_maxSegWidth - 1;
+
+        auto it = std::lower_bound( m_segments.begin(), m_segments.end(), minX,
+                                    []( const TAGGED_SEG& aSeg, int64_t aX )
+                                    {
+                                        return aSeg.first.A.x < aX;
+                                    } );
+
+        for( ; it != m_segments.end() && it->first.A.x <= aP.x + 1; ++it )
+        {
+            if( it->first.B.x >= aP.x - 1 && it->first.Distance( aP ) <= 1 )
+                return it->second;
+        }
+
+        return 0;
+    }
+
+    std::unordered_map<uint64_t, int> m_vertices;
+    std::vector<TAGGED_SEG>           m_segments;
+    int                               m_maxSegWidth;
+};
+
+}   // namespace
+
+
+static std::atomic<bool> s_fastBooleans( true );
+
+
+void SHAPE_POLY_SET::EnableFastBooleans( bool aEnable )
+{
+    s_fastBooleans = aEnable;
+}
+
+
+bool SHAPE_POLY_SET::FastBooleansEnabled()
+{
+    return s_fastBooleans;
+}
+
+
+namespace
+{
+
+///> Coordinates of the fast boolean operands must be strictly below this in absolute value,
+///> keeping the cross products of their vertices in 64 bits
+const int64_t FAST_BOOLEAN_MAX_COORD = 1 << 30;
+
+///> Max product of the vertex counts of two convex polygons tested for nesting
+const int FAST_BOOLEAN_MAX_NESTING_COST = 4096;
+
+
+///> Counts the sign changes of a cyclic sequence, ignoring zeros
+class SIGN_CHANGES
+{
+public:
+    void Add( int64_t aValue )
+    {
+        int sign = ( aValue > 0 ) - ( aValue < 0 );
+
+        if( !sign )
+            return;
+
+        if( !m_first )
+            m_first = sign;
+        else if( sign != m_last )
+            m_count++;
+
+        m_last = sign;
+    }
+
+    int Count() const
+    {
+        return m_count + ( m_first != m_last ? 1 : 0 );
+    }
+
+private:
+    int m_first = 0;
+    int m_last = 0;
+    int m_count = 0;
+};
+
+
+int64_t cross( const VECTOR2I& aOrigin, const VECTOR2I& aA, const VECTOR2I& aB )
+{
+    return ( (int64_t) aA.x - aOrigin.x ) * ( (int64_t) aB.y - aOrigin.y )
+           - ( (int64_t) aA.y - aOrigin.y ) * ( (int64_t) aB.x - aOrigin.x );
+}
+
+
+/**
+ * Returns the orientation (1 or -1) of a strictly convex outline, or 0 if the outline is not
+ * strictly convex (collinear or duplicate vertices included) or out of the safe range.
+ */
+int convexOrientation( const SHAPE_LINE_CHAIN& aPath )
+{
+    int count = aPath.PointCount();
+
+    if( count < 3 )
+        return 0;
+
+    int orientation = 0;
+    SIGN_CHANGES xChanges, yChanges;
+
+    for( int i = 0; i < count; i++ )
+    {
+        const VECTOR2I& p0 = aPath.CPoint( i );
+        const VECTOR2I& p1 = aPath.CPoint( ( i + 1 ) % count );
+        const VECTOR2I& p2 = aPath.CPoint( ( i + 2 ) % count );
+
+        if( p0.x <= -FAST_BOOLEAN_MAX_COORD || p0.x >= FAST_BOOLEAN_MAX_COORD
+                || p0.y <= -FAST_BOOLEAN_MAX_COORD || p0.y >= FAST_BOOLEAN_MAX_COORD )
+            return 0;
+
+        int64_t turn = cross( p0, p1, p2 );
+
+        if( turn == 0 )
+            return 0;
+
+        int sign = turn > 0 ? 1 : -1;
+
+        if( orientation && sign != orientation )
+            return 0;
+
+        orientation = sign;
+        xChanges.Add( (int64_t) p1.x - p0.x );
+        yChanges.Add( (int64_t) p1.y - p0.y );
+    }
+
+    // a convex outline turning more than once (a star) changes direction more often
+    if( xChanges.Count() > 2 || yChanges.Count() > 2 )
+        return 0;
+
+    return orientation;
+}
+
+
+/**
+ * Returns the outline of a set made of a single strictly convex polygon without holes, and
+ * its orientation in aOrientation, or nullptr.
+ */
+const SHAPE_LINE_CHAIN* singleConvex( const SHAPE_POLY_SET& aSet, int& aOrientation )
+{
+    if( aSet.OutlineCount() != 1 || aSet.HoleCount( 0 ) != 0 )
+        return nullptr;
+
+    aOrientation = convexOrientation( aSet.COutline( 0 ) );
+
+    return aOrientation ? &aSet.COutline( 0 ) : nullptr;
+}
+
+
+bool isRectangle( const SHAPE_LINE_CHAIN& aPath )
+{
+    if( aPath.PointCount() != 4 )
+        return false;
+
+    for( int i = 0; i < 4; i++ )
+    {
+        const VECTOR2I& p0 = aPath.CPoint( i );
+        const VECTOR2I& p1 = aPath.CPoint( ( i + 1 ) % 4 );
+        const VECTOR2I& p2 = aPath.CPoint( ( i + 2 ) % 4 );
+
+        // horizontal then vertical, or vertical then horizontal
+        if( !( p0.y == p1.y && p1.x == p2.x ) && !( p0.x == p1.x && p1.y == p2.y ) )
+            return false;
+    }
+
+    return true;
+}
+
+
+///> Returns true if there is a gap between two boxes: nothing in one can touch the other.
+bool separated( const BOX2I& aA, const BOX2I& aB )
+{
+    return aA.GetRight() < aB.GetLeft() || aB.GetRight() < aA.GetLeft()
+           || aA.GetBottom() < aB.GetTop() || aB.GetBottom() < aA.GetTop();
+}
+
+
+///> Returns true if the two boxes overlap over a non null area.
+bool overlap( const BOX2I& aA, const BOX2I& aB )
+{
+    return aA.GetRight() > aB.GetLeft() && aB.GetRight() > aA.GetLeft()
+           && aA.GetBottom() > aB.GetTop() && aB.GetBottom() > aA.GetTop();
+}
+
+
+/**
+ * Tells where the vertices of aInner are relative to the convex outline aOuter of orientation
+ * aOrientation.
+ * @return 1 if they are all strictly inside, 0 if they are all inside or on the edges of
+ * aOuter, -1 if one of them is outside.
+ */
+int convexContains( const SHAPE_LINE_CHAIN& aOuter, int aOrientation,
+                    const SHAPE_LINE_CHAIN& aInner )
+{
+    int result = 1;
+    int count = aOuter.PointCount();
+
+    for( int i = 0; i < count; i++ )
+    {
+        const VECTOR2I& a = aOuter.CPoint( i );
+        const VECTOR2I& b = aOuter.CPoint( ( i + 1 ) % count );
+
+        for( int j = 0; j < aInner.PointCount(); j++ )
+        {
+            int64_t side = cross( a, b, aInner.CPoint( j ) ) * aOrientation;
+
+            if( side < 0 )
+                return -1;
+            else if( side == 0 )
+                result = 0;
+        }
+    }
+
+    return result;
+}
+
+}   // namespace
+
+
+bool SHAPE_POLY_SET::fastBooleanOp( ClipperLib::ClipType aType, const SHAPE_POLY_SET& aShape,
+                                    const SHAPE_POLY_SET& aOtherShape,
+                                    std::vector<POLYGON>& aResult )
+{
+    aResult.clear();
+
+    if( aType == ctIntersection || aType == ctDifference )
+    {
+        if( aShape.OutlineCount() == 0 )
+            return true;
+
+        if( aType == ctIntersection && aOtherShape.OutlineCount() == 0 )
+            return true;
+    }
+
+    if( aType == ctIntersection && !overlap( aShape.BBox(), aOtherShape.BBox() ) )
+        return true;
+
+    int orientA = 0, orientB = 0;
+    const SHAPE_LINE_CHAIN* a = singleConvex( aShape, orientA );
+    const SHAPE_LINE_CHAIN* b = singleConvex( aOtherShape, orientB );
+
+    // an empty operand: the result is the other one, already as clean as Clipper makes it
+    if( aOtherShape.OutlineCount() == 0 && a )
+    {
+        aResult.push_back( { convertFromClipper( convertToClipper( *a, true ) ) } );
+        return true;
+    }
+
+    if( aShape.OutlineCount() == 0 && b && aType == ctUnion )
+    {
+        aResult.push_back( { convertFromClipper( convertToClipper( *b, true ) ) } );
+        return true;
+    }
+
+    if( !a || !b )
+        return false;
+
+    const BOX2I boxA = a->BBox();
+    const BOX2I boxB = b->BBox();
+
+    if( separated( boxA, boxB ) )
+    {
+        aResult.push_back( { convertFromClipper( convertToClipper( *a, true ) ) } );
+
+        if( aType == ctUnion )
+            aResult.push_back( { convertFromClipper( convertToClipper( *b, true ) ) } );
+
+        return true;
+    }
+
+    if( aType == ctIntersection && isRectangle( *a ) && isRectangle( *b ) )
+    {
+        // both are their own bounding box, and they overlap (checked above)
+        int left = std::max( boxA.GetLeft(), boxB.GetLeft() );
+        int top = std::max( boxA.GetTop(), boxB.GetTop() );
+        int right = std::min( boxA.GetRight(), boxB.GetRight() );
+        int bottom = std::min( boxA.GetBottom(), boxB.GetBottom() );
+
+        SHAPE_LINE_CHAIN rect;
+        rect.Append( left, top );
+        rect.Append( right, top );
+        rect.Append( right, bottom );
+        rect.Append( left, bottom );
+        rect.SetClosed( true );
+
+        aResult.push_back( { convertFromClipper( convertToClipper( rect, true ) ) } );
+        return true;
+    }
+
+    if( (int64_t) a->PointCount() * b->PointCount() > FAST_BOOLEAN_MAX_NESTING_COST )
+        return false;
+
+    if( boxA.Contains( boxB ) )
+    {
+        int nesting = convexContains( *a, orientA, *b );
+
+        if( nesting >= 0 )
+        {
+            POLYGON poly = { convertFromClipper(
+                                convertToClipper( aType == ctIntersection ? *b : *a, true ) ) };
+
+            if( aType == ctDifference )
+            {
+                // b touching the outline of a would split it: let Clipper handle this
+                if( nesting == 0 )
+                    return false;
+
+                poly.push_back( convertFromClipper( convertToClipper( *b, false ) ) );
+            }
+
+            aResult.push_back( poly );
+            return true;
+        }
+    }
+
+    if( boxB.Contains( boxA ) && convexContains( *b, orientB, *a ) >= 0 )
+    {
+        if( aType != ctDifference )
+        {
+            aResult.push_back( { convertFromClipper(
+                    convertToClipper( aType == ctIntersection ? *a : *b, true ) ) } );
+        }
+
+        return true;
+    }
+
+    return false;
+}
+
+
+void SHAPE_POLY_SET::booleanOp( ClipperLib::ClipType aType, const SHAPE_POLY_SET& aOtherShape,
+        POLYGON_MODE aFastMode )
+{
+    booleanOp( aType, *this, aOtherShape, aFastMode );
 }
 
 
@@ -520,19 +928,72 @@ void SHAPE_POLY_SET::booleanOp( ClipperLib::ClipType aType,
         const SHAPE_POLY_SET& aOtherShape,
         POLYGON_MODE aFastMode )
 {
+    bool fast = s_fastBooleans;
+
+    // aShape may be this set: its tags are read before the result replaces it
+    ARC_TAG_MAP arcTags;
+
+    for( const SHAPE_POLY_SET* operand : { &aShape, &aOtherShape } )
+    {
+        for( const POLYGON& poly : operand->m_polys )
+        {
+            for( const SHAPE_LINE_CHAIN& path : poly )
+                arcTags.Add( path );
+        }
+    }
+
+    arcTags.Prepare();
+
+    auto restoreArcTags = [&]()
+    {
+        for( POLYGON& poly : m_polys )
+        {
+            for( SHAPE_LINE_CHAIN& path : poly )
+                arcTags.Apply( path );
+        }
+    };
+
+    if( fast )
+    {
+        POLYSET result;
+
+        if( fastBooleanOp( aType, aShape, aOtherShape, result ) )
+        {
+            m_polys.swap( result );
+
+            if( !arcTags.Empty() )
+                restoreArcTags();
+
+            return;
+        }
+    }
+
     Clipper c;
 
     if( aFastMode == PM_STRICTLY_SIMPLE )
         c.StrictlySimple( true );
 
+    // polygons away from the other operand change neither an intersection, nor what is
+    // removed by a difference: they are left out of Clipper
+    bool pruneSubject = fast && aType == ctIntersection;
+    bool pruneClip = fast && ( aType == ctIntersection || aType == ctDifference );
+    BOX2I shapeBox = pruneClip ? aShape.BBox() : BOX2I();
+    BOX2I otherBox = pruneSubject ? aOtherShape.BBox() : BOX2I();
+
     for( const POLYGON& poly : aShape.m_polys )
     {
+        if( pruneSubject && separated( poly[0].BBox(), otherBox ) )
+            continue;
+
         for( unsigned int i = 0; i < poly.size(); i++ )
             c.AddPath( convertToClipper( poly[i], i > 0 ? false : true ), ptSubject, true );
     }
 
     for( const POLYGON& poly : aOtherShape.m_polys )
     {
+        if( pruneClip && separated( poly[0].BBox(), shapeBox ) )
+            continue;
+
         for( unsigned int i = 0; i < poly.size(); i++ )
             c.AddPath( convertToClipper( poly[i], i > 0 ? false : true ), ptClip, true );
     }
@@ -542,6 +1003,9 @@ void SHAPE_POLY_SET::booleanOp( ClipperLib::ClipType aType,
     c.Execute( aType, solution, pftNonZero, pftNonZero );
 
     importTree( &solution );
+
+    if( !arcTags.Empty() )
+        restoreArcTags();
 }
 
 
@@ -595,17 +1059,6 @@ void SHAPE_POLY_SET::Inflate( int aFactor, int aCircleSegmentsCount )
     #define SEG_CNT_MAX 64
     static double arc_tolerance_factor[SEG_CNT_MAX + 1];
 
-    ClipperOffset c;
-
-    for( const POLYGON& poly : m_polys )
-    {
-        for( unsigned int i = 0; i < poly.size(); i++ )
-            c.AddPath( convertToClipper( poly[i], i > 0 ? false : true ), jtRound,
-                    etClosedPolygon );
-    }
-
-    PolyTree solution;
-
     // Calculate the arc tolerance (arc error) from the seg count by circle.
     // the seg count is nn = M_PI / acos(1.0 - c.ArcTolerance / abs(aFactor))
     // see:
@@ -626,11 +1079,147 @@ void SHAPE_POLY_SET::Inflate( int aFactor, int aCircleSegmentsCount )
     else
         coeff = arc_tolerance_factor[aCircleSegmentsCount];
 
-    c.ArcTolerance = std::abs( aFactor ) * coeff;
+    double arcTolerance = std::abs( aFactor ) * coeff;
 
-    c.Execute( solution, aFactor );
+    // the inflated polygons stay inside their bounding box inflated by aFactor (plus the
+    // rounding), so polygons farther apart cannot merge
+    clusteredOp( std::abs( aFactor ) + 1, [aFactor, arcTolerance]( SHAPE_POLY_SET& aCluster )
+    {
+        ClipperOffset c;
 
-    importTree( &solution );
+        for( const POLYGON& poly : aCluster.m_polys )
+        {
+            for( unsigned int i = 0; i < poly.size(); i++ )
+                c.AddPath( aCluster.convertToClipper( poly[i], i > 0 ? false : true ), jtRound,
+                        etClosedPolygon );
+        }
+
+        PolyTree solution;
+
+        c.ArcTolerance = arcTolerance;
+
+        c.Execute( solution, aFactor );
+
+        aCluster.importTree( &solution );
+    } );
+}
+
+
+namespace
+{
+
+/**
+ * Groups the polygons whose bounding boxes, inflated by aMargin, touch each other directly or
+ * through other polygons of the group.
+ * @param aGroups receives the group of each polygon, groups being numbered in the order of
+ * their first polygon.
+ * @return the number of groups.
+ */
+int groupPolygons( const std::vector<SHAPE_POLY_SET::POLYGON>& aPolys, int aMargin,
+                   std::vector<int>& aGroups )
+{
+    int count = aPolys.size();
+    std::vector<BOX2I> boxes( count );
+    std::vector<int> order( count );
+    std::vector<int> parent( count );
+
+    for( int ii = 0; ii < count; ii++ )
+    {
+        boxes[ii] = aPolys[ii].empty() ? BOX2I() : aPolys[ii][0].BBox( aMargin );
+        order[ii] = ii;
+        parent[ii] = ii;
+    }
+
+    auto root = [&parent]( int aIdx )
+    {
+        while( parent[aIdx] != aIdx )
+        {
+            parent[aIdx] = parent[parent[aIdx]];
+            aIdx = parent[aIdx];
+        }
+
+        return aIdx;
+    };
+
+    std::sort( order.begin(), order.end(), [&boxes]( int aA, int aB )
+    {
+        return boxes[aA].GetLeft() < boxes[aB].GetLeft();
+    } );
+
+    // sweep from left to right, keeping the boxes which may still touch the next ones
+    std::vector<int> active;
+
+    for( int ii : order )
+    {
+        const BOX2I& box = boxes[ii];
+        size_t kept = 0;
+
+        for( size_t jj = 0; jj < active.size(); jj++ )
+        {
+            const BOX2I& other = boxes[active[jj]];
+
+            if( other.GetRight() < box.GetLeft() )
+                continue;
+
+            if( other.GetBottom() >= box.GetTop() && box.GetBottom() >= other.GetTop() )
+                parent[root( ii )] = root( active[jj] );
+
+            active[kept++] = active[jj];
+        }
+
+        active.resize( kept );
+        active.push_back( ii );
+    }
+
+    std::vector<int> numbers( count, -1 );
+    int groupCount = 0;
+
+    aGroups.resize( count );
+
+    for( int ii = 0; ii < count; ii++ )
+    {
+        int& number = numbers[root( ii )];
+
+        if( number < 0 )
+            number = groupCount++;
+
+        aGroups[ii] = number;
+    }
+
+    return groupCount;
+}
+
+}   // namespace
+
+
+void SHAPE_POLY_SET::clusteredOp( int aMargin,
+                                  const std::function<void( SHAPE_POLY_SET& )>& aOp )
+{
+    std::vector<int> groups;
+
+    if( m_polys.size() < 2 || groupPolygons( m_polys, aMargin, groups ) < 2 )
+    {
+        aOp( *this );
+        return;
+    }
+
+    std::vector<SHAPE_POLY_SET> clusters( *std::max_element( groups.begin(), groups.end() ) + 1 );
+
+    for( size_t ii = 0; ii < m_polys.size(); ii++ )
+        clusters[groups[ii]].m_polys.push_back( std::move( m_polys[ii] ) );
+
+    THREAD_POOL::GetInstance().ParallelFor( clusters.size(), [&]( size_t ii )
+    {
+        aOp( clusters[ii] );
+    } );
+
+    m_polys.clear();
+
+    for( SHAPE_POLY_SET& cluster : clusters )
+    {
+        for( POLYGON& poly : cluster.m_polys )
+            m_polys.push_back( std::move( poly ) );
+    }
 }
 
 
@@ -876,10 +1465,10 @@ void SHAPE_POLY_SET::Fracture( POLYGON_MODE aFastMode )
 {
     Simplify( aFastMode );    // remove overlapping holes/degeneracy
 
-    for( POLYGON& paths : m_polys )
+    THREAD_POOL::GetInstance().ParallelFor( m_polys.size(), [this]( size_t ii )
     {
-        fractureSingle( paths );
-    }
+        fractureSingle( m_polys[ii] );
+    } );
 }
 
 
@@ -1061,10 +1650,10 @@ bool SHAPE_POLY_SET::HasHoles() const
 
 void SHAPE_POLY_SET::Unfracture( POLYGON_MODE aFastMode )
 {
-    for( POLYGON& path : m_polys )
+    THREAD_POOL::GetInstance().ParallelFor( m_polys.size(), [this]( size_t ii )
     {
-        unfractureSingle( path );
-    }
+        unfractureSingle( m_polys[ii] );
+    } );
 
     Simplify( aFastMode );    // remove overlapping holes/degeneracy
 }
@@ -1072,9 +1661,13 @@ void SHAPE_POLY_SET::Unfracture( POLYGON_MODE aFastMode )
 
 void SHAPE_POLY_SET::Simplify( POLYGON_MODE aFastMode )
 {
-    SHAPE_POLY_SET empty;
+    // polygons whose bounding boxes do not touch cannot merge
+    clusteredOp( 0, [aFastMode]( SHAPE_POLY_SET& aCluster )
+    {
+        SHAPE_POLY_SET empty;
 
-    booleanOp( ctUnion, empty, aFastMode );
+        aCluster.booleanOp( ctUnion, empty, aFastMode );
+    } );
 }
 
 
@@ -1855,10 +2448,11 @@ SHAPE_POLY_SET &SHAPE_POLY_SET::operator=( const SHAPE_POLY_SET& aOther )
     static_cast<SHAPE&>(*this) = aOther;
     m_polys = aOther.m_polys;
 
-    // reset poly cache:
-    m_hash = MD5_HASH{};
-    m_triangulationValid = false;
-    m_triangulatedPolys.clear();
+    // the triangulation is immutable and keyed by the hash of the outlines, so it can be
+    // shared with the copy: IsTriangulationUpToDate() still catches later edits of either set
+    m_hash = aOther.m_hash;
+    m_triangulationValid = aOther.m_triangulationValid;
+    m_triangulatedPolys = aOther.m_triangulatedPolys;
     return *this;
 }
 
@@ -2022,10 +2616,9 @@ void SHAPE_POLY_SET::triangulateSingle( const POLYGON& aPoly,
 
 MD5_HASH SHAPE_POLY_SET::GetHash() const
 {
-    if( !m_hash.IsValid() )
-        return checksum();
-
-    return m_hash;
+    // m_hash is the key of the (possibly shared) triangulation and goes stale when the
+    // outlines are edited in place, so it cannot be returned as is
+    return checksum();
 }
 
 
@@ -2045,26 +2638,15 @@ bool SHAPE_POLY_SET::IsTriangulationUpToDate() const
 
 void SHAPE_POLY_SET::CacheTriangulation()
 {
-    bool recalculate = !m_hash.IsValid();
-    MD5_HASH hash;
-
-    if( !m_triangulationValid )
-        recalculate = true;
-
-    if( !recalculate )
-    {
-        hash = checksum();
-
-        if( m_hash != hash )
-        {
-            m_hash = hash;
-            recalculate = true;
-        }
-    }
+    // the outlines are hashed once: the hash is both the up-to-date check and the key
+    // stored with the new triangulation
+    MD5_HASH hash = checksum();
 
-    if( !recalculate )
+    if( m_triangulationValid && m_hash.IsValid() && m_hash == hash )
         return;
 
+    m_hash = hash;
+
     SHAPE_POLY_SET tmpSet = *this;
 
     if( !tmpSet.HasHoles() )
@@ -2079,14 +2661,17 @@ void SHAPE_POLY_SET::CacheTriangulation()
         return;
     }
 
-    for( int i = 0; i < tmpSet.OutlineCount(); i++ )
+    std::vector<std::shared_ptr<TRIANGULATED_POLYGON>> triangulated( tmpSet.OutlineCount() );
+
+    // outlines are triangulated independently; ParallelFor() runs inline for a single one
+    THREAD_POOL::GetInstance().ParallelFor( triangulated.size(), [&]( size_t ii )
     {
-        m_triangulatedPolys.push_back( std::make_unique<TRIANGULATED_POLYGON>() );
-        triangulateSingle( tmpSet.Polygon( i ), *m_triangulatedPolys.back() );
-    }
+        triangulated[ii] = std::make_shared<TRIANGULATED_POLYGON>();
+        triangulateSingle( tmpSet.Polygon( ii ), *triangulated[ii] );
+    } );
 
+    m_triangulatedPolys.assign( triangulated.begin(), triangulated.end() );
     m_triangulationValid = true;
-    m_hash = checksum();
 }
 
 
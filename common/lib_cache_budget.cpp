@@ -0,0 +1,197 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <lib_cache_budget.h>
+
+#include <wx/utils.h>
+
+
+LIB_CACHE_BUDGET::LIB_CACHE_BUDGET( const wxString& aEnvVar ) :
+    m_lruHead( NULL ),
+    m_lruTail( NULL ),
+    m_budget( 0 ),
+    m_residentBytes( 0 ),
+    m_residentItems( 0 ),
+    m_peakBytes( 0 ),
+    m_evictions( 0 ),
+    m_reloads( 0 )
+{
+    wxString        value;
+    unsigned long   megabytes;
+
+    if( wxGetEnv( aEnvVar, &value ) && value.ToULong( &megabytes ) )
+        m_budget = (size_t) megabytes * 1024 * 1024;
+}
+
+
+LIB_CACHE_BUDGET& LIB_CACHE_BUDGET::Footprints()
+{
+    static LIB_CACHE_BUDGET budget( wxT( "KICAD_FP_CACHE_MB" ) );
+
+    return budget;
+}
+
+
+LIB_CACHE_BUDGET& LIB_CACHE_BUDGET::Symbols()
+{
+    static LIB_CACHE_BUDGET budget( wxT( "KICAD_SYMBOL_CACHE_MB" ) );
+
+    return budget;
+}
+
+
+void LIB_CACHE_BUDGET::Add( size_t aBytes, size_t aItems )
+{
+    size_t resident = m_residentBytes.fetch_add( aBytes ) + aBytes;
+    size_t peak = m_peakBytes.load();
+
+    m_residentItems += aItems;
+
+    while( resident > peak && !m_peakBytes.compare_exchange_weak( peak, resident ) )
+        ;
+}
+
+
+void LIB_CACHE_BUDGET::Remove( size_t aBytes, size_t aItems )
+{
+    m_residentBytes -= aBytes;
+    m_residentItems -= aItems;
+}
+
+
+void LIB_CACHE_BUDGET::unlink( ITEM* aItem )
+{
+    ( aItem->m_prev ? aItem->m_prev->m_next : m_lruHead ) = aItem->m_next;
+    ( aItem->m_next ? aItem->m_next->m_prev : m_lruTail ) = aItem->m_prev;
+    aItem->m_prev = NULL;
+    aItem->m_next = NULL;
+}
+
+
+size_t LIB_CACHE_BUDGET::AddItem( ITEM* aItem, size_t aBytes )
+{
+    std::lock_guard<std::mutex> lock( m_mutex );
+
+    if( aItem->m_resident )
+    {
+        unlink( aItem );
+        Remove( aItem->m_size );
+    }
+
+    aItem->m_prev = m_lruTail;
+    ( m_lruTail ? m_lruTail->m_next : m_lruHead ) = aItem;
+    m_lruTail = aItem;
+    aItem->m_size = aBytes;
+    aItem->m_resident = true;
+    Add( aBytes );
+
+    // The pinned items, one per cache at most, are only skipped: they are few
+    size_t evicted = 0;
+    ITEM*  item = m_lruHead;
+
+    while( item && IsOverBudget() )
+    {
+        ITEM* next = item->m_next;
+
+        if( !item->m_pinned )
+        {
+            unlink( item );
+            Remove( item->m_size );
+            item->m_size = 0;
+            item->m_resident = false;
+            item->evict();
+            evicted++;
+        }
+
+        item = next;
+    }
+
+    m_evictions += evicted;
+
+    return evicted;
+}
+
+
+void LIB_CACHE_BUDGET::RemoveItem( ITEM* aItem )
+{
+    std::lock_guard<std::mutex> lock( m_mutex );
+
+    if( !aItem->m_resident )
+        return;
+
+    unlink( aItem );
+    Remove( aItem->m_size );
+    aItem->m_size = 0;
+    aItem->m_resident = false;
+}
+
+
+bool LIB_CACHE_BUDGET::UseItem( ITEM* aItem, ITEM* aPrevious )
+{
+    std::lock_guard<std::mutex> lock( m_mutex );
+
+    if( aPrevious )
+        aPrevious->m_pinned = false;
+
+    aItem->m_pinned = true;
+
+    if( aItem->m_resident && aItem != m_lruTail )
+    {
+        unlink( aItem );
+        aItem->m_prev = m_lruTail;
+        m_lruTail->m_next = aItem;
+        m_lruTail = aItem;
+    }
+
+    return aItem->m_resident;
+}
+
+
+LIB_CACHE_BUDGET::STATS LIB_CACHE_BUDGET::GetStats() const
+{
+    STATS stats;
+
+    stats.m_budget = m_budget;
+    stats.m_residentBytes = m_residentBytes;
+    stats.m_residentItems = m_residentItems;
+    stats.m_peakBytes = m_peakBytes;
+    stats.m_evictions = m_evictions;
+    stats.m_reloads = m_reloads;
+
+    return stats;
+}
+
+
+wxString LIB_CACHE_BUDGET::FormatStats() const
+{
+    STATS stats = GetStats();
+
+    return wxString::Format( "%llu items, %.1f MB resident (peak %.1f MB, budget %.1f MB), "
+                             "%llu evictions, %llu reloads",
+                             (unsigned long long) stats.m_residentItems,
+                             stats.m_residentBytes / ( 1024.0 * 1024.0 ),
+                             stats.m_peakBytes / ( 1024.0 * 1024.0 ),
+                             stats.m_budget / ( 1024.0 * 1024.0 ),
+                             (unsigned long long) stats.m_evictions,
+                             (unsigned long long) stats.m_reloads );
+}
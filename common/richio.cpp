@@ -23,11 +23,23 @@
  */
 
 
+#include <algorithm>
+#include <cerrno>
 #include <cstdarg>
+#include <cstring>
 #include <config.h> // HAVE_FGETC_NOLOCK
 
 #include <richio.h>
 
+#ifdef __WINDOWS__
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 
 // Fall back to getc() when getc_unlocked() is not available on the target platform.
 #if !defined( HAVE_FGETC_NOLOCK )
@@ -225,13 +237,199 @@ char* FILE_LINE_READER::ReadLine()
 }
 
 
-STRING_LINE_READER::STRING_LINE_READER( const std::string& aString, const wxString& aSource ):
+const size_t MAPPED_FILE_LINE_READER::MinMappedSize;
+
+
+MAPPED_FILE_LINE_READER::MAPPED_FILE_LINE_READER( const wxString& aFileName,
+            unsigned aStartingLineNumber, unsigned aMaxLineLength ) :
+    LINE_READER( aMaxLineLength ), m_data( NULL ), m_size( 0 ), m_ndx( 0 ), m_mapped( false )
+{
+    bool opened = false;
+
+#ifdef __WINDOWS__
+    HANDLE file = CreateFileW( aFileName.wc_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+                               OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL );
+
+    if( file != INVALID_HANDLE_VALUE )
+    {
+        LARGE_INTEGER size;
+
+        if( GetFileSizeEx( file, &size ) )
+        {
+            m_size = (size_t) size.QuadPart;
+            opened = true;
+
+            // an empty file cannot be mapped, and is read as no line at all
+            if( m_size >= MinMappedSize )
+            {
+                HANDLE mapping = CreateFileMappingW( file, NULL, PAGE_READONLY, 0, 0, NULL );
+
+                if( mapping )
+                {
+                    m_data = (const char*) MapViewOfFile( mapping, FILE_MAP_READ, 0, 0, 0 );
+                    CloseHandle( mapping );    // the view keeps the mapping alive
+                }
+
+                opened = m_mapped = m_data != NULL;
+            }
+            else if( m_size )
+            {
+                m_buffer.resize( m_size );
+
+                size_t done = 0;
+
+                while( done < m_size )
+                {
+                    DWORD count;
+
+                    if( !ReadFile( file, &m_buffer[done], (DWORD) ( m_size - done ), &count,
+                                   NULL ) )
+                    {
+                        opened = false;
+                        break;
+                    }
+
+                    // the file may have been truncated since its size was read
+                    if( count == 0 )
+                        break;
+
+                    done += count;
+                }
+
+                m_size = done;
+                m_data = m_size ? m_buffer.data() : NULL;
+            }
+        }
+
+        CloseHandle( file );
+    }
+#else
+    int fd = open( aFileName.fn_str(), O_RDONLY );
+
+    if( fd >= 0 )
+    {
+        struct stat st;
+
+        if( fstat( fd, &st ) == 0 )
+        {
+            m_size = (size_t) st.st_size;
+            opened = true;
+
+            // an empty file cannot be mapped, and is read as no line at all
+            if( m_size >= MinMappedSize )
+            {
+                void* data = mmap( NULL, m_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+
+                if( data != MAP_FAILED )
+                {
+                    madvise( data, m_size, MADV_SEQUENTIAL );
+                    m_data = (const char*) data;
+                }
+
+                opened = m_mapped = m_data != NULL;
+            }
+            else if( m_size )
+            {
+                m_buffer.resize( m_size );
+
+                size_t done = 0;
+
+                while( done < m_size )
+                {
+                    ssize_t count = read( fd, &m_buffer[done], m_size - done );
+
+                    if( count < 0 && errno == EINTR )
+                        continue;
+
+                    if( count < 0 )
+                    {
+                        opened = false;
+                        break;
+                    }
+
+                    // the file may have been truncated since its size was read
+                    if( count == 0 )
+                        break;
+
+                    done += count;
+                }
+
+                m_size = done;
+                m_data = m_size ? m_buffer.data() : NULL;
+            }
+        }
+
+        close( fd );    // the mapping keeps the file open
+    }
+#endif
+
+    if( !opened )
+    {
+        wxString msg = wxString::Format(
+            _( "Unable to open filename \"%s\" for reading" ), aFileName.GetData() );
+        THROW_IO_ERROR( msg );
+    }
+
+    m_source  = aFileName;
+    m_lineNum = aStartingLineNumber;
+}
+
+
+MAPPED_FILE_LINE_READER::~MAPPED_FILE_LINE_READER()
+{
+    if( !m_mapped )
+        return;
+
+#ifdef __WINDOWS__
+    UnmapViewOfFile( m_data );
+#else
+    munmap( (void*) m_data, m_size );
+#endif
+}
+
+
+char* MAPPED_FILE_LINE_READER::ReadLine()
+{
+    m_length = 0;
+
+    if( m_ndx < m_size )
+    {
+        const char* line = m_data + m_ndx;
+        const char* nl = (const char*) memchr( line, '\n', m_size - m_ndx );
+
+        // include the newline, the last line does not necessarily have one
+        size_t length = nl ? nl - line + 1 : m_size - m_ndx;
+
+        if( length >= m_maxLineLength )
+            THROW_IO_ERROR( _( "Maximum line length exceeded" ) );
+
+        if( length + 1 > m_capacity )   // +1 for terminating nul
+            expandCapacity( length + 1 );
+
+        memcpy( m_line, line, length );
+        m_length = length;
+        m_ndx += length;
+    }
+
+    m_line[m_length] = 0;
+
+    // m_lineNum is incremented even if there was no line read, because this
+    // leads to better error reporting when we hit an end of file.
+    ++m_lineNum;
+
+    return m_length ? m_line : NULL;
+}
+
+
+STRING_LINE_READER::STRING_LINE_READER( const std::string& aString, const wxString& aSource,
+                                        unsigned aStartingLineNumber ):
     LINE_READER( LINE_READER_LINE_DEFAULT_MAX ),
     m_lines( aString ), m_ndx( 0 )
 {
     // Clipboard text should be nice and _use multiple lines_ so that
     // we can report _line number_ oriented error messages when parsing.
-    m_source = aSource;
+    m_source  = aSource;
+    m_lineNum = aStartingLineNumber;
 }
 
 
@@ -363,8 +561,37 @@ const char* OUTPUTFORMATTER::GetQuoteChar( const char* wrapee )
     return GetQuoteChar( wrapee, quoteChar );
 }
 
+/**
+ * Function isSimpleFormat
+ * @return true if the only conversions of @a fmt are %s, %d, %c and %%, without flags or
+ *  width, which are the ones used by the s-expression writers.
+ */
+static bool isSimpleFormat( const char* fmt )
+{
+    for( fmt = strchr( fmt, '%' );  fmt;  fmt = strchr( fmt + 2, '%' ) )
+    {
+        switch( fmt[1] )
+        {
+        case 's':
+        case 'd':
+        case 'c':
+        case '%':
+            break;
+
+        default:
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
 int OUTPUTFORMATTER::vprint( const char* fmt,  va_list ap )
 {
+    if( isSimpleFormat( fmt ) )
+        return vprintSimple( fmt, ap );
+
     // This function can call vsnprintf twice.
     // But internally, vsnprintf retrieves arguments from the va_list identified by arg as if
     // va_arg was used on it, and thus the state of the va_list is likely to be altered by the call.
@@ -389,6 +616,90 @@ int OUTPUTFORMATTER::vprint( const char* fmt,  va_list ap )
 }
 
 
+int OUTPUTFORMATTER::vprintSimple( const char* fmt, va_list ap )
+{
+    // Expands the format in m_buffer without vsnprintf(), which is slow compared to these
+    // few conversions.
+    size_t len = 0;
+
+    auto append = [&]( const char* aText, size_t aCount )
+    {
+        if( len + aCount > m_buffer.size() )
+            m_buffer.resize( len + aCount + 1000 );
+
+        memcpy( &m_buffer[len], aText, aCount );
+        len += aCount;
+    };
+
+    for( const char* cur = fmt;  *cur;  )
+    {
+        const char* run = cur;
+
+        while( *cur && *cur != '%' )
+            ++cur;
+
+        if( cur > run )
+            append( run, cur - run );
+
+        if( !*cur )
+            break;
+
+        switch( cur[1] )
+        {
+        case 's':
+            {
+                const char* text = va_arg( ap, const char* );
+
+                // like the glibc printf(), rather than crashing
+                if( !text )
+                    text = "(null)";
+
+                append( text, strlen( text ) );
+            }
+            break;
+
+        case 'd':
+            {
+                char        digits[12];
+                char*       end = digits + sizeof( digits );
+                char*       first = end;
+                int         value = va_arg( ap, int );
+                unsigned    absValue = value < 0 ? 0u - value : value;
+
+                do
+                {
+                    *--first = '0' + absValue % 10;
+                    absValue /= 10;
+                } while( absValue );
+
+                if( value < 0 )
+                    *--first = '-';
+
+                append( first, end - first );
+            }
+            break;
+
+        case 'c':
+            {
+                char c = (char) va_arg( ap, int );
+                append( &c, 1 );
+            }
+            break;
+
+        default:    // "%%"
+            append( cur + 1, 1 );
+        }
+
+        cur += 2;
+    }
+
+    if( len > 0 )
+        write( &m_buffer[0], len );
+
+    return len;
+}
+
+
 int OUTPUTFORMATTER::sprint( const char* fmt, ... )
 {
     va_list     args;
@@ -405,6 +716,8 @@ int OUTPUTFORMATTER::Print( int nestLevel, const char* fmt, ... )
 {
 #define NESTWIDTH           2   ///< how many spaces per nestLevel
 
+    static const char spaces[] = "                                ";
+
     va_list     args;
 
     va_start( args, fmt );
@@ -412,10 +725,11 @@ int OUTPUTFORMATTER::Print( int nestLevel, const char* fmt, ... )
     int result = 0;
     int total  = 0;
 
-    for( int i=0; i<nestLevel;  ++i )
+    for( int indent = nestLevel * NESTWIDTH;  indent > 0;  indent -= result )
     {
         // no error checking needed, an exception indicates an error.
-        result = sprint( "%*c", NESTWIDTH, ' ' );
+        result = std::min( indent, (int) sizeof( spaces ) - 1 );
+        write( spaces, result );
 
         total += result;
     }
@@ -486,7 +800,22 @@ std::string OUTPUTFORMATTER::Quotew( const wxString& aWrapee )
     // a different quoting or escaping strategy is desired from the standard,
     // a derived class can overload Quotes() above, but
     // should never be a reason to overload this Quotew() here.
-    return Quotes( (const char*) aWrapee.utf8_str() );
+    std::string utf8;
+
+    utf8.reserve( aWrapee.length() );
+
+    // Most texts are plain ASCII, which does not need the UTF-8 converter.
+    for( wxString::const_iterator it = aWrapee.begin();  it != aWrapee.end();  ++it )
+    {
+        wxUniChar c = *it;
+
+        if( !c.IsAscii() )
+            return Quotes( (const char*) aWrapee.utf8_str() );
+
+        utf8 += (char) c.GetValue();
+    }
+
+    return Quotes( utf8 );
 }
 
 
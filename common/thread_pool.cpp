@@ -0,0 +1,244 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <thread_pool.h>
+
+
+// The pool and the worker index of the current thread, when it is a worker
+static thread_local const THREAD_POOL* s_currentPool = nullptr;
+static thread_local size_t s_currentWorker = 0;
+
+
+THREAD_POOL::THREAD_POOL( size_t aWorkerCount ) :
+    m_pendingCount( 0 ),
+    m_busyCount( 0 ),
+    m_stop( false ),
+    m_eventCount( 0 )
+{
+    startWorkers( aWorkerCount );
+}
+
+
+THREAD_POOL::~THREAD_POOL()
+{
+    stopWorkers();
+}
+
+
+THREAD_POOL& THREAD_POOL::GetInstance()
+{
+    static THREAD_POOL pool;
+
+    return pool;
+}
+
+
+void THREAD_POOL::SetWorkerCount( size_t aCount )
+{
+    if( aCount == 0 )
+        aCount = std::max( std::thread::hardware_concurrency(), 1U );
+
+    if( aCount == GetWorkerCount() )
+        return;
+
+    stopWorkers();
+    startWorkers( aCount );
+}
+
+
+bool THREAD_POOL::RunPendingTask( const void* aGroup )
+{
+    TASK task;
+
+    if( !pop( task, false, aGroup ) )
+        return false;
+
+    task();
+    notifyEvent();
+    return true;
+}
+
+
+void THREAD_POOL::notifyEvent()
+{
+    {
+        std::lock_guard<std::mutex> lock( m_eventLock );
+        m_eventCount++;
+    }
+
+    m_event.notify_all();
+}
+
+
+void THREAD_POOL::push( TASK aTask, const void* aGroup )
+{
+    // Workers queue their tasks in their own queue, the other threads in the shared one
+    size_t queue = ( s_currentPool == this ) ? s_currentWorker : m_queues.size() - 1;
+
+    {
+        std::lock_guard<std::mutex> lock( m_queues[queue]->m_lock );
+        m_queues[queue]->m_tasks.push_back( TAGGED_TASK{ std::move( aTask ), aGroup } );
+    }
+
+    m_pendingCount.fetch_add( 1 );
+
+    // Take the lock so that a worker can not miss the notification between its test
+    // of m_pendingCount and its wait
+    {
+        std::lock_guard<std::mutex> lock( m_sleepLock );
+    }
+
+    m_wakeUp.notify_one();
+
+    // A thread waiting for this group may run the task
+    notifyEvent();
+}
+
+
+bool THREAD_POOL::pop( TASK& aTask, bool aAnyGroup, const void* aGroup )
+{
+    size_t queueCount = m_queues.size();
+    size_t shared = queueCount - 1;
+
+    auto matches = [&]( const TAGGED_TASK& aTagged )
+    {
+        return aAnyGroup || aTagged.m_group == aGroup;
+    };
+
+    // A worker takes first its newest task, which is the most likely to be in its cache
+    if( s_currentPool == this )
+    {
+        TASK_QUEUE& own = *m_queues[s_currentWorker];
+        std::lock_guard<std::mutex> lock( own.m_lock );
+
+        auto it = std::find_if( own.m_tasks.rbegin(), own.m_tasks.rend(), matches );
+
+        if( it != own.m_tasks.rend() )
+        {
+            aTask = std::move( it->m_func );
+            own.m_tasks.erase( std::next( it ).base() );
+            m_pendingCount.fetch_sub( 1 );
+            return true;
+        }
+    }
+
+    // Then the oldest task of the shared queue, then steal the oldest one of another worker
+    size_t first = ( s_currentPool == this ) ? s_currentWorker + 1 : 0;
+
+    for( size_t ii = 0; ii < queueCount; ++ii )
+    {
+        size_t idx = ( ii == 0 ) ? shared : ( first + ii - 1 ) % shared;
+
+        if( s_currentPool == this && idx == s_currentWorker )
+            continue;
+
+        TASK_QUEUE& queue = *m_queues[idx];
+        std::lock_guard<std::mutex> lock( queue.m_lock );
+
+        auto it = std::find_if( queue.m_tasks.begin(), queue.m_tasks.end(), matches );
+
+        if( it != queue.m_tasks.end() )
+        {
+            aTask = std::move( it->m_func );
+            queue.m_tasks.erase( it );
+            m_pendingCount.fetch_sub( 1 );
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+void THREAD_POOL::startWorkers( size_t aCount )
+{
+    if( aCount == 0 )
+        aCount = std::max( std::thread::hardware_concurrency(), 1U );
+
+    m_stop = false;
+    m_queues.clear();
+
+    // aCount worker queues and the shared one
+    for( size_t ii = 0; ii <= aCount; ++ii )
+        m_queues.push_back( std::unique_ptr<TASK_QUEUE>( new TASK_QUEUE ) );
+
+    std::lock_guard<std::mutex> lock( m_workersLock );
+
+    for( size_t ii = 0; ii < aCount; ++ii )
+        m_workers.push_back( std::thread( &THREAD_POOL::workerLoop, this, ii ) );
+}
+
+
+void THREAD_POOL::stopWorkers()
+{
+    {
+        std::lock_guard<std::mutex> lock( m_sleepLock );
+        m_stop = true;
+    }
+
+    m_wakeUp.notify_all();
+
+    std::vector<std::thread> workers;
+
+    {
+        std::lock_guard<std::mutex> lock( m_workersLock );
+        workers.swap( m_workers );
+    }
+
+    // The workers finish the pending tasks before exiting
+    for( std::thread& worker : workers )
+        worker.join();
+}
+
+
+void THREAD_POOL::workerLoop( size_t aIndex )
+{
+    s_currentPool = this;
+    s_currentWorker = aIndex;
+
+    while( true )
+    {
+        TASK task;
+
+        if( pop( task, true, nullptr ) )
+        {
+            m_busyCount.fetch_add( 1 );
+            task();
+            m_busyCount.fetch_sub( 1 );
+            notifyEvent();
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock( m_sleepLock );
+
+        m_wakeUp.wait( lock, [this]()
+                {
+                    return m_stop || m_pendingCount.load() > 0;
+                } );
+
+        if( m_stop && m_pendingCount.load() <= 0 )
+            break;
+    }
+
+    s_currentPool = nullptr;
+}
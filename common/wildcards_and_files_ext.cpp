@@ -84,6 +84,7 @@ const std::string HtmlFileExtension( "html" );
 
 const std::string LegacyPcbFileExtension( "brd" );
 const std::string KiCadPcbFileExtension( "kicad_pcb" );
+const std::string ConnectivityCacheFileExtension( "kicad_conn" );
 const std::string PageLayoutDescrFileExtension( "kicad_wks" );
 
 const std::string PdfFileExtension( "pdf" );
@@ -22,6 +22,7 @@
 
 #include <ctype.h>
 #include <algorithm>
+#include <map>
 
 #include <wx/mstream.h>
 #include <wx/filename.h>
@@ -34,6 +35,7 @@
 #include <core/typeinfo.h>
 #include <properties.h>
 #include <trace_helpers.h>
+#include <lib_cache_budget.h>
 
 #include <general.h>
 #include <sch_bitmap.h>
@@ -474,6 +476,10 @@ class SCH_LEGACY_PLUGIN_CACHE
     int             m_versionMajor;
     int             m_versionMinor;
     int             m_libType;      // Is this cache a component or symbol library.
+    size_t          m_memorySize;   // Estimated memory size reported to the budget.
+    size_t          m_memoryParts;  // Number of parts counted in m_memorySize.
+    size_t          m_partsSize;    // Estimated memory size of the parts.
+    std::map<const LIB_PART*, size_t> m_partSizes;  // Counted parts and their size.
 
     LIB_PART*       loadPart( FILE_LINE_READER& aReader );
     void            loadHeader( FILE_LINE_READER& aReader );
@@ -484,6 +490,23 @@ class SCH_LEGACY_PLUGIN_CACHE
     void            loadFootprintFilters( std::unique_ptr< LIB_PART >& aPart,
                                           FILE_LINE_READER&            aReader );
     void            loadDocs();
+
+    /**
+     * Counts the memory size of \a aPart, a new part of the cache, for updateMemoryStats().
+     */
+    void            addPartMemory( LIB_PART* aPart );
+
+    /**
+     * Stops counting the memory size of \a aPart, which is about to be deleted.
+     */
+    void            removePartMemory( const LIB_PART* aPart );
+
+    /**
+     * Updates the memory size of the parts of this cache reported to
+     * LIB_CACHE_BUDGET::Symbols().  The parts are only counted, not evicted: they are
+     * referenced by the schematic components and by the library editor.
+     */
+    void            updateMemoryStats();
     LIB_ARC*        loadArc( std::unique_ptr< LIB_PART >& aPart, FILE_LINE_READER& aReader );
     LIB_CIRCLE*     loadCircle( std::unique_ptr< LIB_PART >& aPart, FILE_LINE_READER& aReader );
     LIB_TEXT*       loadText( std::unique_ptr< LIB_PART >& aPart, FILE_LINE_READER& aReader );
@@ -2183,6 +2206,9 @@ SCH_LEGACY_PLUGIN_CACHE::SCH_LEGACY_PLUGIN_CACHE( const wxString& aFullPathAndFi
     m_versionMajor = -1;
     m_versionMinor = -1;
     m_libType = LIBRARY_TYPE_EESCHEMA;
+    m_memorySize = 0;
+    m_memoryParts = 0;
+    m_partsSize = 0;
 }
 
 
@@ -2204,6 +2230,54 @@ SCH_LEGACY_PLUGIN_CACHE::~SCH_LEGACY_PLUGIN_CACHE()
     }
 
     m_aliases.clear();
+    m_partSizes.clear();
+    m_partsSize = 0;
+    updateMemoryStats();
+}
+
+
+void SCH_LEGACY_PLUGIN_CACHE::addPartMemory( LIB_PART* aPart )
+{
+    if( !aPart || m_partSizes.count( aPart ) )
+        return;
+
+    // An estimate: the graphic items are counted with the size of a polyline
+    LIB_ITEMS_CONTAINER& drawItems = aPart->GetDrawItems();
+    size_t pinCount   = drawItems.size( LIB_PIN_T );
+    size_t fieldCount = drawItems.size( LIB_FIELD_T );
+    size_t size       = sizeof( LIB_PART );
+
+    size += pinCount * sizeof( LIB_PIN );
+    size += fieldCount * sizeof( LIB_FIELD );
+    size += ( drawItems.size() - pinCount - fieldCount ) * sizeof( LIB_POLYLINE );
+
+    m_partSizes[aPart] = size;
+    m_partsSize += size;
+}
+
+
+void SCH_LEGACY_PLUGIN_CACHE::removePartMemory( const LIB_PART* aPart )
+{
+    auto it = m_partSizes.find( aPart );
+
+    if( it == m_partSizes.end() )
+        return;
+
+    m_partsSize -= it->second;
+    m_partSizes.erase( it );
+}
+
+
+void SCH_LEGACY_PLUGIN_CACHE::updateMemoryStats()
+{
+    LIB_CACHE_BUDGET& budget = LIB_CACHE_BUDGET::Symbols();
+
+    budget.Remove( m_memorySize, m_memoryParts );
+    m_memorySize = m_partsSize + m_aliases.size() * sizeof( LIB_ALIAS );
+    m_memoryParts = m_partSizes.size();
+    budget.Add( m_memorySize, m_memoryParts );
+
+    wxLogTrace( traceSchLegacyPlugin, wxT( "Symbol caches: %s" ), budget.FormatStats() );
 }
 
 
@@ -2282,6 +2356,7 @@ LIB_ALIAS* SCH_LEGACY_PLUGIN_CACHE::removeAlias( LIB_ALIAS* aAlias )
 
     if( !alias )
     {
+        removePartMemory( part );
         delete part;
 
         if( m_aliases.size() > 1 )
@@ -2323,8 +2398,10 @@ void SCH_LEGACY_PLUGIN_CACHE::AddSymbol( const LIB_PART* aPart )
         m_aliases[ aliasNames[i] ] = alias;
     }
 
+    addPartMemory( const_cast< LIB_PART* >( aPart ) );
     m_isModified = true;
     ++m_modHash;
+    updateMemoryStats();
 }
 
 
@@ -2392,7 +2469,7 @@ void SCH_LEGACY_PLUGIN_CACHE::Load()
         if( strCompare( "DEF", line ) )
         {
             // Read one DEF/ENDDEF part entry from library:
-            loadPart( reader );
+            addPartMemory( loadPart( reader ) );
         }
     }
 
@@ -2405,6 +2482,8 @@ void SCH_LEGACY_PLUGIN_CACHE::Load()
 
     if( USE_OLD_DOC_FILE_FORMAT( m_versionMajor, m_versionMinor ) )
         loadDocs();
+
+    updateMemoryStats();
 }
 
 
@@ -3911,6 +3990,7 @@ void SCH_LEGACY_PLUGIN_CACHE::DeleteAlias( const wxString& aAliasName )
 
     if( !alias )
     {
+        removePartMemory( part );
         delete part;
 
         if( m_aliases.size() > 1 )
@@ -3928,6 +4008,7 @@ void SCH_LEGACY_PLUGIN_CACHE::DeleteAlias( const wxString& aAliasName )
     m_aliases.erase( it );
     ++m_modHash;
     m_isModified = true;
+    updateMemoryStats();
 }
 
 
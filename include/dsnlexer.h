@@ -42,6 +42,23 @@ struct KEYWORD
     const char* name;       ///< unique keyword.
     int         token;      ///< a zero based index into an array of KEYWORDs
 };
+
+
+/**
+ * Struct KEYWORD_HASH
+ * is a perfect hash of a KEYWORD table, generated with the table by the
+ * TokenList2DsnLexer.cmake script.  A token with the 16 bit hashes h and g of its
+ * characters can only be the keyword in
+ *   slots[ ( ( ( g ^ displacements[ h % bucketCount ] ) * 7919 + h ) % 65521 ) % slotCount ]
+ * so a lookup is a single string comparison.
+ */
+struct KEYWORD_HASH
+{
+    const unsigned short* displacements;    ///< one displacement per bucket
+    unsigned              bucketCount;
+    const short*          slots;            ///< index in the KEYWORD table, or -1 if empty
+    unsigned              slotCount;
+};
 #endif
 
 // something like this macro can be used to help initialize a KEYWORD table.
@@ -110,7 +127,9 @@ protected:
 
     const KEYWORD*      keywords;               ///< table sorted by CMake for bsearch()
     unsigned            keywordCount;           ///< count of keywords table
-    KEYWORD_MAP         keyword_hash;           ///< fast, specialized "C string" hashtable
+    const KEYWORD_HASH* keywordPerfectHash;     ///< perfect hash of keywords, or NULL
+    KEYWORD_MAP         keyword_hash;           ///< fast, specialized "C string" hashtable,
+                                                ///< only filled without keywordPerfectHash
 
     void init();
 
@@ -169,9 +188,11 @@ public:
      * @param aKeywordCount is the count of tokens in aKeywordTable.
      * @param aFile is an open file, which will be closed when this is destructed.
      * @param aFileName is the name of the file
+     * @param aKeywordHash is the perfect hash of aKeywordTable generated with it, or NULL.
      */
     DSNLEXER( const KEYWORD* aKeywordTable, unsigned aKeywordCount,
-              FILE* aFile, const wxString& aFileName );
+              FILE* aFile, const wxString& aFileName,
+              const KEYWORD_HASH* aKeywordHash = NULL );
 
     /**
      * Constructor ( const KEYWORD*, unsigned, const std::string&, const wxString& )
@@ -182,9 +203,11 @@ public:
      * @param aKeywordCount is the count of tokens in aKeywordTable.
      * @param aSExpression is text to feed through a STRING_LINE_READER
      * @param aSource is a description of aSExpression, used for error reporting.
+     * @param aKeywordHash is the perfect hash of aKeywordTable generated with it, or NULL.
      */
     DSNLEXER( const KEYWORD* aKeywordTable, unsigned aKeywordCount,
-              const std::string& aSExpression, const wxString& aSource = wxEmptyString );
+              const std::string& aSExpression, const wxString& aSource = wxEmptyString,
+              const KEYWORD_HASH* aKeywordHash = NULL );
 
     /**
      * Constructor ( const std::string&, const wxString& )
@@ -209,9 +232,11 @@ public:
      *
      * @param aLineReader is any subclassed instance of LINE_READER, such as
      *  STRING_LINE_READER or FILE_LINE_READER.  No ownership is taken.
+     *
+     * @param aKeywordHash is the perfect hash of aKeywordTable generated with it, or NULL.
      */
     DSNLEXER( const KEYWORD* aKeywordTable, unsigned aKeywordCount,
-              LINE_READER* aLineReader = NULL );
+              LINE_READER* aLineReader = NULL, const KEYWORD_HASH* aKeywordHash = NULL );
 
     virtual ~DSNLEXER();
 
@@ -284,6 +309,19 @@ public:
      */
     int NextTok();
 
+    /**
+     * Function CopyList
+     * appends to @a aText the text of the list whose opening '(' and first symbol were
+     * just read by NextTok(), up to and including its closing ')', which becomes the
+     * current token.  The closing ')' is found by matching the brackets outside of
+     * quoted strings and comment lines, without splitting the text in tokens, and the
+     * line breaks are kept, so the text can be parsed later with its own lexer.
+     * Only for the KiCad mode, not the specctraMode.
+     * @param aText is the string to append to, previous text is not clear()ed.
+     * @throw IO_ERROR, if the input ends before the closing ')'
+     */
+    void CopyList( std::string& aText );
+
     /**
      * Function NeedSYMBOL
      * calls NextTok() and then verifies that the token read in
@@ -0,0 +1,132 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#ifndef __SEG_BATCH_H
+#define __SEG_BATCH_H
+
+#include <cstdint>
+#include <vector>
+
+#include <geometry/seg.h>
+
+struct SEG_BATCH_QUERY;
+
+/**
+ * Class SEG_BATCH
+ *
+ * A set of segments stored as structure of arrays, to test a segment against all of them
+ * with SIMD instructions.  The kernel is chosen at run time depending on the CPU (AVX2, SSE2
+ * or portable code).
+ *
+ * The results are the same as the ones of the SEG methods called for each segment: the
+ * vector kernels only sort out the segments far enough from the tested one or crossing it
+ * without doubt, the other ones are checked by SEG.
+ */
+class SEG_BATCH
+{
+public:
+    typedef VECTOR2I::extended_type ecoord;
+
+    enum KERNEL
+    {
+        KERNEL_SCALAR = 0,
+        KERNEL_SSE2,
+        KERNEL_AVX2
+    };
+
+    SEG_BATCH();
+
+    void Clear();
+
+    void Reserve( size_t aSize );
+
+    void Add( const SEG& aSeg );
+
+    size_t Size() const
+    {
+        return m_ax.size();
+    }
+
+    const SEG Get( size_t aIndex ) const
+    {
+        return SEG( m_ax[aIndex], m_ay[aIndex], m_bx[aIndex], m_by[aIndex] );
+    }
+
+    /**
+     * Function Collide()
+     *
+     * Finds the first segment, from aStart on, colliding with aSeg as SEG::Collide() tells.
+     * @return the index of the segment, or -1 if none collides.
+     */
+    int Collide( const SEG& aSeg, int aClearance, size_t aStart = 0 ) const;
+
+    /**
+     * Function CollideAll()
+     *
+     * Appends to aIndices the indices of all the segments colliding with aSeg.
+     */
+    void CollideAll( const SEG& aSeg, int aClearance, std::vector<int>& aIndices ) const;
+
+    /**
+     * Function SquaredDistance()
+     *
+     * @return the smallest SEG::SquaredDistance() between aSeg and the segments of the batch,
+     * and the index of the first segment at this distance in aIndex if not null.  The batch
+     * must not be empty.
+     */
+    ecoord SquaredDistance( const SEG& aSeg, int* aIndex = nullptr ) const;
+
+    ///> Returns the best kernel the CPU runs
+    static KERNEL BestKernel();
+
+    ///> Returns the kernel used by all the batches
+    static KERNEL GetKernel();
+
+    /**
+     * Forces the kernel used by all the batches, for tests and benchmarks.  A kernel not
+     * supported by the CPU falls back to the best one supported.
+     */
+    static void SetKernel( KERNEL aKernel );
+
+private:
+    ///> Number of segments given to a kernel at once
+    static const size_t ChunkSize = 256;
+
+    void prepareQuery( const SEG& aSeg, SEG_BATCH_QUERY& aQuery, double& aMargin ) const;
+
+    ///> Finds the first colliding segment, and all of them in aAll if not null
+    int collide( const SEG& aSeg, int aClearance, size_t aStart, std::vector<int>* aAll ) const;
+
+    void runKernel( const SEG_BATCH_QUERY& aQuery, size_t aStart, size_t aCount,
+                    double* aDist, unsigned char* aCross ) const;
+
+    std::vector<int> m_ax, m_ay, m_bx, m_by;
+
+    ///> Segments that SEG::PointCloserThan() measures approximately
+    std::vector<bool> m_inexact;
+
+    ///> The largest absolute coordinate of the segments
+    int64_t m_extent;
+};
+
+#endif    // __SEG_BATCH_H
@@ -0,0 +1,101 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#ifndef __SEG_GRID_H
+#define __SEG_GRID_H
+
+#include <vector>
+
+#include <math/box2.h>
+#include <math/vector2d.h>
+#include <geometry/seg_batch.h>
+
+class SHAPE_LINE_CHAIN;
+
+/**
+ * Class SEG_GRID
+ *
+ * A uniform grid over the bounding box of a line chain, each cell listing the segments
+ * passing through it.  SHAPE_LINE_CHAIN builds one for its large chains, to query only the
+ * segments near a point or a box instead of all of them.
+ *
+ * The cells of a segment cover it with a margin of one unit, so that a query returns all
+ * the segments which may be in the queried box, plus a few others: the callers still run
+ * their exact tests on the returned segments.
+ *
+ * The grid also keeps all the segments in a SEG_BATCH, for the queries covering a large
+ * part of the chain.
+ */
+class SEG_GRID
+{
+public:
+    SEG_GRID( const SHAPE_LINE_CHAIN& aChain );
+
+    ///> The bounding box of the chain, as SHAPE_LINE_CHAIN::BBox() returns it
+    const BOX2I& BBox() const
+    {
+        return m_bbox;
+    }
+
+    ///> All the segments of the chain, segment i of the chain being segment i of the batch
+    const SEG_BATCH& Segments() const
+    {
+        return m_segments;
+    }
+
+    /**
+     * Function Query()
+     *
+     * Appends to aSegments the indices of the segments which may be in aBox, in increasing
+     * order, each one once.
+     */
+    void Query( const BOX2I& aBox, std::vector<int>& aSegments ) const;
+
+    /**
+     * Function NearestSegment()
+     *
+     * Finds the segment of aChain (the chain the grid was built from) nearest to aP, as
+     * SEG::Distance() measures it.
+     * @param aDist receives the distance
+     * @return the index of the segment, the lowest one on ties.
+     */
+    int NearestSegment( const SHAPE_LINE_CHAIN& aChain, const VECTOR2I& aP, int& aDist ) const;
+
+private:
+    int cellX( double aX ) const;
+    int cellY( double aY ) const;
+
+    BOX2I  m_bbox;
+    double m_cellSize;
+    int    m_cols;
+    int    m_rows;
+
+    ///> The segments of cell i are m_cellSegs[m_cellStart[i] .. m_cellStart[i + 1]),
+    ///> cells being stored row by row
+    std::vector<int> m_cellStart;
+    std::vector<int> m_cellSegs;
+
+    SEG_BATCH m_segments;
+};
+
+#endif    // __SEG_GRID_H
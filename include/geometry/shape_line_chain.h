@@ -26,6 +26,7 @@
 #ifndef __SHAPE_LINE_CHAIN
 #define __SHAPE_LINE_CHAIN
 
+#include <memory>
 #include <vector>
 #include <sstream>
 
@@ -35,6 +36,8 @@
 #include <geometry/shape.h>
 #include <geometry/seg.h>
 
+class SEG_GRID;
+
 /**
  * Class SHAPE_LINE_CHAIN
  *
@@ -80,9 +83,45 @@ public:
      * Copy Constructor
      */
     SHAPE_LINE_CHAIN( const SHAPE_LINE_CHAIN& aShape ) :
-        SHAPE( SH_LINE_CHAIN ), m_points( aShape.m_points ), m_closed( aShape.m_closed )
+        SHAPE( SH_LINE_CHAIN ), m_points( aShape.m_points ), m_arcTags( aShape.m_arcTags ),
+        m_closed( aShape.m_closed ), m_segGrid( std::atomic_load( &aShape.m_segGrid ) )
+    {}
+
+    /**
+     * Move Constructor
+     */
+    SHAPE_LINE_CHAIN( SHAPE_LINE_CHAIN&& aShape ) :
+        SHAPE( SH_LINE_CHAIN ), m_points( std::move( aShape.m_points ) ),
+        m_arcTags( std::move( aShape.m_arcTags ) ), m_closed( aShape.m_closed ),
+        m_segGrid( std::atomic_exchange( &aShape.m_segGrid, {} ) )
     {}
 
+    /**
+     * The segment grid may be built concurrently by a const method of the other chain:
+     * it is read (and stored, for the readers of this chain) atomically.
+     */
+    SHAPE_LINE_CHAIN& operator=( const SHAPE_LINE_CHAIN& aShape )
+    {
+        m_points = aShape.m_points;
+        m_arcTags = aShape.m_arcTags;
+        m_closed = aShape.m_closed;
+        m_bbox = aShape.m_bbox;
+        std::atomic_store( &m_segGrid, std::atomic_load( &aShape.m_segGrid ) );
+
+        return *this;
+    }
+
+    SHAPE_LINE_CHAIN& operator=( SHAPE_LINE_CHAIN&& aShape )
+    {
+        m_points = std::move( aShape.m_points );
+        m_arcTags = std::move( aShape.m_arcTags );
+        m_closed = aShape.m_closed;
+        m_bbox = aShape.m_bbox;
+        std::atomic_store( &m_segGrid, std::atomic_exchange( &aShape.m_segGrid, {} ) );
+
+        return *this;
+    }
+
     /**
      * Constructor
      * Initializes a 2-point line chain (a single segment)
@@ -137,7 +176,9 @@ public:
     void Clear()
     {
         m_points.clear();
+        m_arcTags.clear();
         m_closed = false;
+        invalidateSegGrid();
     }
 
     /**
@@ -149,6 +190,9 @@ public:
      */
     void SetClosed( bool aClosed )
     {
+        if( aClosed != m_closed )
+            invalidateSegGrid();
+
         m_closed = aClosed;
     }
 
@@ -240,6 +284,9 @@ public:
         if( aIndex < 0 )
             aIndex += PointCount();
 
+        // the point may be modified through the reference
+        invalidateSegGrid();
+
         return m_points[aIndex];
     }
 
@@ -265,11 +312,53 @@ public:
         return m_points;
     }
 
+    /**
+     * Function SetArcTag()
+     *
+     * Tags the point aIndex as a vertex of the approximation of an arc.  The tags are ids
+     * chosen by the caller, 0 meaning no arc.  They follow the points through the changes of
+     * the chain (but Simplify() and Parse() drop them) and through the boolean operations of
+     * SHAPE_POLY_SET, so that the arcs can be found again in the results.
+     * @param aIndex index of the point
+     * @param aTag the arc tag
+     */
+    void SetArcTag( int aIndex, int aTag );
+
+    /**
+     * Function ArcTag()
+     *
+     * @return the arc tag of the point aIndex (see SetArcTag()), 0 if it has none.
+     */
+    int ArcTag( int aIndex ) const
+    {
+        if( m_arcTags.empty() )
+            return 0;
+
+        if( aIndex < 0 )
+            aIndex += PointCount();
+        else if( aIndex >= PointCount() )
+            aIndex -= PointCount();
+
+        return m_arcTags[aIndex];
+    }
+
+    /**
+     * Function HasArcTags()
+     *
+     * @return true if some points may have an arc tag.
+     */
+    bool HasArcTags() const
+    {
+        return !m_arcTags.empty();
+    }
+
     /**
      * Returns the last point in the line chain.
      */
     VECTOR2I& LastPoint()
     {
+        invalidateSegGrid();
+
         return m_points[PointCount() - 1];
     }
 
@@ -285,7 +374,12 @@ public:
     const BOX2I BBox( int aClearance = 0 ) const override
     {
         BOX2I bbox;
-        bbox.Compute( m_points );
+        std::shared_ptr<const SEG_GRID> grid = std::atomic_load( &m_segGrid );
+
+        if( grid )
+            bbox = segGridBBox( *grid );
+        else
+            bbox.Compute( m_points );
 
         if( aClearance != 0 )
             bbox.Inflate( aClearance );
@@ -370,8 +464,12 @@ public:
 
         if( m_points.size() == 0 || aAllowDuplication || CPoint( -1 ) != aP )
         {
+            invalidateSegGrid();
             m_points.push_back( aP );
             m_bbox.Merge( aP );
+
+            if( !m_arcTags.empty() )
+                m_arcTags.push_back( 0 );
         }
     }
 
@@ -386,11 +484,21 @@ public:
         if( aOtherLine.PointCount() == 0 )
             return;
 
-        else if( PointCount() == 0 || aOtherLine.CPoint( 0 ) != CPoint( -1 ) )
+        invalidateSegGrid();
+
+        bool tagged = HasArcTags() || aOtherLine.HasArcTags();
+
+        if( tagged )
+            m_arcTags.resize( m_points.size(), 0 );
+
+        if( PointCount() == 0 || aOtherLine.CPoint( 0 ) != CPoint( -1 ) )
         {
             const VECTOR2I p = aOtherLine.CPoint( 0 );
             m_points.push_back( p );
             m_bbox.Merge( p );
+
+            if( tagged )
+                m_arcTags.push_back( aOtherLine.ArcTag( 0 ) );
         }
 
         for( int i = 1; i < aOtherLine.PointCount(); i++ )
@@ -398,12 +506,19 @@ public:
             const VECTOR2I p = aOtherLine.CPoint( i );
             m_points.push_back( p );
             m_bbox.Merge( p );
+
+            if( tagged )
+                m_arcTags.push_back( aOtherLine.ArcTag( i ) );
         }
     }
 
     void Insert( int aVertex, const VECTOR2I& aP )
     {
+        invalidateSegGrid();
         m_points.insert( m_points.begin() + aVertex, aP );
+
+        if( !m_arcTags.empty() )
+            m_arcTags.insert( m_arcTags.begin() + aVertex, 0 );
     }
 
     /**
@@ -622,6 +737,8 @@ public:
 
     void Move( const VECTOR2I& aVector ) override
     {
+        invalidateSegGrid();
+
         for( std::vector<VECTOR2I>::iterator i = m_points.begin(); i != m_points.end(); ++i )
             (*i) += aVector;
     }
@@ -644,14 +761,36 @@ public:
     double Area() const;
 
 private:
+    /// chains having fewer segments are not worth a SEG_GRID
+    static const int SegGridThreshold = 256;
+
+    /**
+     * Returns the segment grid of the chain, built on the first call, or null if the chain
+     * is too small to need one.
+     */
+    std::shared_ptr<const SEG_GRID> segGrid() const;
+
+    static const BOX2I& segGridBBox( const SEG_GRID& aGrid );
+
+    void invalidateSegGrid()
+    {
+        std::atomic_store( &m_segGrid, {} );
+    }
+
     /// array of vertices
     std::vector<VECTOR2I> m_points;
 
+    /// arc tags of the vertices (see SetArcTag()), empty when no vertex has one
+    std::vector<int> m_arcTags;
+
     /// is the line chain closed?
     bool m_closed;
 
     /// cached bounding box
     BOX2I m_bbox;
+
+    /// segment grid of the large chains, shared by the copies and dropped on any change
+    mutable std::shared_ptr<const SEG_GRID> m_segGrid;
 };
 
 #endif // __SHAPE_LINE_CHAIN
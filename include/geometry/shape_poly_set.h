@@ -28,6 +28,7 @@
 
 #include <vector>
 #include <cstdio>
+#include <functional>
 #include <memory>
 #include <geometry/shape.h>
 #include <geometry/shape_line_chain.h>
@@ -827,6 +828,16 @@ class SHAPE_POLY_SET : public SHAPE
         void BooleanIntersection( const SHAPE_POLY_SET& a, const SHAPE_POLY_SET& b,
                                   POLYGON_MODE aFastMode );
 
+        /**
+         * Function EnableFastBooleans
+         * enables or disables (for the whole process) the fast path of the boolean operations.
+         * It handles the operands Clipper does not need (disjoint sets, nested convex polygons
+         * and rectangles) and leaves out of Clipper the polygons too far away to matter.
+         * Enabled by default, it is only meant to be disabled to compare it against Clipper.
+         */
+        static void EnableFastBooleans( bool aEnable );
+        static bool FastBooleansEnabled();
+
         ///> Performs outline inflation/deflation, using round corners.
         void Inflate( int aFactor, int aCircleSegmentsCount );
 
@@ -1096,6 +1107,15 @@ class SHAPE_POLY_SET : public SHAPE
         const VECTOR2I& cvertex( int aCornerId ) const;
 
 
+        /**
+         * Function clusteredOp
+         * applies aOp to the groups of polygons of the set whose bounding boxes, inflated by
+         * aMargin, do not touch the other groups, as if they were separate sets.  The groups are
+         * processed in parallel and their results concatenated in the order of their first
+         * polygon, so the result does not depend on the number of threads.
+         */
+        void clusteredOp( int aMargin, const std::function<void( SHAPE_POLY_SET& )>& aOp );
+
         void fractureSingle( POLYGON& paths );
         void unfractureSingle ( POLYGON& path );
         void importTree( ClipperLib::PolyTree* tree );
@@ -1110,6 +1130,8 @@ class SHAPE_POLY_SET : public SHAPE
          * if aFastMode is PM_FAST the result can be a weak polygon
          * if aFastMode is PM_STRICTLY_SIMPLE (default) the result is (theorically) a strictly
          * simple polygon, but calculations can be really significantly time consuming
+         * The arc tags of the vertices (see SHAPE_LINE_CHAIN::SetArcTag()) are kept, and the
+         * new vertices on a segment between two vertices of the same arc get its tag.
          */
         void booleanOp( ClipperLib::ClipType aType,
                         const SHAPE_POLY_SET& aOtherShape, POLYGON_MODE aFastMode );
@@ -1118,6 +1140,16 @@ class SHAPE_POLY_SET : public SHAPE
                         const SHAPE_POLY_SET& aShape,
                         const SHAPE_POLY_SET& aOtherShape, POLYGON_MODE aFastMode );
 
+        /**
+         * Function fastBooleanOp
+         * computes the boolean operation without Clipper when the operands are simple enough
+         * (see EnableFastBooleans()).
+         * @param aResult receives the result, aShape and aOtherShape may be this set.
+         * @return true if the result was computed, false if Clipper is needed.
+         */
+        bool fastBooleanOp( ClipperLib::ClipType aType, const SHAPE_POLY_SET& aShape,
+                            const SHAPE_POLY_SET& aOtherShape, std::vector<POLYGON>& aResult );
+
         bool pointInPolygon( const VECTOR2I& aP, const SHAPE_LINE_CHAIN& aPath ) const;
 
         const ClipperLib::Path convertToClipper( const SHAPE_LINE_CHAIN& aPath, bool aRequiredOrientation );
@@ -1184,11 +1216,14 @@ class SHAPE_POLY_SET : public SHAPE
         MD5_HASH GetHash() const;
 
     private:
-        void triangulateSingle( const POLYGON& aPoly, SHAPE_POLY_SET::TRIANGULATED_POLYGON& aResult );
+        static void triangulateSingle( const POLYGON& aPoly,
+                                       SHAPE_POLY_SET::TRIANGULATED_POLYGON& aResult );
 
         MD5_HASH checksum() const;
 
-        std::vector<std::unique_ptr<TRIANGULATED_POLYGON>> m_triangulatedPolys;
+        /// Triangulated polygons are never modified once built: copies of the set share them
+        /// for as long as their outlines hash to m_hash.
+        std::vector<std::shared_ptr<const TRIANGULATED_POLYGON>> m_triangulatedPolys;
         bool m_triangulationValid = false;
         MD5_HASH m_hash;
 
@@ -0,0 +1,161 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#ifndef LIB_CACHE_BUDGET_H
+#define LIB_CACHE_BUDGET_H
+
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+
+#include <wx/string.h>
+
+/**
+ * A memory budget shared by the library caches of a kind, with their memory statistics.
+ *
+ * The caches report the estimated memory size of the items they parse and delete.  The
+ * caches which can evict their items register them as ITEMs: the budget keeps the resident
+ * ITEMs of all its caches in a single least recently used list, and evicts the oldest ones,
+ * whatever their cache, when the total is over the budget.  An evicted item keeps only a
+ * stub to be parsed again on access.
+ *
+ * The budget is set in megabytes by an environment variable, KICAD_FP_CACHE_MB for the
+ * footprint caches and KICAD_SYMBOL_CACHE_MB for the symbol caches.  It is unlimited when
+ * the variable is not set or is 0.
+ */
+class LIB_CACHE_BUDGET
+{
+public:
+    struct STATS
+    {
+        size_t m_budget;            ///< in bytes, 0 for no limit
+        size_t m_residentBytes;     ///< estimated size of the parsed items in memory
+        size_t m_residentItems;     ///< number of parsed items in memory
+        size_t m_peakBytes;         ///< highest m_residentBytes seen
+        size_t m_evictions;         ///< number of items evicted to stay within the budget
+        size_t m_reloads;           ///< number of evicted items parsed again on access
+    };
+
+    /**
+     * An evictable item of a cache.
+     *
+     * The budget lock guards the parsed data of the item: another thread may evict it at
+     * any time, unless it is pinned.  A cache pins the item it is using, and reads the data
+     * of pinned items only.  A new item is pinned.
+     */
+    class ITEM
+    {
+    public:
+        ITEM() :
+            m_prev( NULL ),
+            m_next( NULL ),
+            m_size( 0 ),
+            m_resident( false ),
+            m_pinned( true )
+        {
+        }
+
+        virtual ~ITEM() {}
+
+    protected:
+        /// Frees the parsed data of the item.  Called by the budget, with its lock held.
+        virtual void evict() = 0;
+
+    private:
+        friend class LIB_CACHE_BUDGET;
+
+        ITEM*   m_prev;         ///< previous resident item, less recently used
+        ITEM*   m_next;         ///< next resident item, more recently used
+        size_t  m_size;         ///< estimated size of the parsed data, while resident
+        bool    m_resident;
+        bool    m_pinned;
+    };
+
+    /**
+     * @param aEnvVar is the environment variable giving the budget in megabytes.
+     */
+    explicit LIB_CACHE_BUDGET( const wxString& aEnvVar );
+
+    /// The budget of the footprint library caches
+    static LIB_CACHE_BUDGET& Footprints();
+
+    /// The budget of the symbol library caches
+    static LIB_CACHE_BUDGET& Symbols();
+
+    void SetBudget( size_t aBytes ) { m_budget = aBytes; }
+    size_t GetBudget() const { return m_budget; }
+
+    bool IsOverBudget() const
+    {
+        return m_budget && m_residentBytes > m_budget;
+    }
+
+    /// Reports \a aItems parsed items of \a aBytes estimated size in total
+    void Add( size_t aBytes, size_t aItems = 1 );
+
+    /// Reports \a aItems deleted items of \a aBytes estimated size in total
+    void Remove( size_t aBytes, size_t aItems = 1 );
+
+    /**
+     * Makes \a aItem resident, as the most recently used item, with parsed data of \a aBytes
+     * estimated size, then evicts the least recently used items not pinned while over budget.
+     * @return the number of items evicted.
+     */
+    size_t AddItem( ITEM* aItem, size_t aBytes );
+
+    /// Makes \a aItem not resident if it is: its parsed data is freed by the caller.
+    void RemoveItem( ITEM* aItem );
+
+    /**
+     * Pins \a aItem as the most recently used item, and unpins \a aPrevious, the item used
+     * before by the cache, if not NULL.
+     * @return true if \a aItem is resident, false if it was evicted.
+     */
+    bool UseItem( ITEM* aItem, ITEM* aPrevious );
+
+    /// The lock of the parsed data of the items.
+    std::mutex& GetMutex() { return m_mutex; }
+
+    void CountReload() { m_reloads++; }
+
+    STATS GetStats() const;
+
+    /// @return the statistics as a one line text, for the logs.
+    wxString FormatStats() const;
+
+private:
+    void unlink( ITEM* aItem );
+
+    std::mutex          m_mutex;            ///< guards the item list and the items data
+    ITEM*               m_lruHead;          ///< least recently used resident item
+    ITEM*               m_lruTail;          ///< most recently used resident item
+
+    std::atomic_size_t  m_budget;
+    std::atomic_size_t  m_residentBytes;
+    std::atomic_size_t  m_residentItems;
+    std::atomic_size_t  m_peakBytes;
+    std::atomic_size_t  m_evictions;
+    std::atomic_size_t  m_reloads;
+};
+
+#endif    // LIB_CACHE_BUDGET_H
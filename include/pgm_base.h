@@ -47,6 +47,7 @@
 #define ENBL_MOUSEWHEEL_PAN_KEY         wxT( "MousewheelPAN" )
 #define MIDDLE_BUTT_PAN_LIMITED_KEY     wxT( "MiddleBtnPANLimited" )
 #define ENBL_AUTO_PAN_KEY               wxT( "AutoPAN" )
+#define WORKER_THREAD_COUNT_KEY         wxT( "WorkerThreadCount" )
 
 ///@}
 
@@ -247,6 +247,78 @@ public:
 };
 
 
+/**
+ * Class MAPPED_FILE_LINE_READER
+ * is a LINE_READER that holds a whole file in memory and copies each line from it with a
+ * single memcpy(), instead of reading it one character at a time through stdio.  It is
+ * meant for the files read by the s-expression parsers.
+ * The files of MinMappedSize bytes or more are mapped in memory: they must not be truncated
+ * while they are being read (the access to the lost pages would raise SIGBUS), which is the
+ * case for the files only read at load time.  The smaller files are read in a buffer, which
+ * costs less than mapping them, and no truncation can hurt them.
+ */
+class MAPPED_FILE_LINE_READER : public LINE_READER
+{
+protected:
+    const char*       m_data;     ///< the file contents, or NULL for an empty file
+    size_t            m_size;     ///< no. bytes in m_data
+    size_t            m_ndx;      ///< offset of the next line in m_data
+    bool              m_mapped;   ///< m_data is a mapping of the file, else m_buffer
+    std::vector<char> m_buffer;   ///< the contents of a file too small to be mapped
+
+public:
+    ///> The size of the smallest file mapped in memory
+    static const size_t MinMappedSize = 256 * 1024;
+
+    /**
+     * Constructor MAPPED_FILE_LINE_READER
+     * maps @a aFileName in memory, or reads it if it is smaller than MinMappedSize.
+     *
+     * @param aFileName is the name of the file to map and to use for error reporting purposes.
+     * @param aStartingLineNumber is the initial line number to report on error.
+     * @param aMaxLineLength is the maximum allowed line length.
+     *
+     * @throw IO_ERROR if @a aFileName cannot be opened, mapped or read.
+     */
+    MAPPED_FILE_LINE_READER( const wxString& aFileName,
+            unsigned aStartingLineNumber = 0,
+            unsigned aMaxLineLength = LINE_READER_LINE_DEFAULT_MAX );
+
+    ~MAPPED_FILE_LINE_READER();
+
+    char* ReadLine() override;
+
+    /**
+     * Function Rewind
+     * goes back to the beginning of the file and resets the line number back to zero.
+     */
+    void Rewind()
+    {
+        m_ndx = 0;
+        m_lineNum = 0;
+    }
+
+    /**
+     * Function Data
+     * returns the whole file, for the binary files laid out to be read in place.
+     * @return const char* - the file contents, NULL for an empty file.
+     */
+    const char* Data() const
+    {
+        return m_data;
+    }
+
+    /**
+     * Function Size
+     * returns the number of bytes of the file.
+     */
+    size_t Size() const
+    {
+        return m_size;
+    }
+};
+
+
 /**
  * Class STRING_LINE_READER
  * is a LINE_READER that reads from a multiline 8 bit wide std::string
@@ -268,8 +340,13 @@ public:
      *
      * @param aSource describes the source of aString for error reporting purposes
      *  can be anything meaninful, such as wxT( "clipboard" ).
+     *
+     * @param aStartingLineNumber is the initial line number to report on error, for
+     *  text taken from a larger source.  The first reported line number will be one
+     *  greater than what is provided here.
      */
-    STRING_LINE_READER( const std::string& aString, const wxString& aSource );
+    STRING_LINE_READER( const std::string& aString, const wxString& aSource,
+                        unsigned aStartingLineNumber = 0 );
 
     /**
      * Constructor STRING_LINE_READER( const STRING_LINE_READER& )
@@ -332,6 +409,9 @@ class OUTPUTFORMATTER
     int sprint( const char* fmt, ... );
     int vprint( const char* fmt,  va_list ap );
 
+    /// vprint() for the formats having only %s, %d, %c and %% conversions
+    int vprintSimple( const char* fmt, va_list ap );
+
 
 protected:
     OUTPUTFORMATTER( int aReserve = OUTPUTFMTBUFZ, char aQuoteChar = '"' ) :
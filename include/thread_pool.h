@@ -0,0 +1,339 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * A persistent pool of worker threads, shared by the compute engines (zone filler,
+ * connectivity, footprint list loader, 3D raytracer...) so they do not create their own
+ * threads and do not oversubscribe the CPU when they run at the same time.
+ *
+ * Each worker has its own task queue: tasks submitted by a worker go to its queue and are
+ * run last in, first out, tasks submitted by other threads go to a shared queue, and an
+ * idle worker steals the oldest tasks of the other queues.
+ *
+ * The tasks can be submitted with a group tag.  Wait() runs meanwhile the pending tasks of
+ * the group waited for, and only them: a waiting thread (the GUI thread, say) never runs an
+ * unrelated long task of the pool.  A task waiting for other tasks must tag them and wait
+ * for them with Wait(), never by blocking on a future: as the waiting thread can run the
+ * tasks it waits for when no worker is free, nested ParallelFor() calls can then not
+ * deadlock the pool.
+ */
+class THREAD_POOL
+{
+public:
+    typedef std::function<void()> TASK;
+
+    /**
+     * @param aWorkerCount is the number of worker threads, 0 for one per hardware thread.
+     */
+    explicit THREAD_POOL( size_t aWorkerCount = 0 );
+    ~THREAD_POOL();
+
+    /**
+     * @return the pool shared by the whole application.
+     */
+    static THREAD_POOL& GetInstance();
+
+    /**
+     * Changes the number of worker threads (0 for one per hardware thread).
+     * The pending tasks are finished first.  Must not be called from a task, and should be
+     * called at startup, when no other thread is submitting tasks.
+     */
+    void SetWorkerCount( size_t aCount );
+
+    size_t GetWorkerCount() const
+    {
+        std::lock_guard<std::mutex> lock( m_workersLock );
+        return m_workers.size();
+    }
+
+    /**
+     * @return the number of workers neither running a task nor about to take a pending one.
+     * Only a hint: it may have changed by the time the caller submits its tasks.
+     */
+    size_t GetIdleWorkerCount() const
+    {
+        int busy = m_busyCount.load() + std::max( m_pendingCount.load(), 0 );
+        int count = (int) GetWorkerCount();
+
+        return count > busy ? count - busy : 0;
+    }
+
+    /**
+     * Queues aFunc to be run by a worker.
+     * @param aGroup tags the task, so that Wait() with the same tag can run it.  Any address
+     *               unique to the tasks waited for together will do.
+     * @return a future receiving the result of aFunc (or the exception it throws).
+     */
+    template <typename FUNC>
+    auto Submit( FUNC aFunc, const void* aGroup = nullptr ) -> std::future<decltype( aFunc() )>
+    {
+        typedef decltype( aFunc() ) RESULT;
+
+        auto task = std::make_shared<std::packaged_task<RESULT()>>( std::move( aFunc ) );
+        std::future<RESULT> future = task->get_future();
+
+        push( [task]() { ( *task )(); }, aGroup );
+
+        return future;
+    }
+
+    /**
+     * Runs aFunc( ii ) for each ii in [0, aCount) on the workers and the calling thread,
+     * and returns when all are done.  Indices are handed out one at a time, so aFunc must
+     * not depend on the execution order.  An exception thrown by aFunc is rethrown.
+     */
+    template <typename FUNC>
+    void ParallelFor( size_t aCount, FUNC aFunc )
+    {
+        if( aCount == 0 )
+            return;
+
+        std::atomic_size_t next( 0 );
+
+        auto loop = [&]()
+        {
+            for( size_t ii = next.fetch_add( 1 ); ii < aCount; ii = next.fetch_add( 1 ) )
+                aFunc( ii );
+        };
+
+        std::vector<std::future<void>> helpers;
+        size_t helperCount = std::min( aCount, GetWorkerCount() + 1 ) - 1;
+
+        // The helpers of this call are tagged by its local counter
+        for( size_t ii = 0; ii < helperCount; ++ii )
+            helpers.push_back( Submit( loop, &next ) );
+
+        try
+        {
+            loop();
+        }
+        catch( ... )
+        {
+            // The helpers use the local variables: they must be done before unwinding
+            next.store( aCount );
+
+            for( std::future<void>& helper : helpers )
+                Wait( helper, &next );
+
+            throw;
+        }
+
+        for( std::future<void>& helper : helpers )
+            Wait( helper, &next );
+
+        for( std::future<void>& helper : helpers )
+            helper.get();
+    }
+
+    /**
+     * Waits until aFuture is ready, running meanwhile the pending tasks of the group aGroup,
+     * which should include the task of aFuture.  Without group, simply blocks.
+     */
+    template <typename T>
+    void Wait( const std::future<T>& aFuture, const void* aGroup = nullptr )
+    {
+        if( !aGroup )
+        {
+            aFuture.wait();
+            return;
+        }
+
+        while( true )
+        {
+            // Read the event count first: a task ending or queued after this is not missed
+            uint64_t events;
+
+            {
+                std::lock_guard<std::mutex> lock( m_eventLock );
+                events = m_eventCount;
+            }
+
+            if( aFuture.wait_for( std::chrono::seconds( 0 ) ) == std::future_status::ready )
+                return;
+
+            if( RunPendingTask( aGroup ) )
+                continue;
+
+            // The task waited for is running on a worker: sleep until a task ends, or
+            // a task (maybe of this group) is queued
+            std::unique_lock<std::mutex> lock( m_eventLock );
+
+            m_event.wait( lock, [&]() { return m_eventCount != events; } );
+        }
+    }
+
+    /**
+     * Runs one pending task of the group aGroup on the calling thread.
+     * @return false if there was no pending task in this group.
+     */
+    bool RunPendingTask( const void* aGroup );
+
+private:
+    struct TAGGED_TASK
+    {
+        TASK        m_func;
+        const void* m_group;
+    };
+
+    struct TASK_QUEUE
+    {
+        std::mutex              m_lock;
+        std::deque<TAGGED_TASK> m_tasks;
+    };
+
+    void push( TASK aTask, const void* aGroup );
+
+    /**
+     * Wakes up the threads sleeping in Wait(), after a task was queued or has ended.
+     */
+    void notifyEvent();
+
+    /**
+     * Takes a pending task, of any group when aAnyGroup is true (for the workers), else of
+     * the group aGroup.
+     */
+    bool pop( TASK& aTask, bool aAnyGroup, const void* aGroup );
+
+    void startWorkers( size_t aCount );
+    void stopWorkers();
+    void workerLoop( size_t aIndex );
+
+    std::vector<std::thread>                 m_workers;
+    mutable std::mutex                       m_workersLock;     ///< Protects m_workers
+
+    ///< One queue per worker, then the queue shared by the other threads
+    std::vector<std::unique_ptr<TASK_QUEUE>> m_queues;
+
+    std::atomic_int                          m_pendingCount;
+    std::atomic_int                          m_busyCount;       ///< Workers running a task
+
+    std::mutex                               m_sleepLock;
+    std::condition_variable                  m_wakeUp;
+    bool                                     m_stop;    ///< Protected by m_sleepLock
+
+    std::mutex                               m_eventLock;
+    std::condition_variable                  m_event;
+    uint64_t                                 m_eventCount;  ///< Protected by m_eventLock
+};
+
+
+/**
+ * A set of tasks run on a THREAD_POOL, which can be waited for or cancelled together.
+ *
+ * Cancelling drops the tasks not started yet, the running ones can poll IsCancelled() to
+ * stop early.  The tasks must be added by a single thread.  The destructor cancels and
+ * waits for the remaining tasks, so they never outlive the data they refer to.
+ */
+class TASK_GROUP
+{
+public:
+    TASK_GROUP( THREAD_POOL& aPool = THREAD_POOL::GetInstance() ) :
+        m_pool( aPool ),
+        m_cancelled( false )
+    {
+    }
+
+    ~TASK_GROUP()
+    {
+        Cancel();
+
+        try
+        {
+            Wait();
+        }
+        catch( ... )
+        {
+        }
+    }
+
+    /**
+     * Queues aFunc (a void() callable) on the pool.
+     */
+    template <typename FUNC>
+    void Run( FUNC aFunc )
+    {
+        m_tasks.push_back( m_pool.Submit( [this, aFunc]()
+                {
+                    if( !m_cancelled.load() )
+                        aFunc();
+                }, this ) );
+    }
+
+    void Cancel() { m_cancelled.store( true ); }
+
+    bool IsCancelled() const { return m_cancelled.load(); }
+
+    /**
+     * @return true when all the tasks are finished (or dropped).
+     */
+    bool IsDone() const
+    {
+        for( const std::future<void>& task : m_tasks )
+        {
+            if( task.wait_for( std::chrono::seconds( 0 ) ) != std::future_status::ready )
+                return false;
+        }
+
+        return true;
+    }
+
+    /**
+     * Waits for all the tasks, running the pending tasks of this group meanwhile, and
+     * rethrows the first exception thrown by a task.  The group can then be reused.
+     */
+    void Wait()
+    {
+        for( const std::future<void>& task : m_tasks )
+            m_pool.Wait( task, this );
+
+        std::vector<std::future<void>> tasks;
+        tasks.swap( m_tasks );
+        m_cancelled.store( false );
+
+        for( std::future<void>& task : tasks )
+            task.get();
+    }
+
+private:
+    THREAD_POOL&                   m_pool;
+    std::atomic_bool               m_cancelled;
+    std::vector<std::future<void>> m_tasks;
+};
+
+#endif  // THREAD_POOL_H
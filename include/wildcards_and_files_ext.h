@@ -65,6 +65,7 @@ extern const std::string HtmlFileExtension;
 extern const std::string LegacyPcbFileExtension;
 extern const std::string KiCadPcbFileExtension;
 #define PcbFileExtension    KiCadPcbFileExtension       // symlink choice
+extern const std::string ConnectivityCacheFileExtension;
 extern const std::string PageLayoutDescrFileExtension;
 
 extern const std::string LegacyFootprintLibPathExtension;
@@ -0,0 +1,334 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file batch_drc.cpp
+ * @brief Command line tool running the zone filler and the DRC on a board file.
+ *
+ * Usage: pcbnew_batch_drc [--no-fill] [--bench-tracks] [-o report.json] board.kicad_pcb
+ *
+ * The violations are written as JSON (to stdout, or to the given file), the time
+ * spent in each phase and the peak memory use are printed to stderr.  The exit code
+ * is 0 when the board has no violation, 1 when it has some and 2 on errors, so the
+ * tool can be used directly in a CI job.
+ *
+ * With --bench-tracks, only the track clearance tests are run, once with the full scan
+ * of the board they used before the spatial index and once with the index.  The time
+ * and the segments per second of both runs are printed, and the exit code is 1 if they
+ * did not find the same violations.
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <wx/init.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+#include <fctsys.h>
+#include <macros.h>
+#include <profile.h>
+#include <io_mgr.h>
+#include <kicad_plugin.h>
+
+#include <class_board.h>
+#include <class_marker_pcb.h>
+#include <class_track.h>
+#include <class_zone.h>
+#include <connectivity_data.h>
+#include <zone_filler.h>
+#include <drc.h>
+
+
+/**
+ * @return the peak resident set size of the process, in kilobytes
+ */
+static long peakRssKb()
+{
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+
+    if( !GetProcessMemoryInfo( GetCurrentProcess(), &counters, sizeof( counters ) ) )
+        return 0;
+
+    return (long) ( counters.PeakWorkingSetSize / 1024 );
+#else
+    struct rusage usage;
+
+    if( getrusage( RUSAGE_SELF, &usage ) != 0 )
+        return 0;
+
+#ifdef __APPLE__
+    return usage.ru_maxrss / 1024;      // bytes on OS X
+#else
+    return usage.ru_maxrss;             // kilobytes on Linux
+#endif
+#endif
+}
+
+
+static std::string jsonString( const wxString& aText )
+{
+    std::string in = TO_UTF8( aText );
+    std::string out = "\"";
+
+    for( char c : in )
+    {
+        switch( c )
+        {
+        case '"':  out += "\\\""; break;
+        case '\\': out += "\\\\"; break;
+        case '\n': out += "\\n";  break;
+        case '\r': out += "\\r";  break;
+        case '\t': out += "\\t";  break;
+
+        default:
+            if( (unsigned char) c < 0x20 )
+            {
+                char buf[8];
+                snprintf( buf, sizeof( buf ), "\\u%04x", c );
+                out += buf;
+            }
+            else
+            {
+                out += c;
+            }
+        }
+    }
+
+    return out + "\"";
+}
+
+
+static void writeItem( FILE* aFile, const DRC_ITEM& aItem, bool aLast )
+{
+    fprintf( aFile, "    { \"code\": %d, \"description\": %s,\n", aItem.GetErrorCode(),
+             jsonString( aItem.GetErrorText() ).c_str() );
+    fprintf( aFile, "      \"items\": [ { \"text\": %s, \"x\": %g, \"y\": %g }",
+             jsonString( aItem.GetTextA() ).c_str(),
+             Iu2Millimeter( aItem.GetPointA().x ), Iu2Millimeter( aItem.GetPointA().y ) );
+
+    if( aItem.HasSecondItem() )
+    {
+        fprintf( aFile, ",\n                 { \"text\": %s, \"x\": %g, \"y\": %g }",
+                 jsonString( aItem.GetTextB() ).c_str(),
+                 Iu2Millimeter( aItem.GetPointB().x ), Iu2Millimeter( aItem.GetPointB().y ) );
+    }
+
+    fprintf( aFile, " ] }%s\n", aLast ? "" : "," );
+}
+
+
+/**
+ * Times the track clearance tests with the full scan of the board and with the spatial
+ * index, and compares the violations they find.
+ * @return 0 if both runs found the same violations, in the same order, 1 otherwise
+ */
+static int benchmarkTracks( BOARD* aBoard )
+{
+    struct BENCH_RUN
+    {
+        std::string                          m_name;
+        bool                                 m_fullScan;
+        std::vector<std::pair<int, wxPoint>> m_markers;    ///< error code and position
+    };
+
+    int segmentCount = 0;
+
+    for( TRACK* track = aBoard->m_Track; track; track = track->Next() )
+        segmentCount++;
+
+    BENCH_RUN runs[] = { { "full scan", true, {} }, { "spatial index", false, {} } };
+
+    for( BENCH_RUN& run : runs )
+    {
+        aBoard->DeleteMARKERs();
+
+        DRC          drc( aBoard, MILLIMETRES );
+        PROF_COUNTER counter( run.m_name );
+
+        drc.TestTracks( run.m_fullScan );
+
+        double msecs = counter.msecs();
+
+        for( int ii = 0; ii < aBoard->GetMARKERCount(); ++ii )
+        {
+            const DRC_ITEM& item = aBoard->GetMARKER( ii )->GetReporter();
+            run.m_markers.emplace_back( item.GetErrorCode(), item.GetPointA() );
+        }
+
+        fprintf( stderr, "%-14s %10.1f ms %12.0f segments/s %8d violations\n",
+                 run.m_name.c_str(), msecs, segmentCount * 1000.0 / std::max( msecs, 0.001 ),
+                 (int) run.m_markers.size() );
+    }
+
+    aBoard->DeleteMARKERs();
+
+    if( runs[0].m_markers != runs[1].m_markers )
+    {
+        fprintf( stderr, "The violations found by both runs differ\n" );
+        return 1;
+    }
+
+    return 0;
+}
+
+
+struct PHASE_TIME
+{
+    std::string m_name;
+    double      m_msecs;
+};
+
+
+int main( int argc, char* argv[] )
+{
+    wxInitializer initializer( argc, argv );
+
+    bool        fillZones = true;
+    bool        benchTracks = false;
+    std::string boardFile;
+    std::string reportFile;
+
+    for( int ii = 1; ii < argc; ++ii )
+    {
+        std::string arg = argv[ii];
+
+        if( arg == "--no-fill" )
+            fillZones = false;
+        else if( arg == "--bench-tracks" )
+            benchTracks = true;
+        else if( arg == "-o" && ii + 1 < argc )
+            reportFile = argv[++ii];
+        else
+            boardFile = arg;
+    }
+
+    if( boardFile.empty() )
+    {
+        fprintf( stderr, "Usage: %s [--no-fill] [--bench-tracks] [-o report.json] "
+                         "board.kicad_pcb\n", argv[0] );
+        return 2;
+    }
+
+    std::vector<PHASE_TIME> phases;
+    PROF_COUNTER            total( "total" );
+    PROF_COUNTER            phase( "load" );
+    PLUGIN::RELEASER        pi( new PCB_IO );
+    BOARD*                  board = nullptr;
+
+    try
+    {
+        board = pi->Load( wxString::FromUTF8( boardFile.c_str() ), NULL, NULL );
+    }
+    catch( const IO_ERROR& ioe )
+    {
+        fprintf( stderr, "Error loading board.\n%s\n", TO_UTF8( ioe.What() ) );
+        return 2;
+    }
+
+    phases.push_back( { "load", phase.msecs() } );
+
+    phase.Start();
+    board->GetConnectivity()->Build( board );
+    phases.push_back( { "connectivity", phase.msecs() } );
+
+    if( fillZones )
+    {
+        // The filler needs the connectivity to remove the insulated islands
+        std::vector<ZONE_CONTAINER*> zones;
+
+        for( int ii = 0; ii < board->GetAreaCount(); ++ii )
+            zones.push_back( board->GetArea( ii ) );
+
+        phase.Start();
+        ZONE_FILLER filler( board );
+        filler.Fill( zones );
+        phases.push_back( { "zone fill", phase.msecs() } );
+    }
+
+    if( benchTracks )
+    {
+        int result = benchmarkTracks( board );
+
+        delete board;
+        return result;
+    }
+
+    DRC drc( board, MILLIMETRES );
+
+    phase.Start();
+    drc.RunTests();
+    phases.push_back( { "drc", phase.msecs() } );
+
+    FILE* report = stdout;
+
+    if( !reportFile.empty() )
+    {
+        report = fopen( reportFile.c_str(), "wt" );
+
+        if( !report )
+        {
+            fprintf( stderr, "Cannot create %s\n", reportFile.c_str() );
+            delete board;
+            return 2;
+        }
+    }
+
+    const DRC_LIST& unconnected = drc.GetUnconnectedItems();
+    int             markerCount = board->GetMARKERCount();
+
+    fprintf( report, "{\n  \"board\": %s,\n",
+             jsonString( wxString::FromUTF8( boardFile.c_str() ) ).c_str() );
+    fprintf( report, "  \"violations\": [\n" );
+
+    for( int ii = 0; ii < markerCount; ++ii )
+        writeItem( report, board->GetMARKER( ii )->GetReporter(), ii == markerCount - 1 );
+
+    fprintf( report, "  ],\n  \"unconnected\": [\n" );
+
+    for( size_t ii = 0; ii < unconnected.size(); ++ii )
+        writeItem( report, *unconnected[ii], ii == unconnected.size() - 1 );
+
+    fprintf( report, "  ]\n}\n" );
+
+    if( report != stdout )
+        fclose( report );
+
+    for( const PHASE_TIME& entry : phases )
+        fprintf( stderr, "%-14s %10.1f ms\n", entry.m_name.c_str(), entry.m_msecs );
+
+    fprintf( stderr, "%-14s %10.1f ms\n", "total", total.msecs() );
+    fprintf( stderr, "%-14s %10ld kB\n", "peak rss", peakRssKb() );
+
+    delete board;
+
+    return ( markerCount || unconnected.size() ) ? 1 : 0;
+}
@@ -31,6 +31,7 @@
 #include <board_commit.h>
 #include <tools/pcb_tool.h>
 #include <connectivity_data.h>
+#include <drc.h>
 
 #include <functional>
 using namespace std::placeholders;
@@ -65,6 +66,8 @@ void BOARD_COMMIT::Push( const wxString& aMessage, bool aCreateUndoEntry, bool a
     PCB_BASE_FRAME* frame = (PCB_BASE_FRAME*) m_toolMgr->GetEditFrame();
     auto connectivity = board->GetConnectivity();
     std::set<EDA_ITEM*> savedModules;
+    std::vector<BOARD_ITEM*> drcChangedItems;
+    std::vector<BOARD_ITEM*> drcRemovedItems;
 
     if( Empty() )
         return;
@@ -107,6 +110,15 @@ void BOARD_COMMIT::Push( const wxString& aMessage, bool aCreateUndoEntry, bool a
             }
         }
 
+        // DRC markers are not design items, and adding them must not retrigger the DRC
+        if( !m_editModules && boardItem->Type() != PCB_MARKER_T )
+        {
+            if( changeType == CHT_REMOVE )
+                drcRemovedItems.push_back( boardItem );
+            else
+                drcChangedItems.push_back( boardItem );
+        }
+
         switch( changeType )
         {
             case CHT_ADD:
@@ -270,6 +282,14 @@ void BOARD_COMMIT::Push( const wxString& aMessage, bool aCreateUndoEntry, bool a
         }
     }
 
+    // The incremental DRC updates the markers here, not in a commit of its own
+    if( !m_editModules && frame->IsType( FRAME_PCB ) && frame->Settings().m_onlineDrc
+            && ( !drcChangedItems.empty() || !drcRemovedItems.empty() ) )
+    {
+        DRC* drc = static_cast<PCB_EDIT_FRAME*>( frame )->GetDrcController();
+        drc->UpdateMarkersIncremental( drcChangedItems, drcRemovedItems );
+    }
+
     if( !m_editModules && aCreateUndoEntry )
         frame->SaveCopyInUndoList( undoList, UR_UNSPECIFIED );
 
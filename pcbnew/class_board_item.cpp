@@ -87,10 +87,77 @@ wxString BOARD_ITEM::GetLayerName() const
 }
 
 
+/// Writes the decimal digits of \a aValue at \a aOut, and returns the end of the digits.
+static char* formatUnsigned( char* aOut, unsigned aValue )
+{
+    char    digits[10];
+    int     count = 0;
+
+    do
+    {
+        digits[count++] = '0' + aValue % 10;
+        aValue /= 10;
+    } while( aValue );
+
+    while( count )
+        *aOut++ = digits[--count];
+
+    return aOut;
+}
+
+
+/**
+ * Function formatIU
+ * writes \a aValue, in nanometers, as millimeters without trailing zeros into \a aBuf.
+ * The result is the same as the "%.10g" format of the floating point millimeters, but
+ * without its cost: a board file writes several millions of these values.
+ * @return the count of chars written, \a aBuf must have room for 16 chars.
+ */
+static int formatIU( char* aBuf, int aValue )
+{
+    static_assert( IU_PER_MM == 1e6, "formatIU() expects nanometer internal units" );
+
+    char*       out = aBuf;
+    unsigned    value = aValue;
+
+    if( aValue < 0 )
+    {
+        *out++ = '-';
+        value = 0u - value;     // also right for INT_MIN
+    }
+
+    unsigned    nm = value % 1000000;
+
+    out = formatUnsigned( out, value / 1000000 );
+
+    if( nm )
+    {
+        *out++ = '.';
+
+        for( unsigned div = 100000; nm;  div /= 10 )
+        {
+            *out++ = '0' + nm / div;
+            nm %= div;
+        }
+    }
+
+    return out - aBuf;
+}
+
+
 std::string BOARD_ITEM::FormatInternalUnits( int aValue )
 {
 #if 1
 
+    char    buf[16];
+
+    return std::string( buf, formatIU( buf, aValue ) );
+
+#else
+
+    // The general purpose floating point algorithm.
+    // Can be used to verify that the above algorithm is correctly generating text.
+
     char    buf[50];
     int     len;
     double  mm = aValue / IU_PER_MM;
@@ -114,65 +181,40 @@ std::string BOARD_ITEM::FormatInternalUnits( int aValue )
 
     return std::string( buf, len );
 
-#else
+#endif
+}
 
-    // Assume aValue is in nanometers, and that we want the result in millimeters,
-    // and that int is 32 bits wide.  Then perform an alternative algorithm.
-    // Can be used to verify that the above algorithm is correctly generating text.
-    // Convert aValue into an integer string, then insert a decimal point manually.
-    // Results are the same as above general purpose algorithm.
 
-    wxASSERT( sizeof(int) == 4 );
+std::string BOARD_ITEM::FormatAngle( double aAngle )
+{
+    char temp[50];
+    int  len;
 
-    if( aValue == 0 )
-        return std::string( 1, '0' );
-    else
+    // Angles are nearly always whole tenths of degree: avoid the "%.10g" format for them.
+    // 0 is excluded, so a -0.0 angle is still written "-0".
+    if( aAngle != 0.0 && fabs( aAngle ) < 1e9 && aAngle == (int) aAngle )
     {
-        char    buf[50];
-        int     len = sprintf( buf, aValue > 0 ? "%06d" : "%07d", aValue );     // optionally pad w/leading zeros
-
-        std::string ret( buf, len );
+        int      tenths = (int) aAngle;
+        unsigned value = tenths < 0 ? 0u - tenths : tenths;
+        char*    out = temp;
 
-        std::string::iterator it = ret.end() - 1;           // last byte
+        if( tenths < 0 )
+            *out++ = '-';
 
-        // insert '.' at 6 positions from end, dividing by 10e6 (a million), nm => mm
-        std::string::iterator decpoint = ret.end() - 6;
+        out = formatUnsigned( out, value / 10 );
 
-        // truncate trailing zeros, up to decimal point position
-        for(  ; *it=='0' && it >= decpoint;  --it )
-            ret.erase( it );    // does not invalidate iterators it or decpoint
-
-        if( it >= decpoint )
+        if( value % 10 )
         {
-            ret.insert( decpoint, '.' );
-
-            // decpoint is invalidated here, after insert()
-
-#if 1       // want a leading zero when decimal point is in first position?
-            if( ret[0] == '.' )
-            {
-                // insert leading zero ahead of decimal point.
-                ret.insert( ret.begin(), '0' );
-            }
-            else if( ret[0]=='-' && ret[1]=='.' )
-            {
-                ret.insert( ret.begin() + 1, '0' );
-            }
-#endif
+            *out++ = '.';
+            *out++ = '0' + value % 10;
         }
 
-        return ret;
+        len = out - temp;
+    }
+    else
+    {
+        len = snprintf( temp, sizeof(temp), "%.10g", aAngle / 10.0 );
     }
-
-#endif
-}
-
-
-std::string BOARD_ITEM::FormatAngle( double aAngle )
-{
-    char temp[50];
-
-    int len = snprintf( temp, sizeof(temp), "%.10g", aAngle / 10.0 );
 
     return std::string( temp, len );
 }
@@ -180,19 +222,25 @@ std::string BOARD_ITEM::FormatAngle( double aAngle )
 
 std::string BOARD_ITEM::FormatInternalUnits( const wxPoint& aPoint )
 {
-    return FormatInternalUnits( aPoint.x ) + " " + FormatInternalUnits( aPoint.y );
+    char    buf[32];
+    int     len = formatIU( buf, aPoint.x );
+
+    buf[len++] = ' ';
+    len += formatIU( buf + len, aPoint.y );
+
+    return std::string( buf, len );
 }
 
 
 std::string BOARD_ITEM::FormatInternalUnits( const VECTOR2I& aPoint )
 {
-    return FormatInternalUnits( aPoint.x ) + " " + FormatInternalUnits( aPoint.y );
+    return FormatInternalUnits( wxPoint( aPoint.x, aPoint.y ) );
 }
 
 
 std::string BOARD_ITEM::FormatInternalUnits( const wxSize& aSize )
 {
-    return FormatInternalUnits( aSize.GetWidth() ) + " " + FormatInternalUnits( aSize.GetHeight() );
+    return FormatInternalUnits( wxPoint( aSize.GetWidth(), aSize.GetHeight() ) );
 }
 
 
@@ -31,6 +31,7 @@
 #define CLASS_ZONE_H_
 
 
+#include <memory>
 #include <vector>
 #include <gr_basic.h>
 #include <class_board_item.h>
@@ -48,6 +49,7 @@ class PCB_EDIT_FRAME;
 class BOARD;
 class ZONE_CONTAINER;
 class MSG_PANEL_ITEM;
+struct ZONE_FILL_CACHE;
 
 typedef std::vector<SEG> ZONE_SEGMENT_FILL;
 
@@ -556,6 +558,21 @@ public:
         m_RawPolysList = aPolysList;
     }
 
+    /**
+     * Data kept by the zone filler between two fills of this zone, used to refill only
+     * the areas affected by the board changes (see ZONE_FILL_CACHE).
+     * @return the fill cache, or nullptr if the zone was never filled in this session.
+     */
+    std::shared_ptr<const ZONE_FILL_CACHE> GetFillCache() const
+    {
+        return m_fillCache;
+    }
+
+    void SetFillCache( std::shared_ptr<const ZONE_FILL_CACHE> aCache )
+    {
+        m_fillCache = aCache;
+    }
+
 
     /**
      * Function GetSmoothedPoly
@@ -736,6 +753,10 @@ private:
     SHAPE_POLY_SET        m_FilledPolysList;
     SHAPE_POLY_SET        m_RawPolysList;
 
+    /// Data used by the zone filler to refill only the changed areas.  It is never
+    /// modified once built, so copies of the zone (undo images) can share it.
+    std::shared_ptr<const ZONE_FILL_CACHE> m_fillCache;
+
     HATCH_STYLE           m_hatchStyle;     // hatch style, see enum above
     int                   m_hatchPitch;     // for DIAGONAL_EDGE, distance between 2 hatch lines
     std::vector<SEG>      m_HatchLines;     // hatch lines
@@ -25,18 +25,23 @@
 #include <connectivity_algo.h>
 #include <widgets/progress_reporter.h>
 #include <geometry/geometry_utils.h>
+#include <thread_pool.h>
 
+#include <atomic>
+#include <chrono>
+#include <cstring>
 #include <thread>
 #include <mutex>
+#include <unordered_map>
+
+#include <wx/ffile.h>
+#include <wx/filename.h>
+#include <wx/log.h>
 
 #ifdef PROFILE
 #include <profile.h>
 #endif
 
-#ifdef USE_OPENMP
-#include <omp.h>
-#endif /* USE_OPENMP */
-
 using namespace std::placeholders;
 
 bool operator<( const CN_ANCHOR_PTR& a, const CN_ANCHOR_PTR& b )
@@ -320,7 +325,7 @@ void CN_CONNECTIVITY_ALGO::searchConnections()
     m_itemList.RemoveInvalidItems( garbage );
 
     for( auto item : garbage )
-        delete item;
+        m_itemList.FreeItem( item );
 
 #ifdef PROFILE
     garbage_collection.Show();
@@ -333,38 +338,64 @@ void CN_CONNECTIVITY_ALGO::searchConnections()
         m_progressReporter->SetMaxProgress( m_itemList.IsDirty() ? m_itemList.Size() : 0 );
     }
 
-#ifdef USE_OPENMP
-    #pragma omp parallel num_threads( std::max( omp_get_num_procs(), 2 ) )
+    if( m_itemList.IsDirty() )
     {
-        if( omp_get_thread_num() == 0 && m_progressReporter )
-            m_progressReporter->KeepRefreshing( true );
-#endif
+        THREAD_POOL& pool = THREAD_POOL::GetInstance();
 
-        if( m_itemList.IsDirty() )
+        auto searchItem = [this]( size_t i )
         {
-#ifdef USE_OPENMP
-            #pragma omp parallel for
-#endif
-            for( int i = 0; i < m_itemList.Size(); i++ )
+            auto item = m_itemList[i];
+
+            if( item->Dirty() )
             {
-                auto item = m_itemList[i];
-                if( item->Dirty() )
+                CN_VISITOR visitor( item, &m_listLock );
+                m_itemList.FindNearby( item, visitor );
+            }
+
+            if( m_progressReporter )
+                m_progressReporter->AdvanceProgress();
+        };
+
+        if( m_progressReporter )
+        {
+            // The search is split in chunks tagged by this object.  This thread runs the
+            // chunks no worker has taken and refreshes the progress reporter in between, so
+            // that the UI stays responsive even when all the workers are busy.
+            size_t count = m_itemList.Size();
+            size_t chunkCount = std::min( count, ( pool.GetWorkerCount() + 1 ) * 8 );
+            std::vector<std::future<void>> chunks;
+
+            for( size_t ii = 0; ii < chunkCount; ++ii )
+            {
+                chunks.push_back( pool.Submit( [&, ii]()
                 {
-                    CN_VISITOR visitor( item, &m_listLock );
-                    m_itemList.FindNearby( item, visitor );
-                }
+                    for( size_t jj = ii * count / chunkCount; jj < ( ii + 1 ) * count / chunkCount; ++jj )
+                        searchItem( jj );
+                }, this ) );
+            }
+
+            for( std::future<void>& chunk : chunks )
+            {
+                while( chunk.wait_for( std::chrono::seconds( 0 ) ) != std::future_status::ready )
+                {
+                    if( !pool.RunPendingTask( this ) )
+                        chunk.wait_for( std::chrono::milliseconds( 20 ) );
 
-                if( m_progressReporter )
-                    m_progressReporter->AdvanceProgress();
+                    m_progressReporter->KeepRefreshing( false );
+                }
             }
+
+            for( std::future<void>& chunk : chunks )
+                chunk.get();
         }
+        else
+        {
+            pool.ParallelFor( m_itemList.Size(), searchItem );
+        }
+    }
 
 #ifdef PROFILE
-        search_basic.Show();
-#endif
-
-#ifdef USE_OPENMP
-    }
+    search_basic.Show();
 #endif
 
     m_itemList.ClearDirtyFlags();
@@ -381,13 +412,12 @@ void CN_CONNECTIVITY_ALGO::searchConnections()
 
 void CN_ITEM::RemoveInvalidRefs()
 {
-    for( auto it = m_connected.begin(); it != m_connected.end(); )
-    {
-        if( !(*it)->Valid() )
-            it = m_connected.erase( it );
-        else
-            ++it;
-    }
+    m_connected.erase( std::remove_if( m_connected.begin(), m_connected.end(),
+                                       []( const CN_ITEM* aItem )
+                                       {
+                                           return !aItem->Valid();
+                                       } ),
+                       m_connected.end() );
 }
 
 
@@ -438,92 +468,152 @@ const CN_CONNECTIVITY_ALGO::CLUSTERS CN_CONNECTIVITY_ALGO::SearchClusters( CLUST
 }
 
 
+/**
+ * Finds the representative of the set containing aItem in a disjoint set forest, halving
+ * the path on the way.  Can be run concurrently with uniteSets().
+ */
+static int findSet( std::vector<std::atomic_int>& aParents, int aItem )
+{
+    while( true )
+    {
+        int parent = aParents[aItem].load();
+
+        if( parent == aItem )
+            return aItem;
+
+        int grandParent = aParents[parent].load();
+
+        // Another thread may have changed the parent meanwhile, in which case the path
+        // is simply not shortened
+        if( grandParent != parent )
+            aParents[aItem].compare_exchange_weak( parent, grandParent );
+
+        aItem = grandParent;
+    }
+}
+
+
+/**
+ * Merges the sets containing aItemA and aItemB, without locks.  A root is always linked
+ * to a root of lower index, so that concurrent merges can not create cycles.
+ */
+static void uniteSets( std::vector<std::atomic_int>& aParents, int aItemA, int aItemB )
+{
+    while( true )
+    {
+        aItemA = findSet( aParents, aItemA );
+        aItemB = findSet( aParents, aItemB );
+
+        if( aItemA == aItemB )
+            return;
+
+        if( aItemA < aItemB )
+            std::swap( aItemA, aItemB );
+
+        // Fails if aItemA stopped being a root, then the search is restarted
+        int expected = aItemA;
+
+        if( aParents[aItemA].compare_exchange_strong( expected, aItemB ) )
+            return;
+    }
+}
+
+
 const CN_CONNECTIVITY_ALGO::CLUSTERS CN_CONNECTIVITY_ALGO::SearchClusters( CLUSTER_SEARCH_MODE aMode,
         const KICAD_T aTypes[], int aSingleNet )
 {
     bool withinAnyNet = ( aMode != CSM_PROPAGATE );
 
-    std::deque<CN_ITEM*> Q;
-    CN_ITEM* head = nullptr;
     CLUSTERS clusters;
 
     if( isDirty() )
         searchConnections();
 
-    auto addToSearchList = [&head, withinAnyNet, aSingleNet, aTypes] ( CN_ITEM *aItem )
+    auto isSearched = [withinAnyNet, aSingleNet, aTypes] ( CN_ITEM *aItem )
     {
         if( withinAnyNet && aItem->Net() <= 0 )
-            return;
+            return false;
 
         if( !aItem->Valid() )
-            return;
+            return false;
 
         if( aSingleNet >=0 && aItem->Net() != aSingleNet )
-            return;
-
-        bool found = false;
+            return false;
 
         for( int i = 0; aTypes[i] != EOT; i++ )
         {
             if( aItem->Parent()->Type() == aTypes[i] )
-            {
-                found = true;
-                break;
-            }
+                return true;
         }
 
-        if( !found )
-            return;
-
-        aItem->ListClear();
-        aItem->SetVisited( false );
-
-        if( !head )
-            head = aItem;
-        else
-            head->ListInsert( aItem );
+        return false;
     };
 
-    std::for_each( m_itemList.begin(), m_itemList.end(), addToSearchList );
+    std::vector<CN_ITEM*> items;
+    items.reserve( m_itemList.Size() );
 
-    while( head )
+    for( auto item : m_itemList )
     {
-        CN_CLUSTER_PTR cluster ( new CN_CLUSTER() );
+        if( isSearched( item ) )
+        {
+            item->SetSearchIndex( items.size() );
+            items.push_back( item );
+        }
+        else
+        {
+            item->SetSearchIndex( -1 );
+        }
+    }
 
-        Q.clear();
-        CN_ITEM* root = head;
-        root->SetVisited ( true );
+    // Every item starts as its own set, then the sets of connected items are merged
+    // concurrently, each connection being handled by the item having the lower index
+    std::vector<std::atomic_int> parents( items.size() );
 
-        head = root->ListRemove();
+    for( size_t i = 0; i < items.size(); i++ )
+        parents[i].store( i );
 
-        Q.push_back( root );
+    const size_t chunkSize = 256;
+    size_t chunkCount = ( items.size() + chunkSize - 1 ) / chunkSize;
 
-        while( Q.size() )
-        {
-            CN_ITEM* current = Q.front();
+    THREAD_POOL::GetInstance().ParallelFor( chunkCount,
+            [&items, &parents, withinAnyNet, chunkSize]( size_t aChunk )
+    {
+        size_t last = std::min( ( aChunk + 1 ) * chunkSize, items.size() );
 
-            Q.pop_front();
-            cluster->Add( current );
+        for( size_t i = aChunk * chunkSize; i < last; i++ )
+        {
+            CN_ITEM* item = items[i];
 
-            for( auto n : current->ConnectedItems() )
+            for( auto n : item->ConnectedItems() )
             {
-                if( withinAnyNet && n->Net() != root->Net() )
+                if( n->SearchIndex() <= (int) i )
                     continue;
 
-                if( !n->Visited() && n->Valid() )
-                {
-                    n->SetVisited( true );
-                    Q.push_back( n );
-                    head = n->ListRemove();
-                }
+                if( withinAnyNet && n->Net() != item->Net() )
+                    continue;
+
+                uniteSets( parents, i, n->SearchIndex() );
             }
         }
+    } );
 
-        clusters.push_back( cluster );
-    }
+    std::vector<int> clusterIndex( items.size(), -1 );
+
+    for( size_t i = 0; i < items.size(); i++ )
+    {
+        int root = findSet( parents, i );
+
+        if( clusterIndex[root] < 0 )
+        {
+            clusterIndex[root] = clusters.size();
+            clusters.push_back( CN_CLUSTER_PTR( new CN_CLUSTER() ) );
+        }
 
+        clusters[clusterIndex[root]]->Add( items[i] );
+    }
 
-    std::sort( clusters.begin(), clusters.end(), []( CN_CLUSTER_PTR a, CN_CLUSTER_PTR b ) {
+    std::stable_sort( clusters.begin(), clusters.end(), []( const CN_CLUSTER_PTR& a,
+                                                            const CN_CLUSTER_PTR& b ) {
         return a->OriginNet() < b->OriginNet();
     } );
 
@@ -594,6 +684,282 @@ void CN_CONNECTIVITY_ALGO::Build( const std::vector<BOARD_ITEM*>& aItems )
 }
 
 
+/**
+ * FNV-1a hash of the copper items of a board, identifying the board content a connection
+ * cache was computed for.
+ */
+class CN_COPPER_HASH
+{
+public:
+    CN_COPPER_HASH() :
+        m_hash( 14695981039346656037ULL )
+    {
+    }
+
+    void AddInt( int64_t aValue )
+    {
+        uint64_t value = aValue;
+
+        for( int i = 0; i < 8; i++ )
+        {
+            m_hash ^= ( value >> ( i * 8 ) ) & 0xff;
+            m_hash *= 1099511628211ULL;
+        }
+    }
+
+    void AddDouble( double aValue )
+    {
+        int64_t bits;
+
+        static_assert( sizeof( bits ) == sizeof( aValue ), "unexpected double size" );
+        memcpy( &bits, &aValue, sizeof( bits ) );
+        AddInt( bits );
+    }
+
+    void AddPoint( const VECTOR2I& aPoint )
+    {
+        AddInt( aPoint.x );
+        AddInt( aPoint.y );
+    }
+
+    void AddString( const wxString& aText )
+    {
+        wxScopedCharBuffer utf8 = aText.utf8_str();
+
+        AddInt( utf8.length() );
+
+        for( size_t i = 0; i < utf8.length(); i++ )
+        {
+            m_hash ^= (unsigned char) utf8.data()[i];
+            m_hash *= 1099511628211ULL;
+        }
+    }
+
+    void AddSize( const wxSize& aSize )
+    {
+        AddInt( aSize.x );
+        AddInt( aSize.y );
+    }
+
+    void AddLayers( const LSET& aLayers )
+    {
+        for( PCB_LAYER_ID layer : aLayers.Seq() )
+            AddInt( layer );
+
+        AddInt( -1 );
+    }
+
+    void AddPolySet( const SHAPE_POLY_SET& aPolySet )
+    {
+        AddInt( aPolySet.TotalVertices() );
+
+        for( auto it = aPolySet.CIterateWithHoles(); it; it++ )
+            AddPoint( *it );
+    }
+
+    uint64_t Get() const
+    {
+        return m_hash;
+    }
+
+private:
+    uint64_t m_hash;
+};
+
+
+uint64_t CN_CONNECTIVITY_ALGO::boardItems( BOARD* aBoard, std::vector<CN_ITEM*>& aItems )
+{
+    CN_COPPER_HASH hash;
+
+    auto addItem = [&]( BOARD_CONNECTED_ITEM* aItem )
+    {
+        if( !ItemExists( aItem ) )
+            return false;
+
+        for( CN_ITEM* item : m_itemMap[aItem].m_items )
+            aItems.push_back( item );
+
+        // Net codes are renumbered on each load, net names are not
+        hash.AddInt( aItem->Type() );
+        hash.AddString( aItem->GetNetname() );
+        hash.AddLayers( aItem->GetLayerSet() );
+        return true;
+    };
+
+    for( int i = 0; i < aBoard->GetAreaCount(); i++ )
+    {
+        ZONE_CONTAINER* zone = aBoard->GetArea( i );
+
+        if( addItem( zone ) )
+        {
+            hash.AddInt( zone->GetMinThickness() );
+            hash.AddPolySet( zone->GetFilledPolysList() );
+        }
+    }
+
+    for( auto track : aBoard->Tracks() )
+    {
+        if( addItem( track ) )
+        {
+            hash.AddPoint( track->GetStart() );
+            hash.AddPoint( track->GetEnd() );
+            hash.AddInt( track->GetWidth() );
+
+            if( track->Type() == PCB_VIA_T )
+            {
+                VIA* via = static_cast<VIA*>( track );
+
+                hash.AddInt( via->GetViaType() );
+                hash.AddInt( via->GetDrillValue() );
+            }
+        }
+    }
+
+    for( auto mod : aBoard->Modules() )
+    {
+        for( auto pad : mod->Pads() )
+        {
+            if( addItem( pad ) )
+            {
+                hash.AddPoint( pad->ShapePos() );
+                hash.AddInt( pad->GetShape() );
+                hash.AddInt( pad->GetAnchorPadShape() );
+                hash.AddInt( pad->GetAttribute() );
+                hash.AddSize( pad->GetSize() );
+                hash.AddSize( pad->GetDelta() );
+                hash.AddDouble( pad->GetOrientation() );
+                hash.AddDouble( pad->GetRoundRectRadiusRatio() );
+                hash.AddInt( pad->GetDrillShape() );
+                hash.AddSize( pad->GetDrillSize() );
+                hash.AddPolySet( pad->GetCustomShapeAsPolygon() );
+            }
+        }
+    }
+
+    hash.AddInt( aItems.size() );
+
+    return hash.Get();
+}
+
+
+// Connection cache file: a header of CACHE_HEADER_SIZE words, then pairs of item indices
+static const uint32_t CACHE_MAGIC = 0x4b434e31;     // "KCN1"
+static const uint32_t CACHE_VERSION = 2;
+static const size_t   CACHE_HEADER_SIZE = 6;        // magic, version, hash (2), items, pairs
+
+
+bool CN_CONNECTIVITY_ALGO::LoadConnections( BOARD* aBoard, const wxString& aFileName )
+{
+    if( !wxFileName::FileExists( aFileName ) )
+        return false;
+
+    wxFFile file( aFileName, "rb" );
+
+    if( !file.IsOpened() )
+        return false;
+
+    wxFileOffset length = file.Length();
+
+    if( length < (wxFileOffset) ( CACHE_HEADER_SIZE * sizeof( uint32_t ) )
+            || length % sizeof( uint32_t ) )
+        return false;
+
+    std::vector<uint32_t> data( length / sizeof( uint32_t ) );
+
+    if( file.Read( data.data(), length ) != (size_t) length )
+        return false;
+
+    std::vector<CN_ITEM*> items;
+    uint64_t hash = boardItems( aBoard, items );
+
+    if( data[0] != CACHE_MAGIC || data[1] != CACHE_VERSION
+            || data[2] != (uint32_t) hash || data[3] != (uint32_t) ( hash >> 32 )
+            || data[4] != items.size()
+            || data.size() != CACHE_HEADER_SIZE + 2 * (size_t) data[5] )
+        return false;
+
+    // The connections can only be restored on items which were not searched yet
+    for( CN_ITEM* item : items )
+    {
+        if( !item->Dirty() )
+            return false;
+    }
+
+    for( size_t i = CACHE_HEADER_SIZE; i < data.size(); i += 2 )
+    {
+        if( data[i] >= items.size() || data[i + 1] >= items.size() )
+            return false;
+    }
+
+    for( size_t i = CACHE_HEADER_SIZE; i < data.size(); i += 2 )
+        CN_ITEM::Connect( items[data[i]], items[data[i + 1]] );
+
+    m_itemList.ClearDirtyFlags();
+
+    return true;
+}
+
+
+bool CN_CONNECTIVITY_ALGO::SaveConnections( BOARD* aBoard, const wxString& aFileName )
+{
+    if( isDirty() )
+        searchConnections();
+
+    std::vector<CN_ITEM*> items;
+    uint64_t hash = boardItems( aBoard, items );
+
+    std::unordered_map<const CN_ITEM*, uint32_t> indices;
+
+    for( size_t i = 0; i < items.size(); i++ )
+        indices[items[i]] = i;
+
+    std::vector<uint32_t> data = { CACHE_MAGIC, CACHE_VERSION, (uint32_t) hash,
+                                   (uint32_t) ( hash >> 32 ), (uint32_t) items.size(), 0 };
+
+    // Each connection is stored once, by its item of lower index
+    for( size_t i = 0; i < items.size(); i++ )
+    {
+        for( CN_ITEM* connected : items[i]->ConnectedItems() )
+        {
+            auto found = indices.find( connected );
+
+            if( found != indices.end() && found->second > i && connected->Valid() )
+            {
+                data.push_back( i );
+                data.push_back( found->second );
+            }
+        }
+    }
+
+    data[5] = ( data.size() - CACHE_HEADER_SIZE ) / 2;
+
+    // Write a temporary file renamed once complete, so an interrupted save never leaves a
+    // partial cache behind
+    wxLogNull doNotLog;
+    wxString  tmpName = aFileName + ".tmp";
+    size_t    size = data.size() * sizeof( uint32_t );
+    bool      ok;
+
+    {
+        wxFFile file( tmpName, "wb" );
+
+        if( !file.IsOpened() )
+            return false;
+
+        ok = file.Write( data.data(), size ) == size;
+        ok = file.Close() && ok;
+    }
+
+    if( !ok || !wxRenameFile( tmpName, aFileName, true ) )
+    {
+        wxRemoveFile( tmpName );
+        return false;
+    }
+
+    return true;
+}
+
+
 void CN_CONNECTIVITY_ALGO::propagateConnections()
 {
     for( const auto& cluster : m_connClusters )
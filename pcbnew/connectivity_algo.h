@@ -39,9 +39,9 @@
 #include <memory>
 #include <algorithm>
 #include <functional>
+#include <type_traits>
 #include <vector>
 #include <deque>
-#include <intrusive_list.h>
 
 #include <connectivity_rtree.h>
 #include <connectivity_data.h>
@@ -112,12 +112,12 @@ public:
         return m_noline;
     }
 
-    inline void SetCluster( std::shared_ptr<CN_CLUSTER> aCluster )
+    inline void SetCluster( const std::shared_ptr<CN_CLUSTER>& aCluster )
     {
         m_cluster = aCluster;
     }
 
-    inline std::shared_ptr<CN_CLUSTER> GetCluster() const
+    inline const std::shared_ptr<CN_CLUSTER>& GetCluster() const
     {
         return m_cluster;
     }
@@ -162,12 +162,12 @@ class CN_EDGE
 public:
     CN_EDGE() {};
     CN_EDGE( CN_ANCHOR_PTR aSource, CN_ANCHOR_PTR aTarget, int aWeight = 0 ) :
-        m_source( aSource ),
-        m_target( aTarget ),
+        m_source( std::move( aSource ) ),
+        m_target( std::move( aTarget ) ),
         m_weight( aWeight ) {}
 
-    CN_ANCHOR_PTR GetSourceNode() const { return m_source; }
-    CN_ANCHOR_PTR GetTargetNode() const { return m_target; }
+    const CN_ANCHOR_PTR& GetSourceNode() const { return m_source; }
+    const CN_ANCHOR_PTR& GetTargetNode() const { return m_target; }
     int GetWeight() const { return m_weight; }
 
     void SetSourceNode( const CN_ANCHOR_PTR& aNode ) { m_source = aNode; }
@@ -263,20 +263,21 @@ typedef std::shared_ptr<CN_CLUSTER> CN_CLUSTER_PTR;
 
 
 // basic connectivity item
-class CN_ITEM : public INTRUSIVE_LIST<CN_ITEM>
+class CN_ITEM
 {
 private:
     BOARD_CONNECTED_ITEM* m_parent;
 
-    using CONNECTED_ITEMS = std::set<CN_ITEM*>;
+    using CONNECTED_ITEMS = std::vector<CN_ITEM*>;
 
-    ///> list of items physically connected (touching)
+    ///> list of items physically connected (touching).  A pair of items is tested only
+    ///> once by the connection search, so the list never holds duplicates.
     CONNECTED_ITEMS m_connected;
 
     CN_ANCHORS m_anchors;
 
-    ///> visited flag for the BFS scan
-    bool m_visited;
+    ///> index of the item in the last cluster search, -1 if it was not part of it
+    int m_searchIndex;
 
     ///> can the net propagator modify the netcode?
     bool m_canChangeNet;
@@ -301,10 +302,10 @@ public:
     {
         m_parent = aParent;
         m_canChangeNet = aCanChangeNet;
-        m_visited = false;
+        m_searchIndex = -1;
         m_valid = true;
         m_dirty = true;
-        m_anchors.reserve( 2 );
+        m_anchors.reserve( aAnchorCount );
         m_layers = LAYER_RANGE( 0, PCB_LAYER_ID_COUNT );
     }
 
@@ -312,7 +313,8 @@ public:
 
     void AddAnchor( const VECTOR2I& aPos )
     {
-        m_anchors.emplace_back( std::make_unique<CN_ANCHOR>( aPos, this ) );
+        // make_shared allocates the anchor and its reference counts in a single block
+        m_anchors.emplace_back( std::make_shared<CN_ANCHOR>( aPos, this ) );
     }
 
     CN_ANCHORS& Anchors()
@@ -416,14 +418,14 @@ public:
         m_connected.clear();
     }
 
-    void SetVisited( bool aVisited )
+    void SetSearchIndex( int aIndex )
     {
-        m_visited = aVisited;
+        m_searchIndex = aIndex;
     }
 
-    bool Visited() const
+    int SearchIndex() const
     {
-        return m_visited;
+        return m_searchIndex;
     }
 
     bool CanChangeNet() const
@@ -433,13 +435,13 @@ public:
 
     bool isConnected( CN_ITEM* aItem ) const
     {
-        return ( m_connected.find( aItem ) != m_connected.end() );
+        return std::find( m_connected.begin(), m_connected.end(), aItem ) != m_connected.end();
     }
 
     static void Connect( CN_ITEM* a, CN_ITEM* b )
     {
-        a->m_connected.insert( b );
-        b->m_connected.insert( a );
+        a->m_connected.push_back( b );
+        b->m_connected.push_back( a );
     }
 
     void RemoveInvalidRefs();
@@ -500,6 +502,80 @@ private:
     int m_subpolyIndex;
 };
 
+/**
+ * Stores objects of type T in large contiguous blocks, so that the connectivity items
+ * created together are adjacent in memory and do not cost a heap allocation each.
+ * The slots of the destroyed objects are reused by the next ones.  Not thread safe.
+ */
+template <class T, size_t BLOCK_SIZE = 1024>
+class CN_POOL
+{
+public:
+    CN_POOL() :
+        m_used( BLOCK_SIZE )
+    {
+    }
+
+    CN_POOL( const CN_POOL& ) = delete;
+    CN_POOL& operator=( const CN_POOL& ) = delete;
+
+    template <typename... ARGS>
+    T* Create( ARGS&&... aArgs )
+    {
+        void* slot;
+
+        if( !m_freeSlots.empty() )
+        {
+            slot = m_freeSlots.back();
+            m_freeSlots.pop_back();
+        }
+        else
+        {
+            if( m_used == BLOCK_SIZE )
+            {
+                m_blocks.emplace_back( new SLOT[BLOCK_SIZE] );
+                m_used = 0;
+            }
+
+            slot = &m_blocks.back()[m_used++];
+        }
+
+        try
+        {
+            return new( slot ) T( std::forward<ARGS>( aArgs )... );
+        }
+        catch( ... )
+        {
+            m_freeSlots.push_back( slot );
+            throw;
+        }
+    }
+
+    void Destroy( T* aObject )
+    {
+        aObject->~T();
+        m_freeSlots.push_back( aObject );
+    }
+
+    /**
+     * Releases the memory blocks.  All the objects must have been destroyed.
+     */
+    void Clear()
+    {
+        m_blocks.clear();
+        m_freeSlots.clear();
+        m_used = BLOCK_SIZE;
+    }
+
+private:
+    typedef typename std::aligned_storage<sizeof( T ), alignof( T )>::type SLOT;
+
+    std::vector<std::unique_ptr<SLOT[]>> m_blocks;
+    std::vector<void*>                   m_freeSlots;
+    size_t                               m_used;    ///< Used slots of the last block
+};
+
+
 class CN_LIST
 {
 private:
@@ -508,6 +584,10 @@ private:
 
     CN_RTREE<CN_ITEM*> m_index;
 
+    ///> storage of the items, zones are kept apart as they are larger and few
+    CN_POOL<CN_ITEM> m_itemPool;
+    CN_POOL<CN_ZONE, 64> m_zonePool;
+
 protected:
     std::vector<CN_ITEM*> m_items;
 
@@ -523,13 +603,32 @@ public:
         m_hasInvalid = false;
     }
 
+    ~CN_LIST()
+    {
+        Clear();
+    }
+
     void Clear()
     {
         for( auto item : m_items )
-            delete item;
+            FreeItem( item );
 
         m_items.clear();
         m_index.RemoveAll();
+        m_itemPool.Clear();
+        m_zonePool.Clear();
+    }
+
+    /**
+     * Destroys an item created by this list, which must not be referenced by the list
+     * anymore (see RemoveInvalidItems()).
+     */
+    void FreeItem( CN_ITEM* aItem )
+    {
+        if( CN_ZONE* zone = dynamic_cast<CN_ZONE*>( aItem ) )
+            m_zonePool.Destroy( zone );
+        else
+            m_itemPool.Destroy( aItem );
     }
 
     using ITER = decltype(m_items)::iterator;
@@ -582,7 +681,7 @@ public:
 
     CN_ITEM* Add( D_PAD* pad )
     {
-        auto item = new CN_ITEM( pad, false, 1 );
+        auto item = m_itemPool.Create( pad, false, 1 );
         item->AddAnchor( pad->ShapePos() );
         item->SetLayers( LAYER_RANGE( F_Cu, B_Cu ) );
 
@@ -616,7 +715,7 @@ public:
 
     CN_ITEM* Add( TRACK* track )
     {
-        auto item = new CN_ITEM( track, true );
+        auto item = m_itemPool.Create( track, true );
         m_items.push_back( item );
         item->AddAnchor( track->GetStart() );
         item->AddAnchor( track->GetEnd() );
@@ -628,7 +727,7 @@ public:
 
     CN_ITEM* Add( VIA* via )
     {
-        auto item = new CN_ITEM( via, true, 1 );
+        auto item = m_itemPool.Create( via, true, 1 );
 
         m_items.push_back( item );
         item->AddAnchor( via->GetStart() );
@@ -646,7 +745,7 @@ public:
 
         for( int j = 0; j < polys.OutlineCount(); j++ )
         {
-            CN_ZONE* zitem = new CN_ZONE( zone, false, j );
+            CN_ZONE* zitem = m_zonePool.Create( zone, false, j );
             const auto& outline = zone->GetFilledPolysList().COutline( j );
 
             for( int k = 0; k < outline.PointCount(); k++ )
@@ -741,6 +840,12 @@ public:
     bool addConnectedItem( BOARD_CONNECTED_ITEM* aItem );
     bool isDirty() const;
 
+    /**
+     * Lists the items of aBoard in the order of Build( aBoard ), and computes a hash of
+     * their copper geometry and nets.
+     */
+    uint64_t boardItems( BOARD* aBoard, std::vector<CN_ITEM*>& aItems );
+
     void markItemNetAsDirty( const BOARD_ITEM* aItem );
 
 public:
@@ -774,7 +879,7 @@ public:
 
     void GetDirtyClusters( CLUSTERS& aClusters )
     {
-        for( auto cl : m_ratsnestClusters )
+        for( const auto& cl : m_ratsnestClusters )
         {
             int net = cl->OriginNet();
 
@@ -799,6 +904,20 @@ public:
     const CLUSTERS  SearchClusters( CLUSTER_SEARCH_MODE aMode, const KICAD_T aTypes[], int aSingleNet );
     const CLUSTERS  SearchClusters( CLUSTER_SEARCH_MODE aMode );
 
+    /**
+     * Restores the connections between the items of a board just built with Build( aBoard )
+     * from a file written by SaveConnections(), so the connection search is skipped.
+     * @return false, and nothing is changed, if the file is missing, invalid or was not
+     * written for the same copper items.
+     */
+    bool    LoadConnections( BOARD* aBoard, const wxString& aFileName );
+
+    /**
+     * Writes the connections between the items of aBoard, after bringing them up to date.
+     * @return false if the file could not be written.
+     */
+    bool    SaveConnections( BOARD* aBoard, const wxString& aFileName );
+
     void    PropagateNets();
     void    FindIsolatedCopperIslands( ZONE_CONTAINER* aZone, std::vector<int>& aIslands );
 
@@ -28,10 +28,10 @@
 #include <connectivity_data.h>
 #include <connectivity_algo.h>
 #include <ratsnest_data.h>
+#include <thread_pool.h>
+#include <wildcards_and_files_ext.h>
 
-#ifdef USE_OPENMP
-#include <omp.h>
-#endif /* USE_OPENMP */
+#include <wx/filename.h>
 
 CONNECTIVITY_DATA::CONNECTIVITY_DATA()
 {
@@ -85,6 +85,37 @@ void CONNECTIVITY_DATA::Build( const std::vector<BOARD_ITEM*>& aItems )
 }
 
 
+bool CONNECTIVITY_DATA::BuildFromCache( BOARD* aBoard, const wxString& aCacheFile )
+{
+    m_connAlgo.reset( new CN_CONNECTIVITY_ALGO );
+    m_connAlgo->Build( aBoard );
+
+    bool cached = m_connAlgo->LoadConnections( aBoard, aCacheFile );
+
+    // Without the cache, the connections are searched here.  The ratsnest is always
+    // recomputed: it is cheap compared to the connection search.
+    RecalculateRatsnest();
+
+    return cached;
+}
+
+
+bool CONNECTIVITY_DATA::SaveCache( BOARD* aBoard, const wxString& aCacheFile )
+{
+    return m_connAlgo->SaveConnections( aBoard, aCacheFile );
+}
+
+
+wxString CONNECTIVITY_DATA::CacheFileName( const wxString& aBoardFile )
+{
+    wxFileName fn( aBoardFile );
+
+    fn.SetExt( ConnectivityCacheFileExtension );
+
+    return fn.GetFullPath();
+}
+
+
 void CONNECTIVITY_DATA::updateRatsnest()
 {
     int lastNet = m_connAlgo->NetCount();
@@ -93,28 +124,14 @@ void CONNECTIVITY_DATA::updateRatsnest()
     PROF_COUNTER rnUpdate( "update-ratsnest" );
     #endif
 
-    int nDirty = 0;
-
-    int i;
-
-    #ifdef USE_OPENMP
-        #pragma omp parallel shared(lastNet) private(i)
+    // Start with net number 1, as 0 stands for not connected
+    THREAD_POOL::GetInstance().ParallelFor( std::max( lastNet - 1, 0 ), [this]( size_t i )
     {
-        #pragma omp for schedule(guided, 1)
-    #else /* USE_OPENMP */
-    {
-    #endif
+        RN_NET* net = m_nets[i + 1];
 
-        // Start with net number 1, as 0 stands for not connected
-        for( i = 1; i < lastNet; ++i )
-        {
-            if( m_nets[i]->IsDirty() )
-            {
-                m_nets[i]->Update();
-                nDirty++;
-            }
-        }
-    }          /* end of parallel section */
+        if( net->IsDirty() )
+            net->Update();
+    } );
 
     #ifdef PROFILE
     rnUpdate.Show();
@@ -158,7 +175,7 @@ void CONNECTIVITY_DATA::RecalculateRatsnest()
         }
     }
 
-    for( auto c : clusters )
+    for( const auto& c : clusters )
     {
         int net = c->OriginNet();
 
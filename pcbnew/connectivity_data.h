@@ -95,6 +95,27 @@ public:
      */
     void Build( const std::vector<BOARD_ITEM*>& aItems );
 
+    /**
+     * Function BuildFromCache()
+     * Builds the connectivity database for the board aBoard like Build(), but restores the
+     * connections between items from aCacheFile when it was written for the same copper.
+     * @return true if the cache was used.
+     */
+    bool BuildFromCache( BOARD* aBoard, const wxString& aCacheFile );
+
+    /**
+     * Function SaveCache()
+     * Writes the connections between the items of aBoard to aCacheFile, for
+     * BuildFromCache().
+     * @return false if the file could not be written.
+     */
+    bool SaveCache( BOARD* aBoard, const wxString& aCacheFile );
+
+    /**
+     * @return the name of the connectivity cache file of the board file aBoardFile.
+     */
+    static wxString CacheFileName( const wxString& aBoardFile );
+
     /**
      * Function Add()
      * Adds an item to the connectivity data.
@@ -27,6 +27,10 @@
  * @file drc.cpp
  */
 
+#include <algorithm>
+#include <set>
+#include <unordered_map>
+
 #include <fctsys.h>
 #include <pcb_edit_frame.h>
 #include <trigo.h>
@@ -41,7 +45,9 @@
 #include <class_draw_panel_gal.h>
 #include <view/view.h>
 #include <geometry/seg.h>
+#include <geometry/rtree.h>
 #include <math_for_graphics.h>
+#include <thread_pool.h>
 
 #include <connectivity_data.h>
 #include <connectivity_algo.h>
@@ -105,11 +111,68 @@ void DRC::addMarkerToPcb( MARKER_PCB* aMarker )
         delete aMarker;
         m_currentMarker = nullptr;
     }
+    else if( m_newMarkers )
+    {
+        // Incremental DRC: the commit being pushed adds the marker
+        m_newMarkers->push_back( aMarker );
+        recordViolation( aMarker );
+    }
+    else if( !m_pcbEditorFrame )
+    {
+        // Command line use: there is no view and no undo
+        m_pcb->Add( aMarker );
+        recordViolation( aMarker );
+    }
     else
     {
         BOARD_COMMIT commit( m_pcbEditorFrame );
         commit.Add( aMarker );
         commit.Push( wxEmptyString, false, false );
+
+        recordViolation( aMarker );
+    }
+}
+
+
+void DRC::recordViolation( MARKER_PCB* aMarker )
+{
+    const DRC_ITEM& item = aMarker->GetReporter();
+
+    if( item.GetMainItemWeakRef() )
+        m_violations[ item.GetMainItemWeakRef() ].push_back( aMarker );
+
+    if( item.GetAuxiliaryItemWeakRef() )
+        m_violations[ item.GetAuxiliaryItemWeakRef() ].push_back( aMarker );
+}
+
+
+void DRC::clearViolations( const BOARD_ITEM* aItem,
+                           std::unordered_set<MARKER_PCB*>& aBoardMarkers,
+                           std::vector<MARKER_PCB*>& aStaleMarkers )
+{
+    auto it = m_violations.find( aItem );
+
+    if( it == m_violations.end() )
+        return;
+
+    // The cache is not told about markers deleted by other means (the user, or a
+    // full DRC run), so only trust the entries still on the board and still referring
+    // to aItem.
+    std::vector<MARKER_PCB*> markers = std::move( it->second );
+    m_violations.erase( it );
+
+    for( MARKER_PCB* marker : markers )
+    {
+        if( !aBoardMarkers.count( marker ) )
+            continue;
+
+        const DRC_ITEM& item = marker->GetReporter();
+
+        if( item.GetMainItemWeakRef() != aItem && item.GetAuxiliaryItemWeakRef() != aItem )
+            continue;
+
+        aBoardMarkers.erase( marker );
+        aStaleMarkers.push_back( marker );
     }
 }
 
@@ -146,6 +209,36 @@ DRC::DRC( PCB_EDIT_FRAME* aPcbWindow )
     // m_rptFilename set to empty by its constructor
 
     m_currentMarker = NULL;
+    m_newMarkers = nullptr;
+
+    m_segmAngle  = 0;
+    m_segmLength = 0;
+
+    m_xcliplo = 0;
+    m_ycliplo = 0;
+    m_xcliphi = 0;
+    m_ycliphi = 0;
+}
+
+
+DRC::DRC( BOARD* aBoard, EDA_UNITS_T aUnits )
+{
+    m_pcbEditorFrame = nullptr;
+    m_pcb = aBoard;
+    m_drcDialog  = NULL;
+    m_units = aUnits;
+
+    m_drcInLegacyRoutingMode = false;
+    m_doPad2PadTest     = true;
+    m_doUnconnectedTest = true;
+    m_doZonesTest = true;
+    m_doKeepoutTest = true;
+    m_refillZones = false;          // The caller is expected to fill the zones itself
+    m_reportAllTrackErrors = false;
+    m_doCreateRptFile = false;
+
+    m_currentMarker = NULL;
+    m_newMarkers = nullptr;
 
     m_segmAngle  = 0;
     m_segmLength = 0;
@@ -205,9 +298,9 @@ int DRC::DrcOnCreatingTrack( TRACK* aRefSegm, TRACK* aList )
 
 int DRC::TestZoneToZoneOutline( ZONE_CONTAINER* aZone, bool aCreateMarkers )
 {
-    BOARD* board = m_pcbEditorFrame->GetBoard();
-    EDA_UNITS_T units = m_pcbEditorFrame->GetUserUnits();
-    BOARD_COMMIT commit( m_pcbEditorFrame );
+    BOARD* board = m_pcbEditorFrame ? m_pcbEditorFrame->GetBoard() : m_pcb;
+    EDA_UNITS_T units = m_pcbEditorFrame ? m_pcbEditorFrame->GetUserUnits() : m_units;
+    std::vector<MARKER_PCB*> markers;
     int nerrors = 0;
 
     // iterate through all areas
@@ -276,7 +369,7 @@ int DRC::TestZoneToZoneOutline( ZONE_CONTAINER* aZone, bool aCreateMarkers )
                         wxPoint pt( currentVertex.x, currentVertex.y );
                         auto marker = new MARKER_PCB( units, COPPERAREA_INSIDE_COPPERAREA,
                                                       pt, zoneRef, pt, zoneToTest, pt );
-                        commit.Add( marker );
+                        markers.push_back( marker );
                     }
 
                     nerrors++;
@@ -296,7 +389,7 @@ int DRC::TestZoneToZoneOutline( ZONE_CONTAINER* aZone, bool aCreateMarkers )
                         wxPoint pt( currentVertex.x, currentVertex.y );
                         auto marker = new MARKER_PCB( units, COPPERAREA_INSIDE_COPPERAREA,
                                                       pt, zoneToTest, pt, zoneRef, pt );
-                        commit.Add( marker );
+                        markers.push_back( marker );
                     }
 
                     nerrors++;
@@ -342,7 +435,7 @@ int DRC::TestZoneToZoneOutline( ZONE_CONTAINER* aZone, bool aCreateMarkers )
                         {
                             auto marker = new MARKER_PCB( units, COPPERAREA_CLOSE_TO_COPPERAREA,
                                                           pt, zoneRef, pt, zoneToTest, pt );
-                            commit.Add( marker );
+                            markers.push_back( marker );
                         }
 
                         nerrors++;
@@ -352,8 +445,26 @@ int DRC::TestZoneToZoneOutline( ZONE_CONTAINER* aZone, bool aCreateMarkers )
         }
     }
 
-    if( aCreateMarkers )
+    if( markers.empty() )
+        return nerrors;
+
+    if( m_pcbEditorFrame )
+    {
+        BOARD_COMMIT commit( m_pcbEditorFrame );
+
+        for( MARKER_PCB* marker : markers )
+            commit.Add( marker );
+
         commit.Push( wxEmptyString, false, false );
+    }
+    else
+    {
+        for( MARKER_PCB* marker : markers )
+            board->Add( marker );
+    }
+
+    for( MARKER_PCB* marker : markers )
+        recordViolation( marker );
 
     return nerrors;
 }
@@ -390,9 +501,14 @@ void DRC::RunTests( wxTextCtrl* aMessages )
 {
     // be sure m_pcb is the current board, not a old one
     // ( the board can be reloaded )
-    m_pcb = m_pcbEditorFrame->GetBoard();
+    if( m_pcbEditorFrame )
+    {
+        m_pcb = m_pcbEditorFrame->GetBoard();
+        m_units = m_pcbEditorFrame->GetUserUnits();
+    }
 
     // someone should have cleared the two lists before calling this.
+    m_violations.clear();
 
     if( !testNetClasses() )
     {
@@ -437,19 +553,22 @@ void DRC::RunTests( wxTextCtrl* aMessages )
         wxSafeYield();
     }
 
-    testTracks( aMessages ? aMessages->GetParent() : m_pcbEditorFrame, true );
+    // No progress bar in command line use
+    testTracks( aMessages ? aMessages->GetParent() : m_pcbEditorFrame,
+                m_pcbEditorFrame != nullptr );
 
     // caller (a wxTopLevelFrame) is the wxDialog or the Pcb Editor frame that call DRC:
     wxWindow* caller = aMessages ? aMessages->GetParent() : m_pcbEditorFrame;
 
-    if( m_refillZones )
+    // In command line use, the zones are filled (or not) by the caller
+    if( m_pcbEditorFrame && m_refillZones )
     {
         if( aMessages )
             aMessages->AppendText( _( "Refilling all zones...\n" ) );
 
         m_pcbEditorFrame->Fill_All_Zones( caller );
     }
-    else
+    else if( m_pcbEditorFrame )
     {
         if( aMessages )
             aMessages->AppendText( _( "Checking zone fills...\n" ) );
@@ -533,6 +652,257 @@ void DRC::RunTests( wxTextCtrl* aMessages )
 }
 
 
+/**
+ * Return the area in which aPad can conflict with another item: its shape, its hole
+ * (which can be bigger than the pad when the pad is not on all copper layers) and its
+ * clearance.
+ */
+static EDA_RECT padClearanceArea( D_PAD* aPad )
+{
+    EDA_RECT area = aPad->GetBoundingBox();
+    int      holeRadius = std::max( aPad->GetDrillSize().x, aPad->GetDrillSize().y ) / 2;
+
+    if( holeRadius > 0 )
+    {
+        EDA_RECT hole( aPad->GetPosition(), wxSize( 0, 0 ) );
+        hole.Inflate( holeRadius + 1 );
+        area.Merge( hole );
+    }
+
+    area.Inflate( aPad->GetClearance() );
+    return area;
+}
+
+
+/**
+ * Return the area in which aTrack can conflict with another item: its shape and its
+ * clearance.
+ */
+static EDA_RECT trackClearanceArea( TRACK* aTrack )
+{
+    EDA_RECT area = aTrack->GetBoundingBox();
+
+    area.Inflate( aTrack->GetClearance() );
+    return area;
+}
+
+
+void DRC::TestItemsIncremental( const std::vector<BOARD_ITEM*>& aChangedItems,
+                                const std::vector<BOARD_ITEM*>& aRemovedItems,
+                                std::vector<MARKER_PCB*>& aStaleMarkers,
+                                std::vector<MARKER_PCB*>& aNewMarkers )
+{
+    std::vector<TRACK*>             changedTracks;
+    std::vector<D_PAD*>             changedPads;
+    std::unordered_set<MARKER_PCB*> boardMarkers;
+
+    m_pcb = m_pcbEditorFrame->GetBoard();
+
+    for( int ii = 0; ii < m_pcb->GetMARKERCount(); ++ii )
+        boardMarkers.insert( m_pcb->GetMARKER( ii ) );
+
+    auto collect = [&]( BOARD_ITEM* aItem, bool aRemoved )
+    {
+        switch( aItem->Type() )
+        {
+        case PCB_TRACE_T:
+        case PCB_VIA_T:
+            clearViolations( aItem, boardMarkers, aStaleMarkers );
+
+            if( !aRemoved )
+                changedTracks.push_back( static_cast<TRACK*>( aItem ) );
+
+            break;
+
+        case PCB_MODULE_T:
+            clearViolations( aItem, boardMarkers, aStaleMarkers );
+
+            for( D_PAD* pad = static_cast<MODULE*>( aItem )->PadsList(); pad; pad = pad->Next() )
+            {
+                clearViolations( pad, boardMarkers, aStaleMarkers );
+
+                if( !aRemoved )
+                    changedPads.push_back( pad );
+            }
+
+            break;
+
+        default:
+            // Markers of other items can only be stale, they are not retested here
+            clearViolations( aItem, boardMarkers, aStaleMarkers );
+            break;
+        }
+    };
+
+    for( BOARD_ITEM* item : aRemovedItems )
+        collect( item, true );
+
+    for( BOARD_ITEM* item : aChangedItems )
+        collect( item, false );
+
+    if( changedTracks.empty() && changedPads.empty() )
+        return;
+
+    // The markers found below go to aNewMarkers, not to the board
+    m_newMarkers = &aNewMarkers;
+
+    // Gather the neighbourhood of the changed items: everything whose bounding box,
+    // inflated by the biggest clearance, overlaps a changed item.
+    int                   clearance = m_pcb->GetDesignSettings().GetBiggestClearanceValue();
+    std::vector<EDA_RECT> changedAreas;
+    EDA_RECT              dirtyArea;
+
+    for( TRACK* track : changedTracks )
+    {
+        changedAreas.push_back( track->GetBoundingBox() );
+        changedAreas.back().Inflate( clearance );
+    }
+
+    for( D_PAD* pad : changedPads )
+    {
+        changedAreas.push_back( padClearanceArea( pad ) );
+        changedAreas.back().Inflate( clearance );
+    }
+
+    dirtyArea = changedAreas[0];
+
+    for( const EDA_RECT& area : changedAreas )
+        dirtyArea.Merge( area );
+
+    auto isDirty = [&]( const EDA_RECT& aBox ) -> bool
+    {
+        if( !dirtyArea.Intersects( aBox ) )
+            return false;
+
+        for( const EDA_RECT& area : changedAreas )
+        {
+            if( area.Intersects( aBox ) )
+                return true;
+        }
+
+        return false;
+    };
+
+    std::vector<TRACK*> nearTracks;
+    std::vector<D_PAD*> nearPads;
+
+    for( TRACK* track = m_pcb->m_Track; track; track = track->Next() )
+    {
+        if( isDirty( trackClearanceArea( track ) ) )
+            nearTracks.push_back( track );
+    }
+
+    for( D_PAD* pad : m_pcb->GetPads() )
+    {
+        if( isDirty( padClearanceArea( pad ) ) )
+            nearPads.push_back( pad );
+    }
+
+    // Each pair is tested only once: a changed item is not tested again against the
+    // changed items which were tested before it.
+    std::set<BOARD_ITEM*> tested;
+
+    for( TRACK* track : changedTracks )
+    {
+        EDA_RECT            area = trackClearanceArea( track );
+        std::vector<D_PAD*> pads;
+        std::vector<TRACK*> tracks;
+
+        for( D_PAD* pad : nearPads )
+        {
+            if( area.Intersects( padClearanceArea( pad ) ) )
+                pads.push_back( pad );
+        }
+
+        for( TRACK* other : nearTracks )
+        {
+            if( other != track && !tested.count( other )
+                    && area.Intersects( trackClearanceArea( other ) ) )
+                tracks.push_back( other );
+        }
+
+        tested.insert( track );
+
+        if( !doTrackDrc( track, pads, tracks ) && m_currentMarker )
+        {
+            addMarkerToPcb( m_currentMarker );
+            m_currentMarker = nullptr;
+        }
+
+        if( m_doKeepoutTest && !doTrackKeepoutDrc( track ) )
+        {
+            addMarkerToPcb( m_currentMarker );
+            m_currentMarker = nullptr;
+        }
+    }
+
+    for( D_PAD* pad : changedPads )
+    {
+        EDA_RECT            area = padClearanceArea( pad );
+        std::vector<D_PAD*> pads;
+
+        // Unchanged tracks near the pad; the changed ones were tested against it above
+        for( TRACK* track : nearTracks )
+        {
+            if( !tested.count( track ) && area.Intersects( trackClearanceArea( track ) )
+                    && !doTrackDrc( track, { pad }, {}, false ) && m_currentMarker )
+            {
+                addMarkerToPcb( m_currentMarker );
+                m_currentMarker = nullptr;
+            }
+        }
+
+        if( !m_doPad2PadTest )
+            continue;
+
+        for( D_PAD* other : nearPads )
+        {
+            if( other != pad && !tested.count( other )
+                    && area.Intersects( padClearanceArea( other ) ) )
+                pads.push_back( other );
+        }
+
+        tested.insert( pad );
+
+        if( !pads.empty() && !doPadToPadsDrc( pad, &pads[0], &pads[0] + pads.size(), INT_MAX ) )
+        {
+            addMarkerToPcb( m_currentMarker );
+            m_currentMarker = nullptr;
+        }
+    }
+
+    m_newMarkers = nullptr;
+    updatePointers();
+}
+
+
+void DRC::UpdateMarkersIncremental( const std::vector<BOARD_ITEM*>& aChangedItems,
+                                    const std::vector<BOARD_ITEM*>& aRemovedItems )
+{
+    std::vector<MARKER_PCB*> staleMarkers;
+    std::vector<MARKER_PCB*> newMarkers;
+
+    TestItemsIncremental( aChangedItems, aRemovedItems, staleMarkers, newMarkers );
+
+    KIGFX::VIEW* view = m_pcbEditorFrame->GetGalCanvas()->GetView();
+
+    for( MARKER_PCB* marker : staleMarkers )
+    {
+        view->Remove( marker );
+        m_pcb->Delete( marker );
+    }
+
+    for( MARKER_PCB* marker : newMarkers )
+    {
+        m_pcb->Add( marker );
+        view->Add( marker );
+    }
+
+    if( !staleMarkers.empty() || !newMarkers.empty() )
+        updatePointers();
+}
+
+
 void DRC::ListUnconnectedPads()
 {
     testUnconnected();
@@ -545,7 +915,8 @@ void DRC::ListUnconnectedPads()
 void DRC::updatePointers()
 {
     // update my pointers, m_pcbEditorFrame is the only unchangeable one
-    m_pcb = m_pcbEditorFrame->GetBoard();
+    if( m_pcbEditorFrame )
+        m_pcb = m_pcbEditorFrame->GetBoard();
 
     if( m_drcDialog )  // Use diag list boxes only in DRC dialog
     {
@@ -565,7 +936,7 @@ bool DRC::doNetClass( const NETCLASSPTR& nc, wxString& msg )
 
     const BOARD_DESIGN_SETTINGS& g = m_pcb->GetDesignSettings();
 
-#define FmtVal( x ) GetChars( StringFromValue( m_pcbEditorFrame->GetUserUnits(), x ) )
+#define FmtVal( x ) GetChars( StringFromValue( m_units, x ) )
 
 #if 0   // set to 1 when (if...) BOARD_DESIGN_SETTINGS has a m_MinClearance value
     if( nc->GetClearance() < g.m_MinClearance )
@@ -781,7 +1152,7 @@ void DRC::testDrilledHoles()
             if( KiROUND( GetLineLength( checkHole.m_location, refHole.m_location ) )
                     <  checkHole.m_drillRadius + refHole.m_drillRadius + holeToHoleMin )
             {
-                addMarkerToPcb( new MARKER_PCB( m_pcbEditorFrame->GetUserUnits(),
+                addMarkerToPcb( new MARKER_PCB( m_units,
                                                 DRCE_DRILLED_HOLES_TOO_CLOSE, refHole.m_location,
                                                 refHole.m_owner, refHole.m_location,
                                                 checkHole.m_owner, checkHole.m_location ) );
@@ -796,12 +1167,86 @@ void DRC::testTracks( wxWindow *aActiveWindow, bool aShowProgressBar )
     wxProgressDialog * progressDialog = NULL;
     const int delta = 500;  // This is the number of tests between 2 calls to the
                             // progress bar
-    int count = 0;
+    std::vector<TRACK*>   tracks;
+    std::vector<D_PAD*>   pads = m_pcb->GetPads();
+    std::vector<EDA_RECT> trackAreas;
+
+    RTree<TRACK*, int, 2, double>      trackTree;
+    RTree<D_PAD*, int, 2, double>      padTree;
+    std::unordered_map<TRACK*, size_t> trackOrder;
+    std::unordered_map<D_PAD*, size_t> padOrder;
+
+    for( TRACK* segm = m_pcb->m_Track; segm; segm = segm->Next() )
+        tracks.push_back( segm );
+
+    // Both trees store the clearance area of each item.  Two items can only be in conflict
+    // if their clearance areas overlap, because the clearance used by the tests is the
+    // biggest of the clearances of the two items.
+    for( size_t ii = 0; ii < tracks.size(); ++ii )
+    {
+        trackAreas.push_back( trackClearanceArea( tracks[ii] ) );
+
+        const EDA_RECT& area = trackAreas.back();
+        const int       mmin[2] = { area.GetX(), area.GetY() };
+        const int       mmax[2] = { area.GetRight(), area.GetBottom() };
+
+        trackTree.Insert( mmin, mmax, tracks[ii] );
+        trackOrder[ tracks[ii] ] = ii;
+    }
+
+    for( size_t ii = 0; ii < pads.size(); ++ii )
+    {
+        EDA_RECT  area = padClearanceArea( pads[ii] );
+        const int mmin[2] = { area.GetX(), area.GetY() };
+        const int mmax[2] = { area.GetRight(), area.GetBottom() };
+
+        padTree.Insert( mmin, mmax, pads[ii] );
+        padOrder[ pads[ii] ] = ii;
+    }
 
-    for( TRACK* segm = m_pcb->m_Track; segm && segm->Next(); segm = segm->Next() )
-        count++;
+    // Gather the candidates of each track in parallel.  The trees are only read here.
+    // Candidates are sorted by their position in the board lists, so the tests below
+    // run in the same order as a full scan of the lists would.  As before, a track is
+    // only tested against the tracks which follow it in the board track list.
+    std::vector<std::vector<D_PAD*>> padCandidates( tracks.size() );
+    std::vector<std::vector<TRACK*>> trackCandidates( tracks.size() );
 
-    int deltamax = count/delta;
+    THREAD_POOL::GetInstance().ParallelFor( tracks.size(), [&]( size_t i )
+    {
+        const EDA_RECT&     area = trackAreas[i];
+        const int           mmin[2] = { area.GetX(), area.GetY() };
+        const int           mmax[2] = { area.GetRight(), area.GetBottom() };
+        std::vector<size_t> found;
+
+        padTree.Search( mmin, mmax, [&]( D_PAD* const& aPad )
+        {
+            found.push_back( padOrder.at( aPad ) );
+            return true;
+        } );
+
+        std::sort( found.begin(), found.end() );
+
+        for( size_t idx : found )
+            padCandidates[i].push_back( pads[idx] );
+
+        found.clear();
+        trackTree.Search( mmin, mmax, [&]( TRACK* const& aTrack )
+        {
+            size_t idx = trackOrder.at( aTrack );
+
+            if( idx > i )
+                found.push_back( idx );
+
+            return true;
+        } );
+
+        std::sort( found.begin(), found.end() );
+
+        for( size_t idx : found )
+            trackCandidates[i].push_back( tracks[idx] );
+    } );
+
+    int deltamax = tracks.size() / delta;
 
     if( aShowProgressBar && deltamax > 3 )
     {
@@ -814,9 +1259,9 @@ void DRC::testTracks( wxWindow *aActiveWindow, bool aShowProgressBar )
     }
 
     int ii = 0;
-    count = 0;
+    int count = 0;
 
-    for( TRACK* segm = m_pcb->m_Track; segm; segm = segm->Next() )
+    for( size_t i = 0; i < tracks.size(); ++i )
     {
         if( ii++ > delta )
         {
@@ -835,7 +1280,7 @@ void DRC::testTracks( wxWindow *aActiveWindow, bool aShowProgressBar )
             }
         }
 
-        if( !doTrackDrc( segm, segm->Next(), true ) )
+        if( !doTrackDrc( tracks[i], padCandidates[i], trackCandidates[i] ) )
         {
             if( m_currentMarker )
             {
@@ -843,6 +1288,10 @@ void DRC::testTracks( wxWindow *aActiveWindow, bool aShowProgressBar )
                 m_currentMarker = nullptr;
             }
         }
+
+        // Release the candidate lists as soon as possible on large boards
+        std::vector<D_PAD*>().swap( padCandidates[i] );
+        std::vector<TRACK*>().swap( trackCandidates[i] );
     }
 
     if( progressDialog )
@@ -850,6 +1299,31 @@ void DRC::testTracks( wxWindow *aActiveWindow, bool aShowProgressBar )
 }
 
 
+void DRC::testTracksFullScan()
+{
+    for( TRACK* segm = m_pcb->m_Track; segm; segm = segm->Next() )
+    {
+        if( !doTrackDrc( segm, segm->Next(), true ) )
+        {
+            if( m_currentMarker )
+            {
+                addMarkerToPcb ( m_currentMarker );
+                m_currentMarker = nullptr;
+            }
+        }
+    }
+}
+
+
+void DRC::TestTracks( bool aFullScan )
+{
+    if( aFullScan )
+        testTracksFullScan();
+    else
+        testTracks( nullptr, false );
+}
+
+
 void DRC::testUnconnected()
 {
 
@@ -867,7 +1341,7 @@ void DRC::testUnconnected()
         auto src = edge.GetSourcePos();
         auto dst = edge.GetTargetPos();
 
-        m_unconnected.emplace_back( new DRC_ITEM( m_pcbEditorFrame->GetUserUnits(),
+        m_unconnected.emplace_back( new DRC_ITEM( m_units,
                                                   DRCE_UNCONNECTED_ITEMS,
                                                   edge.GetSourceNode()->Parent(),
                                                   wxPoint( src.x, src.y ),
@@ -1095,7 +1569,7 @@ void DRC::testTexts()
 
 void DRC::testDisabledLayers()
 {
-    BOARD* board = m_pcbEditorFrame->GetBoard();
+    BOARD* board = m_pcb;
     wxCHECK( board, /*void*/ );
     LSET disabledLayers = board->GetEnabledLayers().flip();
 
@@ -31,6 +31,8 @@
 
 #include <vector>
 #include <memory>
+#include <unordered_map>
+#include <unordered_set>
 
 #define OK_DRC  0
 #define BAD_DRC 1
@@ -218,6 +220,14 @@ private:
 
     DRC_LIST            m_unconnected;      ///< list of unconnected pads, as DRC_ITEMs
 
+    ///> Markers added to the board, by item they refer to (the key is the item weak
+    ///> reference).  Used by TestItemsIncremental() to remove the markers of changed items.
+    std::unordered_map<const void*, std::vector<MARKER_PCB*>> m_violations;
+
+    ///> When not null, the new markers are stored here instead of being added to the board
+    ///> (see TestItemsIncremental())
+    std::vector<MARKER_PCB*>* m_newMarkers;
+
 
     /**
      * Update needed pointers from the one pointer which is known not to change.
@@ -279,6 +289,22 @@ private:
      */
     void addMarkerToPcb( MARKER_PCB* aMarker );
 
+    /**
+     * Store a marker just added to the board in the violation cache, under each of the
+     * items it refers to.
+     */
+    void recordViolation( MARKER_PCB* aMarker );
+
+    /**
+     * Move the cached markers referring to aItem to aStaleMarkers.
+     *
+     * @param aBoardMarkers the markers of the board, the cache not being told about the
+     * markers deleted by other means; the markers moved to aStaleMarkers are removed from it
+     */
+    void clearViolations( const BOARD_ITEM* aItem,
+                          std::unordered_set<MARKER_PCB*>& aBoardMarkers,
+                          std::vector<MARKER_PCB*>& aStaleMarkers );
+
     //-----<categorical group tests>-----------------------------------------
 
     /**
@@ -295,6 +321,10 @@ private:
     /**
      * Perform the DRC on all tracks.
      *
+     * Tracks and pads are stored in R-trees, and the candidates within clearance range of
+     * each track are gathered by a pool of worker threads.  The clearance tests themselves
+     * are then run in board order, so the markers do not depend on the thread scheduling.
+     *
      * This test can take a while, a progress bar can be displayed
      * @param aActiveWindow = the active window ued as parent for the progress bar
      * @param aShowProgressBar = true to show a progress bar
@@ -302,6 +332,13 @@ private:
      */
     void testTracks( wxWindow * aActiveWindow, bool aShowProgressBar );
 
+    /**
+     * Perform the DRC on all tracks the way it was done before the spatial index: each
+     * track is tested against all the following tracks of the board and all the pads.
+     * Kept as the reference of TestTracks( true ).
+     */
+    void testTracksFullScan();
+
     void testPad2Pad();
 
     void testDrilledHoles();
@@ -346,6 +383,23 @@ private:
      */
     bool doTrackDrc( TRACK* aRefSeg, TRACK* aStart, bool doPads = true );
 
+    /**
+     * Test the current segment against an explicit list of candidates.
+     *
+     * Used by testTracks(), which gathers the candidates from a spatial index instead of
+     * walking the whole board.  Items are tested in the order given, so the caller is
+     * responsible for keeping the order (and therefore the marker order) deterministic.
+     *
+     * @param aRefSeg The segment to test
+     * @param aPads the pads to test against
+     * @param aTracks the tracks and vias to test against
+     * @param aTestSizes true to also test the width (and via drill and type) of aRefSeg
+     * @return bool - true if no problems, else false and m_currentMarker is
+     *          filled in with the problem information.
+     */
+    bool doTrackDrc( TRACK* aRefSeg, const std::vector<D_PAD*>& aPads,
+                     const std::vector<TRACK*>& aTracks, bool aTestSizes = true );
+
     /**
      * Test the current segment or via.
      *
@@ -431,6 +485,14 @@ private:
 public:
     DRC( PCB_EDIT_FRAME* aPcbWindow );
 
+    /**
+     * Create a DRC which is not attached to an editor frame, for command line use.
+     *
+     * Markers are added directly to aBoard, and RunTests() neither refills nor checks the
+     * zone fills: the caller is expected to fill the zones first if needed.
+     */
+    DRC( BOARD* aBoard, EDA_UNITS_T aUnits );
+
     ~DRC();
 
     /**
@@ -470,6 +532,46 @@ public:
      */
     int TestZoneToZoneOutline( ZONE_CONTAINER* aZone, bool aCreateMarkers );
 
+    /**
+     * Run the track and pad clearance tests for the items touched by a commit only.
+     *
+     * The markers created earlier for the changed and removed items are deleted, then the
+     * changed tracks and pads are tested against the items whose bounding box, inflated by
+     * the biggest netclass clearance, overlaps them.  The tests involving zones, texts and
+     * courtyards still require a full RunTests().
+     *
+     * The board is not modified: the markers to remove and to add are returned.
+     *
+     * @param aChangedItems the items added or modified by the commit
+     * @param aRemovedItems the items removed by the commit
+     * @param aStaleMarkers receives the markers of the board to remove
+     * @param aNewMarkers receives the markers to add to the board
+     */
+    void TestItemsIncremental( const std::vector<BOARD_ITEM*>& aChangedItems,
+                               const std::vector<BOARD_ITEM*>& aRemovedItems,
+                               std::vector<MARKER_PCB*>& aStaleMarkers,
+                               std::vector<MARKER_PCB*>& aNewMarkers );
+
+    /**
+     * Run TestItemsIncremental() and update the markers of the board and of its view.
+     *
+     * Called by BOARD_COMMIT::Push() and by undo and redo, while they apply their changes:
+     * no other commit is created.  The markers are not in the undo entries, like the
+     * markers of a full DRC run (they can be deleted at any time from the DRC dialog):
+     * undo and redo update them with this function instead.
+     */
+    void UpdateMarkersIncremental( const std::vector<BOARD_ITEM*>& aChangedItems,
+                                   const std::vector<BOARD_ITEM*>& aRemovedItems );
+
+    /**
+     * Run the track and via clearance tests alone, without progress bar, adding the markers
+     * to the board like RunTests().  Used by the benchmark of the command line tool.
+     *
+     * @param aFullScan true to test each track against all the following tracks and all the
+     * pads, as the DRC did before the spatial index, to compare the timings and markers
+     */
+    void TestTracks( bool aFullScan );
+
     /**
      * Open a dialog and prompts the user, then if a test run button is
      * clicked, runs the test(s) and creates the MARKERS.  The dialog is only
@@ -538,6 +640,14 @@ public:
      */
     void ListUnconnectedPads();
 
+    /**
+     * @return the unconnected items found by the last run of the tests
+     */
+    const DRC_LIST& GetUnconnectedItems() const
+    {
+        return m_unconnected;
+    }
+
     /**
      * @return a pointer to the current marker (last created marker
      */
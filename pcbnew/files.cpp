@@ -42,6 +42,7 @@
 #include <msgpanel.h>
 #include <fp_lib_table.h>
 #include <ratsnest_data.h>
+#include <connectivity_data.h>
 #include <kiway.h>
 #include <kiway_player.h>
 #include <trace_helpers.h>
@@ -708,6 +709,13 @@ bool PCB_EDIT_FRAME::SavePcbFile( const wxString& aFileName, bool aCreateBackupF
     GetBoard()->SetFileName( pcbFileName.GetFullPath() );
     UpdateTitle();
 
+    if( m_useConnectivityCache && !pcbFileName.GetName().StartsWith( autosavePrefix ) )
+    {
+        wxString cacheFile = CONNECTIVITY_DATA::CacheFileName( pcbFileName.GetFullPath() );
+
+        GetBoard()->GetConnectivity()->SaveCache( GetBoard(), cacheFile );
+    }
+
     // Put the saved file in File History, unless aCreateBackupFile
     // is false.
     // aCreateBackupFile == false is mainly used to write autosave files
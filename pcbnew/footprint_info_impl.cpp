@@ -35,13 +35,95 @@
 #include <macros.h>
 #include <make_unique.h>
 #include <pgm_base.h>
+#include <richio.h>
 #include <wildcards_and_files_ext.h>
 #include <widgets/progress_reporter.h>
 
-#include <thread>
+#include <wx/filename.h>
+#include <wx/stdpaths.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
 #include <mutex>
 
 
+/*
+ * The binary footprint index of a library: a FP_INDEX_HEADER, followed by its count of
+ * FP_INDEX_ENTRYs, followed by the UTF-8 texts of the entries.  It is read in place from
+ * the mapped file, so opening the footprint chooser needs neither to load nor to parse the
+ * libraries which did not change since their index was written.
+ */
+static const char FP_INDEX_MAGIC[8] = { 'K', 'I', 'F', 'P', 'I', 'D', 'X', '1' };
+
+struct FP_INDEX_HEADER
+{
+    char        magic[8];       ///< FP_INDEX_MAGIC, also the format version
+    int64_t     timestamp;      ///< FP_LIB_TABLE::GenerateTimestamp() of the library
+    uint32_t    count;          ///< number of entries
+    uint32_t    textSize;       ///< number of bytes of the texts
+};
+
+struct FP_INDEX_TEXT
+{
+    uint32_t    offset;         ///< from the start of the texts
+    uint32_t    length;         ///< in bytes
+};
+
+struct FP_INDEX_ENTRY
+{
+    FP_INDEX_TEXT   name;
+    FP_INDEX_TEXT   keywords;
+    FP_INDEX_TEXT   doc;
+    uint32_t        padCount;
+    uint32_t        uniquePadCount;
+};
+
+
+/**
+ * Function fpIndexFileName
+ * @return the name of the index file of the library \a aNickname, in the user cache
+ *         directory, which is created if needed.
+ */
+static wxString fpIndexFileName( FP_LIB_TABLE* aTable, const wxString& aNickname )
+{
+    // wxWidgets does not provide the user cache directory
+    //
+    // 1. OSX: ~/Library/Caches/kicad/fp-index/
+    // 2. Linux: ${XDG_CACHE_HOME}/kicad/fp-index ~/.cache/kicad/fp-index/
+    // 3. MSWin: AppData\Local\kicad\fp-index
+    wxString cacheDir;
+
+#if defined( __WINDOWS__ )
+    cacheDir = wxStandardPaths::Get().GetUserLocalDataDir();
+    cacheDir.append( "\\kicad\\fp-index" );
+#elif defined( __WXMAC__ )
+    cacheDir = "${HOME}/Library/Caches/kicad/fp-index";
+#else
+    cacheDir = ExpandEnvVarSubstitutions( "${XDG_CACHE_HOME}" );
+
+    if( cacheDir.empty() || cacheDir == "${XDG_CACHE_HOME}" )
+        cacheDir = "${HOME}/.cache";
+
+    cacheDir.append( "/kicad/fp-index" );
+#endif
+
+    wxFileName fn( ExpandEnvVarSubstitutions( cacheDir ), wxEmptyString );
+
+    if( !fn.DirExists() )
+        fn.Mkdir( wxS_DIR_DEFAULT, wxPATH_MKDIR_FULL );
+
+    // The nickname and the library path may contain any character: name the file by hash
+    const FP_LIB_TABLE_ROW* row = aTable->FindRow( aNickname );
+    std::string key = TO_UTF8( aNickname + "\n" + row->GetFullURI( true ) );
+
+    fn.SetName( wxString::Format( "%016llx", (unsigned long long) std::hash<std::string>()( key ) ) );
+    fn.SetExt( "fpidx" );
+
+    return fn.GetFullPath();
+}
+
+
 void FOOTPRINT_INFO_IMPL::load()
 {
     FP_LIB_TABLE* fptable = m_owner->GetTable();
@@ -104,8 +186,12 @@ void FOOTPRINT_LIST_IMPL::loader_job()
     while( m_queue_in.pop( nickname ) && !m_cancelled )
     {
         CatchErrors( [this, &nickname]() {
-            m_lib_table->PrefetchLib( nickname );
-            m_queue_out.push( nickname );
+            // A library having an up to date index needs neither to be loaded nor parsed
+            if( !readLibIndex( nickname ) )
+            {
+                m_lib_table->PrefetchLib( nickname );
+                m_queue_out.push( nickname );
+            }
         } );
 
         m_count_finished.fetch_add( 1 );
@@ -116,6 +202,148 @@ void FOOTPRINT_LIST_IMPL::loader_job()
 }
 
 
+bool FOOTPRINT_LIST_IMPL::readLibIndex( const wxString& aNickname )
+{
+    wxString fileName = fpIndexFileName( m_lib_table, aNickname );
+
+    if( !wxFileName::FileExists( fileName ) )
+        return false;
+
+    long long timestamp = m_lib_table->GenerateTimestamp( &aNickname );
+
+    try
+    {
+        MAPPED_FILE_LINE_READER file( fileName );
+
+        const char* data = file.Data();
+        size_t      size = file.Size();
+
+        if( size < sizeof( FP_INDEX_HEADER ) )
+            return false;
+
+        const FP_INDEX_HEADER* header = (const FP_INDEX_HEADER*) data;
+
+        size -= sizeof( FP_INDEX_HEADER );
+
+        if( memcmp( header->magic, FP_INDEX_MAGIC, sizeof( FP_INDEX_MAGIC ) ) != 0
+                || header->timestamp != timestamp
+                || header->count > size / sizeof( FP_INDEX_ENTRY )
+                || size != header->count * sizeof( FP_INDEX_ENTRY ) + header->textSize )
+        {
+            return false;
+        }
+
+        const FP_INDEX_ENTRY* entries = (const FP_INDEX_ENTRY*) ( header + 1 );
+        const char*           texts = (const char*) ( entries + header->count );
+
+        auto isValid = [&]( const FP_INDEX_TEXT& aText )
+        {
+            return aText.offset <= header->textSize
+                   && aText.length <= header->textSize - aText.offset;
+        };
+
+        auto getText = [&]( const FP_INDEX_TEXT& aText )
+        {
+            return wxString::FromUTF8( texts + aText.offset, aText.length );
+        };
+
+        for( uint32_t ii = 0; ii < header->count; ++ii )
+        {
+            const FP_INDEX_ENTRY& entry = entries[ii];
+
+            if( !isValid( entry.name ) || !isValid( entry.keywords ) || !isValid( entry.doc ) )
+                return false;
+        }
+
+        for( uint32_t ii = 0; ii < header->count; ++ii )
+        {
+            const FP_INDEX_ENTRY& entry = entries[ii];
+
+            m_queue_indexed.move_push( std::make_unique<FOOTPRINT_INFO_IMPL>(
+                    aNickname, getText( entry.name ), getText( entry.doc ),
+                    getText( entry.keywords ), 0, entry.padCount, entry.uniquePadCount ) );
+        }
+    }
+    catch( const IO_ERROR& )
+    {
+        return false;   // then load the library
+    }
+
+    return true;
+}
+
+
+void FOOTPRINT_LIST_IMPL::writeLibIndex( const wxString& aNickname, long long aTimestamp,
+                                         const std::vector<std::unique_ptr<FOOTPRINT_INFO_IMPL>>& aInfos )
+{
+    for( const auto& fpinfo : aInfos )
+    {
+        if( !fpinfo->m_loaded )
+            return;
+    }
+
+    FP_INDEX_HEADER             header;
+    std::vector<FP_INDEX_ENTRY> entries( aInfos.size() );
+    std::string                 texts;
+
+    auto addText = [&]( FP_INDEX_TEXT& aText, const wxString& aString )
+    {
+        std::string utf8 = TO_UTF8( aString );
+
+        aText.offset = texts.size();
+        aText.length = utf8.size();
+        texts += utf8;
+    };
+
+    for( size_t ii = 0; ii < aInfos.size(); ++ii )
+    {
+        const FOOTPRINT_INFO_IMPL& fpinfo = *aInfos[ii];
+
+        addText( entries[ii].name, fpinfo.m_fpname );
+        addText( entries[ii].keywords, fpinfo.m_keywords );
+        addText( entries[ii].doc, fpinfo.m_doc );
+        entries[ii].padCount = fpinfo.m_pad_count;
+        entries[ii].uniquePadCount = fpinfo.m_unique_pad_count;
+    }
+
+    memcpy( header.magic, FP_INDEX_MAGIC, sizeof( FP_INDEX_MAGIC ) );
+    header.timestamp = aTimestamp;
+    header.count = entries.size();
+    header.textSize = texts.size();
+
+    wxString fileName;
+
+    try
+    {
+        fileName = fpIndexFileName( m_lib_table, aNickname );
+    }
+    catch( const IO_ERROR& )
+    {
+        return;
+    }
+
+    // Write a temporary file renamed once complete, so a reader never sees a partial index
+    wxString tmpName = fileName + ".tmp";
+    FILE*    fp = wxFopen( tmpName, wxT( "wb" ) );
+
+    if( !fp )
+        return;
+
+    bool ok = fwrite( &header, sizeof( header ), 1, fp ) == 1;
+
+    if( ok && !entries.empty() )
+        ok = fwrite( &entries[0], sizeof( FP_INDEX_ENTRY ), entries.size(), fp ) == entries.size();
+
+    if( ok && !texts.empty() )
+        ok = fwrite( texts.data(), texts.size(), 1, fp ) == 1;
+
+    ok = ( fclose( fp ) == 0 ) && ok;
+
+    if( !ok || !wxRenameFile( tmpName, fileName, true ) )
+        wxRemoveFile( tmpName );
+}
+
+
 bool FOOTPRINT_LIST_IMPL::ReadFootprintFiles( FP_LIB_TABLE* aTable, const wxString* aNickname,
                                               PROGRESS_REPORTER* aProgressReporter )
 {
@@ -184,9 +412,9 @@ void FOOTPRINT_LIST_IMPL::StartWorkers( FP_LIB_TABLE* aTable, wxString const* aN
     m_count_finished.store( 0 );
     m_errors.clear();
     m_list.clear();
-    m_threads.clear();
     m_queue_in.clear();
     m_queue_out.clear();
+    m_queue_indexed.clear();
 
     if( aNickname )
         m_queue_in.push( *aNickname );
@@ -198,10 +426,12 @@ void FOOTPRINT_LIST_IMPL::StartWorkers( FP_LIB_TABLE* aTable, wxString const* aN
 
     m_loader->m_total_libs = m_queue_in.size();
 
-    for( unsigned i = 0; i < aNThreads; ++i )
-    {
-        m_threads.push_back( std::thread( &FOOTPRINT_LIST_IMPL::loader_job, this ) );
-    }
+    // The library loading is mostly waiting for the file system, so more jobs than
+    // workers is pointless: they would only wait in the pool queue
+    size_t jobCount = std::min<size_t>( aNThreads, THREAD_POOL::GetInstance().GetWorkerCount() );
+
+    for( size_t i = 0; i < std::max<size_t>( jobCount, 1 ); ++i )
+        m_loader_jobs.Run( [this]() { loader_job(); } );
 }
 
 void FOOTPRINT_LIST_IMPL::StopWorkers()
@@ -210,12 +440,10 @@ void FOOTPRINT_LIST_IMPL::StopWorkers()
 
     // To safely stop our workers, we set the cancellation flag (they will each
     // exit on their next safe loop location when this is set).  Then we need to wait
-    // for all threads to finish as closing the implementation will free the queues
-    // that the threads write to.
-    for( auto& i : m_threads )
-        i.join();
+    // for all jobs to finish as closing the implementation will free the queues
+    // that the jobs write to.
+    m_loader_jobs.Wait();
 
-    m_threads.clear();
     m_queue_in.clear();
     m_count_finished.store( 0 );
 
@@ -229,10 +457,8 @@ bool FOOTPRINT_LIST_IMPL::JoinWorkers()
     {
         std::lock_guard<std::mutex> lock1( m_join );
 
-        for( auto& i : m_threads )
-            i.join();
+        m_loader_jobs.Wait();
 
-        m_threads.clear();
         m_queue_in.clear();
         m_count_finished.store( 0 );
     }
@@ -242,59 +468,56 @@ bool FOOTPRINT_LIST_IMPL::JoinWorkers()
     LOCALE_IO toggle_locale;
 
     // Parse the footprints in parallel. WARNING! This requires changing the locale, which is
-    // GLOBAL. It is only threadsafe to construct the LOCALE_IO before the threads are created,
+    // GLOBAL. It is only threadsafe to construct the LOCALE_IO before the tasks are queued,
     // destroy it after they finish, and block the main (GUI) thread while they work. Any deviation
     // from this will cause nasal demons.
     //
     // TODO: blast LOCALE_IO into the sun
 
     SYNC_QUEUE<std::unique_ptr<FOOTPRINT_INFO>> queue_parsed;
-    std::vector<std::thread>                    threads;
+    TASK_GROUP                                  parse_jobs;
 
-    for( size_t ii = 0; ii < std::thread::hardware_concurrency() + 1; ++ii )
+    for( size_t ii = 0; ii < THREAD_POOL::GetInstance().GetWorkerCount(); ++ii )
     {
-        threads.push_back( std::thread( [this, &queue_parsed]() {
+        parse_jobs.Run( [this, &queue_parsed]() {
             wxString nickname;
 
             while( this->m_queue_out.pop( nickname ) && !m_cancelled )
             {
-                wxArrayString fpnames;
+                // Any error ends the library here, but it must be counted as finished
+                // whatever happens: the GUI thread waits for the count below.
+                CatchErrors( [this, &nickname, &queue_parsed]() {
+                    wxArrayString fpnames;
+
+                    // Taken before the enumeration: a library modified meanwhile will not
+                    // match its index next time.
+                    long long timestamp = m_lib_table->GenerateTimestamp( &nickname );
 
-                try
-                {
                     m_lib_table->FootprintEnumerate( fpnames, nickname );
-                }
-                catch( const IO_ERROR& ioe )
-                {
-                    m_errors.move_push( std::make_unique<IO_ERROR>( ioe ) );
-                }
-                catch( const std::exception& se )
-                {
-                    // This is a round about way to do this, but who knows what THROW_IO_ERROR()
-                    // may be tricked out to do someday, keep it in the game.
-                    try
-                    {
-                        THROW_IO_ERROR( se.what() );
-                    }
-                    catch( const IO_ERROR& ioe )
+
+                    // The infos are loaded by their constructor, from the footprints just
+                    // enumerated
+                    std::vector<std::unique_ptr<FOOTPRINT_INFO_IMPL>> fpinfos;
+
+                    for( unsigned jj = 0; jj < fpnames.size() && !m_cancelled; ++jj )
                     {
-                        m_errors.move_push( std::make_unique<IO_ERROR>( ioe ) );
+                        wxString fpname = fpnames[jj];
+                        fpinfos.emplace_back( new FOOTPRINT_INFO_IMPL( this, nickname, fpname ) );
                     }
-                }
 
-                for( unsigned jj = 0; jj < fpnames.size() && !m_cancelled; ++jj )
-                {
-                    wxString fpname = fpnames[jj];
-                    FOOTPRINT_INFO* fpinfo = new FOOTPRINT_INFO_IMPL( this, nickname, fpname );
-                    queue_parsed.move_push( std::unique_ptr<FOOTPRINT_INFO>( fpinfo ) );
-                }
+                    if( !m_cancelled )
+                        writeLibIndex( nickname, timestamp, fpinfos );
+
+                    for( auto& fpinfo : fpinfos )
+                        queue_parsed.move_push( std::move( fpinfo ) );
+                } );
 
                 if( m_progress_reporter )
                     m_progress_reporter->AdvanceProgress();
 
                 m_count_finished.fetch_add( 1 );
             }
-        } ) );
+        } );
     }
 
     while( !m_cancelled && (size_t)m_count_finished.load() < total_count )
@@ -305,14 +528,16 @@ bool FOOTPRINT_LIST_IMPL::JoinWorkers()
         wxMilliSleep( 30 );
     }
 
-    for( auto& thr : threads )
-        thr.join();
+    parse_jobs.Wait();
 
     std::unique_ptr<FOOTPRINT_INFO> fpi;
 
     while( queue_parsed.pop( fpi ) )
         m_list.push_back( std::move( fpi ) );
 
+    while( m_queue_indexed.pop( fpi ) )
+        m_list.push_back( std::move( fpi ) );
+
     std::sort( m_list.begin(), m_list.end(), []( std::unique_ptr<FOOTPRINT_INFO> const& lhs,
                                                  std::unique_ptr<FOOTPRINT_INFO> const& rhs ) -> bool
                                              {
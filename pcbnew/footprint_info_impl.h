@@ -23,11 +23,12 @@
 #include <atomic>
 #include <functional>
 #include <memory>
-#include <thread>
+#include <mutex>
 #include <vector>
 
 #include <footprint_info.h>
 #include <sync_queue.h>
+#include <thread_pool.h>
 
 class LOCALE_IO;
 
@@ -78,15 +79,18 @@ public:
 
 protected:
     virtual void load() override;
+
+    friend class FOOTPRINT_LIST_IMPL;     // writes the library indexes from the loaded fields
 };
 
 
 class FOOTPRINT_LIST_IMPL : public FOOTPRINT_LIST
 {
     FOOTPRINT_ASYNC_LOADER*  m_loader;
-    std::vector<std::thread> m_threads;
+    TASK_GROUP               m_loader_jobs;
     SYNC_QUEUE<wxString>     m_queue_in;
     SYNC_QUEUE<wxString>     m_queue_out;
+    SYNC_QUEUE<std::unique_ptr<FOOTPRINT_INFO>> m_queue_indexed;  ///< read from the indexes
     std::atomic_size_t       m_count_finished;
     long long                m_list_timestamp;
     PROGRESS_REPORTER*       m_progress_reporter;
@@ -109,10 +113,31 @@ protected:
 
     /**
      * Function loader_job
-     * loads footprints from m_queue_in.
+     * loads footprints from m_queue_in.  Runs as a task of m_loader_jobs.
      */
     void loader_job();
 
+    /**
+     * Function readLibIndex
+     * reads the footprint infos of the library \a aNickname from its binary index, and
+     * pushes them onto m_queue_indexed.
+     *
+     * @return false if there is no index, or if it is not up to date: the library must then
+     *         be loaded.
+     */
+    bool readLibIndex( const wxString& aNickname );
+
+    /**
+     * Function writeLibIndex
+     * writes the binary index of the library \a aNickname, whose timestamp is \a aTimestamp
+     * and whose footprints are \a aInfos.  The index is made of the fields already loaded
+     * in \a aInfos, and is not written if one of them is not loaded: this never loads nor
+     * parses a footprint.  An index which cannot be written is not an error: the library is
+     * only loaded again next time.
+     */
+    void writeLibIndex( const wxString& aNickname, long long aTimestamp,
+                        const std::vector<std::unique_ptr<FOOTPRINT_INFO_IMPL>>& aInfos );
+
 public:
     FOOTPRINT_LIST_IMPL();
     virtual ~FOOTPRINT_LIST_IMPL();
@@ -30,6 +30,7 @@
 #include <wildcards_and_files_ext.h>
 #include <base_units.h>
 #include <trace_helpers.h>
+#include <lib_cache_budget.h>
 
 #include <class_board.h>
 #include <class_module.h>
@@ -40,6 +41,8 @@
 #include <class_drawsegment.h>
 #include <class_pcb_target.h>
 #include <class_edge_mod.h>
+#include <class_pad.h>
+#include <class_text_mod.h>
 #include <pcb_plot_params.h>
 #include <zones.h>
 #include <kicad_plugin.h>
@@ -50,6 +53,7 @@
 #include <wx/wfstream.h>
 #include <boost/ptr_container/ptr_map.hpp>
 #include <memory.h>
+#include <algorithm>
 #include <connectivity_data.h>
 
 using namespace PCB_KEYS_T;
@@ -83,23 +87,96 @@ void filterNetClass( const BOARD& aBoard, NETCLASS& aNetClass )
  * footprint portion of the PLUGIN API, and only for the #PCB_IO plugin.  It is
  * private to this implementation file so it is not placed into a header.
  */
-class FP_CACHE_ITEM
+class FP_CACHE_ITEM : public LIB_CACHE_BUDGET::ITEM
 {
     WX_FILENAME             m_filename;
-    std::unique_ptr<MODULE> m_module;
+    std::unique_ptr<MODULE> m_module;       // NULL once evicted, the item is then a stub
+
+protected:
+    void evict() override { m_module.reset(); }
 
 public:
     FP_CACHE_ITEM( MODULE* aModule, const WX_FILENAME& aFileName );
+    ~FP_CACHE_ITEM() { SetModule( NULL ); }
 
     const WX_FILENAME& GetFileName() const { return m_filename; }
+
+    /**
+     * @return the parsed footprint, or NULL if evicted.  Only for a pinned item, which
+     * cannot be evicted meanwhile: see FP_CACHE::GetModule().
+     */
     const MODULE*      GetModule()   const { return m_module.get(); }
+
+    /// @return true if \a aModule is the parsed footprint, for an item pinned or not.
+    bool               HasModule( const MODULE* aModule ) const;
+
+    /// Sets the parsed footprint, or evicts it if \a aModule is NULL.
+    void               SetModule( MODULE* aModule );
 };
 
 
+/**
+ * Function moduleMemorySize
+ * @return an estimate of the memory used by \a aModule, for the cache memory budget.
+ */
+static size_t moduleMemorySize( const MODULE* aModule )
+{
+    size_t size = sizeof( MODULE ) + 2 * sizeof( TEXTE_MODULE );
+
+    for( const D_PAD* pad = aModule->PadsList();  pad;  pad = pad->Next() )
+    {
+        size += sizeof( D_PAD );
+        size += pad->GetPrimitives().size() * sizeof( PAD_CS_PRIMITIVE );
+        size += pad->GetCustomShapeAsPolygon().TotalVertices() * sizeof( VECTOR2I );
+    }
+
+    for( const BOARD_ITEM* item = aModule->GraphicalItemsList();  item;  item = item->Next() )
+    {
+        if( item->Type() == PCB_MODULE_EDGE_T )
+        {
+            const EDGE_MODULE* edge = static_cast<const EDGE_MODULE*>( item );
+
+            size += sizeof( EDGE_MODULE );
+            size += edge->GetPolyShape().TotalVertices() * sizeof( VECTOR2I );
+        }
+        else
+        {
+            size += sizeof( TEXTE_MODULE );
+        }
+    }
+
+    size += aModule->Models().size() * sizeof( MODULE_3D_SETTINGS );
+
+    return size;
+}
+
+
 FP_CACHE_ITEM::FP_CACHE_ITEM( MODULE* aModule, const WX_FILENAME& aFileName ) :
-    m_filename( aFileName ),
-    m_module( aModule )
-{ }
+    m_filename( aFileName )
+{
+    SetModule( aModule );
+}
+
+
+bool FP_CACHE_ITEM::HasModule( const MODULE* aModule ) const
+{
+    std::lock_guard<std::mutex> lock( LIB_CACHE_BUDGET::Footprints().GetMutex() );
+
+    return m_module.get() == aModule;
+}
+
+
+void FP_CACHE_ITEM::SetModule( MODULE* aModule )
+{
+    LIB_CACHE_BUDGET& budget = LIB_CACHE_BUDGET::Footprints();
+
+    // Once not resident, the item is not evicted by the other threads anymore
+    budget.RemoveItem( this );
+    m_module.reset( aModule );
+
+    if( m_module && budget.AddItem( this, moduleMemorySize( m_module.get() ) ) )
+        wxLogTrace( traceKicadPcbPlugin, wxT( "Footprint caches: %s" ), budget.FormatStats() );
+}
 
 
 typedef boost::ptr_map< wxString, FP_CACHE_ITEM >   MODULE_MAP;
@@ -118,6 +195,13 @@ class FP_CACHE
                                         // m_cache_timestamp against all the files.
     long long       m_cache_timestamp;  // A hash of the timestamps for all the footprint
                                         // files.
+    FP_CACHE_ITEM*  m_pinned;           // The item in use, which cannot be evicted.
+
+    /**
+     * Function parseModule
+     * parses the footprint file \a aFileName.
+     */
+    MODULE* parseModule( const WX_FILENAME& aFileName );
 
 public:
     FP_CACHE( PCB_IO* aOwner, const wxString& aLibraryPath );
@@ -127,6 +211,27 @@ public:
     bool        Exists() const { return m_lib_path.IsOk() && m_lib_path.DirExists(); }
     MODULE_MAP& GetModules() { return m_modules; }
 
+    /**
+     * Function Insert
+     * adds \a aItem as the footprint \a aName, as the most recently used one.  Its footprint
+     * stays valid until the next call to this cache.
+     */
+    void Insert( const wxString& aName, FP_CACHE_ITEM* aItem );
+
+    /**
+     * Function Erase
+     * deletes the footprint \a aName from the cache, but not its file.
+     */
+    void Erase( const wxString& aName );
+
+    /**
+     * Function GetModule
+     * returns the footprint of \a aItem, parsing it again if it was evicted.  The returned
+     * footprint stays valid until the next call to this cache.
+     * @return the footprint, or NULL if it was evicted and cannot be parsed again.
+     */
+    const MODULE* GetModule( FP_CACHE_ITEM* aItem );
+
     // Most all functions in this class throw IO_ERROR exceptions.  There are no
     // error codes nor user interface calls from here, nor in any PLUGIN.
     // Catch these exceptions higher up please.
@@ -180,6 +285,73 @@ FP_CACHE::FP_CACHE( PCB_IO* aOwner, const wxString& aLibraryPath )
     m_lib_path.SetPath( aLibraryPath );
     m_cache_timestamp = 0;
     m_cache_dirty = true;
+    m_pinned = NULL;
+}
+
+
+MODULE* FP_CACHE::parseModule( const WX_FILENAME& aFileName )
+{
+    MAPPED_FILE_LINE_READER reader( aFileName.GetFullPath() );
+
+    m_owner->m_parser->SetLineReader( &reader );
+
+    MODULE* footprint = (MODULE*) m_owner->m_parser->Parse();
+
+    footprint->SetFPID( LIB_ID( wxEmptyString, aFileName.GetName() ) );
+
+    return footprint;
+}
+
+
+void FP_CACHE::Insert( const wxString& aName, FP_CACHE_ITEM* aItem )
+{
+    // A new item is pinned: it replaces the item in use.  The map deletes it if the name
+    // is already there.
+    if( m_modules.insert( aName, aItem ).second )
+    {
+        LIB_CACHE_BUDGET::Footprints().UseItem( aItem, m_pinned );
+        m_pinned = aItem;
+    }
+}
+
+
+void FP_CACHE::Erase( const wxString& aName )
+{
+    MODULE_ITER it = m_modules.find( aName );
+
+    if( it == m_modules.end() )
+        return;
+
+    if( it->second == m_pinned )
+        m_pinned = NULL;
+
+    m_modules.erase( it );
+}
+
+
+const MODULE* FP_CACHE::GetModule( FP_CACHE_ITEM* aItem )
+{
+    LIB_CACHE_BUDGET& budget = LIB_CACHE_BUDGET::Footprints();
+
+    bool resident = budget.UseItem( aItem, m_pinned );
+
+    m_pinned = aItem;
+
+    if( !resident )
+    {
+        try
+        {
+            aItem->SetModule( parseModule( aItem->GetFileName() ) );
+            budget.CountReload();
+        }
+        catch( const IO_ERROR& ioe )
+        {
+            wxLogTrace( traceKicadPcbPlugin, wxT( "Cannot reload footprint: %s" ), ioe.What() );
+            return NULL;
+        }
+    }
+
+    return aItem->GetModule();
 }
 
 
@@ -201,9 +373,15 @@ void FP_CACHE::Save( MODULE* aModule )
 
     for( MODULE_ITER it = m_modules.begin();  it != m_modules.end();  ++it )
     {
-        if( aModule && aModule != it->second->GetModule() )
+        if( aModule && !it->second->HasModule( aModule ) )
             continue;
 
+        const MODULE* module = aModule ? aModule : GetModule( it->second );
+
+        if( !module )
+            THROW_IO_ERROR( wxString::Format( _( "Cannot read footprint file \"%s\"" ),
+                                              it->second->GetFileName().GetFullPath() ) );
+
         WX_FILENAME fn = it->second->GetFileName();
 
         wxString tempFileName =
@@ -221,7 +399,7 @@ void FP_CACHE::Save( MODULE* aModule )
             FILE_OUTPUTFORMATTER formatter( tempFileName );
 
             m_owner->SetOutputFormatter( &formatter );
-            m_owner->Format( (BOARD_ITEM*) it->second->GetModule() );
+            m_owner->Format( (BOARD_ITEM*) module );
         }
 
 #ifdef USE_TMP_FILE
@@ -284,15 +462,9 @@ void FP_CACHE::Load()
             // Queue I/O errors so only files that fail to parse don't get loaded.
             try
             {
-                FILE_LINE_READER    reader( fn.GetFullPath() );
-
-                m_owner->m_parser->SetLineReader( &reader );
-
-                MODULE*     footprint = (MODULE*) m_owner->m_parser->Parse();
-                wxString    fpName = fn.GetName();
+                MODULE* footprint = parseModule( fn );
 
-                footprint->SetFPID( LIB_ID( wxEmptyString, fpName ) );
-                m_modules.insert( fpName, new FP_CACHE_ITEM( footprint, fn ) );
+                Insert( fn.GetName(), new FP_CACHE_ITEM( footprint, fn ) );
 
                 m_cache_timestamp += fn.GetTimestamp();
             }
@@ -325,7 +497,7 @@ void FP_CACHE::Remove( const wxString& aFootprintName )
 
     // Remove the module from the cache and delete the module file from the library.
     wxString fullPath = it->second->GetFileName().GetFullPath();
-    m_modules.erase( aFootprintName );
+    Erase( aFootprintName );
     wxRemoveFile( fullPath );
 }
 
@@ -1879,7 +2051,7 @@ PCB_IO::~PCB_IO()
 
 BOARD* PCB_IO::Load( const wxString& aFileName, BOARD* aAppendToMe, const PROPERTIES* aProperties )
 {
-    FILE_LINE_READER    reader( aFileName );
+    MAPPED_FILE_LINE_READER reader( aFileName );
 
     init( aProperties );
 
@@ -1995,16 +2167,16 @@ const MODULE* PCB_IO::getFootprint( const wxString& aLibraryPath,
         // do nothing with the error
     }
 
-    const MODULE_MAP& mods = m_cache->GetModules();
+    MODULE_MAP& mods = m_cache->GetModules();
 
-    MODULE_CITER it = mods.find( aFootprintName );
+    MODULE_ITER it = mods.find( aFootprintName );
 
     if( it == mods.end() )
     {
         return NULL;
     }
 
-    return it->second->GetModule();
+    return m_cache->GetModule( it->second );
 }
 
 
@@ -2101,7 +2273,7 @@ void PCB_IO::FootprintSave( const wxString& aLibraryPath, const MODULE* aFootpri
     if( it != mods.end() )
     {
         wxLogTrace( traceKicadPcbPlugin, wxT( "Removing footprint file '%s'." ), fullPath );
-        mods.erase( footprintName );
+        m_cache->Erase( footprintName );
         wxRemoveFile( fullPath );
     }
 
@@ -2118,7 +2290,8 @@ void PCB_IO::FootprintSave( const wxString& aLibraryPath, const MODULE* aFootpri
         module->Flip( module->GetPosition() );
 
     wxLogTrace( traceKicadPcbPlugin, wxT( "Creating s-expr footprint file '%s'." ), fullPath );
-    mods.insert( footprintName, new FP_CACHE_ITEM( module, WX_FILENAME( fn.GetPath(), fullName ) ) );
+    m_cache->Insert( footprintName,
+                     new FP_CACHE_ITEM( module, WX_FILENAME( fn.GetPath(), fullName ) ) );
     m_cache->Save( module );
 }
 
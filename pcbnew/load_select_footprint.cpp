@@ -423,6 +423,13 @@ bool FOOTPRINT_EDIT_FRAME::SaveLibraryAs( const wxString& aLibraryPath )
         for( unsigned i = 0;  i < footprints.size();  ++i )
         {
             const MODULE* footprint = cur->GetEnumeratedFootprint( curLibPath, footprints[i] );
+
+            // NULL when the footprint file cannot be read (again): stop rather than saving
+            // an incomplete library
+            if( !footprint )
+                THROW_IO_ERROR( wxString::Format( _( "Cannot read footprint \"%s\"" ),
+                                                  footprints[i] ) );
+
             dst->FootprintSave( dstLibPath, footprint );
 
             msg = wxString::Format( _( "Footprint \"%s\" saved" ), footprints[i] );
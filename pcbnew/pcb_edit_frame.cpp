@@ -88,6 +88,7 @@ static const wxString PlotLineWidthEntry =      "PlotLineWidth_mm";
 static const wxString ShowMicrowaveEntry =      "ShowMicrowaveTools";
 static const wxString ShowLayerManagerEntry =   "ShowLayerManagerTools";
 static const wxString ShowPageLimitsEntry =     "ShowPageLimits";
+static const wxString ConnectivityCacheEntry =  "UseConnectivityCache";
 
 ///@}
 
@@ -306,6 +307,7 @@ PCB_EDIT_FRAME::PCB_EDIT_FRAME( KIWAY* aKiway, wxWindow* aParent ) :
     m_SelViaSizeBox = NULL;
     m_SelLayerBox = NULL;
     m_show_microwave_tools = false;
+    m_useConnectivityCache = false;
     m_show_layer_manager_tools = true;
     m_hotkeysDescrList = g_Board_Editor_Hotkeys_Descr;
     m_hasAutoSave = true;
@@ -488,7 +490,20 @@ void PCB_EDIT_FRAME::SetBoard( BOARD* aBoard )
 
     if( IsGalCanvasActive() )
     {
-        aBoard->GetConnectivity()->Build( aBoard );
+        auto connectivity = aBoard->GetConnectivity();
+
+        if( m_useConnectivityCache && !aBoard->GetFileName().IsEmpty() )
+        {
+            wxString cacheFile = CONNECTIVITY_DATA::CacheFileName( aBoard->GetFileName() );
+
+            // Write the cache now if it could not be used, for the next time
+            if( !connectivity->BuildFromCache( aBoard, cacheFile ) )
+                connectivity->SaveCache( aBoard, cacheFile );
+        }
+        else
+        {
+            connectivity->Build( aBoard );
+        }
 
         // reload the worksheet
         SetPageSettings( aBoard->GetPageSettings() );
@@ -764,6 +779,7 @@ void PCB_EDIT_FRAME::LoadSettings( wxConfigBase* aCfg )
     aCfg->Read( ShowLayerManagerEntry, &m_show_layer_manager_tools );
 
     aCfg->Read( ShowPageLimitsEntry, &m_showPageLimits );
+    aCfg->Read( ConnectivityCacheEntry, &m_useConnectivityCache, false );
 }
 
 
@@ -780,6 +796,7 @@ void PCB_EDIT_FRAME::SaveSettings( wxConfigBase* aCfg )
     aCfg->Write( ShowMicrowaveEntry, (long) m_show_microwave_tools );
     aCfg->Write( ShowLayerManagerEntry, (long)m_show_layer_manager_tools );
     aCfg->Write( ShowPageLimitsEntry, m_showPageLimits );
+    aCfg->Write( ConnectivityCacheEntry, m_useConnectivityCache );
 }
 
 
@@ -249,6 +249,10 @@ public:
     bool m_show_microwave_tools;
     bool m_show_layer_manager_tools;
 
+    ///> Store the item connections next to the board file, to skip their search when
+    ///> the board is opened again unchanged
+    bool m_useConnectivityCache;
+
     bool m_ZoneFillsDirty;                  // Board has been modified since last zone fill.
 
     virtual ~PCB_EDIT_FRAME();
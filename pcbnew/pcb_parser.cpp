@@ -49,6 +49,7 @@
 #include <pcb_plot_params.h>
 #include <zones.h>
 #include <pcb_parser.h>
+#include <thread_pool.h>
 
 using namespace PCB_KEYS_T;
 
@@ -494,9 +495,38 @@ BOARD* PCB_PARSER::parseBOARD()
 }
 
 
+/// the size of the text of the items parsed by a same worker thread
+static const size_t BATCH_TEXT_SIZE = 256 * 1024;
+
+
+static bool isBoardItem( int aToken )
+{
+    switch( aToken )
+    {
+    case T_gr_arc:
+    case T_gr_circle:
+    case T_gr_curve:
+    case T_gr_line:
+    case T_gr_poly:
+    case T_gr_text:
+    case T_dimension:
+    case T_module:
+    case T_segment:
+    case T_via:
+    case T_zone:
+    case T_target:
+        return true;
+
+    default:
+        return false;
+    }
+}
+
+
 BOARD* PCB_PARSER::parseBOARD_unchecked()
 {
     T token;
+    std::vector<ITEM_BATCH> batches;
 
     parseHeader();
 
@@ -537,53 +567,186 @@ BOARD* PCB_PARSER::parseBOARD_unchecked()
             parseNETCLASS();
             break;
 
-        case T_gr_arc:
-        case T_gr_circle:
-        case T_gr_curve:
-        case T_gr_line:
-        case T_gr_poly:
-            m_board->Add( parseDRAWSEGMENT(), ADD_APPEND );
-            break;
+        default:
+            if( !isBoardItem( token ) )
+            {
+                wxString err;
+                err.Printf( _( "Unknown token \"%s\"" ), GetChars( FromUTF8() ) );
+                THROW_PARSE_ERROR( err, CurSource(), CurLine(), CurLineNumber(), CurOffset() );
+            }
 
-        case T_gr_text:
-            m_board->Add( parseTEXTE_PCB(), ADD_APPEND );
-            break;
+            // The items are only copied here, by matching their brackets, and are parsed
+            // by the worker threads once the nets and layers are all known.
+            if( batches.empty() || batches.back().m_text.size() >= BATCH_TEXT_SIZE )
+            {
+                batches.emplace_back();
+                batches.back().m_firstLine = CurLineNumber();
+                batches.back().m_lastLine  = CurLineNumber();
+            }
 
-        case T_dimension:
-            m_board->Add( parseDIMENSION(), ADD_APPEND );
-            break;
+            ITEM_BATCH& batch = batches.back();
 
-        case T_module:
-            m_board->Add( parseMODULE(), ADD_APPEND );
-            break;
+            // keep the line numbers of the file for the error messages
+            batch.m_text.append( CurLineNumber() - batch.m_lastLine, '\n' );
+            CopyList( batch.m_text );
+            batch.m_lastLine = CurLineNumber();
+        }
+    }
 
-        case T_segment:
-            m_board->Add( parseTRACK(), ADD_INSERT );
-            break;
+    THREAD_POOL::GetInstance().ParallelFor( batches.size(),
+            [&]( size_t ii )
+            {
+                parseItemBatch( batches[ii] );
+            } );
 
-        case T_via:
-            m_board->Add( parseVIA(), ADD_INSERT );
-            break;
+    for( ITEM_BATCH& batch : batches )
+    {
+        if( batch.m_error )
+        {
+            for( ITEM_BATCH& b : batches )
+            {
+                for( auto& item : b.m_items )
+                    delete item.first;
+            }
 
-        case T_zone:
-            m_board->Add( parseZONE_CONTAINER(), ADD_APPEND );
-            break;
+            std::rethrow_exception( batch.m_error );
+        }
+    }
 
-        case T_target:
-            m_board->Add( parsePCB_TARGET(), ADD_APPEND );
-            break;
+    // A zone of a net missing from the board creates the net, which changes the net map
+    // read by the items after the zone.  The batch holding the first such zone, and all the
+    // batches after it, are parsed again here in the file order, as a single thread would
+    // have done.  Other zone fixes only change the zone itself.
+    bool reparse = false;
 
-        default:
-            wxString err;
-            err.Printf( _( "Unknown token \"%s\"" ), GetChars( FromUTF8() ) );
-            THROW_PARSE_ERROR( err, CurSource(), CurLine(), CurLineNumber(), CurOffset() );
+    for( size_t ii = 0; ii < batches.size(); ++ii )
+    {
+        ITEM_BATCH& batch = batches[ii];
+
+        for( auto it = batch.m_zoneNets.begin(); !reparse && it != batch.m_zoneNets.end(); ++it )
+            reparse = m_board->FindNet( it->second ) == NULL;
+
+        if( reparse )
+        {
+            for( auto& item : batch.m_items )
+                delete item.first;
+
+            batch.m_items.clear();
+            batch.m_zoneNets.clear();
+
+            parseItemBatch( batch, false );
+
+            if( batch.m_error )
+            {
+                for( size_t jj = ii; jj < batches.size(); ++jj )
+                {
+                    for( auto& item : batches[jj].m_items )
+                        delete item.first;
+                }
+
+                std::rethrow_exception( batch.m_error );
+            }
         }
+        else
+        {
+            for( auto& zoneNet : batch.m_zoneNets )
+                fixZoneNet( zoneNet.first, zoneNet.second );
+        }
+
+        for( auto& item : batch.m_items )
+            m_board->Add( item.first, item.second );
+
+        batch.m_items.clear();
+        std::string().swap( batch.m_text );
     }
 
     return m_board;
 }
 
 
+bool PCB_PARSER::parseBoardItem( std::vector< std::pair<BOARD_ITEM*, ADD_MODE> >& aItems )
+{
+    switch( CurTok() )
+    {
+    case T_gr_arc:
+    case T_gr_circle:
+    case T_gr_curve:
+    case T_gr_line:
+    case T_gr_poly:
+        aItems.emplace_back( parseDRAWSEGMENT(), ADD_APPEND );
+        return true;
+
+    case T_gr_text:
+        aItems.emplace_back( parseTEXTE_PCB(), ADD_APPEND );
+        return true;
+
+    case T_dimension:
+        aItems.emplace_back( parseDIMENSION(), ADD_APPEND );
+        return true;
+
+    case T_module:
+        aItems.emplace_back( parseMODULE(), ADD_APPEND );
+        return true;
+
+    case T_segment:
+        aItems.emplace_back( parseTRACK(), ADD_INSERT );
+        return true;
+
+    case T_via:
+        aItems.emplace_back( parseVIA(), ADD_INSERT );
+        return true;
+
+    case T_zone:
+        aItems.emplace_back( parseZONE_CONTAINER(), ADD_APPEND );
+        return true;
+
+    case T_target:
+        aItems.emplace_back( parsePCB_TARGET(), ADD_APPEND );
+        return true;
+
+    default:
+        return false;
+    }
+}
+
+
+void PCB_PARSER::parseItemBatch( ITEM_BATCH& aBatch, bool aDeferZoneNets )
+{
+    try
+    {
+        STRING_LINE_READER reader( aBatch.m_text, CurSource(), aBatch.m_firstLine - 1 );
+        PCB_PARSER         parser( &reader );
+
+        parser.m_board           = m_board;
+        parser.m_layerIndices    = m_layerIndices;
+        parser.m_layerMasks      = m_layerMasks;
+        parser.m_netCodes        = m_netCodes;
+        parser.m_tooRecent       = m_tooRecent;
+        parser.m_requiredVersion = m_requiredVersion;
+        parser.m_zoneNets        = aDeferZoneNets ? &aBatch.m_zoneNets : NULL;
+
+        for( T token = parser.NextTok();  token != T_EOF;  token = parser.NextTok() )
+        {
+            if( token != T_LEFT )
+                parser.Expecting( T_LEFT );
+
+            parser.NextTok();
+
+            if( !parser.parseBoardItem( aBatch.m_items ) )
+                parser.Unexpected( parser.CurText() );
+        }
+
+        // the nets added by the zones are known to the next batches
+        if( !aDeferZoneNets )
+            m_netCodes = parser.m_netCodes;
+    }
+    catch( ... )
+    {
+        aBatch.m_error = std::current_exception();
+    }
+}
+
+
 void PCB_PARSER::parseHeader()
 {
     wxCHECK_RET( CurTok() == T_kicad_pcb,
@@ -3172,40 +3335,50 @@ ZONE_CONTAINER* PCB_PARSER::parseZONE_CONTAINER()
     // Ensure the zone net name is valid, and matches the net code, for copper zones
     if( zone_has_net && ( zone->GetNet()->GetNetname() != netnameFromfile ) )
     {
-        // Can happens which old boards, with nonexistent nets ...
-        // or after being edited by hand
-        // We try to fix the mismatch.
-        NETINFO_ITEM* net = m_board->FindNet( netnameFromfile );
-
-        if( net )   // An existing net has the same net name. use it for the zone
-            zone->SetNetCode( net->GetNet() );
-        else    // Not existing net: add a new net to keep trace of the zone netname
-        {
-            int newnetcode = m_board->GetNetCount();
-            net = new NETINFO_ITEM( m_board, netnameFromfile, newnetcode );
-            m_board->Add( net );
-
-            // Store the new code mapping
-            pushValueIntoMap( newnetcode, net->GetNet() );
-            // and update the zone netcode
-            zone->SetNetCode( net->GetNet() );
-
-            // FIXME: a call to any GUI item is not allowed in io plugins:
-            // Change this code to generate a warning message outside this plugin
-            // Prompt the user
-            wxString msg;
-            msg.Printf( _( "There is a zone that belongs to a not existing net\n"
-                           "\"%s\"\n"
-                           "you should verify and edit it (run DRC test)." ),
-                           GetChars( netnameFromfile ) );
-            DisplayError( NULL, msg );
-        }
+        // The board nets cannot be modified by a worker thread: defer the fix
+        if( m_zoneNets )
+            m_zoneNets->emplace_back( zone.get(), netnameFromfile );
+        else
+            fixZoneNet( zone.get(), netnameFromfile );
     }
 
     return zone.release();
 }
 
 
+void PCB_PARSER::fixZoneNet( ZONE_CONTAINER* aZone, const wxString& aNetname )
+{
+    // Can happens which old boards, with nonexistent nets ...
+    // or after being edited by hand
+    // We try to fix the mismatch.
+    NETINFO_ITEM* net = m_board->FindNet( aNetname );
+
+    if( net )   // An existing net has the same net name. use it for the zone
+        aZone->SetNetCode( net->GetNet() );
+    else    // Not existing net: add a new net to keep trace of the zone netname
+    {
+        int newnetcode = m_board->GetNetCount();
+        net = new NETINFO_ITEM( m_board, aNetname, newnetcode );
+        m_board->Add( net );
+
+        // Store the new code mapping
+        pushValueIntoMap( newnetcode, net->GetNet() );
+        // and update the zone netcode
+        aZone->SetNetCode( net->GetNet() );
+
+        // FIXME: a call to any GUI item is not allowed in io plugins:
+        // Change this code to generate a warning message outside this plugin
+        // Prompt the user
+        wxString msg;
+        msg.Printf( _( "There is a zone that belongs to a not existing net\n"
+                       "\"%s\"\n"
+                       "you should verify and edit it (run DRC test)." ),
+                       GetChars( aNetname ) );
+        DisplayError( NULL, msg );
+    }
+}
+
+
 PCB_TARGET* PCB_PARSER::parsePCB_TARGET()
 {
     wxCHECK_MSG( CurTok() == T_target, NULL,
@@ -35,8 +35,12 @@
 #include <layers_id_colors_and_visibility.h>    // PCB_LAYER_ID
 #include <common.h>                             // KiROUND
 #include <convert_to_biu.h>                     // IU_PER_MM
+#include <board_item_container.h>               // ADD_MODE
 
+#include <exception>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 
 class BOARD;
@@ -74,6 +78,27 @@ class PCB_PARSER : public PCB_LEXER
     bool                m_tooRecent;        ///< true if version parses as later than supported
     int                 m_requiredVersion;  ///< set to the KiCad format version this board requires
 
+    typedef std::vector< std::pair<ZONE_CONTAINER*, wxString> > ZONE_NET_LIST;
+
+    ///< when not NULL, the zone net name mismatches are stored here to be fixed later by
+    ///< fixZoneNet() instead of being fixed while parsing the zone
+    ZONE_NET_LIST*      m_zoneNets;
+
+    /**
+     * Struct ITEM_BATCH
+     * is a run of board items copied from the file by parseBOARD_unchecked(), to be
+     * parsed by a worker thread and added to the board afterwards, in the file order.
+     */
+    struct ITEM_BATCH
+    {
+        std::string         m_text;         ///< the items text, with their line breaks
+        int                 m_firstLine;    ///< file line number of the first text line
+        int                 m_lastLine;     ///< file line number of the last text line
+        std::vector< std::pair<BOARD_ITEM*, ADD_MODE> > m_items;
+        ZONE_NET_LIST       m_zoneNets;
+        std::exception_ptr  m_error;        ///< the parse error, if any
+    };
+
     ///> Converts net code using the mapping table if available,
     ///> otherwise returns unchanged net code if < 0 or if is is out of range
     inline int getNetCode( int aNetCode )
@@ -106,6 +131,31 @@ class PCB_PARSER : public PCB_LEXER
     void parsePAGE_INFO();
     void parseTITLE_BLOCK();
 
+    /**
+     * Function parseBoardItem
+     * parses the board item starting at the current token and adds it to @a aItems
+     * with its #ADD_MODE.
+     * @return false if the current token is not a board item.
+     */
+    bool parseBoardItem( std::vector< std::pair<BOARD_ITEM*, ADD_MODE> >& aItems );
+
+    /**
+     * Function parseItemBatch
+     * parses the items of @a aBatch with a new parser sharing the layer and net maps
+     * of this one.
+     * @param aDeferZoneNets if true, the zone net mismatches are stored in the batch, and
+     *  the call is thread safe: neither the board nor this parser are modified.  Else they
+     *  are fixed while parsing, which may add nets to the board and update the net map.
+     */
+    void parseItemBatch( ITEM_BATCH& aBatch, bool aDeferZoneNets = true );
+
+    /**
+     * Function fixZoneNet
+     * gives to @a aZone the net named @a aNetname found in the file, when its net code
+     * does not match that name, creating the net if it does not exist.
+     */
+    void fixZoneNet( ZONE_CONTAINER* aZone, const wxString& aNetname );
+
     void parseLayers();
     void parseLayer( LAYER* aLayer );
 
@@ -273,7 +323,8 @@ public:
 
     PCB_PARSER( LINE_READER* aReader = NULL ) :
         PCB_LEXER( aReader ),
-        m_board( 0 )
+        m_board( 0 ),
+        m_zoneNets( 0 )
     {
         init();
     }
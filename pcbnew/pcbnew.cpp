@@ -61,6 +61,7 @@
 #include <footprint_preview_panel.h>
 #include <footprint_info_impl.h>
 #include <gl_context_mgr.h>
+#include <thread_pool.h>
 #include "invoke_pcb_dialog.h"
 
 extern bool IsWxPythonLoaded();
@@ -351,6 +352,14 @@ bool IFACE::OnKifaceStart( PGM_BASE* aProgram, int aCtlBits )
     // display the real hotkeys in menus or tool tips
     ReadHotkeyConfig( PCB_EDIT_FRAME_NAME, g_Board_Editor_Hotkeys_Descr );
 
+    // The worker threads shared by the zone filler, the connectivity and the footprint
+    // loader.  0 (the default) uses one worker per hardware thread.
+    long workerCount = 0;
+    aProgram->CommonSettings()->Read( WORKER_THREAD_COUNT_KEY, &workerCount, 0L );
+
+    if( workerCount > 0 )
+        THREAD_POOL::GetInstance().SetWorkerCount( workerCount );
+
     try
     {
         // The global table is not related to a specific project.  All projects
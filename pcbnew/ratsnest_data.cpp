@@ -41,306 +41,594 @@
 using namespace std::placeholders;
 
 #include <cassert>
+#include <cmath>
 #include <algorithm>
 #include <limits>
 
 #include <connectivity_algo.h>
 
-static uint64_t getDistance( const CN_ANCHOR_PTR& aNode1, const CN_ANCHOR_PTR& aNode2 )
+typedef VECTOR2I::extended_type ecoord;
+
+
+/**
+ * Class RN_NET::YAO_GRAPH
+ * Candidate edges for the ratsnest of a net, updated incrementally when positions are added
+ * or removed.
+ *
+ * Each position is linked to its nearest neighbour in each of 8 sectors of 45 degrees around
+ * it (the Yao graph).  With sectors narrower than 60 degrees, this graph contains a minimum
+ * spanning tree of the positions, so running Kruskal on it gives the same ratsnest length as
+ * on all the position pairs.  Unlike a Delaunay triangulation, it is cheap to update when a
+ * footprint is moved: only the positions having a removed neighbour, and the ones closer to a
+ * new position than to their current neighbour in its direction, change.
+ *
+ * The positions are stored in a uniform grid for the nearest neighbour searches.  The searches
+ * visit the grid by rings of cells, skipping the parts of the rings out of the sectors still
+ * searched.
+ */
+class RN_NET::YAO_GRAPH
 {
-    double  dx = ( aNode1->Pos().x - aNode2->Pos().x );
-    double  dy = ( aNode1->Pos().y - aNode2->Pos().y );
+public:
+    // enum constants, so they can be bound to references without out-of-class definitions
+    enum
+    {
+        SECTORS     = 8,
+        ALL_SECTORS = ( 1 << SECTORS ) - 1
+    };
+
+    YAO_GRAPH() :
+        m_aliveCount( 0 ),
+        m_cellSize( 1 ),
+        m_cols( 0 ),
+        m_rows( 0 )
+    {
+    }
 
-    return sqrt( dx * dx + dy * dy );
-}
+    /**
+     * Function Update()
+     * Updates the graph for a new list of positions.
+     * @param aPositions are the (distinct) positions of the net nodes.
+     * @param aPointIds receives the point id of each of aPositions.
+     */
+    void Update( const std::vector<VECTOR2I>& aPositions, std::vector<int>& aPointIds )
+    {
+        aPointIds.assign( aPositions.size(), -1 );
 
+        std::vector<char> kept( m_pos.size(), 0 );
+        std::vector<int>  added;
+        std::vector<int>  removed;
 
-static bool sortWeight( const CN_EDGE& aEdge1, const CN_EDGE& aEdge2 )
-{
-    return aEdge1.GetWeight() < aEdge2.GetWeight();
-}
+        for( size_t ii = 0; ii < aPositions.size(); ++ii )
+        {
+            auto it = m_pointAt.find( positionKey( aPositions[ii] ) );
 
+            if( it == m_pointAt.end() )
+            {
+                added.push_back( ii );
+            }
+            else
+            {
+                aPointIds[ii] = it->second;
+                kept[it->second] = 1;
+            }
+        }
 
-static const std::vector<CN_EDGE> kruskalMST( std::list<CN_EDGE>& aEdges,
-        std::vector<CN_ANCHOR_PTR>& aNodes )
-{
-    unsigned int    nodeNumber = aNodes.size();
-    unsigned int    mstExpectedSize = nodeNumber - 1;
-    unsigned int    mstSize = 0;
-    bool ratsnestLines = false;
+        for( size_t ii = 0; ii < m_pos.size(); ++ii )
+        {
+            if( m_alive[ii] && !kept[ii] )
+                removed.push_back( ii );
+        }
 
-    //printf("mst nodes : %d edges : %d\n", aNodes.size(), aEdges.size () );
-    // The output
-    std::vector<CN_EDGE> mst;
+        // Each added position costs a pass over all the others, so above a few changes a
+        // rebuild is faster
+        size_t changes = added.size() + removed.size();
 
-    // Set tags for marking cycles
-    std::unordered_map<CN_ANCHOR_PTR, int> tags;
-    unsigned int tag = 0;
+        // The grid is not extended, the sector pruning of the searches needs all the points
+        // inside of it
+        bool outside = false;
 
-    for( auto& node : aNodes )
-    {
-        node->SetTag( tag );
-        tags[node] = tag++;
-    }
+        for( int idx : added )
+        {
+            const VECTOR2I& pos = aPositions[idx];
 
-    // Lists of nodes connected together (subtrees) to detect cycles in the graph
-    std::vector<std::list<int> > cycles( nodeNumber );
+            if( m_cols == 0 || pos.x < m_origin.x || pos.y < m_origin.y
+                    || ( (ecoord) pos.x - m_origin.x ) / m_cellSize >= m_cols
+                    || ( (ecoord) pos.y - m_origin.y ) / m_cellSize >= m_rows )
+                outside = true;
+        }
 
-    for( unsigned int i = 0; i < nodeNumber; ++i )
-        cycles[i].push_back( i );
+        if( m_aliveCount == 0 || outside || added.size() > 256 || changes * 8 > aPositions.size() )
+        {
+            rebuild( aPositions );
 
-    // Kruskal algorithm requires edges to be sorted by their weight
-    aEdges.sort( sortWeight );
+            for( size_t ii = 0; ii < aPositions.size(); ++ii )
+                aPointIds[ii] = ii;
 
-    while( mstSize < mstExpectedSize && !aEdges.empty() )
-    {
-        //printf("mstSize %d %d\n", mstSize, mstExpectedSize);
-        auto& dt = aEdges.front();
+            return;
+        }
 
-        int srcTag  = tags[dt.GetSourceNode()];
-        int trgTag  = tags[dt.GetTargetNode()];
+        for( int point : removed )
+            removePoint( point );
 
-        // Check if by adding this edge we are going to join two different forests
-        if( srcTag != trgTag )
+        // The points which lost a neighbour search a new one in the same sector.  This must
+        // be done before adding the new points, as they can reuse the removed point ids.
+        if( !removed.empty() )
         {
-            // Because edges are sorted by their weight, first we always process connected
-            // items (weight == 0). Once we stumble upon an edge with non-zero weight,
-            // it means that the rest of the lines are ratsnest.
-            if( !ratsnestLines && dt.GetWeight() != 0 )
-                ratsnestLines = true;
-
-            // Update tags
-            if( ratsnestLines )
+            for( size_t ii = 0; ii < m_pos.size(); ++ii )
             {
-                for( auto it = cycles[trgTag].begin(); it != cycles[trgTag].end(); ++it )
-                {
-                    tags[aNodes[*it]] = srcTag;
-                }
+                if( !m_alive[ii] )
+                    continue;
 
-                // Do a copy of edge, but make it RN_EDGE_MST. In contrary to RN_EDGE,
-                // RN_EDGE_MST saves both source and target node and does not require any other
-                // edges to exist for getting source/target nodes
-                CN_EDGE newEdge ( dt.GetSourceNode(), dt.GetTargetNode(), dt.GetWeight() );
+                unsigned int lostSectors = 0;
 
-                assert( newEdge.GetSourceNode()->GetTag() != newEdge.GetTargetNode()->GetTag() );
-                assert( newEdge.GetWeight() > 0 );
-
-                mst.push_back( newEdge );
-                ++mstSize;
-            }
-            else
-            {
-                // for( it = cycles[trgTag].begin(), itEnd = cycles[trgTag].end(); it != itEnd; ++it )
-                // for( auto it : cycles[trgTag] )
-                for( auto it = cycles[trgTag].begin(); it != cycles[trgTag].end(); ++it )
+                for( int sector = 0; sector < SECTORS; ++sector )
                 {
-                    tags[aNodes[*it]] = srcTag;
-                    aNodes[*it]->SetTag( srcTag );
+                    int& nearest = m_nearest[ii * SECTORS + sector];
+
+                    if( nearest >= 0 && !m_alive[nearest] )
+                    {
+                        nearest = -1;
+                        lostSectors |= 1 << sector;
+                    }
                 }
 
-                // Processing a connection, decrease the expected size of the ratsnest MST
-                --mstExpectedSize;
+                if( lostSectors )
+                    findNearest( ii, lostSectors );
             }
-
-            // Move nodes that were marked with old tag to the list marked with the new tag
-            cycles[srcTag].splice( cycles[srcTag].end(), cycles[trgTag] );
         }
 
-        // Remove the edge that was just processed
-        aEdges.erase( aEdges.begin() );
-    }
-
-    // Probably we have discarded some of edges, so reduce the size
-    mst.resize( mstSize );
+        for( int idx : added )
+            aPointIds[idx] = addPoint( aPositions[idx] );
 
-    return mst;
-}
+        for( int idx : added )
+        {
+            int point = aPointIds[idx];
 
+            findNearest( point, ALL_SECTORS );
 
-class RN_NET::TRIANGULATOR_STATE
-{
-private:
-    std::vector<CN_ANCHOR_PTR>  m_allNodes;
+            // The new point can be the nearest neighbour of any other one
+            for( size_t ii = 0; ii < m_pos.size(); ++ii )
+            {
+                if( !m_alive[ii] || (int) ii == point )
+                    continue;
 
-    std::list<hed::EDGE_PTR> hedTriangulation( std::vector<hed::NODE_PTR>& aNodes )
-    {
-        hed::TRIANGULATION triangulator;
-        triangulator.CreateDelaunay( aNodes.begin(), aNodes.end() );
-        std::list<hed::EDGE_PTR> edges;
-        triangulator.GetEdges( edges );
+                int    sector = sectorOf( m_pos[ii], m_pos[point] );
+                int&   nearest = m_nearest[ii * SECTORS + sector];
+                ecoord dist = ( m_pos[point] - m_pos[ii] ).SquaredEuclideanNorm();
 
-        return edges;
+                if( nearest < 0 || closer( dist, m_pos[point],
+                                           ( m_pos[nearest] - m_pos[ii] ).SquaredEuclideanNorm(),
+                                           m_pos[nearest] ) )
+                {
+                    nearest = point;
+                }
+            }
+        }
     }
 
-
-    // Checks if all nodes in aNodes lie on a single line. Requires the nodes to
-    // have unique coordinates!
-    bool areNodesColinear( const std::vector<hed::NODE_PTR>& aNodes ) const
+    /**
+     * Function ForEachEdge()
+     * Calls aFunc( aPoint, aNeighbour, aSquaredDistance ) for each edge of the graph.  An edge
+     * linking two points being the nearest neighbour of each other is reported twice.
+     */
+    template <typename FUNC>
+    void ForEachEdge( FUNC aFunc ) const
     {
-        if ( aNodes.size() <= 2 )
-            return true;
-
-        const auto p0 = aNodes[0]->Pos();
-        const auto v0 = aNodes[1]->Pos() - p0;
-
-        for( unsigned i = 2; i < aNodes.size(); i++ )
+        for( size_t ii = 0; ii < m_pos.size(); ++ii )
         {
-            const auto v1 = aNodes[i]->Pos() - p0;
+            if( !m_alive[ii] )
+                continue;
 
-            if( v0.Cross( v1 ) != 0 )
+            for( int sector = 0; sector < SECTORS; ++sector )
             {
-                return false;
+                int nearest = m_nearest[ii * SECTORS + sector];
+
+                if( nearest >= 0 )
+                    aFunc( ii, nearest, ( m_pos[nearest] - m_pos[ii] ).SquaredEuclideanNorm() );
             }
         }
+    }
+
+    /**
+     * Function FindNearest()
+     * Searches the point nearest to aPos accepted by aAccept( aPoint ), which returns a node
+     * index or -1 to reject the point.
+     * @param aBestDist is the squared distance to beat, updated when a nearer point is found.
+     * @return the node index returned by aAccept for the nearest point, or -1 if no point
+     * is nearer than aBestDist.
+     */
+    template <typename FUNC>
+    int FindNearest( const VECTOR2I& aPos, FUNC aAccept, ecoord& aBestDist ) const
+    {
+        int best = -1;
+
+        searchRings( aPos,
+                [&]( int aPoint )
+                {
+                    ecoord dist = ( m_pos[aPoint] - aPos ).SquaredEuclideanNorm();
+
+                    if( dist < aBestDist )
+                    {
+                        int node = aAccept( aPoint );
+
+                        if( node >= 0 )
+                        {
+                            aBestDist = dist;
+                            best = node;
+                        }
+                    }
+                },
+                [&]( ecoord aMinDist ) -> unsigned int
+                {
+                    return aBestDist <= aMinDist ? 0 : ALL_SECTORS;
+                } );
 
-        return true;
+        return best;
     }
 
-    const std::list<hed::EDGE_PTR> computeTriangulation( std::vector<hed::NODE_PTR>& aNodes )
+    size_t PointCapacity() const
     {
-        return hedTriangulation( aNodes );
+        return m_pos.size();
     }
 
-public:
+private:
+    static uint64_t positionKey( const VECTOR2I& aPos )
+    {
+        return ( (uint64_t) (uint32_t) aPos.x << 32 ) | (uint32_t) aPos.y;
+    }
 
-    void Clear()
+    /**
+     * @return the sector of aTo seen from aFrom.  Sector n covers the directions from n * 45
+     * degrees (included) to (n + 1) * 45 degrees (excluded).
+     */
+    static int sectorOf( const VECTOR2I& aFrom, const VECTOR2I& aTo )
     {
-        m_allNodes.clear();
+        ecoord dx = (ecoord) aTo.x - aFrom.x;
+        ecoord dy = (ecoord) aTo.y - aFrom.y;
+
+        if( dx > 0 && dy >= 0 )
+            return dy < dx ? 0 : 1;
+        else if( dx <= 0 && dy > 0 )
+            return -dx < dy ? 2 : 3;
+        else if( dx < 0 && dy <= 0 )
+            return -dy < -dx ? 4 : 5;
+        else
+            return dx < -dy ? 6 : 7;
     }
 
-    void AddNode( CN_ANCHOR_PTR aNode )
+    ///> Distance comparison, with ties broken by position so the graph does not depend on
+    ///> the order the points were added in.
+    static bool closer( ecoord aDistA, const VECTOR2I& aPosA, ecoord aDistB, const VECTOR2I& aPosB )
     {
-        m_allNodes.push_back( aNode );
+        if( aDistA != aDistB )
+            return aDistA < aDistB;
+
+        if( aPosA.x != aPosB.x )
+            return aPosA.x < aPosB.x;
+
+        return aPosA.y < aPosB.y;
     }
 
-    const std::list<CN_EDGE> Triangulate()
+    int cellIndex( const VECTOR2I& aPos, int& aCol, int& aRow ) const
     {
-        std::list<CN_EDGE> mstEdges;
-        std::list<hed::EDGE_PTR> triangEdges;
-        std::vector<hed::NODE_PTR> triNodes;
+        ecoord col = ( (ecoord) aPos.x - m_origin.x ) / m_cellSize;
+        ecoord row = ( (ecoord) aPos.y - m_origin.y ) / m_cellSize;
 
-        using ANCHOR_LIST = std::vector<CN_ANCHOR_PTR>;
-        std::vector<ANCHOR_LIST> anchorChains;
+        aCol = (int) std::min<ecoord>( std::max<ecoord>( col, 0 ), m_cols - 1 );
+        aRow = (int) std::min<ecoord>( std::max<ecoord>( row, 0 ), m_rows - 1 );
 
-        triNodes.reserve( m_allNodes.size() );
-        anchorChains.reserve( m_allNodes.size() );
+        return aRow * m_cols + aCol;
+    }
 
-        std::sort( m_allNodes.begin(), m_allNodes.end(),
-                [] ( const CN_ANCHOR_PTR& aNode1, const CN_ANCHOR_PTR& aNode2 )
+    /**
+     * @return the sectors seen from aPos covering the cells from aCol0, aRow0 to aCol1, aRow1,
+     * which must not contain aPos.
+     */
+    unsigned int cellSectors( const VECTOR2I& aPos, int aCol0, int aRow0, int aCol1, int aRow1 ) const
+    {
+        // The sectors spanned by a convex area not containing aPos are the ones between
+        // the sectors of its corners, going the short way round.  This table maps the corner
+        // sectors to the spanned ones.
+        static const std::vector<unsigned int> spanned = []()
         {
-            if( aNode1->Pos().y < aNode2->Pos().y )
-                return true;
-            else if( aNode1->Pos().y == aNode2->Pos().y )
+            std::vector<unsigned int> table( ALL_SECTORS + 1, ALL_SECTORS );
+
+            for( unsigned int mask = 1; mask <= ALL_SECTORS; ++mask )
             {
-                return aNode1->Pos().x < aNode2->Pos().x;
+                int gapStart = 0;
+                int gapLength = 0;
+
+                for( int start = 0; start < SECTORS; ++start )
+                {
+                    int length = 0;
+
+                    while( length < SECTORS && !( mask & ( 1 << ( ( start + length ) % SECTORS ) ) ) )
+                        length++;
+
+                    if( length > gapLength )
+                    {
+                        gapStart = start;
+                        gapLength = length;
+                    }
+                }
+
+                for( int ii = 0; ii < gapLength; ++ii )
+                    table[mask] &= ~( 1 << ( ( gapStart + ii ) % SECTORS ) );
             }
 
-            return false;
-        }
-                );
+            return table;
+        }();
 
-        CN_ANCHOR_PTR prev, last;
-        int id = 0;
+        ecoord   x0 = m_origin.x + aCol0 * m_cellSize;
+        ecoord   y0 = m_origin.y + aRow0 * m_cellSize;
+        ecoord   x1 = m_origin.x + ( aCol1 + 1 ) * m_cellSize - 1;
+        ecoord   y1 = m_origin.y + ( aRow1 + 1 ) * m_cellSize - 1;
+        unsigned corners = 0;
 
-        for( auto n : m_allNodes )
-        {
-            anchorChains.push_back( ANCHOR_LIST() );
-        }
+        corners |= 1 << sectorOf( aPos, VECTOR2I( x0, y0 ) );
+        corners |= 1 << sectorOf( aPos, VECTOR2I( x1, y0 ) );
+        corners |= 1 << sectorOf( aPos, VECTOR2I( x0, y1 ) );
+        corners |= 1 << sectorOf( aPos, VECTOR2I( x1, y1 ) );
+
+        return spanned[corners];
+    }
+
+    /**
+     * Visits the points by rings of cells around aPos.  Before each ring, aPending( aMinDist )
+     * is called with the squared distance under which no point remains to be visited, and
+     * returns the sectors in which the search must go on (0 stops it).  The sides of the rings
+     * out of these sectors are skipped.
+     */
+    template <typename VISIT, typename PENDING>
+    void searchRings( const VECTOR2I& aPos, VISIT aVisit, PENDING aPending ) const
+    {
+        int col, row;
+        cellIndex( aPos, col, row );
 
-        for( auto n : m_allNodes )
+        // Sector pruning needs aPos to be in its cell
+        bool inside = ( (ecoord) aPos.x - m_origin.x ) / m_cellSize == col
+                      && ( (ecoord) aPos.y - m_origin.y ) / m_cellSize == row
+                      && aPos.x >= m_origin.x && aPos.y >= m_origin.y;
+
+        int lastRing = std::max( std::max( col, m_cols - 1 - col ),
+                                 std::max( row, m_rows - 1 - row ) );
+
+        auto visitCells = [&]( int aCol0, int aRow0, int aCol1, int aRow1, unsigned int aPendingSectors )
         {
-            if( !prev || prev->Pos() != n->Pos() )
-            {
-                auto tn = std::make_shared<hed::NODE> ( n->Pos().x, n->Pos().y );
+            aCol0 = std::max( aCol0, 0 );
+            aRow0 = std::max( aRow0, 0 );
+            aCol1 = std::min( aCol1, m_cols - 1 );
+            aRow1 = std::min( aRow1, m_rows - 1 );
+
+            if( aCol0 > aCol1 || aRow0 > aRow1 )
+                return false;
+
+            if( inside && aPendingSectors != ALL_SECTORS
+                    && !( cellSectors( aPos, aCol0, aRow0, aCol1, aRow1 ) & aPendingSectors ) )
+                return false;
 
-                tn->SetId( id );
-                triNodes.push_back( tn );
+            for( int r = aRow0; r <= aRow1; ++r )
+            {
+                for( int c = aCol0; c <= aCol1; ++c )
+                {
+                    for( int point : m_cells[r * m_cols + c] )
+                        aVisit( point );
+                }
             }
 
-            id++;
-            prev = n;
-        }
+            return true;
+        };
 
-        int prevId = 0;
+        visitCells( col, row, col, row, ALL_SECTORS );
 
-        for( auto n : triNodes )
+        for( int ring = 1; ring <= lastRing; ++ring )
         {
-            for( int i = prevId; i < n->Id(); i++ )
-                anchorChains[prevId].push_back( m_allNodes[ i ] );
+            ecoord       minDist = (ecoord) ( ring - 1 ) * m_cellSize;
+            unsigned int pending = aPending( minDist * minDist );
+
+            if( !pending )
+                return;
+
+            // Top, bottom, left and right sides of the ring
+            bool visited = false;
 
-            prevId = n->Id();
+            if( row - ring >= 0 )
+                visited |= visitCells( col - ring, row - ring, col + ring, row - ring, pending );
+
+            if( row + ring < m_rows )
+                visited |= visitCells( col - ring, row + ring, col + ring, row + ring, pending );
+
+            if( col - ring >= 0 )
+                visited |= visitCells( col - ring, row - ring + 1, col - ring, row + ring - 1, pending );
+
+            if( col + ring < m_cols )
+                visited |= visitCells( col + ring, row - ring + 1, col + ring, row + ring - 1, pending );
+
+            // The rays from aPos crossing none of the sides in the grid have left it: the
+            // pending sectors hold no more points
+            if( !visited )
+                return;
         }
+    }
 
-        for( int i = prevId; i < id; i++ )
-            anchorChains[prevId].push_back( m_allNodes[ i ] );
+    void findNearest( int aPoint, unsigned int aSectors )
+    {
+        const VECTOR2I& pos = m_pos[aPoint];
+        int*            nearest = &m_nearest[aPoint * SECTORS];
+        ecoord          dist[SECTORS];
 
-        if( triNodes.size() == 1 )
+        for( int sector = 0; sector < SECTORS; ++sector )
         {
-            return mstEdges;
+            if( aSectors & ( 1 << sector ) )
+                nearest[sector] = -1;
         }
-        else if( areNodesColinear( triNodes ) )
+
+        searchRings( pos,
+                [&]( int aOther )
+                {
+                    if( aOther == aPoint )
+                        return;
+
+                    int sector = sectorOf( pos, m_pos[aOther] );
+
+                    if( !( aSectors & ( 1 << sector ) ) )
+                        return;
+
+                    ecoord d = ( m_pos[aOther] - pos ).SquaredEuclideanNorm();
+
+                    if( nearest[sector] < 0
+                            || closer( d, m_pos[aOther], dist[sector], m_pos[nearest[sector]] ) )
+                    {
+                        nearest[sector] = aOther;
+                        dist[sector] = d;
+                    }
+                },
+                [&]( ecoord aMinDist ) -> unsigned int
+                {
+                    unsigned int pending = 0;
+
+                    // Strictly nearer, a point at the same distance could win the tie
+                    for( int sector = 0; sector < SECTORS; ++sector )
+                    {
+                        if( ( aSectors & ( 1 << sector ) )
+                                && ( nearest[sector] < 0 || dist[sector] >= aMinDist ) )
+                            pending |= 1 << sector;
+                    }
+
+                    return pending;
+                } );
+    }
+
+    int addPoint( const VECTOR2I& aPos )
+    {
+        int point;
+
+        if( m_freePoints.empty() )
         {
-            // special case: all nodes are on the same line - there's no
-            // triangulation for such set. In this case, we sort along any coordinate
-            // and chain the nodes together.
-            for(int i = 0; i < (int)triNodes.size() - 1; i++ )
-            {
-                auto src = m_allNodes[ triNodes[i]->Id() ];
-                auto dst = m_allNodes[ triNodes[i + 1]->Id() ];
-                mstEdges.emplace_back( src, dst, getDistance( src, dst ) );
-            }
+            point = m_pos.size();
+            m_pos.push_back( aPos );
+            m_alive.push_back( 1 );
+            m_nearest.resize( m_nearest.size() + SECTORS, -1 );
         }
         else
         {
-            hed::TRIANGULATION triangulator;
-            triangulator.CreateDelaunay( triNodes.begin(), triNodes.end() );
-            triangulator.GetEdges( triangEdges );
+            point = m_freePoints.back();
+            m_freePoints.pop_back();
+            m_pos[point] = aPos;
+            m_alive[point] = 1;
+            std::fill_n( &m_nearest[point * SECTORS], SECTORS, -1 );
+        }
 
-            for( auto e : triangEdges )
-            {
-                auto    src = m_allNodes[ e->GetSourceNode()->Id() ];
-                auto    dst = m_allNodes[ e->GetTargetNode()->Id() ];
+        int col, row;
+        m_cells[cellIndex( aPos, col, row )].push_back( point );
+        m_pointAt[positionKey( aPos )] = point;
+        m_aliveCount++;
 
-                mstEdges.emplace_back( src, dst, getDistance( src, dst ) );
-            }
-        }
+        return point;
+    }
 
-        for( unsigned int i = 0; i < anchorChains.size(); i++ )
-        {
-            auto& chain = anchorChains[i];
+    void removePoint( int aPoint )
+    {
+        int col, row;
+        std::vector<int>& cell = m_cells[cellIndex( m_pos[aPoint], col, row )];
+
+        cell.erase( std::find( cell.begin(), cell.end(), aPoint ) );
+        m_pointAt.erase( positionKey( m_pos[aPoint] ) );
+        m_alive[aPoint] = 0;
+        m_freePoints.push_back( aPoint );
+        m_aliveCount--;
+    }
 
-            if( chain.size() < 2 )
-                continue;
+    void rebuild( const std::vector<VECTOR2I>& aPositions )
+    {
+        m_pos.clear();
+        m_alive.clear();
+        m_nearest.clear();
+        m_freePoints.clear();
+        m_pointAt.clear();
+        m_aliveCount = 0;
 
-            std::sort( chain.begin(), chain.end(),
-                    [] ( const CN_ANCHOR_PTR& a, const CN_ANCHOR_PTR& b ) {
-                return a->GetCluster().get() < b->GetCluster().get();
-            } );
+        BOX2I bbox( aPositions[0], VECTOR2I( 0, 0 ) );
 
-            for( unsigned int j = 1; j < chain.size(); j++ )
-            {
-                const auto& prevNode    = chain[j - 1];
-                const auto& curNode     = chain[j];
-                int weight = prevNode->GetCluster() != curNode->GetCluster() ? 1 : 0;
-                mstEdges.push_back( CN_EDGE ( prevNode, curNode, weight ) );
-            }
-        }
+        for( const VECTOR2I& pos : aPositions )
+            bbox.Merge( pos );
+
+        // About two points by cell
+        ecoord width = (ecoord) bbox.GetWidth() + 1;
+        ecoord height = (ecoord) bbox.GetHeight() + 1;
+        ecoord cellCount = std::max<ecoord>( aPositions.size() / 2, 1 );
+
+        m_origin = bbox.GetOrigin();
+        m_cellSize = std::max<ecoord>( (ecoord) std::sqrt( (double) width * height / cellCount ), 1 );
+
+        // Aligned positions have a flat bounding box, keep their cell count bounded
+        while( ( width / m_cellSize + 1 ) * ( height / m_cellSize + 1 ) > 4 * cellCount + 16 )
+            m_cellSize *= 2;
 
-        return mstEdges;
+        m_cols = width / m_cellSize + 1;
+        m_rows = height / m_cellSize + 1;
+        m_cells.assign( m_cols * m_rows, std::vector<int>() );
+
+        m_pos.reserve( aPositions.size() );
+        m_alive.reserve( aPositions.size() );
+        m_nearest.reserve( aPositions.size() * SECTORS );
+
+        for( const VECTOR2I& pos : aPositions )
+            addPoint( pos );
+
+        for( size_t ii = 0; ii < aPositions.size(); ++ii )
+            findNearest( ii, ALL_SECTORS );
     }
+
+    std::vector<VECTOR2I> m_pos;
+    std::vector<char>     m_alive;
+    std::vector<int>      m_nearest;        ///< SECTORS neighbours by point, -1 for none
+    std::vector<int>      m_freePoints;     ///< Ids of removed points, to be reused
+    std::unordered_map<uint64_t, int> m_pointAt;
+    int                   m_aliveCount;
+
+    VECTOR2I              m_origin;
+    ecoord                m_cellSize;
+    int                   m_cols;
+    int                   m_rows;
+    std::vector<std::vector<int>> m_cells;
+};
+
+
+///> An edge of the ratsnest candidates, between two m_nodes indices.
+struct RN_MST_EDGE
+{
+    ecoord m_weight;        ///< squared length, 0 for connected nodes
+    int    m_source;
+    int    m_target;
 };
 
 
+static int findRoot( std::vector<int>& aParents, int aNode )
+{
+    while( aParents[aNode] != aNode )
+    {
+        aParents[aNode] = aParents[aParents[aNode]];
+        aNode = aParents[aNode];
+    }
+
+    return aNode;
+}
+
+
 RN_NET::RN_NET() : m_dirty( true )
 {
-    m_triangulator.reset( new TRIANGULATOR_STATE );
+    m_yaoGraph.reset( new YAO_GRAPH );
 }
 
 
 void RN_NET::compute()
 {
-    // Special cases do not need complicated algorithms (actually, it does not work well with
-    // the Delaunay triangulator)
+    m_pointGroups.clear();
+    m_groupStarts.clear();
+    m_nodeOrder.clear();
+
+    // Special cases do not need complicated algorithms
     //printf("compute nodes :  %d\n", m_nodes.size() );
     if( m_nodes.size() <= 2 )
     {
@@ -368,37 +656,148 @@ void RN_NET::compute()
         return;
     }
 
+    #ifdef PROFILE
+    PROF_COUNTER cnt("candidates");
+    #endif
+
+    // Group the nodes by position: several nodes can share a position (e.g. a track end on
+    // a pad), only the first one of each group is linked to the other positions
+    m_nodeOrder.resize( m_nodes.size() );
+
+    for( size_t ii = 0; ii < m_nodes.size(); ++ii )
+        m_nodeOrder[ii] = ii;
+
+    std::sort( m_nodeOrder.begin(), m_nodeOrder.end(), [this] ( int aNode1, int aNode2 )
+            {
+                const VECTOR2I& pos1 = m_nodes[aNode1]->Pos();
+                const VECTOR2I& pos2 = m_nodes[aNode2]->Pos();
 
-    m_triangulator->Clear();
+                if( pos1.y != pos2.y )
+                    return pos1.y < pos2.y;
 
-    for( auto n : m_nodes )
+                return pos1.x < pos2.x;
+            } );
+
+    std::vector<VECTOR2I> positions;
+
+    for( size_t ii = 0; ii < m_nodeOrder.size(); ++ii )
     {
-        m_triangulator->AddNode( n );
+        const VECTOR2I& pos = m_nodes[m_nodeOrder[ii]]->Pos();
+
+        if( positions.empty() || positions.back() != pos )
+        {
+            positions.push_back( pos );
+            m_groupStarts.push_back( ii );
+        }
     }
 
-    #ifdef PROFILE
-    PROF_COUNTER cnt("triangulate");
-    #endif
-    auto triangEdges = m_triangulator->Triangulate();
+    m_groupStarts.push_back( m_nodeOrder.size() );
+
+    std::vector<int> pointIds;
+    m_yaoGraph->Update( positions, pointIds );
+
+    m_pointGroups.assign( m_yaoGraph->PointCapacity(), -1 );
+
+    for( size_t ii = 0; ii < pointIds.size(); ++ii )
+        m_pointGroups[pointIds[ii]] = ii;
+
+    std::vector<RN_MST_EDGE> edges;
+    edges.reserve( m_boardEdges.size() + m_nodes.size() + positions.size() * YAO_GRAPH::SECTORS );
+
+    for( const auto& boardEdge : m_boardEdges )
+        edges.push_back( { 0, boardEdge.first, boardEdge.second } );
+
+    // Nodes sharing a position are chained, unconnected ones by a ratsnest line of length 1
+    for( size_t group = 0; group + 1 < m_groupStarts.size(); ++group )
+    {
+        auto first = m_nodeOrder.begin() + m_groupStarts[group];
+        auto last = m_nodeOrder.begin() + m_groupStarts[group + 1];
+
+        if( last - first < 2 )
+            continue;
+
+        std::sort( first, last, [this] ( int aNode1, int aNode2 )
+                {
+                    return m_nodes[aNode1]->GetCluster().get() < m_nodes[aNode2]->GetCluster().get();
+                } );
+
+        for( auto it = first + 1; it != last; ++it )
+        {
+            bool connected = m_nodes[*( it - 1 )]->GetCluster() == m_nodes[*it]->GetCluster();
+            edges.push_back( { connected ? 0 : 1, *( it - 1 ), *it } );
+        }
+    }
+
+    m_yaoGraph->ForEachEdge( [&] ( int aPoint, int aNeighbour, ecoord aDist )
+            {
+                int source = m_nodeOrder[m_groupStarts[m_pointGroups[aPoint]]];
+                int target = m_nodeOrder[m_groupStarts[m_pointGroups[aNeighbour]]];
+                edges.push_back( { aDist, source, target } );
+            } );
+
     #ifdef PROFILE
     cnt.Show();
+    PROF_COUNTER cnt2("mst");
     #endif
 
-    for( const auto& e : m_boardEdges )
-        triangEdges.push_back( e );
+    // Kruskal algorithm.  Edges are sorted by their weight, so first we always process
+    // connected items (weight == 0).  The remaining edges joining two subtrees are ratsnest.
+    std::sort( edges.begin(), edges.end(), [] ( const RN_MST_EDGE& aEdge1, const RN_MST_EDGE& aEdge2 )
+            {
+                return aEdge1.m_weight < aEdge2.m_weight;
+            } );
 
-// Get the minimal spanning tree
-#ifdef PROFILE
-    PROF_COUNTER cnt2("mst");
-#endif
-    m_rnEdges = kruskalMST( triangEdges, m_nodes );
-#ifdef PROFILE
+    std::vector<int> parents( m_nodes.size() );
+    size_t           subtrees = m_nodes.size();
+    bool             tagged = false;
+
+    for( size_t ii = 0; ii < parents.size(); ++ii )
+        parents[ii] = ii;
+
+    // Nodes connected by copper share the same tag
+    auto setTags = [&]()
+    {
+        for( size_t ii = 0; ii < m_nodes.size(); ++ii )
+            m_nodes[ii]->SetTag( findRoot( parents, ii ) );
+
+        tagged = true;
+    };
+
+    m_rnEdges.clear();
+
+    for( const RN_MST_EDGE& edge : edges )
+    {
+        if( subtrees == 1 )
+            break;
+
+        if( edge.m_weight > 0 && !tagged )
+            setTags();
+
+        int srcRoot = findRoot( parents, edge.m_source );
+        int trgRoot = findRoot( parents, edge.m_target );
+
+        if( srcRoot == trgRoot )
+            continue;
+
+        parents[trgRoot] = srcRoot;
+        subtrees--;
+
+        if( edge.m_weight > 0 )
+        {
+            unsigned int length = std::sqrt( (double) edge.m_weight );
+            m_rnEdges.emplace_back( m_nodes[edge.m_source], m_nodes[edge.m_target], length );
+        }
+    }
+
+    if( !tagged )
+        setTags();
+
+    #ifdef PROFILE
     cnt2.Show();
-#endif
+    #endif
 }
 
 
-
 void RN_NET::Update()
 {
     compute();
@@ -412,6 +811,9 @@ void RN_NET::Clear()
     m_rnEdges.clear();
     m_boardEdges.clear();
     m_nodes.clear();
+    m_pointGroups.clear();
+    m_groupStarts.clear();
+    m_nodeOrder.clear();
 
     m_dirty = true;
 }
@@ -420,6 +822,7 @@ void RN_NET::Clear()
 void RN_NET::AddCluster( CN_CLUSTER_PTR aCluster )
 {
     CN_ANCHOR_PTR firstAnchor;
+    int firstNode = -1;
 
     for( auto item : *aCluster )
     {
@@ -444,12 +847,13 @@ void RN_NET::AddCluster( CN_CLUSTER_PTR aCluster )
             {
                 if( firstAnchor != anchors[i] )
                 {
-                    m_boardEdges.emplace_back( firstAnchor, anchors[i], 0 );
+                    m_boardEdges.emplace_back( firstNode, m_nodes.size() - 1 );
                 }
             }
             else
             {
                 firstAnchor = anchors[i];
+                firstNode = m_nodes.size() - 1;
             }
         }
     }
@@ -463,6 +867,38 @@ bool RN_NET::NearestBicoloredPair( const RN_NET& aOtherNet, CN_ANCHOR_PTR& aNode
 
     VECTOR2I::extended_type distMax = VECTOR2I::ECOORD_MAX;
 
+    // The positions grid of the ratsnest computation avoids testing all the node pairs,
+    // when the nodes did not change since
+    if( !m_dirty && !m_pointGroups.empty() )
+    {
+        auto acceptPoint = [this] ( int aPoint )
+        {
+            int group = m_pointGroups[aPoint];
+
+            for( int ii = m_groupStarts[group]; ii < m_groupStarts[group + 1]; ++ii )
+            {
+                if( !m_nodes[m_nodeOrder[ii]]->GetNoLine() )
+                    return m_nodeOrder[ii];
+            }
+
+            return -1;
+        };
+
+        for( auto nodeB : aOtherNet.m_nodes )
+        {
+            int nodeA = m_yaoGraph->FindNearest( nodeB->Pos(), acceptPoint, distMax );
+
+            if( nodeA >= 0 )
+            {
+                rv = true;
+                aNode1 = m_nodes[nodeA];
+                aNode2 = nodeB;
+            }
+        }
+
+        return rv;
+    }
+
     for( auto nodeA : m_nodes )
     {
         for( auto nodeB : aOtherNet.m_nodes )
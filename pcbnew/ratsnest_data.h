@@ -34,11 +34,12 @@
 #include <math/box2.h>
 
 #include <deque>
+#include <list>
+#include <memory>
 #include <unordered_set>
 #include <unordered_map>
-
-#include <ttl/halfedge/hetriang.h>
-#include <ttl/halfedge/hetraits.h>
+#include <utility>
+#include <vector>
 
 #include <connectivity_algo.h>
 
@@ -145,14 +146,14 @@ public:
     bool NearestBicoloredPair( const RN_NET& aOtherNet, CN_ANCHOR_PTR& aNode1, CN_ANCHOR_PTR& aNode2 ) const;
 
 protected:
-    ///> Recomputes ratsnest from scratch.
+    ///> Recomputes ratsnest, reusing the candidate edges for the unchanged node positions.
     void compute();
 
     ///> Vector of nodes
     std::vector<CN_ANCHOR_PTR> m_nodes;
 
-    ///> Vector of edges that make pre-defined connections
-    std::vector<CN_EDGE> m_boardEdges;
+    ///> Pre-defined connections, as pairs of m_nodes indices
+    std::vector<std::pair<int, int>> m_boardEdges;
 
     ///> Vector of edges that makes ratsnest for a given net.
     std::vector<CN_EDGE> m_rnEdges;
@@ -160,9 +161,17 @@ protected:
     ///> Flag indicating necessity of recalculation of ratsnest for a net.
     bool m_dirty;
 
-    class TRIANGULATOR_STATE;
+    ///> m_nodes indices sorted by position, and start of each position group in it
+    std::vector<int> m_nodeOrder;
+    std::vector<int> m_groupStarts;
+
+    ///> Position group of each point of m_yaoGraph
+    std::vector<int> m_pointGroups;
+
+    class YAO_GRAPH;
 
-    std::shared_ptr<TRIANGULATOR_STATE> m_triangulator;
+    ///> Ratsnest candidate edges, kept between updates
+    std::shared_ptr<YAO_GRAPH> m_yaoGraph;
 };
 
 #endif /* RATSNEST_DATA_H */
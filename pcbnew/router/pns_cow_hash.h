@@ -0,0 +1,164 @@
+/*
+ * KiRouter - a push-and-(sometimes-)shove PCB router
+ *
+ * Copyright (C) 2018 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __PNS_COW_HASH_H
+#define __PNS_COW_HASH_H
+
+#include <cstdint>
+#include <memory>
+
+namespace PNS {
+
+/**
+ * Class COW_HASH
+ *
+ * Unordered container (set or map) split in buckets by the hash of the keys, stored in a
+ * two-level trie.  Copies of a COW_HASH share the trie nodes and the buckets until one of
+ * them modifies a bucket, which then copies the bucket and the trie node leading to it
+ * only (path copying).  Copying the container is therefore O(NodeSize), whatever its size,
+ * and modifying a copy costs the copy of a trie node and of a single small bucket.
+ **/
+template <class CONTAINER>
+class COW_HASH
+{
+public:
+    typedef typename CONTAINER::key_type KEY;
+
+    static const int NodeBits = 6;
+    static const int NodeSize = 1 << NodeBits;
+
+    /**
+     * Function Bucket()
+     *
+     * Returns the bucket holding aKey, or NULL if it is empty.  The bucket may be shared with
+     * other copies and must not be modified.
+     */
+    CONTAINER* Bucket( const KEY& aKey ) const
+    {
+        uint64_t hash = mixedHash( aKey );
+        const NODE* node = m_nodes[nodeIndex( hash )].get();
+
+        return node ? node->m_buckets[bucketIndex( hash )].get() : NULL;
+    }
+
+    /**
+     * Function MutableBucket()
+     *
+     * Returns the bucket holding aKey, copied first if it is shared with other copies.
+     */
+    CONTAINER& MutableBucket( const KEY& aKey )
+    {
+        uint64_t hash = mixedHash( aKey );
+        NODE& node = unshare( m_nodes[nodeIndex( hash )] );
+
+        return unshare( node.m_buckets[bucketIndex( hash )] );
+    }
+
+    size_t Count( const KEY& aKey ) const
+    {
+        const CONTAINER* bucket = Bucket( aKey );
+
+        return bucket ? bucket->count( aKey ) : 0;
+    }
+
+    size_t Size() const
+    {
+        size_t size = 0;
+
+        ForEachBucket( [&size]( const CONTAINER& aBucket )
+        {
+            size += aBucket.size();
+        } );
+
+        return size;
+    }
+
+    /**
+     * Function ForEach()
+     *
+     * Calls aFunc on each element of the container.
+     */
+    template <class FUNC>
+    void ForEach( FUNC aFunc ) const
+    {
+        ForEachBucket( [&aFunc]( const CONTAINER& aBucket )
+        {
+            for( const typename CONTAINER::value_type& value : aBucket )
+                aFunc( value );
+        } );
+    }
+
+private:
+    struct NODE
+    {
+        std::shared_ptr<CONTAINER> m_buckets[NodeSize];
+    };
+
+    template <class FUNC>
+    void ForEachBucket( FUNC aFunc ) const
+    {
+        for( const std::shared_ptr<NODE>& node : m_nodes )
+        {
+            if( !node )
+                continue;
+
+            for( const std::shared_ptr<CONTAINER>& bucket : node->m_buckets )
+            {
+                if( bucket )
+                    aFunc( *bucket );
+            }
+        }
+    }
+
+    template <class T>
+    static T& unshare( std::shared_ptr<T>& aPtr )
+    {
+        if( !aPtr )
+            aPtr = std::make_shared<T>();
+        else if( aPtr.use_count() > 1 )
+            aPtr = std::make_shared<T>( *aPtr );
+
+        return *aPtr;
+    }
+
+    static uint64_t mixedHash( const KEY& aKey )
+    {
+        // the hashes of pointers and joint tags have poor low bits: use the high bits of
+        // a multiplicative hash
+        uint64_t hash = typename CONTAINER::hasher()( aKey );
+
+        return hash * 0x9e3779b97f4a7c15ULL;
+    }
+
+    static int nodeIndex( uint64_t aHash )
+    {
+        return aHash >> ( 64 - NodeBits );
+    }
+
+    static int bucketIndex( uint64_t aHash )
+    {
+        return ( aHash >> ( 64 - 2 * NodeBits ) ) & ( NodeSize - 1 );
+    }
+
+    std::shared_ptr<NODE> m_nodes[NodeSize];
+};
+
+}
+
+#endif
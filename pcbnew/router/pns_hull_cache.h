@@ -0,0 +1,124 @@
+/*
+ * KiRouter - a push-and-(sometimes-)shove PCB router
+ *
+ * Copyright (C) 2018 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __PNS_HULL_CACHE_H
+#define __PNS_HULL_CACHE_H
+
+#include <mutex>
+#include <vector>
+
+#include <geometry/shape_line_chain.h>
+
+namespace PNS {
+
+/**
+ * Class HULL_CACHE
+ *
+ * Keeps the last hulls built for an item, keyed by clearance and walkaround thickness, as
+ * the collision and walkaround queries ask for the same hulls over and over.  The item must
+ * Clear() its cache when its geometry changes.  The cache is locked since the walkaround
+ * queries the items from several threads.
+ */
+class HULL_CACHE
+{
+public:
+    HULL_CACHE() :
+        m_next( 0 )
+    {}
+
+    HULL_CACHE( const HULL_CACHE& aOther ) :
+        m_next( 0 )
+    {
+        std::lock_guard<std::mutex> lock( aOther.m_lock );
+        m_entries = aOther.m_entries;
+    }
+
+    HULL_CACHE& operator=( const HULL_CACHE& aOther )
+    {
+        if( this != &aOther )
+        {
+            std::lock( m_lock, aOther.m_lock );
+            std::lock_guard<std::mutex> lock( m_lock, std::adopt_lock );
+            std::lock_guard<std::mutex> otherLock( aOther.m_lock, std::adopt_lock );
+
+            m_entries = aOther.m_entries;
+            m_next = 0;
+        }
+
+        return *this;
+    }
+
+    /**
+     * Returns the hull for the given clearance and walkaround thickness, built by
+     * aBuild() if it is not cached yet.
+     */
+    template <class FUNC>
+    const SHAPE_LINE_CHAIN Get( int aClearance, int aWalkaroundThickness, FUNC aBuild ) const
+    {
+        std::lock_guard<std::mutex> lock( m_lock );
+
+        for( const ENTRY& entry : m_entries )
+        {
+            if( entry.m_clearance == aClearance && entry.m_thickness == aWalkaroundThickness )
+                return entry.m_hull;
+        }
+
+        ENTRY entry = { aClearance, aWalkaroundThickness, aBuild() };
+
+        // the oldest entry is replaced when the cache is full
+        if( m_entries.size() < CacheSize )
+        {
+            m_entries.push_back( entry );
+        }
+        else
+        {
+            m_entries[m_next] = entry;
+            m_next = ( m_next + 1 ) % CacheSize;
+        }
+
+        return entry.m_hull;
+    }
+
+    void Clear()
+    {
+        std::lock_guard<std::mutex> lock( m_lock );
+
+        m_entries.clear();
+        m_next = 0;
+    }
+
+private:
+    ///> Different clearances are seldom used for the same item
+    static const size_t CacheSize = 4;
+
+    struct ENTRY
+    {
+        int              m_clearance;
+        int              m_thickness;
+        SHAPE_LINE_CHAIN m_hull;
+    };
+
+    mutable std::mutex          m_lock;
+    mutable std::vector<ENTRY>  m_entries;
+    mutable size_t              m_next;
+};
+
+}
+
+#endif    // __PNS_HULL_CACHE_H
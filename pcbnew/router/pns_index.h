@@ -24,7 +24,9 @@
 
 #include <layers_id_colors_and_visibility.h>
 #include <map>
+#include <memory>
 #include <unordered_set>
+#include <vector>
 
 #include <boost/range/adaptor/map.hpp>
 
@@ -32,6 +34,7 @@
 #include <geometry/shape_index.h>
 
 #include "pns_item.h"
+#include "pns_cow_hash.h"
 
 namespace PNS {
 
@@ -154,6 +157,9 @@ private:
 
     ITEM_SHAPE_INDEX* getSubindex( const ITEM* aItem );
 
+    INDEX( const INDEX& aOther ) = delete;
+    INDEX& operator=( const INDEX& aOther ) = delete;
+
     ITEM_SHAPE_INDEX* m_subIndices[MaxSubIndices];
     std::map<int, NET_ITEMS_LIST> m_netMap;
     ITEM_SET m_allItems;
@@ -328,6 +334,318 @@ INDEX::NET_ITEMS_LIST* INDEX::GetItemsForNet( int aNet )
     return &m_netMap[aNet];
 }
 
+
+/**
+ * Class CHUNKED_INDEX
+ *
+ * Persistent INDEX: a copy shares all the data of the original, and modifying one of them
+ * copies O(log n) items at most, amortized.  This is what a branch of the router's NODEs
+ * inherits from its parent, so that branching and the first changes of a branch do not
+ * depend on the number of items changed since the root.
+ *
+ * The items are stored in a stack of INDEX chunks of decreasing sizes (logarithmic method).
+ * A chunk shared with other copies is never modified: an item added goes to a new chunk on
+ * top of the stack, merged with the chunks below while they are not larger, and an item
+ * removed from a shared chunk is only hidden, until its chunk gets merged.  A chunk no other
+ * copy uses is modified in place, so an index that is never copied (the root's) holds its
+ * items in a single chunk, like an INDEX.
+ **/
+class CHUNKED_INDEX
+{
+public:
+    typedef COW_HASH<std::unordered_set<ITEM*>> ITEM_HASH_SET;
+
+    CHUNKED_INDEX();
+
+    /**
+     * Function Add()
+     *
+     * Adds item to the index.
+     */
+    void Add( ITEM* aItem );
+
+    /**
+     * Function Remove()
+     *
+     * Removes an item from the index.
+     */
+    void Remove( ITEM* aItem );
+
+    /**
+     * Function Query()
+     *
+     * Same as INDEX::Query(), on the items of all the chunks which are not hidden.
+     */
+    template<class Visitor>
+    int Query( const ITEM* aItem, int aMinDistance, Visitor& aVisitor );
+
+    template<class Visitor>
+    int Query( const SHAPE* aShape, int aMinDistance, Visitor& aVisitor );
+
+    /**
+     * Function ForEach()
+     *
+     * Calls aFunc on each item of the index.
+     */
+    template<class Func>
+    void ForEach( Func aFunc ) const;
+
+    /**
+     * Function ForEachInNet()
+     *
+     * Calls aFunc on each item of the index belonging to net aNet.
+     */
+    template<class Func>
+    void ForEachInNet( int aNet, Func aFunc ) const;
+
+    /**
+     * Function ForEachUnshared()
+     *
+     * Calls aFunc on each item of the chunks no other copy of the index uses.  These hold
+     * all the items added to this copy since it was made.
+     */
+    template<class Func>
+    void ForEachUnshared( Func aFunc ) const;
+
+    /**
+     * Function Size()
+     *
+     * Returns number of items stored in the index.
+     */
+    int Size() const;
+
+    /**
+     * Function ChunkCount()
+     *
+     * Returns the number of chunks the items are stored in.
+     */
+    int ChunkCount() const { return m_chunks.size(); }
+
+private:
+    template <class Visitor>
+    struct VISIBLE_ITEMS_VISITOR
+    {
+        const CHUNKED_INDEX& m_index;
+        Visitor&             m_visitor;
+
+        bool operator()( ITEM* aItem )
+        {
+            return m_index.isHidden( aItem ) || m_visitor( aItem );
+        }
+    };
+
+    bool isHidden( ITEM* aItem ) const
+    {
+        return m_hiddenCount && m_hidden.Count( aItem );
+    }
+
+    void hide( ITEM* aItem );
+    void unhide( ITEM* aItem );
+
+    ///> copies the visible items of aChunk to aTarget, dropping the hidden ones
+    void moveItems( INDEX& aChunk, INDEX& aTarget );
+
+    ///> merges the two chunks at the top of the stack
+    void mergeTop();
+
+    std::vector<std::shared_ptr<INDEX>> m_chunks;
+    ITEM_HASH_SET m_hidden;
+    int m_hiddenCount;
+};
+
+CHUNKED_INDEX::CHUNKED_INDEX() :
+    m_hiddenCount( 0 )
+{
+}
+
+void CHUNKED_INDEX::hide( ITEM* aItem )
+{
+    if( m_hidden.MutableBucket( aItem ).insert( aItem ).second )
+        m_hiddenCount++;
+}
+
+void CHUNKED_INDEX::unhide( ITEM* aItem )
+{
+    if( isHidden( aItem ) && m_hidden.MutableBucket( aItem ).erase( aItem ) )
+        m_hiddenCount--;
+}
+
+void CHUNKED_INDEX::Add( ITEM* aItem )
+{
+    // an item hidden in this copy is still stored in its chunk
+    if( isHidden( aItem ) )
+    {
+        unhide( aItem );
+        return;
+    }
+
+    if( m_chunks.empty() || m_chunks.back().use_count() > 1 )
+        m_chunks.push_back( std::make_shared<INDEX>() );
+
+    m_chunks.back()->Add( aItem );
+
+    while( m_chunks.size() > 1 && m_chunks[m_chunks.size() - 2]->Size() <= m_chunks.back()->Size() )
+        mergeTop();
+}
+
+void CHUNKED_INDEX::Remove( ITEM* aItem )
+{
+    for( auto chunk = m_chunks.rbegin(); chunk != m_chunks.rend(); ++chunk )
+    {
+        if( (*chunk)->Contains( aItem ) )
+        {
+            if( chunk->use_count() > 1 )
+            {
+                hide( aItem );
+            }
+            else
+            {
+                (*chunk)->Remove( aItem );
+                unhide( aItem );
+            }
+
+            return;
+        }
+    }
+}
+
+void CHUNKED_INDEX::moveItems( INDEX& aChunk, INDEX& aTarget )
+{
+    for( ITEM* item : aChunk )
+    {
+        if( isHidden( item ) )
+            unhide( item );
+        else
+            aTarget.Add( item );
+    }
+}
+
+void CHUNKED_INDEX::mergeTop()
+{
+    std::shared_ptr<INDEX> top = std::move( m_chunks.back() );
+    m_chunks.pop_back();
+
+    std::shared_ptr<INDEX>& below = m_chunks.back();
+
+    // copy the items of the smaller chunk, unless the larger one is shared
+    if( top.use_count() == 1 )
+    {
+        moveItems( *below, *top );
+        below = std::move( top );
+    }
+    else if( below.use_count() == 1 )
+    {
+        moveItems( *top, *below );
+    }
+    else
+    {
+        std::shared_ptr<INDEX> merged = std::make_shared<INDEX>();
+
+        moveItems( *below, *merged );
+        moveItems( *top, *merged );
+        below = std::move( merged );
+    }
+}
+
+template<class Visitor>
+int CHUNKED_INDEX::Query( const ITEM* aItem, int aMinDistance, Visitor& aVisitor )
+{
+    int total = 0;
+
+    if( !m_hiddenCount )
+    {
+        for( const std::shared_ptr<INDEX>& chunk : m_chunks )
+            total += chunk->Query( aItem, aMinDistance, aVisitor );
+
+        return total;
+    }
+
+    VISIBLE_ITEMS_VISITOR<Visitor> visitor = { *this, aVisitor };
+
+    for( const std::shared_ptr<INDEX>& chunk : m_chunks )
+        total += chunk->Query( aItem, aMinDistance, visitor );
+
+    return total;
+}
+
+template<class Visitor>
+int CHUNKED_INDEX::Query( const SHAPE* aShape, int aMinDistance, Visitor& aVisitor )
+{
+    int total = 0;
+
+    if( !m_hiddenCount )
+    {
+        for( const std::shared_ptr<INDEX>& chunk : m_chunks )
+            total += chunk->Query( aShape, aMinDistance, aVisitor );
+
+        return total;
+    }
+
+    VISIBLE_ITEMS_VISITOR<Visitor> visitor = { *this, aVisitor };
+
+    for( const std::shared_ptr<INDEX>& chunk : m_chunks )
+        total += chunk->Query( aShape, aMinDistance, visitor );
+
+    return total;
+}
+
+template<class Func>
+void CHUNKED_INDEX::ForEach( Func aFunc ) const
+{
+    for( const std::shared_ptr<INDEX>& chunk : m_chunks )
+    {
+        for( ITEM* item : *chunk )
+        {
+            if( !isHidden( item ) )
+                aFunc( item );
+        }
+    }
+}
+
+template<class Func>
+void CHUNKED_INDEX::ForEachInNet( int aNet, Func aFunc ) const
+{
+    for( const std::shared_ptr<INDEX>& chunk : m_chunks )
+    {
+        INDEX::NET_ITEMS_LIST* items = chunk->GetItemsForNet( aNet );
+
+        if( !items )
+            continue;
+
+        for( ITEM* item : *items )
+        {
+            if( !isHidden( item ) )
+                aFunc( item );
+        }
+    }
+}
+
+template<class Func>
+void CHUNKED_INDEX::ForEachUnshared( Func aFunc ) const
+{
+    for( const std::shared_ptr<INDEX>& chunk : m_chunks )
+    {
+        if( chunk.use_count() > 1 )
+            continue;
+
+        for( ITEM* item : *chunk )
+        {
+            if( !isHidden( item ) )
+                aFunc( item );
+        }
+    }
+}
+
+int CHUNKED_INDEX::Size() const
+{
+    int size = 0;
+
+    for( const std::shared_ptr<INDEX>& chunk : m_chunks )
+        size += chunk->Size();
+
+    return size - m_hiddenCount;
+}
+
 }
 
 #endif
@@ -436,6 +436,9 @@ public:
 
     void AddLine( const SHAPE_LINE_CHAIN& aLine, int aType, int aWidth ) override
     {
+        if( !m_view )
+            return;
+
         ROUTER_PREVIEW_ITEM* pitem = new ROUTER_PREVIEW_ITEM( NULL, m_view );
 
         pitem->Line( aLine, aWidth, aType );
@@ -472,13 +475,18 @@ PNS_KICAD_IFACE::PNS_KICAD_IFACE()
     m_view = nullptr;
     m_previewItems = nullptr;
     m_router = nullptr;
-    m_debugDecorator = nullptr;
     m_dispOptions = nullptr;
+
+    // Replaced when a view is set, the router can run without one (in the replay tool)
+    m_debugDecorator = new PNS_PCBNEW_DEBUG_DECORATOR();
 }
 
 
 PNS_KICAD_IFACE::~PNS_KICAD_IFACE()
 {
+    for( BOARD_CONNECTED_ITEM* item : m_removedItems )
+        delete item;
+
     delete m_ruleResolver;
     delete m_debugDecorator;
 
@@ -1000,6 +1008,9 @@ void PNS_KICAD_IFACE::SyncWorld( PNS::NODE *aWorld )
 
 void PNS_KICAD_IFACE::EraseView()
 {
+    if( !m_view )
+        return;
+
     for( auto item : m_hiddenItems )
         m_view->SetVisible( item, true );
 
@@ -1020,6 +1031,9 @@ void PNS_KICAD_IFACE::DisplayItem( const PNS::ITEM* aItem, int aColor, int aClea
 {
     wxLogTrace( "PNS", "DisplayItem %p", aItem );
 
+    if( !m_view )
+        return;
+
     ROUTER_PREVIEW_ITEM* pitem = new ROUTER_PREVIEW_ITEM( aItem, m_view );
 
     if( aColor >= 0 )
@@ -1048,7 +1062,7 @@ void PNS_KICAD_IFACE::HideItem( PNS::ITEM* aItem )
 {
     BOARD_CONNECTED_ITEM* parent = aItem->Parent();
 
-    if( parent )
+    if( parent && m_view )
     {
         if( m_view->IsVisible( parent ) )
             m_hiddenItems.insert( parent );
@@ -1063,10 +1077,19 @@ void PNS_KICAD_IFACE::RemoveItem( PNS::ITEM* aItem )
 {
     BOARD_CONNECTED_ITEM* parent = aItem->Parent();
 
-    if( parent )
+    if( !parent )
+        return;
+
+    // Without a host tool (in the replay tool), the board is modified directly
+    if( m_commit )
     {
         m_commit->Remove( parent );
     }
+    else
+    {
+        m_board->Remove( parent );
+        m_removedItems.push_back( parent );
+    }
 }
 
 
@@ -1114,7 +1137,10 @@ void PNS_KICAD_IFACE::AddItem( PNS::ITEM* aItem )
         aItem->SetParent( newBI );
         newBI->ClearFlags();
 
-        m_commit->Add( newBI );
+        if( m_commit )
+            m_commit->Add( newBI );
+        else
+            m_board->Add( newBI );
     }
 }
 
@@ -1122,6 +1148,16 @@ void PNS_KICAD_IFACE::AddItem( PNS::ITEM* aItem )
 void PNS_KICAD_IFACE::Commit()
 {
     EraseView();
+
+    if( !m_commit )
+    {
+        for( BOARD_CONNECTED_ITEM* item : m_removedItems )
+            delete item;
+
+        m_removedItems.clear();
+        return;
+    }
+
     m_commit->Push( _( "Added a track" ) );
     m_commit.reset( new BOARD_COMMIT( m_tool ) );
 }
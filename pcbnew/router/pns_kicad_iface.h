@@ -23,6 +23,7 @@
 #define __PNS_KICAD_IFACE_H
 
 #include <unordered_set>
+#include <vector>
 
 #include "pns_router.h"
 
@@ -80,7 +81,10 @@ private:
     PNS::ROUTER* m_router;
     BOARD* m_board;
     PCB_TOOL* m_tool;
-    std::unique_ptr<BOARD_COMMIT> m_commit;
+    std::unique_ptr<BOARD_COMMIT> m_commit;     ///< null when there is no host tool
+
+    ///< Items removed from the board without a host tool, deleted on Commit()
+    std::vector<BOARD_CONNECTED_ITEM*> m_removedItems;
     PCB_DISPLAY_OPTIONS* m_dispOptions;
 };
 
@@ -269,7 +269,10 @@ bool LINE::Walkaround( const SHAPE_LINE_CHAIN& aObstacle, SHAPE_LINE_CHAIN& aPat
 
 const SHAPE_LINE_CHAIN SEGMENT::Hull( int aClearance, int aWalkaroundThickness ) const
 {
-   return SegmentHull( m_seg, aClearance, aWalkaroundThickness );
+    return m_hullCache.Get( aClearance, aWalkaroundThickness, [&]()
+            {
+                return SegmentHull( m_seg, aClearance, aWalkaroundThickness );
+            } );
 }
 
 
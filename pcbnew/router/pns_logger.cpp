@@ -139,6 +139,32 @@ void LOGGER::Log( const VECTOR2I& aStart, const VECTOR2I& aEnd,
 }
 
 
+void LOGGER::LogEvent( const std::string& aName, const VECTOR2I& aP, const ITEM* aItem,
+                       const std::vector<int>& aArgs )
+{
+    m_theLog << "event " << aName << " " << aP.x << " " << aP.y << " ";
+
+    if( aItem )
+    {
+        VECTOR2I anchor = aItem->AnchorCount() ? aItem->Anchor( 0 ) : aP;
+
+        m_theLog << aItem->Kind() << " " << aItem->Net() << " " << aItem->Layers().Start() <<
+                    " " << aItem->Layers().End() << " " << anchor.x << " " << anchor.y;
+    }
+    else
+    {
+        m_theLog << "-1 0 0 0 0 0";
+    }
+
+    m_theLog << " " << aArgs.size();
+
+    for( int arg : aArgs )
+        m_theLog << " " << arg;
+
+    m_theLog << std::endl;
+}
+
+
 void LOGGER::dumpShape( const SHAPE* aSh )
 {
     switch( aSh->Type() )
@@ -194,12 +220,16 @@ void LOGGER::dumpShape( const SHAPE* aSh )
 }
 
 
-void LOGGER::Save( const std::string& aFilename )
+void LOGGER::Save( const std::string& aFilename, bool aAppend )
 {
     EndGroup();
 
-    FILE* f = fopen( aFilename.c_str(), "wb" );
+    FILE* f = fopen( aFilename.c_str(), aAppend ? "ab" : "wb" );
     wxLogTrace( "PNS", "Saving to '%s' [%p]", aFilename.c_str(), f );
+
+    if( !f )
+        return;
+
     const std::string s = m_theLog.str();
     fwrite( s.c_str(), 1, s.length(), f );
     fclose( f );
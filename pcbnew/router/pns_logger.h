@@ -42,7 +42,7 @@ public:
     LOGGER();
     ~LOGGER();
 
-    void Save( const std::string& aFilename );
+    void Save( const std::string& aFilename, bool aAppend = false );
     void Clear();
 
     void NewGroup( const std::string& aName, int aIter = 0 );
@@ -53,6 +53,15 @@ public:
     void Log( const VECTOR2I& aStart, const VECTOR2I& aEnd, int aKind = 0,
               const std::string& aName = std::string() );
 
+    /**
+     * Records a router input event, so that it can be played back by the router replay
+     * tool (qa/router_replay).  The line reads:
+     *   event name x y kind net layer_start layer_end anchor_x anchor_y arg_count args...
+     * where kind is -1 when there is no item.
+     */
+    void LogEvent( const std::string& aName, const VECTOR2I& aP, const ITEM* aItem = nullptr,
+                   const std::vector<int>& aArgs = std::vector<int>() );
+
 private:
     void dumpShape( const SHAPE* aSh );
 
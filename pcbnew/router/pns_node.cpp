@@ -53,7 +53,7 @@ NODE::NODE()
     m_parent = NULL;
     m_maxClearance = 800000;    // fixme: depends on how thick traces are.
     m_ruleResolver = NULL;
-    m_index = new INDEX;
+    m_index.reset( new CHUNKED_INDEX );
 
 #ifdef DEBUG
     allocNodes.insert( this );
@@ -81,18 +81,15 @@ NODE::~NODE()
     allocNodes.erase( this );
 #endif
 
-    m_joints.clear();
-
-    for( INDEX::ITEM_SET::iterator i = m_index->begin(); i != m_index->end(); ++i )
+    // the items of this node can't be in the chunks shared with the parent
+    m_index->ForEachUnshared( [this]( ITEM* aItem )
     {
-        if( (*i)->BelongsTo( this ) )
-            delete *i;
-    }
+        if( aItem->BelongsTo( this ) )
+            delete aItem;
+    } );
 
     releaseGarbage();
     unlinkParent();
-
-    delete m_index;
 }
 
 int NODE::GetClearance( const ITEM* aA, const ITEM* aB ) const
@@ -118,21 +115,19 @@ NODE* NODE::Branch()
     child->m_root = isRoot() ? this : m_root;
 
     // immmediate offspring of the root branch needs not copy anything.
-    // For the rest, deep-copy joints, overridden item map and pointers
-    // to stored items.
+    // For the rest, the stored items, joints and overridden item map are
+    // persistent structures shared with the parent: neither branching nor
+    // modifying the branch depends on the number of items changed since the root.
     if( !isRoot() )
     {
-        JOINT_MAP::iterator j;
-
-        for( INDEX::ITEM_SET::iterator i = m_index->begin(); i != m_index->end(); ++i )
-            child->m_index->Add( *i );
-
+        *child->m_index = *m_index;
         child->m_joints = m_joints;
         child->m_override = m_override;
     }
 
-    wxLogTrace( "PNS", "%d items, %d joints, %d overrides",
-            child->m_index->Size(), (int) child->m_joints.size(), (int) child->m_override.size() );
+    wxLogTrace( "PNS", "%d items in %d chunks, %d joints, %d overrides", child->m_index->Size(),
+            child->m_index->ChunkCount(), (int) child->m_joints.Size(),
+            (int) child->m_override.Size() );
 
     return child;
 }
@@ -639,12 +634,16 @@ void NODE::doRemove( ITEM* aItem )
     // case 1: removing an item that is stored in the root node from any branch:
     // mark it as overridden, but do not remove
     if( aItem->BelongsTo( m_root ) && !isRoot() )
-        m_override.insert( aItem );
+    {
+        m_override.MutableBucket( aItem ).insert( aItem );
+    }
 
     // case 2: the item belongs to this branch or a parent, non-root branch,
     // or the root itself and we are the root: remove from the index
     else if( !aItem->BelongsTo( m_root ) || isRoot() )
-        m_index->Remove( aItem );
+    {
+            m_index->Remove( aItem );
+    }
 
     // the item belongs to this particular branch: un-reference it
     if( aItem->BelongsTo( this ) )
@@ -678,13 +677,15 @@ void NODE::removeViaIndex( VIA* aVia )
     tag.net = net;
     tag.pos = p;
 
+    JOINT_MAP& joints = m_joints.MutableBucket( tag );
+
     bool split;
     do
     {
         split = false;
-        std::pair<JOINT_MAP::iterator, JOINT_MAP::iterator> range = m_joints.equal_range( tag );
+        std::pair<JOINT_MAP::iterator, JOINT_MAP::iterator> range = joints.equal_range( tag );
 
-        if( range.first == m_joints.end() )
+        if( range.first == joints.end() )
             break;
 
         // find and remove all joints containing the via to be removed
@@ -693,7 +694,7 @@ void NODE::removeViaIndex( VIA* aVia )
         {
             if( aVia->LayersOverlap( &f->second ) )
             {
-                m_joints.erase( f );
+                joints.erase( f );
                 split = true;
                 break;
             }
@@ -972,15 +973,27 @@ JOINT* NODE::FindJoint( const VECTOR2I& aPos, int aLayer, int aNet )
     tag.net = aNet;
     tag.pos = aPos;
 
-    JOINT_MAP::iterator f = m_joints.find( tag ), end = m_joints.end();
+    JOINT_MAP* joints = m_joints.Bucket( tag );
+    JOINT_MAP::iterator f, end;
 
-    if( f == end && !isRoot() )
+    if( joints )
     {
-        end = m_root->m_joints.end();
-        f = m_root->m_joints.find( tag );    // m_root->FindJoint(aPos, aLayer, aNet);
+        f = joints->find( tag );
+        end = joints->end();
     }
 
-    if( f == end )
+    if( ( !joints || f == end ) && !isRoot() )
+    {
+        joints = m_root->m_joints.Bucket( tag );    // m_root->FindJoint(aPos, aLayer, aNet);
+
+        if( joints )
+        {
+            f = joints->find( tag );
+            end = joints->end();
+        }
+    }
+
+    if( !joints || f == end )
         return NULL;
 
     while( f != end )
@@ -1009,18 +1022,25 @@ JOINT& NODE::touchJoint( const VECTOR2I& aPos, const LAYER_RANGE& aLayers, int a
     tag.pos = aPos;
     tag.net = aNet;
 
+    JOINT_MAP& joints = m_joints.MutableBucket( tag );
+
     // try to find the joint in this node.
-    JOINT_MAP::iterator f = m_joints.find( tag );
+    JOINT_MAP::iterator f = joints.find( tag );
 
     std::pair<JOINT_MAP::iterator, JOINT_MAP::iterator> range;
 
     // not found and we are not root? find in the root and copy results here.
-    if( f == m_joints.end() && !isRoot() )
+    if( f == joints.end() && !isRoot() )
     {
-        range = m_root->m_joints.equal_range( tag );
+        JOINT_MAP* rootJoints = m_root->m_joints.Bucket( tag );
 
-        for( f = range.first; f != range.second; ++f )
-            m_joints.insert( *f );
+        if( rootJoints )
+        {
+            range = rootJoints->equal_range( tag );
+
+            for( f = range.first; f != range.second; ++f )
+                joints.insert( *f );
+        }
     }
 
     // now insert and combine overlapping joints
@@ -1031,9 +1051,9 @@ JOINT& NODE::touchJoint( const VECTOR2I& aPos, const LAYER_RANGE& aLayers, int a
     do
     {
         merged  = false;
-        range   = m_joints.equal_range( tag );
+        range   = joints.equal_range( tag );
 
-        if( range.first == m_joints.end() )
+        if( range.first == joints.end() )
             break;
 
         for( f = range.first; f != range.second; ++f )
@@ -1041,7 +1061,7 @@ JOINT& NODE::touchJoint( const VECTOR2I& aPos, const LAYER_RANGE& aLayers, int a
             if( aLayers.Overlaps( f->second.Layers() ) )
             {
                 jt.Merge( f->second );
-                m_joints.erase( f );
+                joints.erase( f );
                 merged = true;
                 break;
             }
@@ -1049,7 +1069,7 @@ JOINT& NODE::touchJoint( const VECTOR2I& aPos, const LAYER_RANGE& aLayers, int a
     }
     while( merged );
 
-    return m_joints.insert( TagJointPair( tag, jt ) )->second;
+    return joints.insert( TagJointPair( tag, jt ) )->second;
 }
 
 
@@ -1162,17 +1182,21 @@ void NODE::Dump( bool aLong )
 
 void NODE::GetUpdatedItems( ITEM_VECTOR& aRemoved, ITEM_VECTOR& aAdded )
 {
-    aRemoved.reserve( m_override.size() );
+    aRemoved.reserve( m_override.Size() );
     aAdded.reserve( m_index->Size() );
 
     if( isRoot() )
         return;
 
-    for( ITEM* item : m_override )
-        aRemoved.push_back( item );
+    m_override.ForEach( [&]( ITEM* aItem )
+    {
+        aRemoved.push_back( aItem );
+    } );
 
-    for( INDEX::ITEM_SET::iterator i = m_index->begin(); i != m_index->end(); ++i )
-        aAdded.push_back( *i );
+    m_index->ForEach( [&]( ITEM* aItem )
+    {
+        aAdded.push_back( aItem );
+    } );
 }
 
 void NODE::releaseChildren()
@@ -1208,16 +1232,17 @@ void NODE::Commit( NODE* aNode )
     if( aNode->isRoot() )
         return;
 
-    for( ITEM* item : aNode->m_override )
-    Remove( item );
+    aNode->m_override.ForEach( [&]( ITEM* aItem )
+    {
+        Remove( aItem );
+    } );
 
-    for( INDEX::ITEM_SET::iterator i = aNode->m_index->begin();
-         i != aNode->m_index->end(); ++i )
+    aNode->m_index->ForEach( [&]( ITEM* aItem )
     {
-        (*i)->SetRank( -1 );
-        (*i)->Unmark();
-        Add( std::unique_ptr<ITEM>( *i ) );
-    }
+        aItem->SetRank( -1 );
+        aItem->Unmark();
+        Add( std::unique_ptr<ITEM>( aItem ) );
+    } );
 
     releaseChildren();
     releaseGarbage();
@@ -1233,43 +1258,39 @@ void NODE::KillChildren()
 
 void NODE::AllItemsInNet( int aNet, std::set<ITEM*>& aItems )
 {
-    INDEX::NET_ITEMS_LIST* l_cur = m_index->GetItemsForNet( aNet );
-
-    if( l_cur )
+    m_index->ForEachInNet( aNet, [&]( ITEM* aItem )
     {
-        for( ITEM*item : *l_cur )
-            aItems.insert( item );
-    }
+        aItems.insert( aItem );
+    } );
 
     if( !isRoot() )
     {
-        INDEX::NET_ITEMS_LIST* l_root = m_root->m_index->GetItemsForNet( aNet );
-
-        if( l_root )
-            for( INDEX::NET_ITEMS_LIST::iterator i = l_root->begin(); i!= l_root->end(); ++i )
-                if( !Overrides( *i ) )
-                    aItems.insert( *i );
+        m_root->m_index->ForEachInNet( aNet, [&]( ITEM* aItem )
+        {
+            if( !Overrides( aItem ) )
+                aItems.insert( aItem );
+        } );
     }
 }
 
 
 void NODE::ClearRanks( int aMarkerMask )
 {
-    for( INDEX::ITEM_SET::iterator i = m_index->begin(); i != m_index->end(); ++i )
+    m_index->ForEach( [&]( ITEM* aItem )
     {
-        (*i)->SetRank( -1 );
-        (*i)->Mark( (*i)->Marker() & (~aMarkerMask) );
-    }
+        aItem->SetRank( -1 );
+        aItem->Mark( aItem->Marker() & (~aMarkerMask) );
+    } );
 }
 
 
 int NODE::FindByMarker( int aMarker, ITEM_SET& aItems )
 {
-    for( INDEX::ITEM_SET::iterator i = m_index->begin(); i != m_index->end(); ++i )
+    m_index->ForEach( [&]( ITEM* aItem )
     {
-        if( (*i)->Marker() & aMarker )
-            aItems.Add( *i );
-    }
+        if( aItem->Marker() & aMarker )
+            aItems.Add( aItem );
+    } );
 
     return 0;
 }
@@ -1279,13 +1300,11 @@ int NODE::RemoveByMarker( int aMarker )
 {
     std::list<ITEM*> garbage;
 
-    for( INDEX::ITEM_SET::iterator i = m_index->begin(); i != m_index->end(); ++i )
+    m_index->ForEach( [&]( ITEM* aItem )
     {
-        if( (*i)->Marker() & aMarker )
-        {
-            garbage.push_back( *i );
-        }
-    }
+        if( aItem->Marker() & aMarker )
+            garbage.push_back( aItem );
+    } );
 
     for( std::list<ITEM*>::const_iterator i = garbage.begin(), end = garbage.end(); i != end; ++i )
     {
@@ -1329,13 +1348,15 @@ SEGMENT* NODE::findRedundantSegment( SEGMENT* aSeg )
 
 ITEM *NODE::FindItemByParent( const BOARD_CONNECTED_ITEM* aParent )
 {
-    INDEX::NET_ITEMS_LIST* l_cur = m_index->GetItemsForNet( aParent->GetNetCode() );
+    ITEM* found = NULL;
 
-    for( ITEM*item : *l_cur )
-        if( item->Parent() == aParent )
-            return item;
+    m_index->ForEachInNet( aParent->GetNetCode(), [&]( ITEM* aItem )
+    {
+        if( !found && aItem->Parent() == aParent )
+            found = aItem;
+    } );
 
-    return NULL;
+    return found;
 }
 
 }
@@ -24,6 +24,7 @@
 
 #include <vector>
 #include <list>
+#include <memory>
 #include <unordered_set>
 #include <unordered_map>
 
@@ -36,6 +37,7 @@
 #include "pns_item.h"
 #include "pns_joint.h"
 #include "pns_itemset.h"
+#include "pns_cow_hash.h"
 
 namespace PNS {
 
@@ -43,7 +45,7 @@ class SEGMENT;
 class LINE;
 class SOLID;
 class VIA;
-class INDEX;
+class CHUNKED_INDEX;
 class ROUTER;
 class NODE;
 
@@ -172,7 +174,7 @@ public:
     ///> Returns the number of joints
     int JointCount() const
     {
-        return m_joints.size();
+        return m_joints.Size();
     }
 
     ///> Returns the number of nodes in the inheritance chain (wrs to the root node)
@@ -415,7 +417,7 @@ public:
     ///> from the root branch.
     bool Overrides( ITEM* aItem ) const
     {
-        return m_override.find( aItem ) != m_override.end();
+        return m_override.Count( aItem ) > 0;
     }
 
 private:
@@ -450,6 +452,7 @@ private:
 
     void doRemove( ITEM* aItem );
     void unlinkParent();
+
     void releaseChildren();
     void releaseGarbage();
 
@@ -473,8 +476,9 @@ private:
                      bool        aStopAtLockedJoints );
 
     ///> hash table with the joints, linking the items. Joints are hashed by
-    ///> their position, layer set and net.
-    JOINT_MAP m_joints;
+    ///> their position, layer set and net.  Like m_override and m_index, a branch
+    ///> shares it with its parent until one of them modifies it.
+    COW_HASH<JOINT_MAP> m_joints;
 
     ///> node this node was branched from
     NODE* m_parent;
@@ -486,7 +490,7 @@ private:
     std::set<NODE*> m_children;
 
     ///> hash of root's items that have been changed in this node
-    std::unordered_set<ITEM*> m_override;
+    COW_HASH<std::unordered_set<ITEM*>> m_override;
 
     ///> worst case item-item clearance
     int m_maxClearance;
@@ -495,7 +499,7 @@ private:
     RULE_RESOLVER* m_ruleResolver;
 
     ///> Geometric/Net index of the items
-    INDEX* m_index;
+    std::unique_ptr<CHUNKED_INDEX> m_index;
 
     ///> depth of the node (number of parent nodes in the inheritance chain)
     int m_depth;
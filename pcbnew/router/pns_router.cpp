@@ -95,6 +95,7 @@ void ROUTER::SyncWorld()
     m_world = std::unique_ptr<NODE>( new NODE );
     m_iface->SyncWorld( m_world.get() );
 
+    logEvent( "sync", VECTOR2I() );
 }
 
 void ROUTER::ClearWorld()
@@ -126,6 +127,7 @@ const ITEM_SET ROUTER::QueryHoverItems( const VECTOR2I& aP )
 
 bool ROUTER::StartDragging( const VECTOR2I& aP, ITEM* aStartItem, int aDragMode )
 {
+    logEvent( "drag", aP, aStartItem, { aDragMode, Settings().Mode() } );
 
     if( aDragMode & DM_FREE_ANGLE )
         m_forceMarkObstaclesMode = true;
@@ -169,6 +171,7 @@ bool ROUTER::isStartingPointRoutable( const VECTOR2I& aWhere, int aLayer )
 
 bool ROUTER::StartRouting( const VECTOR2I& aP, ITEM* aStartItem, int aLayer )
 {
+    logEvent( "route", aP, aStartItem, { aLayer, m_mode, Settings().Mode() } );
 
     if( ! isStartingPointRoutable( aP, aLayer ) )
     {
@@ -224,6 +227,8 @@ void ROUTER::DisplayItems( const ITEM_SET& aItems )
 
 void ROUTER::Move( const VECTOR2I& aP, ITEM* endItem )
 {
+    logEvent( "move", aP, endItem );
+
     m_currentEnd = aP;
 
     switch( m_state )
@@ -309,6 +314,11 @@ void ROUTER::UpdateSizes( const SIZES_SETTINGS& aSizes )
 {
     m_sizes = aSizes;
 
+    logEvent( "sizes", VECTOR2I(), nullptr,
+              { m_sizes.TrackWidth(), m_sizes.ViaDiameter(), m_sizes.ViaDrill(),
+                m_sizes.ViaType(), m_sizes.DiffPairWidth(), m_sizes.DiffPairGap(),
+                m_sizes.DiffPairViaGap(), m_sizes.GetLayerTop(), m_sizes.GetLayerBottom() } );
+
     // Change track/via size settings
     if( m_state == ROUTE_TRACK)
     {
@@ -365,6 +375,8 @@ bool ROUTER::FixRoute( const VECTOR2I& aP, ITEM* aEndItem, bool aForceFinish )
 {
     bool rv = false;
 
+    logEvent( "fix", aP, aEndItem, { aForceFinish } );
+
     switch( m_state )
     {
     case ROUTE_TRACK:
@@ -388,6 +400,14 @@ bool ROUTER::FixRoute( const VECTOR2I& aP, ITEM* aEndItem, bool aForceFinish )
 
 void ROUTER::StopRouting()
 {
+    logEvent( "stop", m_currentEnd );
+
+    if( m_eventLogger )
+    {
+        m_eventLogger->Save( m_eventLogFile, true );
+        m_eventLogger->Clear();
+    }
+
     // Update the ratsnest with new changes
 
     if( m_placer )
@@ -416,6 +436,8 @@ void ROUTER::StopRouting()
 
 void ROUTER::FlipPosture()
 {
+    logEvent( "posture", m_currentEnd );
+
     if( m_state == ROUTE_TRACK )
     {
         m_placer->FlipPosture();
@@ -425,6 +447,8 @@ void ROUTER::FlipPosture()
 
 void ROUTER::SwitchLayer( int aLayer )
 {
+    logEvent( "layer", m_currentEnd, nullptr, { aLayer } );
+
     switch( m_state )
     {
     case ROUTE_TRACK:
@@ -438,6 +462,8 @@ void ROUTER::SwitchLayer( int aLayer )
 
 void ROUTER::ToggleViaPlacement()
 {
+    logEvent( "via", m_currentEnd );
+
     if( m_state == ROUTE_TRACK )
     {
         bool toggle = !m_placer->IsPlacingVia();
@@ -486,6 +512,25 @@ void ROUTER::DumpLog()
 }
 
 
+void ROUTER::SetEventLogFile( const std::string& aFilename )
+{
+    m_eventLogFile = aFilename;
+
+    if( aFilename.empty() )
+        m_eventLogger.reset();
+    else if( !m_eventLogger )
+        m_eventLogger.reset( new LOGGER );
+}
+
+
+void ROUTER::logEvent( const std::string& aName, const VECTOR2I& aP, const ITEM* aItem,
+                       const std::vector<int>& aArgs )
+{
+    if( m_eventLogger )
+        m_eventLogger->LogEvent( aName, aP, aItem, aArgs );
+}
+
+
 bool ROUTER::IsPlacingVia() const
 {
     if( !m_placer )
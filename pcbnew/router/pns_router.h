@@ -35,6 +35,7 @@
 #include "pns_item.h"
 #include "pns_itemset.h"
 #include "pns_node.h"
+#include "pns_logger.h"
 
 namespace KIGFX
 {
@@ -160,6 +161,13 @@ public:
 
     void DumpLog();
 
+    /**
+     * Records the routing events (start, move, fix...) to aFilename, so that the session
+     * can be played back by the router replay tool.  The events of each routing operation
+     * are appended to the file when it ends.  An empty name stops the recording.
+     */
+    void SetEventLogFile( const std::string& aFilename );
+
     RULE_RESOLVER* GetRuleResolver() const
     {
         return m_iface->GetRuleResolver();
@@ -247,6 +255,9 @@ private:
     void markViolations( NODE* aNode, ITEM_SET& aCurrent, NODE::ITEM_VECTOR& aRemoved );
     bool isStartingPointRoutable( const VECTOR2I& aWhere, int aLayer );
 
+    void logEvent( const std::string& aName, const VECTOR2I& aP, const ITEM* aItem = nullptr,
+                   const std::vector<int>& aArgs = std::vector<int>() );
+
     VECTOR2I m_currentEnd;
     RouterState m_state;
 
@@ -271,6 +282,9 @@ private:
 
     wxString m_toolStatusbarName;
     wxString m_failureReason;
+
+    std::unique_ptr<LOGGER> m_eventLogger;     ///< null when the events are not recorded
+    std::string             m_eventLogFile;
 };
 
 }
@@ -30,6 +30,7 @@
 
 #include "pns_item.h"
 #include "pns_line.h"
+#include "pns_hull_cache.h"
 
 namespace PNS {
 
@@ -83,6 +84,7 @@ public:
     void SetWidth( int aWidth )
     {
         m_seg.SetWidth(aWidth);
+        m_hullCache.Clear();
     }
 
     int Width() const
@@ -103,12 +105,14 @@ public:
     void SetEnds( const VECTOR2I& a, const VECTOR2I& b )
     {
         m_seg.SetSeg( SEG ( a, b ) );
+        m_hullCache.Clear();
     }
 
     void SwapEnds()
     {
         SEG tmp = m_seg.GetSeg();
         m_seg.SetSeg( SEG (tmp.B , tmp.A ) );
+        m_hullCache.Clear();
     }
 
     const SHAPE_LINE_CHAIN Hull( int aClearance, int aWalkaroundThickness ) const override;
@@ -128,6 +132,7 @@ public:
 
 private:
     SHAPE_SEGMENT m_seg;
+    HULL_CACHE    m_hullCache;
 };
 
 }
@@ -33,6 +33,15 @@
 namespace PNS {
 
 const SHAPE_LINE_CHAIN SOLID::Hull( int aClearance, int aWalkaroundThickness ) const
+{
+    return m_hullCache.Get( aClearance, aWalkaroundThickness, [&]()
+            {
+                return buildHull( aClearance, aWalkaroundThickness );
+            } );
+}
+
+
+const SHAPE_LINE_CHAIN SOLID::buildHull( int aClearance, int aWalkaroundThickness ) const
 {
     int cl = aClearance + ( aWalkaroundThickness + 1 )/ 2;
 
@@ -29,6 +29,7 @@
 #include <geometry/shape_line_chain.h>
 
 #include "pns_item.h"
+#include "pns_hull_cache.h"
 
 namespace PNS {
 
@@ -46,7 +47,8 @@ public:
     }
 
     SOLID( const SOLID& aSolid ) :
-        ITEM( aSolid )
+        ITEM( aSolid ),
+        m_hullCache( aSolid.m_hullCache )
     {
         m_shape = aSolid.m_shape->Clone();
         m_pos = aSolid.m_pos;
@@ -69,6 +71,7 @@ public:
             delete m_shape;
 
         m_shape = shape;
+        m_hullCache.Clear();
     }
 
     const VECTOR2I& Pos() const
@@ -102,9 +105,12 @@ public:
     }
 
 private:
+    const SHAPE_LINE_CHAIN buildHull( int aClearance, int aWalkaroundThickness ) const;
+
     VECTOR2I    m_pos;
     SHAPE*      m_shape;
     VECTOR2I    m_offset;
+    HULL_CACHE  m_hullCache;
 };
 
 }
@@ -100,6 +100,13 @@ void TOOL_BASE::Reset( RESET_REASON aReason )
 
     m_router = new ROUTER;
     m_router->SetInterface( m_iface );
+
+    // Routing sessions can be recorded for the router replay tool
+    wxString eventLogFile;
+
+    if( wxGetEnv( "KICAD_ROUTER_EVENT_LOG", &eventLogFile ) )
+        m_router->SetEventLogFile( TO_UTF8( eventLogFile ) );
+
     m_router->ClearWorld();
     m_router->SyncWorld();
     m_router->LoadSettings( m_savedSettings );
@@ -73,11 +73,15 @@ bool VIA::PushoutForce( NODE* aNode, const VECTOR2I& aDirection, VECTOR2I& aForc
 
 const SHAPE_LINE_CHAIN VIA::Hull( int aClearance, int aWalkaroundThickness ) const
 {
-    int cl = ( aClearance + aWalkaroundThickness / 2 );
-
-    return OctagonalHull( m_pos -
-            VECTOR2I( m_diameter / 2, m_diameter / 2 ), VECTOR2I( m_diameter, m_diameter ),
-            cl + 1, ( 2 * cl + m_diameter ) * 0.26 );
+    return m_hullCache.Get( aClearance, aWalkaroundThickness, [&]()
+            {
+                int cl = ( aClearance + aWalkaroundThickness / 2 );
+
+                return OctagonalHull( m_pos -
+                        VECTOR2I( m_diameter / 2, m_diameter / 2 ),
+                        VECTOR2I( m_diameter, m_diameter ),
+                        cl + 1, ( 2 * cl + m_diameter ) * 0.26 );
+            } );
 }
 
 
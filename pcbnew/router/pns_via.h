@@ -28,6 +28,7 @@
 #include "../class_track.h"
 
 #include "pns_item.h"
+#include "pns_hull_cache.h"
 
 namespace PNS {
 
@@ -77,6 +78,7 @@ public:
         m_rank = aB.m_rank;
         m_drill = aB.m_drill;
         m_viaType = aB.m_viaType;
+        m_hullCache = aB.m_hullCache;
     }
 
     static inline bool ClassOf( const ITEM* aItem )
@@ -94,6 +96,7 @@ public:
     {
         m_pos = aPos;
         m_shape.SetCenter( aPos );
+        m_hullCache.Clear();
     }
 
     VIATYPE_T ViaType() const
@@ -115,6 +118,7 @@ public:
     {
         m_diameter = aDiameter;
         m_shape.SetRadius( m_diameter / 2 );
+        m_hullCache.Clear();
     }
 
     int Drill() const
@@ -160,6 +164,7 @@ private:
     VECTOR2I m_pos;
     SHAPE_CIRCLE m_shape;
     VIATYPE_T m_viaType;
+    HULL_CACHE m_hullCache;
 };
 
 }
@@ -20,6 +20,7 @@
  */
 
 #include <core/optional.h>
+#include <thread_pool.h>
 
 #include <geometry/shape_line_chain.h>
 
@@ -52,12 +53,15 @@ NODE::OPT_OBSTACLE WALKAROUND::nearestObstacle( const LINE& aPath )
 
 
 WALKAROUND::WALKAROUND_STATUS WALKAROUND::singleStep( LINE& aPath,
-                                                              bool aWindingDirection )
+                                                              bool aWindingDirection,
+                                                              int aIteration )
 {
     OPT<OBSTACLE>& current_obs =
         aWindingDirection ? m_currentObstacle[0] : m_currentObstacle[1];
 
     bool& prev_recursive = aWindingDirection ? m_recursiveCollision[0] : m_recursiveCollision[1];
+    int& blockage_count =
+        aWindingDirection ? m_recursiveBlockageCount[0] : m_recursiveBlockageCount[1];
 
     if( !current_obs )
         return DONE;
@@ -68,9 +72,9 @@ WALKAROUND::WALKAROUND_STATUS WALKAROUND::singleStep( LINE& aPath,
 
     if( ( current_obs->m_hull ).PointInside( last ) || ( current_obs->m_hull ).PointOnEdge( last ) )
     {
-        m_recursiveBlockageCount++;
+        blockage_count++;
 
-        if( m_recursiveBlockageCount < 3 )
+        if( blockage_count < 3 )
             aPath.Line().Append( current_obs->m_hull.NearestPoint( last ) );
         else
         {
@@ -88,12 +92,16 @@ WALKAROUND::WALKAROUND_STATUS WALKAROUND::singleStep( LINE& aPath,
         return STUCK;
 
 #ifdef DEBUG
-    m_logger.NewGroup( aWindingDirection ? "walk-cw" : "walk-ccw", m_iteration );
-    m_logger.Log( &path_walk[0], 0, "path-walk" );
-    m_logger.Log( &path_pre[0], 1, "path-pre" );
-    m_logger.Log( &path_post[0], 4, "path-post" );
-    m_logger.Log( &current_obs->m_hull, 2, "hull" );
-    m_logger.Log( current_obs->m_item, 3, "item" );
+    {
+        std::lock_guard<std::mutex> lock( m_loggerLock );
+
+        m_logger.NewGroup( aWindingDirection ? "walk-cw" : "walk-ccw", aIteration );
+        m_logger.Log( &path_walk[0], 0, "path-walk" );
+        m_logger.Log( &path_pre[0], 1, "path-pre" );
+        m_logger.Log( &path_post[0], 4, "path-post" );
+        m_logger.Log( &current_obs->m_hull, 2, "hull" );
+        m_logger.Log( current_obs->m_item, 3, "item" );
+    }
 #endif
 
     int len_pre = path_walk[0].Length();
@@ -144,6 +152,31 @@ WALKAROUND::WALKAROUND_STATUS WALKAROUND::singleStep( LINE& aPath,
 }
 
 
+WALKAROUND::WALKAROUND_STATUS WALKAROUND::walk( LINE& aPath, bool aWindingDirection,
+                                                int& aIterations, std::atomic_bool* aDone )
+{
+    WALKAROUND_STATUS st = IN_PROGRESS;
+
+    for( aIterations = 0; aIterations < m_iterationLimit; aIterations++ )
+    {
+        // the other direction has found its way: this one could only be kept if better,
+        // which is not worth waiting for
+        if( aDone && aDone->load() )
+            break;
+
+        st = singleStep( aPath, aWindingDirection, aIterations );
+
+        if( st != IN_PROGRESS )
+            break;
+    }
+
+    if( aDone && st == DONE )
+        aDone->store( true );
+
+    return st;
+}
+
+
 WALKAROUND::WALKAROUND_STATUS WALKAROUND::Route( const LINE& aInitialPath,
         LINE& aWalkPath, bool aOptimize )
 {
@@ -164,63 +197,101 @@ WALKAROUND::WALKAROUND_STATUS WALKAROUND::Route( const LINE& aInitialPath,
     start( aInitialPath );
 
     m_currentObstacle[0] = m_currentObstacle[1] = nearestObstacle( aInitialPath );
-    m_recursiveBlockageCount = 0;
+    m_recursiveBlockageCount[0] = m_recursiveBlockageCount[1] = 0;
+    m_recursiveCollision[0] = m_recursiveCollision[1] = false;
 
-    aWalkPath = aInitialPath;
+    int iter_cw = 0, iter_ccw = 0;
 
     if( m_forceWinding )
     {
-        s_cw = m_forceCw ? IN_PROGRESS : STUCK;
-        s_ccw = m_forceCw ? STUCK : IN_PROGRESS;
+        // the other direction is stuck from the start and keeps the initial path
+        if( m_forceCw )
+        {
+            s_cw = walk( path_cw, true, iter_cw );
+            s_ccw = STUCK;
+        }
+        else
+        {
+            s_ccw = walk( path_ccw, false, iter_ccw );
+            s_cw = STUCK;
+        }
+
         m_forceSingleDirection = true;
-    } else {
-        m_forceSingleDirection = false;
     }
-
-    while( m_iteration < m_iterationLimit )
+    else if( THREAD_POOL::GetInstance().GetIdleWorkerCount() == 0 )
     {
-        if( s_cw != STUCK )
-            s_cw = singleStep( path_cw, true );
-
-        if( s_ccw != STUCK )
-            s_ccw = singleStep( path_ccw, false );
+        // No worker to walk in parallel: interleave the steps of both directions, so that
+        // the first one done ends the walk
+        int iter;
 
-        if( ( s_cw == DONE && s_ccw == DONE ) || ( s_cw == STUCK && s_ccw == STUCK ) )
+        for( iter = 0; iter < m_iterationLimit; iter++ )
         {
-            int len_cw  = path_cw.CLine().Length();
-            int len_ccw = path_ccw.CLine().Length();
+            if( s_cw == IN_PROGRESS )
+                s_cw = singleStep( path_cw, true, iter );
 
-            if( m_forceLongerPath )
-                aWalkPath = ( len_cw > len_ccw ? path_cw : path_ccw );
-            else
-                aWalkPath = ( len_cw < len_ccw ? path_cw : path_ccw );
+            if( s_ccw == IN_PROGRESS )
+                s_ccw = singleStep( path_ccw, false, iter );
 
-            break;
-        }
-        else if( s_cw == DONE && !m_forceLongerPath )
-        {
-            aWalkPath = path_cw;
-            break;
-        }
-        else if( s_ccw == DONE && !m_forceLongerPath )
-        {
-            aWalkPath = path_ccw;
-            break;
+            if( s_cw != IN_PROGRESS && s_ccw != IN_PROGRESS )
+                break;
+
+            if( !m_forceLongerPath && ( s_cw == DONE || s_ccw == DONE ) )
+                break;
         }
 
-        m_iteration++;
+        iter_cw = iter_ccw = iter;
+        m_forceSingleDirection = false;
+    }
+    else
+    {
+        // Both walks only query the world, which is not modified until they are done.
+        // The counter-clockwise one goes to the pool, the clockwise one runs here (and also
+        // the counter-clockwise one, if no worker has taken it by then).  Unless the longer
+        // path is wanted, the first one done stops the other one.
+        THREAD_POOL& pool = THREAD_POOL::GetInstance();
+        std::atomic_bool done( false );
+        std::atomic_bool* stop = m_forceLongerPath ? NULL : &done;
+
+        auto ccw = pool.Submit( [&]() { s_ccw = walk( path_ccw, false, iter_ccw, stop ); },
+                                this );
+
+        s_cw = walk( path_cw, true, iter_cw, stop );
+
+        pool.Wait( ccw, this );
+        ccw.get();
+
+        m_forceSingleDirection = false;
     }
 
-    if( m_iteration == m_iterationLimit )
+    m_iteration = std::max( iter_cw, iter_ccw );
+
+    int len_cw  = path_cw.CLine().Length();
+    int len_ccw = path_ccw.CLine().Length();
+
+    if( m_forceLongerPath )
+        aWalkPath = ( len_cw > len_ccw ? path_cw : path_ccw );
+    else if( s_cw == DONE && s_ccw != DONE )
+        aWalkPath = path_cw;
+    else if( s_ccw == DONE && s_cw != DONE )
+        aWalkPath = path_ccw;
+    else if( s_cw == DONE && s_ccw == DONE )
     {
-        int len_cw  = path_cw.CLine().Length();
-        int len_ccw = path_ccw.CLine().Length();
+        // keep the cheapest one, or the shortest if none is better in both length
+        // and corners
+        COST_ESTIMATOR cost_cw, cost_ccw;
+
+        cost_cw.Add( path_cw );
+        cost_ccw.Add( path_ccw );
 
-        if( m_forceLongerPath )
-            aWalkPath = ( len_cw > len_ccw ? path_cw : path_ccw );
+        if( cost_cw.IsBetter( cost_ccw, 1.0, 1.0 ) )
+            aWalkPath = path_ccw;
+        else if( cost_ccw.IsBetter( cost_cw, 1.0, 1.0 ) )
+            aWalkPath = path_cw;
         else
             aWalkPath = ( len_cw < len_ccw ? path_cw : path_ccw );
     }
+    else
+        aWalkPath = ( len_cw < len_ccw ? path_cw : path_ccw );
 
     if( m_cursorApproachMode )
     {
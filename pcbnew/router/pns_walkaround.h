@@ -22,6 +22,8 @@
 #ifndef __PNS_WALKAROUND_H
 #define __PNS_WALKAROUND_H
 
+#include <atomic>
+#include <mutex>
 #include <set>
 
 #include "pns_line.h"
@@ -49,7 +51,7 @@ public:
         m_itemMask = ITEM::ANY_T;
 
         // Initialize other members, to avoid uninitialized variables.
-        m_recursiveBlockageCount = 0;
+        m_recursiveBlockageCount[0] = m_recursiveBlockageCount[1] = 0;
         m_recursiveCollision[0] = m_recursiveCollision[1] = false;
         m_iteration = 0;
         m_forceCw = false;
@@ -118,6 +120,13 @@ public:
             m_restrictedSet.clear();
     }
 
+    /**
+     * Walks aInitialPath around the obstacles.  Unless a winding is forced, the clockwise
+     * and counter-clockwise walks run in parallel on the thread pool (or interleaved on the
+     * calling thread when no worker is free), and both stop as soon as one of them is done,
+     * unless the longer path is wanted.  The best of the two is kept: the cheapest one
+     * according to COST_ESTIMATOR when both are done.
+     */
     WALKAROUND_STATUS Route( const LINE& aInitialPath, LINE& aWalkPath,
             bool aOptimize = true );
 
@@ -129,12 +138,22 @@ public:
 private:
     void start( const LINE& aInitialPath );
 
-    WALKAROUND_STATUS singleStep( LINE& aPath, bool aWindingDirection );
+    WALKAROUND_STATUS singleStep( LINE& aPath, bool aWindingDirection, int aIteration );
+
+    /**
+     * Steps aPath in a single winding direction until it is done or stuck, at most
+     * m_iterationLimit times.
+     * @param aDone if not NULL, is set when the walk is done, and stops it (still in
+     *              progress) when set by the walk in the other direction.
+     * @return the status, aIterations receives the number of steps
+     */
+    WALKAROUND_STATUS walk( LINE& aPath, bool aWindingDirection, int& aIterations,
+                            std::atomic_bool* aDone = NULL );
     NODE::OPT_OBSTACLE nearestObstacle( const LINE& aPath );
 
     NODE* m_world;
 
-    int m_recursiveBlockageCount;
+    int m_recursiveBlockageCount[2];
     int m_iteration;
     int m_iterationLimit;
     int m_itemMask;
@@ -146,6 +165,7 @@ private:
     NODE::OPT_OBSTACLE m_currentObstacle[2];
     bool m_recursiveCollision[2];
     LOGGER m_logger;
+    std::mutex m_loggerLock;     ///< both winding directions log from their own thread
     std::set<ITEM*> m_restrictedSet;
 };
 
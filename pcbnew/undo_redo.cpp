@@ -47,6 +47,7 @@ using namespace std::placeholders;
 #include <origin_viewitem.h>
 
 #include <connectivity_data.h>
+#include <drc.h>
 
 #include <tools/selection_tool.h>
 #include <tools/pcbnew_control.h>
@@ -588,6 +589,35 @@ void PCB_BASE_EDIT_FRAME::PutDataInPreviousState( PICKED_ITEMS_LIST* aList, bool
     {
         Compile_Ratsnest( NULL, false );
     }
+
+    // The DRC markers are not in the undo entries: retest the restored items
+    if( IsType( FRAME_PCB ) && Settings().m_onlineDrc )
+    {
+        std::vector<BOARD_ITEM*> changedItems;
+        std::vector<BOARD_ITEM*> removedItems;
+
+        for( unsigned ii = 0; ii < aList->GetCount(); ii++ )
+        {
+            UNDO_REDO_T status = aList->GetPickedItemStatus( ii );
+            item = (BOARD_ITEM*) aList->GetPickedItem( ii );
+
+            if( status == UR_DRILLORIGIN || status == UR_GRIDORIGIN
+                    || item->Type() == PCB_MARKER_T )
+                continue;
+
+            // The statuses were swapped above: UR_DELETED items are now out of the board
+            if( status == UR_DELETED )
+                removedItems.push_back( item );
+            else
+                changedItems.push_back( item );
+        }
+
+        if( !changedItems.empty() || !removedItems.empty() )
+        {
+            DRC* drc = static_cast<PCB_EDIT_FRAME*>( this )->GetDrcController();
+            drc->UpdateMarkersIncremental( changedItems, removedItems );
+        }
+    }
 }
 
 
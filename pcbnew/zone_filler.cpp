@@ -24,7 +24,8 @@
  */
 
 #include <cstdint>
-#include <thread>
+#include <algorithm>
+#include <atomic>
 #include <mutex>
 
 #include <class_board.h>
@@ -46,6 +47,7 @@
 #include <geometry/convex_hull.h>
 #include <geometry/geometry_utils.h>
 #include <confirm.h>
+#include <thread_pool.h>
 
 #include "zone_filler.h"
 
@@ -65,9 +67,481 @@ extern void CreateThermalReliefPadPolygon( SHAPE_POLY_SET& aCornerBuffer,
 static double s_thermalRot = 450;    // angle of stubs in thermal reliefs for round pads
 static const bool s_DumpZonesWhenFilling = false;
 
+
+/**
+ * Appends the polygons aFirst to aFirst + aCount - 1 of aSource (with their holes)
+ * to aDest.
+ */
+static void appendPolygons( SHAPE_POLY_SET& aDest, const SHAPE_POLY_SET& aSource,
+                            int aFirst, int aCount )
+{
+    for( int ii = aFirst; ii < aFirst + aCount; ++ii )
+    {
+        aDest.AddOutline( aSource.COutline( ii ) );
+
+        for( int hole = 0; hole < aSource.HoleCount( ii ); ++hole )
+            aDest.AddHole( aSource.CHole( ii, hole ) );
+    }
+}
+
+
+static const uint64_t s_hashSeed = 14695981039346656037ULL;     // FNV-1a offset basis
+static const uint64_t s_hashPrime = 1099511628211ULL;           // FNV-1a prime
+
+
+/**
+ * FNV-1a hash of the points of a contour, chained to aHash.
+ */
+static uint64_t hashContour( uint64_t aHash, const SHAPE_LINE_CHAIN& aContour )
+{
+    for( int ii = 0; ii < aContour.PointCount(); ++ii )
+    {
+        aHash = ( aHash ^ (uint32_t) aContour.CPoint( ii ).x ) * s_hashPrime;
+        aHash = ( aHash ^ (uint32_t) aContour.CPoint( ii ).y ) * s_hashPrime;
+    }
+
+    // Contour separator, so that splitting the same points differently changes the hash
+    return ( aHash ^ 0xFFFFFFFFULL ) * s_hashPrime;
+}
+
+
+/**
+ * Hashes the polygons aFirst to aFirst + aCount - 1 of aPolys, chained to aHash.
+ */
+static uint64_t hashPolygons( uint64_t aHash, const SHAPE_POLY_SET& aPolys,
+                              int aFirst, int aCount )
+{
+    for( int ii = aFirst; ii < aFirst + aCount; ++ii )
+    {
+        aHash = hashContour( aHash, aPolys.COutline( ii ) );
+
+        for( int hole = 0; hole < aPolys.HoleCount( ii ); ++hole )
+            aHash = hashContour( aHash, aPolys.CHole( ii, hole ) );
+    }
+
+    return aHash;
+}
+
+
+/**
+ * Builds polygons for aCount items on the worker threads.
+ * aBuild( aIndex, aPolys ) adds the polygons of the item aIndex to aPolys.  The items are
+ * handled by chunks having their own polygon set, appended to aPolys in the chunk order,
+ * so the result is the same as the one of a sequential loop over the items.
+ * When aHoleList is not null, the polygons added by each item are recorded in it.
+ */
+template <typename FUNC>
+static void buildPolygonsByChunks( size_t aCount, SHAPE_POLY_SET& aPolys,
+                                   std::vector<ZONE_FILL_HOLE>* aHoleList, FUNC aBuild )
+{
+    const size_t chunkSize = 128;
+    size_t chunkCount = ( aCount + chunkSize - 1 ) / chunkSize;
+    std::vector<SHAPE_POLY_SET> chunks( chunkCount );
+    std::vector<std::vector<ZONE_FILL_HOLE>> chunkHoles( chunkCount );
+
+    THREAD_POOL::GetInstance().ParallelFor( chunkCount, [&]( size_t ii )
+    {
+        SHAPE_POLY_SET& polys = chunks[ii];
+        size_t last = std::min( aCount, ( ii + 1 ) * chunkSize );
+
+        for( size_t item = ii * chunkSize; item < last; ++item )
+        {
+            int first = polys.OutlineCount();
+
+            aBuild( item, polys );
+
+            if( !aHoleList || polys.OutlineCount() == first )
+                continue;
+
+            ZONE_FILL_HOLE hole;
+            hole.m_firstOutline = first;
+            hole.m_outlineCount = polys.OutlineCount() - first;
+            hole.m_hash = hashPolygons( s_hashSeed, polys, first, hole.m_outlineCount );
+            hole.m_bbox = polys.COutline( first ).BBox();
+
+            for( int jj = first + 1; jj < polys.OutlineCount(); ++jj )
+                hole.m_bbox.Merge( polys.COutline( jj ).BBox() );
+
+            chunkHoles[ii].push_back( hole );
+        }
+    } );
+
+    for( size_t ii = 0; ii < chunkCount; ++ii )
+    {
+        int offset = aPolys.OutlineCount();
+
+        aPolys.Append( chunks[ii] );
+
+        if( !aHoleList )
+            continue;
+
+        for( ZONE_FILL_HOLE& hole : chunkHoles[ii] )
+        {
+            hole.m_firstOutline += offset;
+            aHoleList->push_back( hole );
+        }
+    }
+}
+
+
+/**
+ * Merges the (usually many and overlapping) polygons of aPolys. The result is the same
+ * area as aPolys.Simplify( PM_FAST ), but the work is shared between threads: the
+ * outlines are sorted by X position and split into vertical strips which are simplified
+ * separately, then neighbour strips are unioned two by two until one set is left.
+ */
+static void parallelSimplify( SHAPE_POLY_SET& aPolys )
+{
+    THREAD_POOL& pool = THREAD_POOL::GetInstance();
+
+    // Below this count of outlines by strip, the thread overhead is not worth it
+    const int minStripSize = 64;
+    int threadCount = (int) pool.GetWorkerCount() + 1;
+    int stripCount = std::min( threadCount * 2, aPolys.OutlineCount() / minStripSize );
+
+    if( stripCount < 2 )
+    {
+        aPolys.Simplify( SHAPE_POLY_SET::PM_FAST );
+        return;
+    }
+
+    std::vector<std::pair<int, int>> order;     // outline X center, outline index
+
+    for( int ii = 0; ii < aPolys.OutlineCount(); ++ii )
+        order.emplace_back( aPolys.COutline( ii ).BBox().Centre().x, ii );
+
+    std::sort( order.begin(), order.end() );
+
+    std::vector<SHAPE_POLY_SET> strips( stripCount );
+
+    for( size_t ii = 0; ii < order.size(); ++ii )
+        appendPolygons( strips[ ii * stripCount / order.size() ], aPolys, order[ii].second, 1 );
+
+    pool.ParallelFor( strips.size(), [&]( size_t ii )
+    {
+        strips[ii].Simplify( SHAPE_POLY_SET::PM_FAST );
+    } );
+
+    while( strips.size() > 1 )
+    {
+        std::vector<SHAPE_POLY_SET> merged( ( strips.size() + 1 ) / 2 );
+
+        pool.ParallelFor( merged.size(), [&]( size_t ii )
+        {
+            if( 2 * ii + 1 < strips.size() )
+                merged[ii].BooleanAdd( strips[2 * ii], strips[2 * ii + 1],
+                                       SHAPE_POLY_SET::PM_FAST );
+            else
+                merged[ii] = strips[2 * ii];
+        } );
+
+        strips.swap( merged );
+    }
+
+    aPolys = strips[0];
+}
+
+
+/**
+ * Updates the copper area of a previous fill for the holes changed since.
+ * The holes found in only one of aCache.m_holes and aHoleList (both sorted by hash) are
+ * the changed ones: the areas they cover are recomputed from the zone outline (given in
+ * aSolidAreas) and the holes crossing them, and merged with the rest of the copper area of
+ * the previous fill.
+ * @param aHoles is the hole polygons list referred to by aHoleList.
+ * @param aSolidAreas is the zone outline on input, and the copper area on output.
+ * @return false (and aSolidAreas is unchanged) if too many holes changed, in this case a
+ * full fill is faster.
+ */
+static bool spliceChangedHoles( const ZONE_FILL_CACHE& aCache,
+                                const std::vector<ZONE_FILL_HOLE>& aHoleList,
+                                const SHAPE_POLY_SET& aHoles, SHAPE_POLY_SET& aSolidAreas )
+{
+    std::vector<BOX2I> dirty;
+    auto oldHole = aCache.m_holes.begin();
+    auto newHole = aHoleList.begin();
+
+    while( oldHole != aCache.m_holes.end() || newHole != aHoleList.end() )
+    {
+        if( newHole == aHoleList.end()
+                || ( oldHole != aCache.m_holes.end() && oldHole->m_hash < newHole->m_hash ) )
+        {
+            dirty.push_back( oldHole->m_bbox );
+            ++oldHole;
+        }
+        else if( oldHole == aCache.m_holes.end() || newHole->m_hash < oldHole->m_hash )
+        {
+            dirty.push_back( newHole->m_bbox );
+            ++newHole;
+        }
+        else
+        {
+            ++oldHole;
+            ++newHole;
+        }
+    }
+
+    if( dirty.size() > aHoleList.size() / 4 )
+        return false;
+
+    if( dirty.empty() )
+    {
+        aSolidAreas = aCache.m_solidAreas;
+        return true;
+    }
+
+    // The recomputed areas are slightly larger than the dirty ones, so that the new and
+    // the kept parts of the copper overlap, and no slit can appear between them because
+    // of rounding errors
+    const int overlap = 10;
+
+    SHAPE_POLY_SET dirtyAreas;
+    SHAPE_POLY_SET recomputedAreas;
+    std::vector<BOX2I> recomputedBoxes;
+    BOX2I recomputedBBox = dirty[0];
+
+    auto addRect = []( SHAPE_POLY_SET& aPolys, const BOX2I& aBox )
+    {
+        SHAPE_LINE_CHAIN rect;
+
+        rect.Append( aBox.GetX(), aBox.GetY() );
+        rect.Append( aBox.GetRight(), aBox.GetY() );
+        rect.Append( aBox.GetRight(), aBox.GetBottom() );
+        rect.Append( aBox.GetX(), aBox.GetBottom() );
+        rect.SetClosed( true );
+
+        aPolys.AddOutline( rect );
+    };
+
+    for( BOX2I box : dirty )
+    {
+        addRect( dirtyAreas, box );
+        box.Inflate( overlap );
+        addRect( recomputedAreas, box );
+        recomputedBoxes.push_back( box );
+        recomputedBBox.Merge( box );
+    }
+
+    dirtyAreas.Simplify( SHAPE_POLY_SET::PM_FAST );
+    recomputedAreas.Simplify( SHAPE_POLY_SET::PM_FAST );
+
+    SHAPE_POLY_SET nearHoles;
+
+    for( const ZONE_FILL_HOLE& hole : aHoleList )
+    {
+        if( !hole.m_bbox.Intersects( recomputedBBox ) )
+            continue;
+
+        for( const BOX2I& box : recomputedBoxes )
+        {
+            if( hole.m_bbox.Intersects( box ) )
+            {
+                appendPolygons( nearHoles, aHoles, hole.m_firstOutline, hole.m_outlineCount );
+                break;
+            }
+        }
+    }
+
+    parallelSimplify( nearHoles );
+
+    aSolidAreas.BooleanIntersection( recomputedAreas, SHAPE_POLY_SET::PM_FAST );
+    aSolidAreas.BooleanSubtract( nearHoles, SHAPE_POLY_SET::PM_FAST );
+
+    SHAPE_POLY_SET keptAreas = aCache.m_solidAreas;
+    keptAreas.BooleanSubtract( dirtyAreas, SHAPE_POLY_SET::PM_FAST );
+
+    // Use SHAPE_POLY_SET::PM_STRICTLY_SIMPLE as the full fill does, for Fracture()
+    aSolidAreas.BooleanAdd( keptAreas, SHAPE_POLY_SET::PM_STRICTLY_SIMPLE );
+
+    return true;
+}
+
+
+/**
+ * @return true if the closed outline aChain is convex.
+ */
+static bool isConvex( const SHAPE_LINE_CHAIN& aChain )
+{
+    int     count = aChain.PointCount();
+    int64_t orientation = 0;
+
+    for( int ii = 0; ii < count; ++ii )
+    {
+        const VECTOR2I& a = aChain.CPoint( ii );
+        const VECTOR2I& b = aChain.CPoint( ( ii + 1 ) % count );
+        const VECTOR2I& c = aChain.CPoint( ( ii + 2 ) % count );
+        int64_t cross = (int64_t) ( b.x - a.x ) * ( c.y - b.y )
+                        - (int64_t) ( b.y - a.y ) * ( c.x - b.x );
+
+        if( cross == 0 )
+            continue;
+
+        if( orientation == 0 )
+            orientation = cross;
+        else if( ( cross > 0 ) != ( orientation > 0 ) )
+            return false;
+    }
+
+    return orientation != 0;
+}
+
+
+/**
+ * Replaces in aHoles the round holes far from the other holes and from the outlines of
+ * aSolidAreas (typically the antipads of vias and through hole pads in an inner plane) by
+ * 8 vertices of their outline, tagged as an arc (see SHAPE_LINE_CHAIN::SetArcTag()).
+ * Nothing crosses such a hole, so the boolean operations keep it as is, and they do not
+ * need all its vertices: restoreArcHoles() puts back the full outline in their result.
+ * @param aHoleList is the list of the holes of aHoles.
+ * @param aArcOutlines receives the replaced outlines, outline ii being tagged ii + 1.
+ */
+static void replaceArcHoles( SHAPE_POLY_SET& aHoles, const std::vector<ZONE_FILL_HOLE>& aHoleList,
+                             const SHAPE_POLY_SET& aSolidAreas,
+                             std::vector<SHAPE_LINE_CHAIN>& aArcOutlines )
+{
+    // Below this count of vertices, replacing the outline saves nothing worth it
+    const int minPointCount = 12;
+    const int standInPointCount = 8;
+
+    std::vector<const ZONE_FILL_HOLE*> candidates;
+
+    for( const ZONE_FILL_HOLE& hole : aHoleList )
+        candidates.push_back( &hole );
+
+    std::sort( candidates.begin(), candidates.end(),
+               []( const ZONE_FILL_HOLE* a, const ZONE_FILL_HOLE* b )
+               {
+                   return a->m_bbox.GetLeft() < b->m_bbox.GetLeft();
+               } );
+
+    // Sweep the holes by X position to find the ones touching another hole
+    std::vector<bool> touching( candidates.size(), false );
+
+    for( size_t ii = 0; ii < candidates.size(); ++ii )
+    {
+        BOX2I box = candidates[ii]->m_bbox;
+        box.Inflate( 1 );
+
+        for( size_t jj = ii + 1; jj < candidates.size()
+                && candidates[jj]->m_bbox.GetLeft() <= box.GetRight(); ++jj )
+        {
+            if( box.Intersects( candidates[jj]->m_bbox ) )
+                touching[ii] = touching[jj] = true;
+        }
+    }
+
+    std::vector<const SHAPE_LINE_CHAIN*> contours;
+
+    for( int ii = 0; ii < aSolidAreas.OutlineCount(); ++ii )
+    {
+        contours.push_back( &aSolidAreas.COutline( ii ) );
+
+        for( int jj = 0; jj < aSolidAreas.HoleCount( ii ); ++jj )
+            contours.push_back( &aSolidAreas.CHole( ii, jj ) );
+    }
+
+    for( size_t ii = 0; ii < candidates.size(); ++ii )
+    {
+        const ZONE_FILL_HOLE& hole = *candidates[ii];
+
+        if( touching[ii] || hole.m_outlineCount != 1
+                || aHoles.HoleCount( hole.m_firstOutline ) != 0 )
+            continue;
+
+        const SHAPE_LINE_CHAIN& outline = aHoles.COutline( hole.m_firstOutline );
+        int count = outline.PointCount();
+
+        if( count < minPointCount || !isConvex( outline ) )
+            continue;
+
+        // The hole must be inside or outside the copper, with no copper outline in its box
+        BOX2I box = hole.m_bbox;
+        box.Inflate( 1 );
+
+        VECTOR2I corners[4] = { box.GetOrigin(), VECTOR2I( box.GetRight(), box.GetTop() ),
+                                box.GetEnd(), VECTOR2I( box.GetLeft(), box.GetBottom() ) };
+        bool crossed = false;
+
+        for( const SHAPE_LINE_CHAIN* contour : contours )
+        {
+            BOX2I contourBox = contour->BBox();
+
+            if( !contourBox.Intersects( box ) )
+                continue;
+
+            if( box.Contains( contourBox ) )
+                crossed = true;
+
+            for( int jj = 0; jj < 4 && !crossed; ++jj )
+                crossed = contour->Collide( SEG( corners[jj], corners[( jj + 1 ) % 4] ), 1 );
+
+            if( crossed )
+                break;
+        }
+
+        if( crossed )
+            continue;
+
+        // A convex polygon of vertices of the convex outline is inside it
+        SHAPE_LINE_CHAIN standIn;
+        int tag = (int) aArcOutlines.size() + 1;
+
+        for( int jj = 0; jj < standInPointCount; ++jj )
+        {
+            standIn.Append( outline.CPoint( jj * count / standInPointCount ) );
+            standIn.SetArcTag( jj, tag );
+        }
+
+        standIn.SetClosed( true );
+
+        // Too thin to be sure it stays a hole through the operations
+        if( std::abs( standIn.Area() ) < std::abs( outline.Area() ) / 2 )
+            continue;
+
+        aArcOutlines.push_back( outline );
+        aHoles.Outline( hole.m_firstOutline ) = standIn;
+    }
+}
+
+
+/**
+ * Puts back in aPolys the outlines replaced by replaceArcHoles().
+ */
+static void restoreArcHoles( SHAPE_POLY_SET& aPolys,
+                             const std::vector<SHAPE_LINE_CHAIN>& aArcOutlines )
+{
+    for( int ii = 0; ii < aPolys.OutlineCount(); ++ii )
+    {
+        for( int jj = 0; jj < aPolys.HoleCount( ii ); ++jj )
+        {
+            SHAPE_LINE_CHAIN& hole = aPolys.Hole( ii, jj );
+            int tag = hole.ArcTag( 0 );
+
+            if( tag <= 0 || tag > (int) aArcOutlines.size() )
+                continue;
+
+            bool whole = true;
+
+            for( int kk = 1; kk < hole.PointCount() && whole; ++kk )
+                whole = hole.ArcTag( kk ) == tag;
+
+            if( !whole )
+                continue;
+
+            SHAPE_LINE_CHAIN outline = aArcOutlines[tag - 1];
+
+            if( ( outline.Area() > 0 ) != ( hole.Area() > 0 ) )
+                outline.Reverse();
+
+            hole = outline;
+        }
+    }
+}
+
+
 ZONE_FILLER::ZONE_FILLER(  BOARD* aBoard, COMMIT* aCommit ) :
     m_board( aBoard ), m_commit( aCommit ), m_progressReporter( nullptr ),
-    m_next( 0 ), m_count_done( 0 )
+    m_count_done( 0 )
 {
 }
 
@@ -84,8 +558,6 @@ void ZONE_FILLER::SetProgressReporter( WX_PROGRESS_REPORTER* aReporter )
 
 bool ZONE_FILLER::Fill( std::vector<ZONE_CONTAINER*> aZones, bool aCheck )
 {
-    int parallelThreadCount = std::max( ( int )std::thread::hardware_concurrency(), 2 );
-
     std::vector<CN_ZONE_ISOLATED_ISLAND_LIST> toFill;
     auto connectivity = m_board->GetConnectivity();
 
@@ -115,32 +587,40 @@ bool ZONE_FILLER::Fill( std::vector<ZONE_CONTAINER*> aZones, bool aCheck )
         m_progressReporter->SetMaxProgress( toFill.size() );
     }
 
-    m_next = 0;
+    // One task per zone.  The zone fills split their own work in smaller tasks, so when
+    // there are fewer zones than workers (e.g. a board having only one big plane) the
+    // idle workers help inside each zone fill
+    TASK_GROUP tasks;
     m_count_done = 0;
-    std::vector<std::thread> fillWorkers;
 
-    for( ssize_t ii = 0; ii < parallelThreadCount; ++ii )
+    for( size_t ii = 0; ii < toFill.size(); ++ii )
     {
-        fillWorkers.push_back( std::thread( [ this, toFill ]()
+        ZONE_CONTAINER* zone = toFill[ii].m_zone;
+
+        tasks.Run( [ this, zone, aCheck ]()
         {
-            size_t i = m_next.fetch_add( 1 );
-            while( i < toFill.size() )
-            {
-                SHAPE_POLY_SET rawPolys, finalPolys;
-                ZONE_CONTAINER* zone = toFill[i].m_zone;
-                fillSingleZone( zone, rawPolys, finalPolys );
+            SHAPE_POLY_SET rawPolys, finalPolys;
 
-                zone->SetRawPolysList( rawPolys );
-                zone->SetFilledPolysList( finalPolys );
-                zone->SetIsFilled( true );
+            // An incrementally updated fill covers the same area as a full fill, but
+            // its polygons can differ, so the fill check (done by comparing hashes)
+            // always uses a full fill
+            std::shared_ptr<const ZONE_FILL_CACHE> fillCache;
 
-                if( m_progressReporter )
-                    m_progressReporter->AdvanceProgress();
+            if( !aCheck )
+                fillCache = zone->GetFillCache();
 
-                m_count_done.fetch_add( 1 );
-                i = m_next.fetch_add( 1 );
-            }
-        } ) );
+            fillSingleZone( zone, rawPolys, finalPolys, fillCache );
+
+            zone->SetFillCache( fillCache );
+            zone->SetRawPolysList( rawPolys );
+            zone->SetFilledPolysList( finalPolys );
+            zone->SetIsFilled( true );
+
+            if( m_progressReporter )
+                m_progressReporter->AdvanceProgress();
+
+            m_count_done.fetch_add( 1 );
+        } );
     }
 
     while( m_count_done.load() < toFill.size() )
@@ -151,8 +631,7 @@ bool ZONE_FILLER::Fill( std::vector<ZONE_CONTAINER*> aZones, bool aCheck )
         wxMilliSleep( 20 );
     }
 
-    for( size_t ii = 0; ii < fillWorkers.size(); ++ii )
-        fillWorkers[ ii ].join();
+    tasks.Wait();
 
     // Now remove insulated copper islands
     if( m_progressReporter )
@@ -218,26 +697,21 @@ bool ZONE_FILLER::Fill( std::vector<ZONE_CONTAINER*> aZones, bool aCheck )
         m_progressReporter->SetMaxProgress( toFill.size() );
     }
 
-    m_next = 0;
     m_count_done = 0;
-    std::vector<std::thread> triangulationWorkers;
 
-    for( ssize_t ii = 0; ii < parallelThreadCount; ++ii )
+    for( size_t ii = 0; ii < toFill.size(); ++ii )
     {
-        triangulationWorkers.push_back( std::thread( [ this, toFill ]()
+        ZONE_CONTAINER* zone = toFill[ii].m_zone;
+
+        tasks.Run( [ this, zone ]()
         {
-            size_t i = m_next.fetch_add( 1 );
-            while( i < toFill.size() )
-            {
-                if( m_progressReporter )
-                    m_progressReporter->AdvanceProgress();
+            if( m_progressReporter )
+                m_progressReporter->AdvanceProgress();
 
-                toFill[i].m_zone->CacheTriangulation();
+            zone->CacheTriangulation();
 
-                m_count_done.fetch_add( 1 );
-                i = m_next.fetch_add( 1 );
-            }
-        } ) );
+            m_count_done.fetch_add( 1 );
+        } );
     }
 
     while( m_count_done.load() < toFill.size() )
@@ -248,8 +722,7 @@ bool ZONE_FILLER::Fill( std::vector<ZONE_CONTAINER*> aZones, bool aCheck )
         wxMilliSleep( 10 );
     }
 
-    for( size_t ii = 0; ii < triangulationWorkers.size(); ++ii )
-        triangulationWorkers[ ii ].join();
+    tasks.Wait();
 
     // If some zones must be filled by segments, create the filling segments
     // (note, this is a outdated option, but it exists)
@@ -318,7 +791,7 @@ bool ZONE_FILLER::Fill( std::vector<ZONE_CONTAINER*> aZones, bool aCheck )
 
 
 void ZONE_FILLER::buildZoneFeatureHoleList( const ZONE_CONTAINER* aZone,
-        SHAPE_POLY_SET& aFeatures ) const
+        SHAPE_POLY_SET& aFeatures, std::vector<ZONE_FILL_HOLE>& aHoleList ) const
 {
     int segsPerCircle;
     double correctionFactor;
@@ -337,6 +810,7 @@ void ZONE_FILLER::buildZoneFeatureHoleList( const ZONE_CONTAINER* aZone,
     correctionFactor = GetCircletoPolyCorrectionFactor( segsPerCircle );
 
     aFeatures.RemoveAllContours();
+    aHoleList.clear();
 
     int outline_half_thickness = aZone->GetMinThickness() / 2;
 
@@ -355,207 +829,240 @@ void ZONE_FILLER::buildZoneFeatureHoleList( const ZONE_CONTAINER* aZone,
     /* items ouside the zone bounding box are skipped
      * the bounding box is the zone bounding box + the biggest clearance found in Netclass list
      */
-    EDA_RECT    item_boundingbox;
     EDA_RECT    zone_boundingbox = aZone->GetBoundingBox();
     int biggest_clearance = m_board->GetDesignSettings().GetBiggestClearanceValue();
     biggest_clearance = std::max( biggest_clearance, zone_clearance );
     zone_boundingbox.Inflate( biggest_clearance );
 
+    /* The hole polygons are built by chunks of items on the worker threads.
+     * The polygons are kept in the item order, so the hole list is the same as the one
+     * built by a single thread.  The polygons of each item are recorded in aHoleList.
+     */
+    std::vector<D_PAD*> pads;
+
+    for( auto module : m_board->Modules() )
+    {
+        for( auto pad : module->Pads() )
+            pads.push_back( pad );
+    }
+
     /*
      * First : Add pads. Note: pads having the same net as zone are left in zone.
      * Thermal shapes will be created later if necessary
      */
-
-    /* Use a dummy pad to calculate hole clearance when a pad is not on all copper layers
-     * and this pad has a hole
-     * This dummy pad has the size and shape of the hole
-     * Therefore, this dummy pad is a circle or an oval.
-     * A pad must have a parent because some functions expect a non null parent
-     * to find the parent board, and some other data
-     */
-    MODULE  dummymodule( m_board );   // Creates a dummy parent
-    D_PAD   dummypad( &dummymodule );
-
-    for( MODULE* module = m_board->m_Modules; module; module = module->Next() )
+    auto addPadHoles = [&]( D_PAD* pad, SHAPE_POLY_SET& aHoles )
     {
-        D_PAD* nextpad;
+        EDA_RECT bbox;
 
-        for( D_PAD* pad = module->PadsList(); pad != NULL; pad = nextpad )
+        // Note: netcode <=0 means not connected item
+        if( ( pad->GetNetCode() != aZone->GetNetCode() ) || ( pad->GetNetCode() <= 0 ) )
         {
-            nextpad = pad->Next();      // pad pointer can be modified by next code, so
-                                        // calculate the next pad here
-
-            if( !pad->IsOnLayer( aZone->GetLayer() ) )
-            {
-                /* Test for pads that are on top or bottom only and have a hole.
-                 * There are curious pads but they can be used for some components that are
-                 * inside the board (in fact inside the hole. Some photo diodes and Leds are
-                 * like this)
-                 */
-                if( pad->GetDrillSize().x == 0 && pad->GetDrillSize().y == 0 )
-                    continue;
-
-                // Use a dummy pad to calculate a hole shape that have the same dimension as
-                // the pad hole
-                dummypad.SetSize( pad->GetDrillSize() );
-                dummypad.SetOrientation( pad->GetOrientation() );
-                dummypad.SetShape( pad->GetDrillShape() == PAD_DRILL_SHAPE_OBLONG ?
-                        PAD_SHAPE_OVAL : PAD_SHAPE_CIRCLE );
-                dummypad.SetPosition( pad->GetPosition() );
-
-                pad = &dummypad;
-            }
+            int item_clearance = pad->GetClearance() + outline_half_thickness;
+            bbox = pad->GetBoundingBox();
+            bbox.Inflate( item_clearance );
 
-            // Note: netcode <=0 means not connected item
-            if( ( pad->GetNetCode() != aZone->GetNetCode() ) || ( pad->GetNetCode() <= 0 ) )
+            if( bbox.Intersects( zone_boundingbox ) )
             {
-                int item_clearance = pad->GetClearance() + outline_half_thickness;
-                item_boundingbox = pad->GetBoundingBox();
-                item_boundingbox.Inflate( item_clearance );
+                int clearance = std::max( zone_clearance, item_clearance );
 
-                if( item_boundingbox.Intersects( zone_boundingbox ) )
+                // PAD_SHAPE_CUSTOM can have a specific keepout, to avoid to break the shape
+                if( pad->GetShape() == PAD_SHAPE_CUSTOM
+                    && pad->GetCustomShapeInZoneOpt() == CUST_PAD_SHAPE_IN_ZONE_CONVEXHULL )
                 {
-                    int clearance = std::max( zone_clearance, item_clearance );
-
-                    // PAD_SHAPE_CUSTOM can have a specific keepout, to avoid to break the shape
-                    if( pad->GetShape() == PAD_SHAPE_CUSTOM
-                        && pad->GetCustomShapeInZoneOpt() == CUST_PAD_SHAPE_IN_ZONE_CONVEXHULL )
+                    // the pad shape in zone can be its convex hull or
+                    // the shape itself
+                    SHAPE_POLY_SET outline( pad->GetCustomShapeAsPolygon() );
+                    outline.Inflate( KiROUND( clearance * correctionFactor ), segsPerCircle );
+                    pad->CustomShapeAsPolygonToBoardPosition( &outline,
+                            pad->GetPosition(), pad->GetOrientation() );
+
+                    if( pad->GetCustomShapeInZoneOpt() == CUST_PAD_SHAPE_IN_ZONE_CONVEXHULL )
                     {
-                        // the pad shape in zone can be its convex hull or
-                        // the shape itself
-                        SHAPE_POLY_SET outline( pad->GetCustomShapeAsPolygon() );
-                        outline.Inflate( KiROUND( clearance * correctionFactor ), segsPerCircle );
-                        pad->CustomShapeAsPolygonToBoardPosition( &outline,
-                                pad->GetPosition(), pad->GetOrientation() );
-
-                        if( pad->GetCustomShapeInZoneOpt() == CUST_PAD_SHAPE_IN_ZONE_CONVEXHULL )
-                        {
-                            std::vector<wxPoint> convex_hull;
-                            BuildConvexHull( convex_hull, outline );
-
-                            aFeatures.NewOutline();
-
-                            for( unsigned ii = 0; ii < convex_hull.size(); ++ii )
-                                aFeatures.Append( convex_hull[ii] );
-                        }
-                        else
-                            aFeatures.Append( outline );
+                        std::vector<wxPoint> convex_hull;
+                        BuildConvexHull( convex_hull, outline );
+
+                        aHoles.NewOutline();
+
+                        for( unsigned ii = 0; ii < convex_hull.size(); ++ii )
+                            aHoles.Append( convex_hull[ii] );
                     }
                     else
-                        pad->TransformShapeWithClearanceToPolygon( aFeatures,
-                                clearance,
-                                segsPerCircle,
-                                correctionFactor );
+                        aHoles.Append( outline );
                 }
-
-                continue;
+                else
+                    pad->TransformShapeWithClearanceToPolygon( aHoles,
+                            clearance,
+                            segsPerCircle,
+                            correctionFactor );
             }
 
-            // Pads are removed from zone if the setup is PAD_ZONE_CONN_NONE
-            // or if they have a custom shape and not PAD_ZONE_CONN_FULL,
-            // because a thermal relief will break
-            // the shape
-            if( aZone->GetPadConnection( pad ) == PAD_ZONE_CONN_NONE
-                || ( pad->GetShape() == PAD_SHAPE_CUSTOM && aZone->GetPadConnection( pad ) != PAD_ZONE_CONN_FULL ) )
-            {
-                int gap = zone_clearance;
-                int thermalGap = aZone->GetThermalReliefGap( pad );
-                gap = std::max( gap, thermalGap );
-                item_boundingbox = pad->GetBoundingBox();
-                item_boundingbox.Inflate( gap );
+            return;
+        }
 
-                if( item_boundingbox.Intersects( zone_boundingbox ) )
+        // Pads are removed from zone if the setup is PAD_ZONE_CONN_NONE
+        // or if they have a custom shape and not PAD_ZONE_CONN_FULL,
+        // because a thermal relief will break
+        // the shape
+        if( aZone->GetPadConnection( pad ) == PAD_ZONE_CONN_NONE
+            || ( pad->GetShape() == PAD_SHAPE_CUSTOM && aZone->GetPadConnection( pad ) != PAD_ZONE_CONN_FULL ) )
+        {
+            int gap = zone_clearance;
+            int thermalGap = aZone->GetThermalReliefGap( pad );
+            gap = std::max( gap, thermalGap );
+            bbox = pad->GetBoundingBox();
+            bbox.Inflate( gap );
+
+            if( bbox.Intersects( zone_boundingbox ) )
+            {
+                // PAD_SHAPE_CUSTOM has a specific keepout, to avoid to break the shape
+                // the pad shape in zone can be its convex hull or the shape itself
+                if( pad->GetShape() == PAD_SHAPE_CUSTOM
+                    && pad->GetCustomShapeInZoneOpt() == CUST_PAD_SHAPE_IN_ZONE_CONVEXHULL )
                 {
-                    // PAD_SHAPE_CUSTOM has a specific keepout, to avoid to break the shape
-                    // the pad shape in zone can be its convex hull or the shape itself
-                    if( pad->GetShape() == PAD_SHAPE_CUSTOM
-                        && pad->GetCustomShapeInZoneOpt() == CUST_PAD_SHAPE_IN_ZONE_CONVEXHULL )
-                    {
-                        // the pad shape in zone can be its convex hull or
-                        // the shape itself
-                        SHAPE_POLY_SET outline( pad->GetCustomShapeAsPolygon() );
-                        outline.Inflate( KiROUND( gap * correctionFactor ), segsPerCircle );
-                        pad->CustomShapeAsPolygonToBoardPosition( &outline,
-                                pad->GetPosition(), pad->GetOrientation() );
+                    // the pad shape in zone can be its convex hull or
+                    // the shape itself
+                    SHAPE_POLY_SET outline( pad->GetCustomShapeAsPolygon() );
+                    outline.Inflate( KiROUND( gap * correctionFactor ), segsPerCircle );
+                    pad->CustomShapeAsPolygonToBoardPosition( &outline,
+                            pad->GetPosition(), pad->GetOrientation() );
 
-                        std::vector<wxPoint> convex_hull;
-                        BuildConvexHull( convex_hull, outline );
+                    std::vector<wxPoint> convex_hull;
+                    BuildConvexHull( convex_hull, outline );
 
-                        aFeatures.NewOutline();
+                    aHoles.NewOutline();
 
-                        for( unsigned ii = 0; ii < convex_hull.size(); ++ii )
-                            aFeatures.Append( convex_hull[ii] );
-                    }
-                    else
-                        pad->TransformShapeWithClearanceToPolygon( aFeatures,
-                                gap, segsPerCircle, correctionFactor );
+                    for( unsigned ii = 0; ii < convex_hull.size(); ++ii )
+                        aHoles.Append( convex_hull[ii] );
                 }
+                else
+                    pad->TransformShapeWithClearanceToPolygon( aHoles,
+                            gap, segsPerCircle, correctionFactor );
             }
         }
-    }
+    };
+
+    buildPolygonsByChunks( pads.size(), aFeatures, &aHoleList,
+            [&]( size_t aIndex, SHAPE_POLY_SET& aHoles )
+    {
+        D_PAD* pad = pads[aIndex];
+
+        if( pad->IsOnLayer( aZone->GetLayer() ) )
+        {
+            addPadHoles( pad, aHoles );
+            return;
+        }
+
+        /* Test for pads that are on top or bottom only and have a hole.
+         * There are curious pads but they can be used for some components that are
+         * inside the board (in fact inside the hole. Some photo diodes and Leds are
+         * like this)
+         */
+        if( pad->GetDrillSize().x == 0 && pad->GetDrillSize().y == 0 )
+            return;
+
+        /* Use a dummy pad to calculate hole clearance when a pad is not on all copper layers
+         * and this pad has a hole
+         * This dummy pad has the size and shape of the hole
+         * Therefore, this dummy pad is a circle or an oval.
+         * A pad must have a parent because some functions expect a non null parent
+         * to find the parent board, and some other data
+         */
+        MODULE  dummymodule( m_board );   // Creates a dummy parent
+        D_PAD   dummypad( &dummymodule );
+
+        dummypad.SetSize( pad->GetDrillSize() );
+        dummypad.SetOrientation( pad->GetOrientation() );
+        dummypad.SetShape( pad->GetDrillShape() == PAD_DRILL_SHAPE_OBLONG ?
+                PAD_SHAPE_OVAL : PAD_SHAPE_CIRCLE );
+        dummypad.SetPosition( pad->GetPosition() );
+
+        addPadHoles( &dummypad, aHoles );
+    } );
 
     /* Add holes (i.e. tracks and vias areas as polygons outlines)
      * in cornerBufferPolysToSubstract
      */
+    std::vector<TRACK*> tracks;
+
     for( auto track : m_board->Tracks() )
+        tracks.push_back( track );
+
+    buildPolygonsByChunks( tracks.size(), aFeatures, &aHoleList,
+            [&]( size_t aIndex, SHAPE_POLY_SET& aHoles )
     {
+        TRACK* track = tracks[aIndex];
+
         if( !track->IsOnLayer( aZone->GetLayer() ) )
-            continue;
+            return;
 
         if( track->GetNetCode() == aZone->GetNetCode()  && ( aZone->GetNetCode() != 0) )
-            continue;
+            return;
 
         int item_clearance = track->GetClearance() + outline_half_thickness;
-        item_boundingbox = track->GetBoundingBox();
+        EDA_RECT bbox = track->GetBoundingBox();
 
-        if( item_boundingbox.Intersects( zone_boundingbox ) )
+        if( bbox.Intersects( zone_boundingbox ) )
         {
             int clearance = std::max( zone_clearance, item_clearance );
-            track->TransformShapeWithClearanceToPolygon( aFeatures,
+            track->TransformShapeWithClearanceToPolygon( aHoles,
                     clearance,
                     segsPerCircle,
                     correctionFactor );
         }
-    }
+    } );
 
     /* Add module edge items that are on copper layers
      * Pcbnew allows these items to be on copper layers in microwave applictions
      * This is a bad thing, but must be handled here, until a better way is found
      */
+    std::vector<EDGE_MODULE*> moduleEdges;
+
     for( auto module : m_board->Modules() )
     {
         for( auto item : module->GraphicalItems() )
         {
-            if( !item->IsOnLayer( aZone->GetLayer() ) && !item->IsOnLayer( Edge_Cuts ) )
-                continue;
+            if( item->Type() == PCB_MODULE_EDGE_T )
+                moduleEdges.push_back( (EDGE_MODULE*) item );
+        }
+    }
 
-            if( item->Type() != PCB_MODULE_EDGE_T )
-                continue;
+    buildPolygonsByChunks( moduleEdges.size(), aFeatures, &aHoleList,
+            [&]( size_t aIndex, SHAPE_POLY_SET& aHoles )
+    {
+        EDGE_MODULE* item = moduleEdges[aIndex];
 
-            item_boundingbox = item->GetBoundingBox();
+        if( !item->IsOnLayer( aZone->GetLayer() ) && !item->IsOnLayer( Edge_Cuts ) )
+            return;
 
-            if( item_boundingbox.Intersects( zone_boundingbox ) )
-            {
-                int zclearance = zone_clearance;
+        if( item->GetBoundingBox().Intersects( zone_boundingbox ) )
+        {
+            int zclearance = zone_clearance;
 
-                if( item->IsOnLayer( Edge_Cuts ) )
-                    // use only the m_ZoneClearance, not the clearance using
-                    // the netclass value, because we do not have a copper item
-                    zclearance = zone_to_edgecut_clearance;
+            if( item->IsOnLayer( Edge_Cuts ) )
+                // use only the m_ZoneClearance, not the clearance using
+                // the netclass value, because we do not have a copper item
+                zclearance = zone_to_edgecut_clearance;
 
-                ( (EDGE_MODULE*) item )->TransformShapeWithClearanceToPolygon(
-                        aFeatures, zclearance, segsPerCircle, correctionFactor );
-            }
+            item->TransformShapeWithClearanceToPolygon(
+                    aHoles, zclearance, segsPerCircle, correctionFactor );
         }
-    }
+    } );
 
     // Add graphic items (copper texts) and board edges
     // Currently copper texts have no net, so only the zone_clearance
     // is used.
+    std::vector<BOARD_ITEM*> drawings;
+
     for( auto item : m_board->Drawings() )
+        drawings.push_back( item );
+
+    buildPolygonsByChunks( drawings.size(), aFeatures, &aHoleList,
+            [&]( size_t aIndex, SHAPE_POLY_SET& aHoles )
     {
+        BOARD_ITEM* item = drawings[aIndex];
+
         if( item->GetLayer() != aZone->GetLayer() && item->GetLayer() != Edge_Cuts )
-            continue;
+            return;
 
         int zclearance = zone_clearance;
 
@@ -568,40 +1075,39 @@ void ZONE_FILLER::buildZoneFeatureHoleList( const ZONE_CONTAINER* aZone,
         {
         case PCB_LINE_T:
             ( (DRAWSEGMENT*) item )->TransformShapeWithClearanceToPolygon(
-                    aFeatures,
+                    aHoles,
                     zclearance, segsPerCircle, correctionFactor );
             break;
 
         case PCB_TEXT_T:
             ( (TEXTE_PCB*) item )->TransformBoundingBoxWithClearanceToPolygon(
-                    aFeatures, zclearance );
+                    aHoles, zclearance );
             break;
 
         default:
             break;
         }
-    }
+    } );
 
     // Add zones outlines having an higher priority and keepout
-    for( int ii = 0; ii < m_board->GetAreaCount(); ii++ )
+    buildPolygonsByChunks( m_board->GetAreaCount(), aFeatures, &aHoleList,
+            [&]( size_t aIndex, SHAPE_POLY_SET& aHoles )
     {
-        ZONE_CONTAINER* zone = m_board->GetArea( ii );
+        ZONE_CONTAINER* zone = m_board->GetArea( aIndex );
 
         // If the zones share no common layers
         if( !aZone->CommonLayerExists( zone->GetLayerSet() ) )
-            continue;
+            return;
 
         if( !zone->GetIsKeepout() && zone->GetPriority() <= aZone->GetPriority() )
-            continue;
+            return;
 
         if( zone->GetIsKeepout() && !zone->GetDoNotAllowCopperPour() )
-            continue;
+            return;
 
         // A highter priority zone or keepout area is found: remove this area
-        item_boundingbox = zone->GetBoundingBox();
-
-        if( !item_boundingbox.Intersects( zone_boundingbox ) )
-            continue;
+        if( !zone->GetBoundingBox().Intersects( zone_boundingbox ) )
+            return;
 
         // Add the zone outline area.
         // However if the zone has the same net as the current zone,
@@ -628,44 +1134,44 @@ void ZONE_FILLER::buildZoneFeatureHoleList( const ZONE_CONTAINER* aZone,
         }
 
         zone->TransformOutlinesShapeWithClearanceToPolygon(
-                aFeatures, min_clearance, use_net_clearance );
-    }
+                aHoles, min_clearance, use_net_clearance );
+    } );
 
     // Remove thermal symbols
-    for( auto module : m_board->Modules() )
+    buildPolygonsByChunks( pads.size(), aFeatures, &aHoleList,
+            [&]( size_t aIndex, SHAPE_POLY_SET& aHoles )
     {
-        for( auto pad : module->Pads() )
-        {
-            // Rejects non-standard pads with tht-only thermal reliefs
-            if( aZone->GetPadConnection( pad ) == PAD_ZONE_CONN_THT_THERMAL
-                && pad->GetAttribute() != PAD_ATTRIB_STANDARD )
-                continue;
+        D_PAD* pad = pads[aIndex];
 
-            if( aZone->GetPadConnection( pad ) != PAD_ZONE_CONN_THERMAL
-                && aZone->GetPadConnection( pad ) != PAD_ZONE_CONN_THT_THERMAL )
-                continue;
+        // Rejects non-standard pads with tht-only thermal reliefs
+        if( aZone->GetPadConnection( pad ) == PAD_ZONE_CONN_THT_THERMAL
+            && pad->GetAttribute() != PAD_ATTRIB_STANDARD )
+            return;
 
-            if( !pad->IsOnLayer( aZone->GetLayer() ) )
-                continue;
+        if( aZone->GetPadConnection( pad ) != PAD_ZONE_CONN_THERMAL
+            && aZone->GetPadConnection( pad ) != PAD_ZONE_CONN_THT_THERMAL )
+            return;
 
-            if( pad->GetNetCode() != aZone->GetNetCode() )
-                continue;
+        if( !pad->IsOnLayer( aZone->GetLayer() ) )
+            return;
 
-            item_boundingbox = pad->GetBoundingBox();
-            int thermalGap = aZone->GetThermalReliefGap( pad );
-            item_boundingbox.Inflate( thermalGap, thermalGap );
+        if( pad->GetNetCode() != aZone->GetNetCode() )
+            return;
 
-            if( item_boundingbox.Intersects( zone_boundingbox ) )
-            {
-                CreateThermalReliefPadPolygon( aFeatures,
-                        *pad, thermalGap,
-                        aZone->GetThermalReliefCopperBridge( pad ),
-                        aZone->GetMinThickness(),
-                        segsPerCircle,
-                        correctionFactor, s_thermalRot );
-            }
+        EDA_RECT bbox = pad->GetBoundingBox();
+        int thermalGap = aZone->GetThermalReliefGap( pad );
+        bbox.Inflate( thermalGap, thermalGap );
+
+        if( bbox.Intersects( zone_boundingbox ) )
+        {
+            CreateThermalReliefPadPolygon( aHoles,
+                    *pad, thermalGap,
+                    aZone->GetThermalReliefCopperBridge( pad ),
+                    aZone->GetMinThickness(),
+                    segsPerCircle,
+                    correctionFactor, s_thermalRot );
         }
-    }
+    } );
 }
 
 /**
@@ -700,7 +1206,8 @@ void ZONE_FILLER::buildZoneFeatureHoleList( const ZONE_CONTAINER* aZone,
 void ZONE_FILLER::computeRawFilledAreas( const ZONE_CONTAINER* aZone,
         const SHAPE_POLY_SET& aSmoothedOutline,
         SHAPE_POLY_SET& aRawPolys,
-        SHAPE_POLY_SET& aFinalPolys ) const
+        SHAPE_POLY_SET& aFinalPolys,
+        std::shared_ptr<const ZONE_FILL_CACHE>& aFillCache ) const
 {
     int segsPerCircle;
     double correctionFactor;
@@ -728,29 +1235,62 @@ void ZONE_FILLER::computeRawFilledAreas( const ZONE_CONTAINER* aZone,
     solidAreas.Simplify( SHAPE_POLY_SET::PM_FAST );
 
     SHAPE_POLY_SET holes;
+    std::vector<ZONE_FILL_HOLE> holeList;
 
     if( s_DumpZonesWhenFilling )
         dumper->Write( &solidAreas, "solid-areas" );
 
-    buildZoneFeatureHoleList( aZone, holes );
+    buildZoneFeatureHoleList( aZone, holes, holeList );
 
     if( s_DumpZonesWhenFilling )
         dumper->Write( &holes, "feature-holes" );
 
-    holes.Simplify( SHAPE_POLY_SET::PM_FAST );
+    std::sort( holeList.begin(), holeList.end(),
+               []( const ZONE_FILL_HOLE& a, const ZONE_FILL_HOLE& b )
+               {
+                   return a.m_hash < b.m_hash;
+               } );
 
-    if( s_DumpZonesWhenFilling )
-        dumper->Write( &holes, "feature-holes-postsimplify" );
+    uint64_t outlineKey = hashPolygons( s_hashSeed, aSmoothedOutline, 0,
+                                        aSmoothedOutline.OutlineCount() );
+    outlineKey = ( outlineKey ^ (uint32_t) outline_half_thickness ) * s_hashPrime;
+    outlineKey = ( outlineKey ^ (uint32_t) segsPerCircle ) * s_hashPrime;
 
-    // Generate the filled areas (currently, without thermal shapes, which will
-    // be created later).
-    // Use SHAPE_POLY_SET::PM_STRICTLY_SIMPLE to generate strictly simple polygons
-    // needed by Gerber files and Fracture()
-    solidAreas.BooleanSubtract( holes, SHAPE_POLY_SET::PM_STRICTLY_SIMPLE );
+    // If the zone outline did not change since the previous fill, only the areas covered
+    // by the changed holes are recomputed
+    bool spliced = aFillCache && aFillCache->m_outlineKey == outlineKey
+                   && spliceChangedHoles( *aFillCache, holeList, holes, solidAreas );
+
+    if( !spliced )
+    {
+        // The round holes standing alone go through the booleans with a few vertices
+        std::vector<SHAPE_LINE_CHAIN> arcHoles;
+        replaceArcHoles( holes, holeList, solidAreas, arcHoles );
+
+        parallelSimplify( holes );
+
+        if( s_DumpZonesWhenFilling )
+            dumper->Write( &holes, "feature-holes-postsimplify" );
+
+        // Generate the filled areas (currently, without thermal shapes, which will
+        // be created later).
+        // Use SHAPE_POLY_SET::PM_STRICTLY_SIMPLE to generate strictly simple polygons
+        // needed by Gerber files and Fracture()
+        solidAreas.BooleanSubtract( holes, SHAPE_POLY_SET::PM_STRICTLY_SIMPLE );
+
+        if( !arcHoles.empty() )
+            restoreArcHoles( solidAreas, arcHoles );
+    }
 
     if( s_DumpZonesWhenFilling )
         dumper->Write( &solidAreas, "solid-areas-minus-holes" );
 
+    auto fillCache = std::make_shared<ZONE_FILL_CACHE>();
+    fillCache->m_outlineKey = outlineKey;
+    fillCache->m_solidAreas = solidAreas;
+    fillCache->m_holes = std::move( holeList );
+    aFillCache = fillCache;
+
     SHAPE_POLY_SET areas_fractured = solidAreas;
     areas_fractured.Fracture( SHAPE_POLY_SET::PM_FAST );
 
@@ -773,7 +1313,7 @@ void ZONE_FILLER::computeRawFilledAreas( const ZONE_CONTAINER* aZone,
     // remove copper areas corresponding to not connected stubs
     if( !thermalHoles.IsEmpty() )
     {
-        thermalHoles.Simplify( SHAPE_POLY_SET::PM_FAST );
+        parallelSimplify( thermalHoles );
         // Remove unconnected stubs. Use SHAPE_POLY_SET::PM_STRICTLY_SIMPLE to
         // generate strictly simple polygons
         // needed by Gerber files and Fracture()
@@ -803,7 +1343,8 @@ void ZONE_FILLER::computeRawFilledAreas( const ZONE_CONTAINER* aZone,
  * ( holes are linked by overlapping segments to the main outline)
  */
 bool ZONE_FILLER::fillSingleZone( const ZONE_CONTAINER* aZone, SHAPE_POLY_SET& aRawPolys,
-                                  SHAPE_POLY_SET& aFinalPolys ) const
+                                  SHAPE_POLY_SET& aFinalPolys,
+                                  std::shared_ptr<const ZONE_FILL_CACHE>& aFillCache ) const
 {
     SHAPE_POLY_SET smoothedPoly;
 
@@ -816,7 +1357,7 @@ bool ZONE_FILLER::fillSingleZone( const ZONE_CONTAINER* aZone, SHAPE_POLY_SET& a
 
     if( aZone->IsOnCopperLayer() )
     {
-        computeRawFilledAreas( aZone, smoothedPoly, aRawPolys, aFinalPolys );
+        computeRawFilledAreas( aZone, smoothedPoly, aRawPolys, aFinalPolys, aFillCache );
     }
     else
     {
@@ -824,6 +1365,7 @@ bool ZONE_FILLER::fillSingleZone( const ZONE_CONTAINER* aZone, SHAPE_POLY_SET& a
         aFinalPolys = smoothedPoly;
         aFinalPolys.Inflate( -aZone->GetMinThickness() / 2, 16 );
         aFinalPolys.Fracture( SHAPE_POLY_SET::PM_FAST );
+        aFillCache.reset();
     }
 
     return true;
@@ -1008,9 +1550,6 @@ void ZONE_FILLER::buildUnconnectedThermalStubsPolygonList( SHAPE_POLY_SET& aCorn
                                               double                aArcCorrection,
                                               double                aRoundPadThermalRotation ) const
 {
-    SHAPE_LINE_CHAIN spokes;
-    BOX2I itemBB;
-    VECTOR2I ptTest[4];
     auto zoneBB = aRawFilledArea.BBox();
 
 
@@ -1023,145 +1562,158 @@ void ZONE_FILLER::buildUnconnectedThermalStubsPolygonList( SHAPE_POLY_SET& aCorn
     // half size of the pen used to draw/plot zones outlines
     int pen_radius = aZone->GetMinThickness() / 2;
 
+    std::vector<D_PAD*> pads;
+
     for( auto module : m_board->Modules() )
     {
         for( auto pad : module->Pads() )
-        {
-            // Rejects non-standard pads with tht-only thermal reliefs
-            if( aZone->GetPadConnection( pad ) == PAD_ZONE_CONN_THT_THERMAL
-             && pad->GetAttribute() != PAD_ATTRIB_STANDARD )
-                continue;
-
-            if( aZone->GetPadConnection( pad ) != PAD_ZONE_CONN_THERMAL
-             && aZone->GetPadConnection( pad ) != PAD_ZONE_CONN_THT_THERMAL )
-                continue;
-
-            if( !pad->IsOnLayer( aZone->GetLayer() ) )
-                continue;
-
-            if( pad->GetNetCode() != aZone->GetNetCode() )
-                continue;
+            pads.push_back( pad );
+    }
 
-            // Calculate thermal bridge half width
-            int thermalBridgeWidth = aZone->GetThermalReliefCopperBridge( pad )
-                                     - aZone->GetMinThickness();
-            if( thermalBridgeWidth <= 0 )
-                continue;
+    // The aRawFilledArea.Contains() tests are the expensive part on large zones, so
+    // pads are handled by chunks on several threads
+    buildPolygonsByChunks( pads.size(), aCornerBuffer, nullptr,
+            [&]( size_t aIndex, SHAPE_POLY_SET& aStubs )
+    {
+        SHAPE_LINE_CHAIN spokes;
+        BOX2I itemBB;
+        VECTOR2I ptTest[4];
+        D_PAD* pad = pads[aIndex];
+
+        // Rejects non-standard pads with tht-only thermal reliefs
+        if( aZone->GetPadConnection( pad ) == PAD_ZONE_CONN_THT_THERMAL
+         && pad->GetAttribute() != PAD_ATTRIB_STANDARD )
+            return;
+
+        if( aZone->GetPadConnection( pad ) != PAD_ZONE_CONN_THERMAL
+         && aZone->GetPadConnection( pad ) != PAD_ZONE_CONN_THT_THERMAL )
+            return;
+
+        if( !pad->IsOnLayer( aZone->GetLayer() ) )
+            return;
+
+        if( pad->GetNetCode() != aZone->GetNetCode() )
+            return;
+
+        // Calculate thermal bridge half width
+        int thermalBridgeWidth = aZone->GetThermalReliefCopperBridge( pad )
+                                 - aZone->GetMinThickness();
+        if( thermalBridgeWidth <= 0 )
+            return;
+
+        // we need the thermal bridge half width
+        // with a small extra size to be sure we create a stub
+        // slightly larger than the actual stub
+        thermalBridgeWidth = ( thermalBridgeWidth + 4 ) / 2;
+
+        int thermalReliefGap = aZone->GetThermalReliefGap( pad );
+
+        itemBB = pad->GetBoundingBox();
+        itemBB.Inflate( thermalReliefGap );
+        if( !( itemBB.Intersects( zoneBB ) ) )
+            return;
+
+        // Thermal bridges are like a segment from a starting point inside the pad
+        // to an ending point outside the pad
+
+        // calculate the ending point of the thermal pad, outside the pad
+        VECTOR2I endpoint;
+        endpoint.x = ( pad->GetSize().x / 2 ) + thermalReliefGap;
+        endpoint.y = ( pad->GetSize().y / 2 ) + thermalReliefGap;
+
+        // Calculate the starting point of the thermal stub
+        // inside the pad
+        VECTOR2I startpoint;
+        int copperThickness = aZone->GetThermalReliefCopperBridge( pad )
+                              - aZone->GetMinThickness();
+
+        if( copperThickness < 0 )
+            copperThickness = 0;
+
+        // Leave a small extra size to the copper area inside to pad
+        copperThickness += KiROUND( IU_PER_MM * 0.04 );
+
+        startpoint.x = std::min( pad->GetSize().x, copperThickness );
+        startpoint.y = std::min( pad->GetSize().y, copperThickness );
+
+        startpoint.x /= 2;
+        startpoint.y /= 2;
+
+        // This is a CIRCLE pad tweak
+        // for circle pads, the thermal stubs orientation is 45 deg
+        double fAngle = pad->GetOrientation();
+        if( pad->GetShape() == PAD_SHAPE_CIRCLE )
+        {
+            endpoint.x     = KiROUND( endpoint.x * aArcCorrection );
+            endpoint.y     = endpoint.x;
+            fAngle = aRoundPadThermalRotation;
+        }
 
-            // we need the thermal bridge half width
-            // with a small extra size to be sure we create a stub
-            // slightly larger than the actual stub
-            thermalBridgeWidth = ( thermalBridgeWidth + 4 ) / 2;
+        // contour line width has to be taken into calculation to avoid "thermal stub bleed"
+        endpoint.x += pen_radius;
+        endpoint.y += pen_radius;
+        // compute north, south, west and east points for zone connection.
+        ptTest[0] = VECTOR2I( 0, endpoint.y );       // lower point
+        ptTest[1] = VECTOR2I( 0, -endpoint.y );      // upper point
+        ptTest[2] = VECTOR2I( endpoint.x, 0 );       // right point
+        ptTest[3] = VECTOR2I( -endpoint.x, 0 );      // left point
+
+        // Test all sides
+        for( int i = 0; i < 4; i++ )
+        {
+            // rotate point
+            RotatePoint( ptTest[i], fAngle );
 
-            int thermalReliefGap = aZone->GetThermalReliefGap( pad );
+            // translate point
+            ptTest[i] += pad->ShapePos();
 
-            itemBB = pad->GetBoundingBox();
-            itemBB.Inflate( thermalReliefGap );
-            if( !( itemBB.Intersects( zoneBB ) ) )
+            if( aRawFilledArea.Contains( ptTest[i] ) )
                 continue;
 
-            // Thermal bridges are like a segment from a starting point inside the pad
-            // to an ending point outside the pad
-
-            // calculate the ending point of the thermal pad, outside the pad
-            VECTOR2I endpoint;
-            endpoint.x = ( pad->GetSize().x / 2 ) + thermalReliefGap;
-            endpoint.y = ( pad->GetSize().y / 2 ) + thermalReliefGap;
-
-            // Calculate the starting point of the thermal stub
-            // inside the pad
-            VECTOR2I startpoint;
-            int copperThickness = aZone->GetThermalReliefCopperBridge( pad )
-                                  - aZone->GetMinThickness();
-
-            if( copperThickness < 0 )
-                copperThickness = 0;
+            spokes.Clear();
 
-            // Leave a small extra size to the copper area inside to pad
-            copperThickness += KiROUND( IU_PER_MM * 0.04 );
-
-            startpoint.x = std::min( pad->GetSize().x, copperThickness );
-            startpoint.y = std::min( pad->GetSize().y, copperThickness );
-
-            startpoint.x /= 2;
-            startpoint.y /= 2;
-
-            // This is a CIRCLE pad tweak
-            // for circle pads, the thermal stubs orientation is 45 deg
-            double fAngle = pad->GetOrientation();
-            if( pad->GetShape() == PAD_SHAPE_CIRCLE )
+            // polygons are rectangles with width of copper bridge value
+            switch( i )
             {
-                endpoint.x     = KiROUND( endpoint.x * aArcCorrection );
-                endpoint.y     = endpoint.x;
-                fAngle = aRoundPadThermalRotation;
+            case 0:       // lower stub
+                spokes.Append( -thermalBridgeWidth, endpoint.y );
+                spokes.Append( +thermalBridgeWidth, endpoint.y );
+                spokes.Append( +thermalBridgeWidth, startpoint.y );
+                spokes.Append( -thermalBridgeWidth, startpoint.y );
+                break;
+
+            case 1:       // upper stub
+                spokes.Append( -thermalBridgeWidth, -endpoint.y );
+                spokes.Append( +thermalBridgeWidth, -endpoint.y );
+                spokes.Append( +thermalBridgeWidth, -startpoint.y );
+                spokes.Append( -thermalBridgeWidth, -startpoint.y );
+                break;
+
+            case 2:       // right stub
+                spokes.Append( endpoint.x, -thermalBridgeWidth );
+                spokes.Append( endpoint.x, thermalBridgeWidth );
+                spokes.Append( +startpoint.x, thermalBridgeWidth );
+                spokes.Append( +startpoint.x, -thermalBridgeWidth );
+                break;
+
+            case 3:       // left stub
+                spokes.Append( -endpoint.x, -thermalBridgeWidth );
+                spokes.Append( -endpoint.x, thermalBridgeWidth );
+                spokes.Append( -startpoint.x, thermalBridgeWidth );
+                spokes.Append( -startpoint.x, -thermalBridgeWidth );
+                break;
             }
 
-            // contour line width has to be taken into calculation to avoid "thermal stub bleed"
-            endpoint.x += pen_radius;
-            endpoint.y += pen_radius;
-            // compute north, south, west and east points for zone connection.
-            ptTest[0] = VECTOR2I( 0, endpoint.y );       // lower point
-            ptTest[1] = VECTOR2I( 0, -endpoint.y );      // upper point
-            ptTest[2] = VECTOR2I( endpoint.x, 0 );       // right point
-            ptTest[3] = VECTOR2I( -endpoint.x, 0 );      // left point
-
-            // Test all sides
-            for( int i = 0; i < 4; i++ )
-            {
-                // rotate point
-                RotatePoint( ptTest[i], fAngle );
-
-                // translate point
-                ptTest[i] += pad->ShapePos();
+            aStubs.NewOutline();
 
-                if( aRawFilledArea.Contains( ptTest[i] ) )
-                    continue;
-
-                spokes.Clear();
-
-                // polygons are rectangles with width of copper bridge value
-                switch( i )
-                {
-                case 0:       // lower stub
-                    spokes.Append( -thermalBridgeWidth, endpoint.y );
-                    spokes.Append( +thermalBridgeWidth, endpoint.y );
-                    spokes.Append( +thermalBridgeWidth, startpoint.y );
-                    spokes.Append( -thermalBridgeWidth, startpoint.y );
-                    break;
-
-                case 1:       // upper stub
-                    spokes.Append( -thermalBridgeWidth, -endpoint.y );
-                    spokes.Append( +thermalBridgeWidth, -endpoint.y );
-                    spokes.Append( +thermalBridgeWidth, -startpoint.y );
-                    spokes.Append( -thermalBridgeWidth, -startpoint.y );
-                    break;
-
-                case 2:       // right stub
-                    spokes.Append( endpoint.x, -thermalBridgeWidth );
-                    spokes.Append( endpoint.x, thermalBridgeWidth );
-                    spokes.Append( +startpoint.x, thermalBridgeWidth );
-                    spokes.Append( +startpoint.x, -thermalBridgeWidth );
-                    break;
-
-                case 3:       // left stub
-                    spokes.Append( -endpoint.x, -thermalBridgeWidth );
-                    spokes.Append( -endpoint.x, thermalBridgeWidth );
-                    spokes.Append( -startpoint.x, thermalBridgeWidth );
-                    spokes.Append( -startpoint.x, -thermalBridgeWidth );
-                    break;
-                }
-
-                aCornerBuffer.NewOutline();
-
-                // add computed polygon to list
-                for( int ic = 0; ic < spokes.PointCount(); ic++ )
-                {
-                    auto cpos = spokes.CPoint( ic );
-                    RotatePoint( cpos, fAngle );                               // Rotate according to module orientation
-                    cpos += pad->ShapePos();                              // Shift origin to position
-                    aCornerBuffer.Append( cpos );
-                }
+            // add computed polygon to list
+            for( int ic = 0; ic < spokes.PointCount(); ic++ )
+            {
+                auto cpos = spokes.CPoint( ic );
+                RotatePoint( cpos, fAngle );                               // Rotate according to module orientation
+                cpos += pad->ShapePos();                              // Shift origin to position
+                aStubs.Append( cpos );
             }
         }
-    }
+    } );
 }
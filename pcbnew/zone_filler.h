@@ -26,6 +26,8 @@
 #ifndef __ZONE_FILLER_H
 #define __ZONE_FILLER_H
 
+#include <cstdint>
+#include <memory>
 #include <vector>
 #include <class_zone.h>
 
@@ -35,6 +37,32 @@ class COMMIT;
 class SHAPE_POLY_SET;
 class SHAPE_LINE_CHAIN;
 
+/**
+ * Hole polygons added to a zone fill by one board item.
+ */
+struct ZONE_FILL_HOLE
+{
+    uint64_t m_hash;                ///< hash of the polygon coordinates
+    BOX2I    m_bbox;                ///< bounding box of the polygons
+    int      m_firstOutline;        ///< index of the first polygon in the hole list
+    int      m_outlineCount;        ///< number of polygons
+};
+
+
+/**
+ * Data kept in a zone between two fills, to refill only the areas affected by the board
+ * changes.  The copper area before the thermal stub removal depends only on the zone
+ * outline and fill parameters (m_outlineKey) and on the holes, so the next fill compares
+ * its holes with m_holes and recomputes only the areas covered by the changed ones.
+ */
+struct ZONE_FILL_CACHE
+{
+    uint64_t                    m_outlineKey;   ///< hash of the outline and fill parameters
+    SHAPE_POLY_SET              m_solidAreas;   ///< copper area, thermal stubs not removed
+    std::vector<ZONE_FILL_HOLE> m_holes;        ///< holes, sorted by hash
+};
+
+
 class ZONE_FILLER
 {
 public:
@@ -46,8 +74,13 @@ public:
 
 private:
 
+    /**
+     * Builds the polygons of the items (with clearance) to remove from a zone.
+     * @param aFeatures receives the hole polygons (not merged).
+     * @param aHoleList receives the polygons added by each item.
+     */
     void buildZoneFeatureHoleList( const ZONE_CONTAINER* aZone,
-            SHAPE_POLY_SET& aFeatures ) const;
+            SHAPE_POLY_SET& aFeatures, std::vector<ZONE_FILL_HOLE>& aHoleList ) const;
 
     /**
      * Function computeRawFilledAreas
@@ -59,12 +92,15 @@ private:
      * BuildFilledSolidAreasPolygons() call this function just after creating the
      *  filled copper area polygon (without clearance areas
      * @param aPcb: the current board
+     * @param aFillCache: the fill cache of the previous fill of the zone (can be null), only
+     * the areas affected by the holes changed since are recomputed.  Receives the new cache.
      * _NG version uses SHAPE_POLY_SET instead of Boost.Polygon
      */
     void computeRawFilledAreas( const ZONE_CONTAINER* aZone,
             const SHAPE_POLY_SET& aSmoothedOutline,
             SHAPE_POLY_SET& aRawPolys,
-            SHAPE_POLY_SET& aFinalPolys ) const;
+            SHAPE_POLY_SET& aFinalPolys,
+            std::shared_ptr<const ZONE_FILL_CACHE>& aFillCache ) const;
 
     bool fillPolygonWithHorizontalSegments( const SHAPE_LINE_CHAIN& aPolygon,
             ZONE_SEGMENT_FILL& aFillSegmList, int aStep ) const;
@@ -110,19 +146,20 @@ private:
      * (holes are linked to main outline by overlapping segments, and these polygons are shrinked
      * by aZone->GetMinThickness() / 2 to be drawn with a outline thickness = aZone->GetMinThickness()
      * aFinalPolys are polygons that will be drawn on screen and plotted
+     * @param aFillCache: the fill cache of the previous fill (can be null), receives the
+     * new one (see computeRawFilledAreas)
      */
     bool fillSingleZone( const ZONE_CONTAINER* aZone,
             SHAPE_POLY_SET& aRawPolys,
-            SHAPE_POLY_SET& aFinalPolys ) const;
+            SHAPE_POLY_SET& aFinalPolys,
+            std::shared_ptr<const ZONE_FILL_CACHE>& aFillCache ) const;
 
     BOARD* m_board;
     COMMIT* m_commit;
     WX_PROGRESS_REPORTER* m_progressReporter;
 
-    std::atomic_size_t m_next;          // An index into the vector of zones to fill.
-                                        // Used by the variuos parallel thread sets during
-                                        // fill operations.
-    std::atomic_size_t m_count_done;
+    std::atomic_size_t m_count_done;    // Count of zones done by the fill and triangulation
+                                        // tasks, polled to refresh the progress reporter.
 };
 
 #endif
@@ -0,0 +1,107 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * SEG_BATCH microbenchmark.
+ *
+ * Usage: seg_batch_bench [segments] [queries]
+ *
+ * Tests random queries against a batch of random segments of board sizes, with a loop of
+ * SEG::Collide() and with each SEG_BATCH kernel the CPU runs, and prints the times.
+ */
+
+#include <geometry/seg_batch.h>
+#include <profile.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+
+static std::vector<SEG> randomSegs( std::mt19937& aRng, int aCount, int aMaxLength )
+{
+    std::uniform_int_distribution<int> pos( -100000000, 100000000 );
+    std::uniform_int_distribution<int> delta( -aMaxLength, aMaxLength );
+    std::vector<SEG> segs;
+
+    for( int ii = 0; ii < aCount; ii++ )
+    {
+        VECTOR2I a( pos( aRng ), pos( aRng ) );
+        segs.push_back( SEG( a, a + VECTOR2I( delta( aRng ), delta( aRng ) ) ) );
+    }
+
+    return segs;
+}
+
+
+int main( int argc, char *argv[] )
+{
+    int segCount = argc > 1 ? atoi( argv[1] ) : 10000;
+    int queryCount = argc > 2 ? atoi( argv[2] ) : 1000;
+    const int clearance = 200000;
+
+    std::mt19937 rng( 1 );
+    std::vector<SEG> segs = randomSegs( rng, segCount, 2000000 );
+    std::vector<SEG> queries = randomSegs( rng, queryCount, 2000000 );
+
+    SEG_BATCH batch;
+
+    for( const SEG& seg : segs )
+        batch.Add( seg );
+
+    size_t collisions = 0;
+
+    PROF_COUNTER scalarLoop( "SEG::Collide loop" );
+
+    for( const SEG& query : queries )
+    {
+        for( const SEG& seg : segs )
+            collisions += seg.Collide( query, clearance ) ? 1 : 0;
+    }
+
+    scalarLoop.Stop();
+
+    printf( "%d segments, %d queries, %zu collisions\n\n", segCount, queryCount, collisions );
+    printf( "%-20s %10.3f ms\n", "SEG::Collide loop", scalarLoop.msecs() );
+
+    const char* names[] = { "SEG_BATCH scalar", "SEG_BATCH SSE2", "SEG_BATCH AVX2" };
+
+    for( int kernel = SEG_BATCH::KERNEL_SCALAR; kernel <= SEG_BATCH::BestKernel(); kernel++ )
+    {
+        SEG_BATCH::SetKernel( (SEG_BATCH::KERNEL) kernel );
+
+        std::vector<int> found;
+
+        PROF_COUNTER cnt( names[kernel] );
+
+        for( const SEG& query : queries )
+            batch.CollideAll( query, clearance, found );
+
+        cnt.Stop();
+
+        printf( "%-20s %10.3f ms (%zu collisions)\n", names[kernel], cnt.msecs(), found.size() );
+    }
+
+    return 0;
+}
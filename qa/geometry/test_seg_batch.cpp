@@ -0,0 +1,235 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see CHANGELOG.TXT for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <geometry/seg_batch.h>
+
+#include <random>
+#include <vector>
+
+struct SegBatchFixture
+{
+    SegBatchFixture() :
+        m_rng( 4242 )
+    {
+    }
+
+    ~SegBatchFixture()
+    {
+        SEG_BATCH::SetKernel( SEG_BATCH::BestKernel() );
+    }
+
+    SEG randomSeg( int aRange, int aMaxLength )
+    {
+        std::uniform_int_distribution<int> pos( -aRange, aRange );
+        std::uniform_int_distribution<int> delta( -aMaxLength, aMaxLength );
+
+        VECTOR2I a( pos( m_rng ), pos( m_rng ) );
+
+        return SEG( a, a + VECTOR2I( delta( m_rng ), delta( m_rng ) ) );
+    }
+
+    /**
+     * Checks all the queries of a batch against the SEG methods, with all the kernels
+     * the CPU runs.
+     */
+    void checkBatch( const std::vector<SEG>& aSegs, const std::vector<SEG>& aQueries,
+                     const std::vector<int>& aClearances )
+    {
+        SEG_BATCH batch;
+
+        for( const SEG& seg : aSegs )
+            batch.Add( seg );
+
+        for( int kernel = SEG_BATCH::KERNEL_SCALAR; kernel <= SEG_BATCH::BestKernel(); kernel++ )
+        {
+            SEG_BATCH::SetKernel( (SEG_BATCH::KERNEL) kernel );
+
+            for( const SEG& query : aQueries )
+            {
+                for( int clearance : aClearances )
+                {
+                    std::vector<int> expected, found;
+
+                    for( size_t ii = 0; ii < aSegs.size(); ii++ )
+                    {
+                        if( aSegs[ii].Collide( query, clearance ) )
+                            expected.push_back( ii );
+                    }
+
+                    batch.CollideAll( query, clearance, found );
+
+                    BOOST_CHECK( found == expected );
+                    BOOST_CHECK_EQUAL( batch.Collide( query, clearance ),
+                                       expected.empty() ? -1 : expected[0] );
+                }
+
+                int  expectedIndex = 0;
+                auto expectedDist = aSegs[0].SquaredDistance( query );
+
+                for( size_t ii = 1; ii < aSegs.size(); ii++ )
+                {
+                    auto dist = aSegs[ii].SquaredDistance( query );
+
+                    if( dist < expectedDist )
+                    {
+                        expectedDist = dist;
+                        expectedIndex = ii;
+                    }
+                }
+
+                int index = -1;
+
+                BOOST_CHECK_EQUAL( batch.SquaredDistance( query, &index ), expectedDist );
+                BOOST_CHECK_EQUAL( index, expectedIndex );
+            }
+        }
+    }
+
+    std::mt19937 m_rng;
+};
+
+
+BOOST_FIXTURE_TEST_SUITE( SegBatch, SegBatchFixture )
+
+
+/**
+ * The kernel can be forced, but not to one the CPU does not run
+ */
+BOOST_AUTO_TEST_CASE( KernelSelection )
+{
+    SEG_BATCH::SetKernel( SEG_BATCH::KERNEL_SCALAR );
+    BOOST_CHECK_EQUAL( SEG_BATCH::GetKernel(), SEG_BATCH::KERNEL_SCALAR );
+
+    SEG_BATCH::SetKernel( SEG_BATCH::KERNEL_AVX2 );
+    BOOST_CHECK_EQUAL( SEG_BATCH::GetKernel(), SEG_BATCH::BestKernel() );
+}
+
+
+/**
+ * Random segments of board sizes, tested with usual clearances
+ */
+BOOST_AUTO_TEST_CASE( RandomBoardScale )
+{
+    std::vector<SEG> segs, queries;
+
+    for( int ii = 0; ii < 1000; ii++ )
+        segs.push_back( randomSeg( 100000000, 5000000 ) );
+
+    for( int ii = 0; ii < 50; ii++ )
+        queries.push_back( randomSeg( 100000000, 20000000 ) );
+
+    checkBatch( segs, queries, { 0, 1, 200000, 2000000 } );
+}
+
+
+/**
+ * Short segments close together, where the tolerances of the kernels matter
+ */
+BOOST_AUTO_TEST_CASE( RandomCloseRange )
+{
+    std::vector<SEG> segs, queries;
+
+    for( int ii = 0; ii < 1000; ii++ )
+        segs.push_back( randomSeg( 50, 20 ) );
+
+    for( int ii = 0; ii < 200; ii++ )
+        queries.push_back( randomSeg( 50, 20 ) );
+
+    checkBatch( segs, queries, { 0, 1, 2, 3, 4, 5, 7, 10 } );
+}
+
+
+/**
+ * Chained, collinear, degenerate and nearly axis aligned segments
+ */
+BOOST_AUTO_TEST_CASE( SpecialCases )
+{
+    std::vector<SEG> segs = {
+        SEG( 0, 0, 1000, 0 ),           // chain
+        SEG( 1000, 0, 1000, 1000 ),
+        SEG( 1000, 1000, 2000, 2000 ),
+        SEG( 2000, 2000, 3000, 2000 ),
+        SEG( 3000, 2000, 5000, 2000 ),  // collinear with the previous one
+        SEG( 500, 500, 500, 500 ),      // points
+        SEG( -7, 3, -7, 3 ),
+        SEG( 0, 10, 1, 1000 ),          // slopes badly measured by SEG::PointCloserThan()
+        SEG( 10, 0, 1000, 1 ),
+        SEG( 0, 0, 1, 3 ),
+        SEG( 0, 0, 2, 1 ),
+        SEG( 0, 0, 100, 101 ),          // nearly diagonal
+        SEG( 1000000000, 0, -1000000000, 1 ),   // far from the origin
+        SEG( 1200000000, 1200000000, 1200000100, 1200000101 )
+    };
+
+    std::vector<SEG> queries = segs;
+
+    queries.push_back( SEG( 0, -1, 5000, -1 ) );
+    queries.push_back( SEG( 1000, 1, 1000, 999 ) );
+    queries.push_back( SEG( 3, 3, 3, 3 ) );
+    queries.push_back( SEG( 1, 1001, 0, 11 ) );
+    queries.push_back( SEG( -1000000000, -1000000000, 1000000000, 1000000000 ) );
+
+    checkBatch( segs, queries, { 0, 1, 2, 5, 100, 1000 } );
+}
+
+
+/**
+ * Batches not filling the vector lanes, and queries starting past the first segment
+ */
+BOOST_AUTO_TEST_CASE( SizesAndStart )
+{
+    for( int size = 1; size < 12; size++ )
+    {
+        std::vector<SEG> segs, queries;
+
+        for( int ii = 0; ii < size; ii++ )
+            segs.push_back( randomSeg( 1000, 500 ) );
+
+        for( int ii = 0; ii < 20; ii++ )
+            queries.push_back( randomSeg( 1000, 500 ) );
+
+        checkBatch( segs, queries, { 0, 100 } );
+
+        SEG_BATCH batch;
+
+        for( const SEG& seg : segs )
+            batch.Add( seg );
+
+        for( int start = 0; start <= size; start++ )
+        {
+            int expected = -1;
+
+            for( int ii = start; ii < size && expected < 0; ii++ )
+            {
+                if( segs[ii].Collide( queries[0], 100 ) )
+                    expected = ii;
+            }
+
+            BOOST_CHECK_EQUAL( batch.Collide( queries[0], 100, start ), expected );
+        }
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,233 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see CHANGELOG.TXT for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <geometry/shape_line_chain.h>
+
+#include <climits>
+#include <cmath>
+#include <random>
+
+/**
+ * Checks the queries of large line chains, which use a SEG_GRID, against the plain loops
+ * over all the segments.
+ */
+struct SegGridFixture
+{
+    SegGridFixture() :
+        m_rng( 1234 )
+    {
+    }
+
+    ///> A star shaped closed outline with aCount vertices at random radii
+    SHAPE_LINE_CHAIN randomOutline( int aCount, int aRadius )
+    {
+        std::uniform_int_distribution<int> radius( aRadius / 2, aRadius );
+        SHAPE_LINE_CHAIN chain;
+
+        for( int i = 0; i < aCount; i++ )
+        {
+            double angle = 2.0 * M_PI * i / aCount;
+            int    r = radius( m_rng );
+
+            chain.Append( VECTOR2I( r * cos( angle ), r * sin( angle ) ) );
+        }
+
+        chain.SetClosed( true );
+
+        return chain;
+    }
+
+    VECTOR2I randomPoint( int aRange )
+    {
+        std::uniform_int_distribution<int> pos( -aRange, aRange );
+
+        return VECTOR2I( pos( m_rng ), pos( m_rng ) );
+    }
+
+    static bool refPointInside( const SHAPE_LINE_CHAIN& aChain, const VECTOR2I& aP )
+    {
+        if( !aChain.BBox().Contains( aP ) )
+            return false;
+
+        bool inside = false;
+
+        for( int i = 0; i < aChain.PointCount(); i++ )
+        {
+            const VECTOR2D p1 = aChain.CPoint( i );
+            const VECTOR2D p2 = aChain.CPoint( i + 1 );
+            const VECTOR2D diff = p2 - p1;
+
+            if( ( ( p1.y > aP.y ) != ( p2.y > aP.y ) ) &&
+                    ( aP.x - p1.x < ( diff.x / diff.y ) * ( aP.y - p1.y ) ) )
+                inside = !inside;
+        }
+
+        return inside;
+    }
+
+    static int refDistance( const SHAPE_LINE_CHAIN& aChain, const VECTOR2I& aP, int& aNearest )
+    {
+        int d = INT_MAX;
+
+        aNearest = 0;
+
+        for( int s = 0; s < aChain.SegmentCount(); s++ )
+        {
+            int sd = aChain.CSegment( s ).Distance( aP );
+
+            if( sd < d )
+            {
+                d = sd;
+                aNearest = s;
+            }
+        }
+
+        return d;
+    }
+
+    static bool refCollide( const SHAPE_LINE_CHAIN& aChain, const SEG& aSeg, int aClearance )
+    {
+        BOX2I box_a( aSeg.A, aSeg.B - aSeg.A );
+        BOX2I::ecoord_type dist_sq = (BOX2I::ecoord_type) aClearance * aClearance;
+
+        for( int i = 0; i < aChain.SegmentCount(); i++ )
+        {
+            const SEG s = aChain.CSegment( i );
+            BOX2I box_b( s.A, s.B - s.A );
+
+            if( box_a.SquaredDistance( box_b ) < dist_sq && s.Collide( aSeg, aClearance ) )
+                return true;
+        }
+
+        return false;
+    }
+
+    std::mt19937 m_rng;
+};
+
+
+BOOST_FIXTURE_TEST_SUITE( SegGrid, SegGridFixture )
+
+
+BOOST_AUTO_TEST_CASE( PointQueries )
+{
+    const int radius = 10000000;
+    SHAPE_LINE_CHAIN chain = randomOutline( 5000, radius );
+
+    for( int i = 0; i < 2000; i++ )
+    {
+        VECTOR2I p = randomPoint( radius + radius / 10 );
+        int      refNearest;
+        int      refDist = refDistance( chain, p, refNearest );
+
+        BOOST_CHECK_EQUAL( chain.PointInside( p ), refPointInside( chain, p ) );
+        BOOST_CHECK_EQUAL( chain.Distance( p, true ), refDist );
+        BOOST_CHECK( chain.NearestPoint( p ) == chain.CSegment( refNearest ).NearestPoint( p ) );
+        BOOST_CHECK_EQUAL( chain.CheckClearance( p, 200000 ), refDist <= 200000 );
+    }
+
+    // Points on the outline
+    for( int i = 0; i < chain.PointCount(); i += 7 )
+    {
+        const VECTOR2I& p = chain.CPoint( i );
+
+        BOOST_CHECK_EQUAL( chain.PointInside( p ), refPointInside( chain, p ) );
+        BOOST_CHECK_EQUAL( chain.Distance( p, true ), 0 );
+        BOOST_CHECK_EQUAL( chain.FindSegment( p ), i == 0 ? 0 : i - 1 );
+    }
+}
+
+
+BOOST_AUTO_TEST_CASE( SegmentQueries )
+{
+    const int radius = 10000000;
+    SHAPE_LINE_CHAIN chain = randomOutline( 5000, radius );
+
+    for( int i = 0; i < 500; i++ )
+    {
+        VECTOR2I a = randomPoint( radius + radius / 10 );
+        SEG      seg( a, a + randomPoint( radius / 5 ) );
+
+        for( int clearance : { 0, 1000, 100000 } )
+            BOOST_CHECK_EQUAL( chain.Collide( seg, clearance ), refCollide( chain, seg, clearance ) );
+
+        SHAPE_LINE_CHAIN::INTERSECTIONS found;
+        int count = 0;
+
+        for( int s = 0; s < chain.SegmentCount(); s++ )
+            count += chain.CSegment( s ).Intersect( seg ) ? 1 : 0;
+
+        BOOST_CHECK_EQUAL( chain.Intersect( seg, found ), count );
+    }
+
+    // Segments across the outline, tested with the SEG_BATCH of the grid
+    for( int i = 0; i < 200; i++ )
+    {
+        SEG seg( randomPoint( radius ), randomPoint( radius ) );
+
+        for( int clearance : { 1000, 100000, radius / 2 } )
+            BOOST_CHECK_EQUAL( chain.Collide( seg, clearance ), refCollide( chain, seg, clearance ) );
+
+        // Inside the outline, with a clearance reaching many segments but not colliding
+        SEG inner( randomPoint( radius / 4 ), randomPoint( radius / 4 ) );
+
+        BOOST_CHECK_EQUAL( chain.Collide( inner, radius / 8 ),
+                           refCollide( chain, inner, radius / 8 ) );
+    }
+}
+
+
+/**
+ * The grid is dropped when the chain changes, and shared with its copies
+ */
+BOOST_AUTO_TEST_CASE( Invalidation )
+{
+    SHAPE_LINE_CHAIN chain = randomOutline( 1000, 1000000 );
+    VECTOR2I         far( 5000000, 0 );
+
+    BOOST_CHECK( !chain.PointInside( far ) );
+
+    SHAPE_LINE_CHAIN copy( chain );
+
+    chain.Point( 0 ) = VECTOR2I( 6000000, 0 );
+    BOOST_CHECK( chain.PointInside( far ) );
+    BOOST_CHECK( !copy.PointInside( far ) );
+
+    copy.Move( VECTOR2I( 5000000, 0 ) );
+    BOOST_CHECK( copy.PointInside( far ) );
+
+    int nearest;
+    BOOST_CHECK_EQUAL( copy.Distance( VECTOR2I( 0, 0 ), true ),
+                       refDistance( copy, VECTOR2I( 0, 0 ), nearest ) );
+
+    copy.Append( VECTOR2I( 0, 0 ) );
+    BOOST_CHECK_EQUAL( copy.Distance( VECTOR2I( 0, 0 ), true ), 0 );
+
+    copy.Remove( -1 );
+    copy.SetClosed( false );
+    BOOST_CHECK( !copy.PointInside( far ) );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
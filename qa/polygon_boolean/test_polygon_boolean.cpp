@@ -0,0 +1,292 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * Benchmark of the polygon boolean operations on the workloads of a real board.
+ *
+ * Usage: test_polygon_boolean board.kicad_pcb [runs]
+ *
+ * Runs, with and without the fast path of SHAPE_POLY_SET booleans (see
+ * SHAPE_POLY_SET::EnableFastBooleans()):
+ *  - courtyards: the overlapping courtyard test of the DRC, intersecting all the pairs of
+ *    courtyards on the same side,
+ *  - pad clearances: intersects the clearance area of each pad with the pads it may touch,
+ *  - zone knockouts: removes from each zone outline the clearance areas of the pads as the
+ *    zone filler does.
+ * The best time of each workload is printed, with a check that both runs got the same area.
+ */
+
+#include <io_mgr.h>
+#include <kicad_plugin.h>
+
+#include <class_board.h>
+#include <class_module.h>
+#include <class_zone.h>
+#include <geometry/geometry_utils.h>
+#include <geometry/shape_poly_set.h>
+#include <pcbnew.h>
+#include <profile.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+
+
+BOARD* loadBoard( const std::string& filename )
+{
+    PLUGIN::RELEASER pi( new PCB_IO );
+    BOARD* brd = nullptr;
+
+    try
+    {
+        brd = pi->Load( wxString( filename.c_str() ), NULL, NULL );
+    }
+    catch( const IO_ERROR& ioe )
+    {
+        wxString msg = wxString::Format( _( "Error loading board.\n%s" ),
+                ioe.Problem() );
+
+        printf( "%s\n", (const char*) msg.mb_str() );
+        return nullptr;
+    }
+
+    return brd;
+}
+
+
+static double area( const SHAPE_POLY_SET& aSet )
+{
+    double area = 0.0;
+
+    for( int i = 0; i < aSet.OutlineCount(); i++ )
+    {
+        area += std::abs( aSet.COutline( i ).Area() );
+
+        for( int j = 0; j < aSet.HoleCount( i ); j++ )
+            area -= std::abs( aSet.CHole( i, j ).Area() );
+    }
+
+    return area;
+}
+
+
+static void courtyards( BOARD* aBoard, double& aArea, int& aOps )
+{
+    SHAPE_POLY_SET courtyard;
+
+    for( int side = 0; side < 2; side++ )
+    {
+        for( MODULE* footprint = aBoard->m_Modules; footprint; footprint = footprint->Next() )
+        {
+            SHAPE_POLY_SET& fpCourtyard = side ? footprint->GetPolyCourtyardBack()
+                                               : footprint->GetPolyCourtyardFront();
+
+            if( fpCourtyard.OutlineCount() == 0 )
+                continue;
+
+            for( MODULE* candidate = footprint->Next(); candidate; candidate = candidate->Next() )
+            {
+                SHAPE_POLY_SET& candCourtyard = side ? candidate->GetPolyCourtyardBack()
+                                                     : candidate->GetPolyCourtyardFront();
+
+                if( candCourtyard.OutlineCount() == 0 )
+                    continue;
+
+                courtyard.RemoveAllContours();
+                courtyard.Append( fpCourtyard );
+                courtyard.BooleanIntersection( candCourtyard, SHAPE_POLY_SET::PM_FAST );
+
+                aArea += area( courtyard );
+                aOps++;
+            }
+        }
+    }
+}
+
+
+static void padClearances( const std::vector<D_PAD*>& aPads,
+                           const std::vector<SHAPE_POLY_SET>& aPadPolys,
+                           const std::vector<SHAPE_POLY_SET>& aClearancePolys,
+                           double& aArea, int& aOps )
+{
+    for( size_t ii = 0; ii < aPads.size(); ii++ )
+    {
+        BOX2I box = aClearancePolys[ii].BBox();
+
+        for( size_t jj = ii + 1; jj < aPads.size(); jj++ )
+        {
+            if( ( aPads[ii]->GetLayerSet() & aPads[jj]->GetLayerSet() ).none() )
+                continue;
+
+            if( !box.Intersects( aPadPolys[jj].BBox() ) )
+                continue;
+
+            SHAPE_POLY_SET overlap;
+            overlap.BooleanIntersection( aClearancePolys[ii], aPadPolys[jj],
+                                         SHAPE_POLY_SET::PM_FAST );
+
+            aArea += area( overlap );
+            aOps++;
+        }
+    }
+}
+
+
+static void zoneKnockouts( BOARD* aBoard, const std::vector<D_PAD*>& aPads, double& aArea,
+                           int& aOps )
+{
+    int    segsPerCircle = ARC_APPROX_SEGMENTS_COUNT_HIGHT_DEF;
+    double correctionFactor = GetCircletoPolyCorrectionFactor( segsPerCircle );
+
+    for( int z = 0; z < aBoard->GetAreaCount(); z++ )
+    {
+        ZONE_CONTAINER* zone = aBoard->GetArea( z );
+
+        if( zone->GetIsKeepout() )
+            continue;
+
+        EDA_RECT zoneBox = zone->GetBoundingBox();
+        zoneBox.Inflate( zone->GetClearance() );
+
+        SHAPE_POLY_SET holes;
+
+        for( D_PAD* pad : aPads )
+        {
+            if( !pad->IsOnLayer( zone->GetLayer() ) || pad->GetNetCode() == zone->GetNetCode() )
+                continue;
+
+            int clearance = std::max( zone->GetClearance(), pad->GetClearance() );
+
+            if( !zoneBox.Intersects( pad->GetBoundingBox() ) )
+                continue;
+
+            pad->TransformShapeWithClearanceToPolygon( holes, clearance, segsPerCircle,
+                                                       correctionFactor );
+        }
+
+        SHAPE_POLY_SET solid = *zone->Outline();
+        solid.BooleanSubtract( holes, SHAPE_POLY_SET::PM_FAST );
+
+        aArea += area( solid );
+        aOps++;
+    }
+}
+
+
+/**
+ * Runs aWorkload aRuns times with and without the fast path, and prints the best times.
+ */
+static void benchmark( const char* aName, int aRuns,
+                       std::function<void( double&, int& )> aWorkload )
+{
+    double best[2] = { 1e30, 1e30 };
+    double areas[2] = { 0.0, 0.0 };
+    int    ops = 0;
+
+    for( int run = 0; run < aRuns; run++ )
+    {
+        for( int fast = 0; fast < 2; fast++ )
+        {
+            SHAPE_POLY_SET::EnableFastBooleans( fast );
+
+            areas[fast] = 0.0;
+            ops = 0;
+
+            PROF_COUNTER cnt( aName );
+            aWorkload( areas[fast], ops );
+            cnt.Stop();
+
+            best[fast] = std::min( best[fast], cnt.msecs() );
+        }
+    }
+
+    SHAPE_POLY_SET::EnableFastBooleans( true );
+
+    printf( "%-16s %7d ops: Clipper %9.3f ms, fast path %9.3f ms (x%.2f), %s\n", aName, ops,
+            best[0], best[1], best[0] / std::max( best[1], 1e-6 ),
+            std::abs( areas[0] - areas[1] ) <= 1e-9 * std::abs( areas[0] ) ? "same area"
+                                                                          : "AREA MISMATCH" );
+}
+
+
+int main( int argc, char *argv[] )
+{
+    if( argc < 2 )
+    {
+        printf( "Usage: %s board.kicad_pcb [runs]\n", argv[0] );
+        return -1;
+    }
+
+    auto brd = loadBoard( argv[1] );
+    int  runs = argc > 2 ? std::max( atoi( argv[2] ), 1 ) : 3;
+
+    if( !brd )
+        return -1;
+
+    std::vector<D_PAD*>         pads;
+    std::vector<SHAPE_POLY_SET> padPolys, clearancePolys;
+
+    int    segsPerCircle = ARC_APPROX_SEGMENTS_COUNT_HIGHT_DEF;
+    double correctionFactor = GetCircletoPolyCorrectionFactor( segsPerCircle );
+
+    for( MODULE* module = brd->m_Modules; module; module = module->Next() )
+    {
+        module->BuildPolyCourtyard();
+
+        for( auto pad : module->Pads() )
+        {
+            pads.push_back( pad );
+            padPolys.emplace_back();
+            clearancePolys.emplace_back();
+            pad->TransformShapeWithClearanceToPolygon( padPolys.back(), 0, segsPerCircle,
+                                                       correctionFactor );
+            pad->TransformShapeWithClearanceToPolygon( clearancePolys.back(),
+                                                       pad->GetClearance(), segsPerCircle,
+                                                       correctionFactor );
+        }
+    }
+
+    printf( "%d footprints, %d pads, %d zones\n", (int) brd->m_Modules.GetCount(),
+            (int) pads.size(), brd->GetAreaCount() );
+
+    benchmark( "courtyards", runs, [&]( double& aArea, int& aOps )
+    {
+        courtyards( brd, aArea, aOps );
+    } );
+
+    benchmark( "pad clearances", runs, [&]( double& aArea, int& aOps )
+    {
+        padClearances( pads, padPolys, clearancePolys, aArea, aOps );
+    } );
+
+    benchmark( "zone knockouts", runs, [&]( double& aArea, int& aOps )
+    {
+        zoneKnockouts( brd, pads, aArea, aOps );
+    } );
+
+    delete brd;
+
+    return 0;
+}
@@ -0,0 +1,169 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * Drag latency benchmark of the ratsnest.
+ *
+ * Usage: test_ratsnest_drag board.kicad_pcb [steps]
+ *
+ * Finds the net having the most ratsnest nodes, then drags the footprint having the most
+ * pads on this net by small steps.  Each step computes the dynamic ratsnest shown while
+ * dragging, then moves the footprint and updates the ratsnest as a commit does.  The
+ * average and worst times of both phases are printed.
+ */
+
+#include <io_mgr.h>
+#include <kicad_plugin.h>
+
+#include <class_board.h>
+#include <class_module.h>
+#include <connectivity_data.h>
+#include <ratsnest_data.h>
+#include <profile.h>
+#include <convert_to_biu.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+
+
+BOARD* loadBoard( const std::string& filename )
+{
+    PLUGIN::RELEASER pi( new PCB_IO );
+    BOARD* brd = nullptr;
+
+    try
+    {
+        brd = pi->Load( wxString( filename.c_str() ), NULL, NULL );
+    }
+    catch( const IO_ERROR& ioe )
+    {
+        wxString msg = wxString::Format( _( "Error loading board.\n%s" ),
+                ioe.Problem() );
+
+        printf( "%s\n", (const char*) msg.mb_str() );
+        return nullptr;
+    }
+
+    return brd;
+}
+
+
+int main( int argc, char *argv[] )
+{
+    if( argc < 2 )
+    {
+        printf( "Usage: %s board.kicad_pcb [steps]\n", argv[0] );
+        return -1;
+    }
+
+    auto brd = loadBoard( argv[1] );
+    int  steps = argc > 2 ? atoi( argv[2] ) : 100;
+
+    if( !brd )
+        return -1;
+
+    auto connectivity = brd->GetConnectivity();
+
+    PROF_COUNTER build( "build" );
+    connectivity->Build( brd );
+    build.Show();
+
+    int bigNet = 0;
+    unsigned int bigNetNodes = 0;
+
+    for( int net = 1; net < connectivity->GetNetCount(); net++ )
+    {
+        RN_NET* rnNet = connectivity->GetRatsnestForNet( net );
+
+        if( rnNet && rnNet->GetNodeCount() > bigNetNodes )
+        {
+            bigNet = net;
+            bigNetNodes = rnNet->GetNodeCount();
+        }
+    }
+
+    MODULE* dragged = nullptr;
+    int draggedPads = 0;
+
+    for( auto module : brd->Modules() )
+    {
+        int count = 0;
+
+        for( auto pad : module->Pads() )
+        {
+            if( pad->GetNetCode() == bigNet )
+                count++;
+        }
+
+        if( count > draggedPads )
+        {
+            dragged = module;
+            draggedPads = count;
+        }
+    }
+
+    if( !dragged )
+    {
+        printf( "No footprint to drag\n" );
+        delete brd;
+        return -1;
+    }
+
+    printf( "net %d: %u nodes, dragging %s (%d pads on the net)\n", bigNet, bigNetNodes,
+            (const char*) dragged->GetReference().mb_str(), draggedPads );
+
+    std::vector<BOARD_ITEM*> items = { dragged };
+    wxPoint delta( Millimeter2iu( 0.1 ), Millimeter2iu( 0.05 ) );
+
+    double previewTotal = 0.0, previewMax = 0.0;
+    double commitTotal = 0.0, commitMax = 0.0;
+
+    for( int step = 0; step < steps; step++ )
+    {
+        PROF_COUNTER preview( "preview" );
+        connectivity->ComputeDynamicRatsnest( items );
+        preview.Stop();
+
+        PROF_COUNTER commit( "commit" );
+        dragged->Move( delta );
+        connectivity->Update( dragged );
+        connectivity->RecalculateRatsnest();
+        commit.Stop();
+
+        previewTotal += preview.msecs();
+        previewMax = std::max( previewMax, preview.msecs() );
+        commitTotal += commit.msecs();
+        commitMax = std::max( commitMax, commit.msecs() );
+    }
+
+    connectivity->ClearDynamicRatsnest();
+
+    printf( "preview: %.3f ms average, %.3f ms worst\n", previewTotal / steps, previewMax );
+    printf( "commit:  %.3f ms average, %.3f ms worst\n", commitTotal / steps, commitMax );
+    printf( "unconnected: %u\n", connectivity->GetUnconnectedCount() );
+
+    delete brd;
+
+    return 0;
+}
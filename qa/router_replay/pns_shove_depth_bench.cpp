@@ -0,0 +1,148 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * Router branch depth microbenchmark.
+ *
+ * Usage: pns_shove_depth_bench [depth] [tracks]
+ *
+ * Builds a root node holding a bus of parallel tracks, then plays a chain of shove steps
+ * like the shove stack does: each step branches the current node, replaces a track by a
+ * shoved copy made of three segments and looks for the obstacles of the new segments.  The
+ * mean time of a step is printed for each group of steps: it should not depend on the
+ * depth of the node, i.e. on the number of items changed since the root.
+ */
+
+#include <layers_id_colors_and_visibility.h>
+#include <router/pns_node.h>
+#include <router/pns_segment.h>
+#include <router/pns_joint.h>
+#include <profile.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+using namespace PNS;
+
+
+static const int TRACK_PITCH = 500000;
+static const int TRACK_LENGTH = 50000000;
+static const int TRACK_WIDTH = 200000;
+
+
+static SEGMENT* addSegment( NODE* aNode, const VECTOR2I& aA, const VECTOR2I& aB, int aNet )
+{
+    std::unique_ptr<SEGMENT> seg( new SEGMENT( SEG( aA, aB ), aNet ) );
+    SEGMENT* ret = seg.get();
+
+    seg->SetLayer( F_Cu );
+    seg->SetWidth( TRACK_WIDTH );
+    aNode->Add( std::move( seg ), true );
+
+    return ret;
+}
+
+
+int main( int argc, char *argv[] )
+{
+    int depth = argc > 1 ? atoi( argv[1] ) : 2000;
+    int trackCount = argc > 2 ? atoi( argv[2] ) : 1000;
+    const int groupSize = std::max( 1, depth / 10 );
+
+    NODE* root = new NODE;
+
+    root->SetMaxClearance( 4 * TRACK_WIDTH );
+
+    // the segments each track is currently made of, in the current node
+    std::vector<std::vector<SEGMENT*>> tracks( trackCount );
+
+    for( int ii = 0; ii < trackCount; ii++ )
+    {
+        int y = ii * TRACK_PITCH;
+
+        tracks[ii].push_back( addSegment( root, VECTOR2I( 0, y ), VECTOR2I( TRACK_LENGTH, y ), ii ) );
+    }
+
+    printf( "%d tracks, %d shove steps\n\n", trackCount, depth );
+    printf( "%12s %12s %14s\n", "depth", "overlay", "us/step" );
+
+    NODE*  node = root;
+    double groupTime = 0.0;
+    size_t obstacles = 0;
+    size_t joints = 0;
+
+    for( int step = 1; step <= depth; step++ )
+    {
+        PROF_COUNTER cnt;
+
+        node = node->Branch();
+
+        // shove track ii with a jog, moving it by a varying offset
+        int ii = step % trackCount;
+        int y = ii * TRACK_PITCH;
+        int jog = ( 4 + step / trackCount % 4 ) * TRACK_PITCH / 8;
+        int x0 = ( step * 7919 ) % ( TRACK_LENGTH / 2 );
+        int x1 = x0 + TRACK_LENGTH / 4;
+
+        for( SEGMENT* seg : tracks[ii] )
+            node->Remove( seg );
+
+        tracks[ii].clear();
+        tracks[ii].push_back( addSegment( node, VECTOR2I( 0, y ), VECTOR2I( x0, y + jog ), ii ) );
+        tracks[ii].push_back( addSegment( node, VECTOR2I( x0, y + jog ), VECTOR2I( x1, y + jog ), ii ) );
+        tracks[ii].push_back( addSegment( node, VECTOR2I( x1, y + jog ), VECTOR2I( TRACK_LENGTH, y ), ii ) );
+
+        for( SEGMENT* seg : tracks[ii] )
+        {
+            NODE::OBSTACLES obs;
+
+            node->QueryColliding( seg, obs, ITEM::ANY_T, -1, true );
+            obstacles += obs.size();
+
+            if( node->FindJoint( seg->Seg().A, seg ) )
+                joints++;
+        }
+
+        groupTime += cnt.msecs();
+
+        if( step % groupSize == 0 )
+        {
+            NODE::ITEM_VECTOR removed, added;
+
+            node->GetUpdatedItems( removed, added );
+
+            printf( "%12d %12d %14.1f\n", step, (int) added.size(), 1000.0 * groupTime / groupSize );
+            groupTime = 0.0;
+        }
+    }
+
+    printf( "\n%zu obstacles, %zu joints found\n", obstacles, joints );
+
+    root->KillChildren();
+    delete root;
+
+    return 0;
+}
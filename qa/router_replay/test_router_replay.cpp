@@ -0,0 +1,366 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * Router replay benchmark.
+ *
+ * Usage: test_router_replay [-o result.kicad_pcb] board.kicad_pcb events.log
+ *
+ * Plays back a routing session recorded by pcbnew (run it with the KICAD_ROUTER_EVENT_LOG
+ * environment variable set to the log file name) on the board it was recorded on, without
+ * any view.  The latency percentiles of each kind of event are printed, then a summary of
+ * the resulting tracks and vias.  The resulting board can be saved to be compared with a
+ * reference one.
+ *
+ * Only the router events are recorded: the board must not have been modified by other
+ * tools during the session.
+ */
+
+#include <io_mgr.h>
+#include <kicad_plugin.h>
+
+#include <class_board.h>
+#include <class_track.h>
+#include <profile.h>
+#include <convert_to_biu.h>
+
+#include <router/pns_router.h>
+#include <router/pns_kicad_iface.h>
+#include <router/pns_item.h>
+#include <router/pns_itemset.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+
+struct REPLAY_EVENT
+{
+    std::string      m_name;
+    VECTOR2I         m_pos;
+    int              m_kind;          ///< kind of the item, -1 when there is none
+    int              m_net;
+    int              m_layerStart;
+    int              m_layerEnd;
+    VECTOR2I         m_anchor;
+    std::vector<int> m_args;
+};
+
+
+BOARD* loadBoard( const std::string& filename )
+{
+    PLUGIN::RELEASER pi( new PCB_IO );
+    BOARD* brd = nullptr;
+
+    try
+    {
+        brd = pi->Load( wxString( filename.c_str() ), NULL, NULL );
+    }
+    catch( const IO_ERROR& ioe )
+    {
+        wxString msg = wxString::Format( _( "Error loading board.\n%s" ),
+                ioe.Problem() );
+
+        printf( "%s\n", (const char*) msg.mb_str() );
+        return nullptr;
+    }
+
+    return brd;
+}
+
+
+/**
+ * Reads the events of a log written by PNS::LOGGER::LogEvent(), the other lines are skipped.
+ */
+bool loadEvents( const std::string& filename, std::vector<REPLAY_EVENT>& aEvents )
+{
+    std::ifstream file( filename );
+
+    if( !file )
+        return false;
+
+    std::string line;
+
+    while( std::getline( file, line ) )
+    {
+        std::istringstream tokens( line );
+        std::string        tag;
+        REPLAY_EVENT       ev;
+        size_t             argCount = 0;
+
+        if( !( tokens >> tag ) || tag != "event" )
+            continue;
+
+        tokens >> ev.m_name >> ev.m_pos.x >> ev.m_pos.y >> ev.m_kind >> ev.m_net
+               >> ev.m_layerStart >> ev.m_layerEnd >> ev.m_anchor.x >> ev.m_anchor.y
+               >> argCount;
+
+        for( size_t ii = 0; ii < argCount; ii++ )
+        {
+            int arg = 0;
+            tokens >> arg;
+            ev.m_args.push_back( arg );
+        }
+
+        if( !tokens )
+        {
+            printf( "Malformed event: %s\n", line.c_str() );
+            return false;
+        }
+
+        aEvents.push_back( ev );
+    }
+
+    return true;
+}
+
+
+/**
+ * Finds the router item an event was recorded with, among the items under its position.
+ */
+PNS::ITEM* findItem( PNS::ROUTER& aRouter, const REPLAY_EVENT& aEvent )
+{
+    if( aEvent.m_kind < 0 )
+        return nullptr;
+
+    PNS::ITEM_SET candidates = aRouter.QueryHoverItems( aEvent.m_pos );
+    PNS::ITEM*    found = nullptr;
+
+    for( PNS::ITEM* item : candidates.Items() )
+    {
+        if( item->Kind() != aEvent.m_kind || item->Net() != aEvent.m_net
+            || item->Layers().Start() != aEvent.m_layerStart
+            || item->Layers().End() != aEvent.m_layerEnd )
+            continue;
+
+        VECTOR2I anchor = item->AnchorCount() ? item->Anchor( 0 ) : aEvent.m_pos;
+
+        if( anchor == aEvent.m_anchor )
+            return item;
+
+        if( !found )
+            found = item;
+    }
+
+    return found;
+}
+
+
+/**
+ * Replays aEvent, with aItem the item it was recorded with (found by findItem()).
+ */
+void replayEvent( PNS::ROUTER& aRouter, const REPLAY_EVENT& aEvent, PNS::ITEM* aItem )
+{
+    auto arg = [&]( size_t aIndex )
+    {
+        return aIndex < aEvent.m_args.size() ? aEvent.m_args[aIndex] : 0;
+    };
+
+    if( aEvent.m_name == "sync" )
+    {
+        aRouter.SyncWorld();
+    }
+    else if( aEvent.m_name == "sizes" )
+    {
+        PNS::SIZES_SETTINGS sizes( aRouter.Sizes() );
+
+        sizes.SetTrackWidth( arg( 0 ) );
+        sizes.SetViaDiameter( arg( 1 ) );
+        sizes.SetViaDrill( arg( 2 ) );
+        sizes.SetViaType( (VIATYPE_T) arg( 3 ) );
+        sizes.SetDiffPairWidth( arg( 4 ) );
+        sizes.SetDiffPairGap( arg( 5 ) );
+        sizes.SetDiffPairViaGap( arg( 6 ) );
+        sizes.SetDiffPairViaGapSameAsTraceGap( arg( 6 ) == arg( 5 ) );
+        sizes.ClearLayerPairs();
+        sizes.AddLayerPair( arg( 7 ), arg( 8 ) );
+
+        aRouter.UpdateSizes( sizes );
+    }
+    else if( aEvent.m_name == "route" )
+    {
+        aRouter.SetMode( (PNS::ROUTER_MODE) arg( 1 ) );
+        aRouter.Settings().SetMode( (PNS::PNS_MODE) arg( 2 ) );
+        aRouter.StartRouting( aEvent.m_pos, aItem, arg( 0 ) );
+    }
+    else if( aEvent.m_name == "drag" )
+    {
+        aRouter.Settings().SetMode( (PNS::PNS_MODE) arg( 1 ) );
+        aRouter.StartDragging( aEvent.m_pos, aItem, arg( 0 ) );
+    }
+    else if( aEvent.m_name == "move" )
+    {
+        aRouter.Move( aEvent.m_pos, aItem );
+    }
+    else if( aEvent.m_name == "fix" )
+    {
+        aRouter.FixRoute( aEvent.m_pos, aItem, arg( 0 ) != 0 );
+    }
+    else if( aEvent.m_name == "stop" )
+    {
+        aRouter.StopRouting();
+    }
+    else if( aEvent.m_name == "posture" )
+    {
+        aRouter.FlipPosture();
+    }
+    else if( aEvent.m_name == "layer" )
+    {
+        aRouter.SwitchLayer( arg( 0 ) );
+    }
+    else if( aEvent.m_name == "via" )
+    {
+        aRouter.ToggleViaPlacement();
+    }
+}
+
+
+double percentile( const std::vector<double>& aSorted, double aRank )
+{
+    size_t index = std::min( aSorted.size() - 1, (size_t) ( aRank * aSorted.size() ) );
+
+    return aSorted[index];
+}
+
+
+int main( int argc, char *argv[] )
+{
+    std::string boardFile, eventFile, resultFile;
+
+    for( int ii = 1; ii < argc; ii++ )
+    {
+        std::string arg = argv[ii];
+
+        if( arg == "-o" && ii + 1 < argc )
+            resultFile = argv[++ii];
+        else if( boardFile.empty() )
+            boardFile = arg;
+        else
+            eventFile = arg;
+    }
+
+    if( eventFile.empty() )
+    {
+        printf( "Usage: %s [-o result.kicad_pcb] board.kicad_pcb events.log\n", argv[0] );
+        return -1;
+    }
+
+    std::vector<REPLAY_EVENT> events;
+
+    if( !loadEvents( eventFile, events ) )
+    {
+        printf( "Cannot read the events from %s\n", eventFile.c_str() );
+        return -1;
+    }
+
+    auto brd = loadBoard( boardFile );
+
+    if( !brd )
+        return -1;
+
+    // The router does not need a view nor a host tool: the board is modified directly
+    {
+        PNS_KICAD_IFACE iface;
+        PNS::ROUTER     router;
+
+        iface.SetBoard( brd );
+        router.SetInterface( &iface );
+        router.ClearWorld();
+        router.SyncWorld();
+
+        std::map<std::string, std::vector<double>> latencies;
+        double total = 0.0;
+
+        for( const REPLAY_EVENT& ev : events )
+        {
+            // The item lookup is not part of the event handling: it is done before timing
+            PNS::ITEM* item = findItem( router, ev );
+
+            PROF_COUNTER cnt( "event" );
+            replayEvent( router, ev, item );
+            cnt.Stop();
+
+            latencies[ev.m_name].push_back( cnt.msecs() );
+            total += cnt.msecs();
+        }
+
+        router.StopRouting();
+
+        printf( "%zu events replayed in %.1f ms\n\n", events.size(), total );
+        printf( "%-8s %8s %10s %10s %10s %10s\n", "event", "count", "p50 [ms]", "p90 [ms]",
+                "p99 [ms]", "max [ms]" );
+
+        for( auto& entry : latencies )
+        {
+            std::vector<double>& times = entry.second;
+
+            std::sort( times.begin(), times.end() );
+
+            printf( "%-8s %8zu %10.3f %10.3f %10.3f %10.3f\n", entry.first.c_str(),
+                    times.size(), percentile( times, 0.5 ), percentile( times, 0.9 ),
+                    percentile( times, 0.99 ), times.back() );
+        }
+    }
+
+    int    trackCount = 0, viaCount = 0;
+    double trackLength = 0.0;
+
+    for( auto track : brd->Tracks() )
+    {
+        if( track->Type() == PCB_VIA_T )
+        {
+            viaCount++;
+        }
+        else
+        {
+            trackCount++;
+            trackLength += track->GetLength();
+        }
+    }
+
+    printf( "\ntracks: %d, total length %.3f mm\n", trackCount, trackLength / IU_PER_MM );
+    printf( "vias:   %d\n", viaCount );
+
+    if( !resultFile.empty() )
+    {
+        try
+        {
+            PLUGIN::RELEASER pi( new PCB_IO );
+            pi->Save( wxString( resultFile.c_str() ), brd );
+        }
+        catch( const IO_ERROR& ioe )
+        {
+            printf( "Error saving board.\n%s\n", (const char*) ioe.Problem().mb_str() );
+            delete brd;
+            return -1;
+        }
+    }
+
+    delete brd;
+
+    return 0;
+}
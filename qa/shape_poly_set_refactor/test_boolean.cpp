@@ -0,0 +1,327 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see CHANGELOG.TXT for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <boost/test/unit_test.hpp>
+#include <geometry/shape_poly_set.h>
+#include <geometry/shape_line_chain.h>
+#include <common.h>
+
+#include <cmath>
+#include <random>
+
+/**
+ * Random operands of the boolean operations: rectangles, convex polygons, polygons with a
+ * hole and sets of several polygons, often nested, touching or far from each other.
+ */
+class BOOLEAN_OPERANDS
+{
+public:
+    BOOLEAN_OPERANDS() :
+        m_rng( 1234 )
+    {
+    }
+
+    SHAPE_POLY_SET Generate()
+    {
+        SHAPE_POLY_SET set;
+
+        switch( m_rng() % 6 )
+        {
+        case 0:
+        case 1:
+            addRectangle( set );
+            break;
+
+        case 2:
+        case 3:
+            addConvex( set );
+            break;
+
+        case 4:
+            addRectangle( set );
+            set.AddHole( shrunk( set.COutline( 0 ) ) );
+            break;
+
+        default:
+            addRectangle( set );
+            addConvex( set );
+            addRectangle( set );
+            break;
+        }
+
+        return set;
+    }
+
+private:
+    int coord( int aMax )
+    {
+        // snapped to a coarse grid to get many shared edges and vertices
+        return ( m_rng() % ( aMax / 100 + 1 ) ) * 100;
+    }
+
+    void addRectangle( SHAPE_POLY_SET& aSet )
+    {
+        int x = coord( 8000 ), y = coord( 8000 );
+        int w = coord( 4000 ) + 100, h = coord( 4000 ) + 100;
+
+        aSet.NewOutline();
+        aSet.Append( x, y );
+        aSet.Append( x + w, y );
+        aSet.Append( x + w, y + h );
+        aSet.Append( x, y + h );
+    }
+
+    void addConvex( SHAPE_POLY_SET& aSet )
+    {
+        int x = coord( 8000 ), y = coord( 8000 );
+        int radius = coord( 3000 ) + 200;
+        int count = 3 + m_rng() % 30;
+
+        aSet.NewOutline();
+
+        for( int i = 0; i < count; i++ )
+        {
+            double angle = 2.0 * M_PI * i / count;
+            aSet.Append( x + KiROUND( radius * cos( angle ) ),
+                         y + KiROUND( radius * sin( angle ) ) );
+        }
+    }
+
+    SHAPE_LINE_CHAIN shrunk( const SHAPE_LINE_CHAIN& aRect )
+    {
+        BOX2I box = aRect.BBox();
+        int   margin = std::min( box.GetWidth(), box.GetHeight() ) / 4;
+
+        box.Inflate( -margin );
+
+        SHAPE_LINE_CHAIN hole;
+        hole.Append( box.GetLeft(), box.GetTop() );
+        hole.Append( box.GetLeft(), box.GetBottom() );
+        hole.Append( box.GetRight(), box.GetBottom() );
+        hole.Append( box.GetRight(), box.GetTop() );
+        hole.SetClosed( true );
+
+        return hole;
+    }
+
+    std::mt19937 m_rng;
+};
+
+
+static double area( const SHAPE_POLY_SET& aSet )
+{
+    double area = 0.0;
+
+    for( int i = 0; i < aSet.OutlineCount(); i++ )
+    {
+        area += std::abs( aSet.COutline( i ).Area() );
+
+        for( int j = 0; j < aSet.HoleCount( i ); j++ )
+            area -= std::abs( aSet.CHole( i, j ).Area() );
+    }
+
+    return area;
+}
+
+
+static int holeCount( const SHAPE_POLY_SET& aSet )
+{
+    int count = 0;
+
+    for( int i = 0; i < aSet.OutlineCount(); i++ )
+        count += aSet.HoleCount( i );
+
+    return count;
+}
+
+
+enum BOOLEAN_OP
+{
+    BO_ADD,
+    BO_SUBTRACT,
+    BO_INTERSECTION
+};
+
+
+static SHAPE_POLY_SET booleanOp( BOOLEAN_OP aOp, const SHAPE_POLY_SET& aA,
+                                 const SHAPE_POLY_SET& aB, bool aFast )
+{
+    SHAPE_POLY_SET::EnableFastBooleans( aFast );
+
+    SHAPE_POLY_SET result;
+
+    switch( aOp )
+    {
+    case BO_ADD:          result.BooleanAdd( aA, aB, SHAPE_POLY_SET::PM_FAST );          break;
+    case BO_SUBTRACT:     result.BooleanSubtract( aA, aB, SHAPE_POLY_SET::PM_FAST );     break;
+    case BO_INTERSECTION: result.BooleanIntersection( aA, aB, SHAPE_POLY_SET::PM_FAST ); break;
+    }
+
+    SHAPE_POLY_SET::EnableFastBooleans( true );
+
+    return result;
+}
+
+
+BOOST_AUTO_TEST_SUITE( FastBoolean )
+
+
+/**
+ * Checks that the fast path covers the same area as Clipper, with the same outlines and holes.
+ */
+BOOST_AUTO_TEST_CASE( SameAsClipper )
+{
+    BOOLEAN_OPERANDS operands;
+
+    for( int i = 0; i < 3000; i++ )
+    {
+        SHAPE_POLY_SET a = operands.Generate();
+        SHAPE_POLY_SET b = i % 50 ? operands.Generate() : SHAPE_POLY_SET();
+
+        for( BOOLEAN_OP op : { BO_ADD, BO_SUBTRACT, BO_INTERSECTION } )
+        {
+            SHAPE_POLY_SET fast = booleanOp( op, a, b, true );
+            SHAPE_POLY_SET ref = booleanOp( op, a, b, false );
+
+            BOOST_CHECK_EQUAL( fast.OutlineCount(), ref.OutlineCount() );
+            BOOST_CHECK_EQUAL( holeCount( fast ), holeCount( ref ) );
+            BOOST_CHECK_EQUAL( area( fast ), area( ref ) );
+
+            // both differences are empty when the results cover the same area
+            BOOST_CHECK_EQUAL( booleanOp( BO_SUBTRACT, fast, ref, false ).OutlineCount(), 0 );
+            BOOST_CHECK_EQUAL( booleanOp( BO_SUBTRACT, ref, fast, false ).OutlineCount(), 0 );
+        }
+    }
+}
+
+
+/**
+ * Checks the results of the operations handled without Clipper.
+ */
+BOOST_AUTO_TEST_CASE( SimpleOperands )
+{
+    auto rect = []( int x0, int y0, int x1, int y1 )
+    {
+        SHAPE_POLY_SET set;
+        set.NewOutline();
+        set.Append( x0, y0 );
+        set.Append( x1, y0 );
+        set.Append( x1, y1 );
+        set.Append( x0, y1 );
+        return set;
+    };
+
+    SHAPE_POLY_SET outer = rect( 0, 0, 1000, 1000 );
+    SHAPE_POLY_SET inner = rect( 200, 200, 400, 400 );
+    SHAPE_POLY_SET apart = rect( 2000, 0, 3000, 1000 );
+    SHAPE_POLY_SET crossing = rect( 500, 500, 1500, 1500 );
+
+    SHAPE_POLY_SET result = booleanOp( BO_SUBTRACT, outer, inner, true );
+    BOOST_CHECK_EQUAL( result.OutlineCount(), 1 );
+    BOOST_CHECK_EQUAL( result.HoleCount( 0 ), 1 );
+    BOOST_CHECK_EQUAL( area( result ), 1000.0 * 1000 - 200.0 * 200 );
+
+    result = booleanOp( BO_ADD, outer, apart, true );
+    BOOST_CHECK_EQUAL( result.OutlineCount(), 2 );
+
+    result = booleanOp( BO_INTERSECTION, outer, apart, true );
+    BOOST_CHECK_EQUAL( result.OutlineCount(), 0 );
+
+    result = booleanOp( BO_INTERSECTION, outer, crossing, true );
+    BOOST_CHECK_EQUAL( result.OutlineCount(), 1 );
+    BOOST_CHECK( result.COutline( 0 ).BBox().GetOrigin() == VECTOR2I( 500, 500 ) );
+    BOOST_CHECK( result.COutline( 0 ).BBox().GetEnd() == VECTOR2I( 1000, 1000 ) );
+
+    result = booleanOp( BO_SUBTRACT, inner, outer, true );
+    BOOST_CHECK_EQUAL( result.OutlineCount(), 0 );
+
+    // the result of an operation on this set itself
+    result = outer;
+    result.BooleanAdd( inner, SHAPE_POLY_SET::PM_FAST );
+    BOOST_CHECK_EQUAL( area( result ), 1000.0 * 1000 );
+}
+
+
+/**
+ * Checks that the arc tags of the vertices are kept by the operations, and given to the
+ * vertices added where another outline crosses the arc.
+ */
+BOOST_AUTO_TEST_CASE( ArcTags )
+{
+    SHAPE_POLY_SET rect;
+    rect.NewOutline();
+    rect.Append( 0, 0 );
+    rect.Append( 4000, 0 );
+    rect.Append( 4000, 4000 );
+    rect.Append( 0, 4000 );
+
+    auto circle = []( int aX, int aY )
+    {
+        SHAPE_LINE_CHAIN chain;
+
+        for( int i = 0; i < 32; i++ )
+        {
+            double angle = 2.0 * M_PI * i / 32;
+            chain.Append( aX + KiROUND( 1000 * cos( angle ) ), aY + KiROUND( 1000 * sin( angle ) ) );
+            chain.SetArcTag( i, 7 );
+        }
+
+        chain.SetClosed( true );
+
+        SHAPE_POLY_SET set;
+        set.AddOutline( chain );
+        return set;
+    };
+
+    auto isCorner = []( const VECTOR2I& aPt )
+    {
+        return ( aPt.x == 0 || aPt.x == 4000 ) && ( aPt.y == 0 || aPt.y == 4000 );
+    };
+
+    for( bool fast : { true, false } )
+    {
+        // a hole inside the rectangle keeps all its tags
+        SHAPE_POLY_SET result = booleanOp( BO_SUBTRACT, rect, circle( 2000, 2000 ), fast );
+        BOOST_REQUIRE_EQUAL( result.OutlineCount(), 1 );
+        BOOST_REQUIRE_EQUAL( result.HoleCount( 0 ), 1 );
+        BOOST_CHECK( !result.COutline( 0 ).HasArcTags() );
+
+        for( int i = 0; i < result.CHole( 0, 0 ).PointCount(); i++ )
+            BOOST_CHECK_EQUAL( result.CHole( 0, 0 ).ArcTag( i ), 7 );
+
+        // a circle on a corner: all the vertices but the corners are on the arc
+        for( BOOLEAN_OP op : { BO_ADD, BO_SUBTRACT, BO_INTERSECTION } )
+        {
+            result = booleanOp( op, rect, circle( 4100, 3900 ), fast );
+            BOOST_REQUIRE_EQUAL( result.OutlineCount(), 1 );
+
+            const SHAPE_LINE_CHAIN& outline = result.COutline( 0 );
+
+            for( int i = 0; i < outline.PointCount(); i++ )
+                BOOST_CHECK_EQUAL( outline.ArcTag( i ), isCorner( outline.CPoint( i ) ) ? 0 : 7 );
+        }
+    }
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,174 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see CHANGELOG.TXT for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <boost/test/unit_test.hpp>
+#include <geometry/shape_poly_set.h>
+#include <geometry/shape_line_chain.h>
+
+#include <cmath>
+#include <functional>
+#include <random>
+
+/**
+ * Islands of overlapping polygons, far enough from each other to be processed separately by
+ * Simplify(), Inflate() and Fracture().  The polygons of the islands are interleaved in the
+ * set, and m_islands holds each island alone, in the order of its first polygon.
+ */
+struct ISLANDS_FIXTURE
+{
+    ISLANDS_FIXTURE()
+    {
+        std::mt19937 rng( 42 );
+        const int islandCount = 40;
+        const int spacing = 100000;
+
+        m_islands.resize( islandCount );
+
+        for( int ii = 0; ii < 4 * islandCount; ii++ )
+        {
+            int island = ii % islandCount;
+            int x = ( island % 8 ) * spacing + rng() % 2000;
+            int y = ( island / 8 ) * spacing + rng() % 2000;
+            int radius = 5000 + rng() % 10000;
+            int count = 8 + rng() % 24;
+
+            SHAPE_LINE_CHAIN outline;
+
+            for( int jj = 0; jj < count; jj++ )
+            {
+                double angle = 2.0 * M_PI * jj / count;
+                double r = radius * ( jj % 2 ? 0.7 : 1.0 );
+                outline.Append( x + (int) ( r * cos( angle ) ), y + (int) ( r * sin( angle ) ) );
+            }
+
+            outline.SetClosed( true );
+
+            m_set.AddOutline( outline );
+            m_islands[island].AddOutline( outline );
+
+            if( ii % 3 == 0 )
+            {
+                SHAPE_LINE_CHAIN hole;
+                hole.Append( x - 1000, y - 1000 );
+                hole.Append( x - 1000, y + 1000 );
+                hole.Append( x + 1000, y + 1000 );
+                hole.Append( x + 1000, y - 1000 );
+                hole.SetClosed( true );
+
+                m_set.AddHole( hole );
+                m_islands[island].AddHole( hole );
+            }
+        }
+    }
+
+    /**
+     * Checks that aOp gives the same result on the whole set as on each island alone.
+     */
+    void CheckSameAsIslands( const std::function<void( SHAPE_POLY_SET& )>& aOp )
+    {
+        SHAPE_POLY_SET whole = m_set;
+        SHAPE_POLY_SET expected;
+
+        aOp( whole );
+
+        for( const SHAPE_POLY_SET& island : m_islands )
+        {
+            SHAPE_POLY_SET result = island;
+            aOp( result );
+            expected.Append( result );
+        }
+
+        BOOST_REQUIRE_EQUAL( whole.OutlineCount(), expected.OutlineCount() );
+
+        for( int ii = 0; ii < whole.OutlineCount(); ii++ )
+        {
+            const SHAPE_POLY_SET::POLYGON& poly = whole.Polygon( ii );
+            const SHAPE_POLY_SET::POLYGON& expectedPoly = expected.Polygon( ii );
+
+            BOOST_REQUIRE_EQUAL( poly.size(), expectedPoly.size() );
+
+            for( size_t jj = 0; jj < poly.size(); jj++ )
+            {
+                BOOST_REQUIRE_EQUAL( poly[jj].PointCount(), expectedPoly[jj].PointCount() );
+
+                for( int kk = 0; kk < poly[jj].PointCount(); kk++ )
+                    BOOST_CHECK( poly[jj].CPoint( kk ) == expectedPoly[jj].CPoint( kk ) );
+            }
+        }
+    }
+
+    SHAPE_POLY_SET m_set;
+    std::vector<SHAPE_POLY_SET> m_islands;
+};
+
+
+BOOST_FIXTURE_TEST_SUITE( ClusteredOps, ISLANDS_FIXTURE )
+
+
+BOOST_AUTO_TEST_CASE( Simplify )
+{
+    CheckSameAsIslands( []( SHAPE_POLY_SET& aSet )
+    {
+        aSet.Simplify( SHAPE_POLY_SET::PM_FAST );
+    } );
+
+    CheckSameAsIslands( []( SHAPE_POLY_SET& aSet )
+    {
+        aSet.Simplify( SHAPE_POLY_SET::PM_STRICTLY_SIMPLE );
+    } );
+}
+
+
+BOOST_AUTO_TEST_CASE( Inflate )
+{
+    CheckSameAsIslands( []( SHAPE_POLY_SET& aSet )
+    {
+        aSet.Inflate( 3000, 32 );
+    } );
+
+    CheckSameAsIslands( []( SHAPE_POLY_SET& aSet )
+    {
+        aSet.Inflate( -1000, 16 );
+    } );
+}
+
+
+BOOST_AUTO_TEST_CASE( Fracture )
+{
+    CheckSameAsIslands( []( SHAPE_POLY_SET& aSet )
+    {
+        aSet.Fracture( SHAPE_POLY_SET::PM_FAST );
+
+        for( int ii = 0; ii < aSet.OutlineCount(); ii++ )
+            BOOST_CHECK_EQUAL( aSet.HoleCount( ii ), 0 );
+    } );
+
+    CheckSameAsIslands( []( SHAPE_POLY_SET& aSet )
+    {
+        aSet.Fracture( SHAPE_POLY_SET::PM_FAST );
+        aSet.Unfracture( SHAPE_POLY_SET::PM_FAST );
+    } );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,151 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see CHANGELOG.TXT for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <boost/test/unit_test.hpp>
+#include <geometry/shape_poly_set.h>
+#include <geometry/shape_line_chain.h>
+
+#include <cmath>
+
+/**
+ * Builds a set of aCount squares of side aSize, every other one with a square hole.
+ */
+static SHAPE_POLY_SET buildSquares( int aCount, int aSize )
+{
+    SHAPE_POLY_SET set;
+
+    for( int ii = 0; ii < aCount; ii++ )
+    {
+        int x0 = ii * 2 * aSize;
+
+        set.NewOutline();
+        set.Append( x0, 0 );
+        set.Append( x0 + aSize, 0 );
+        set.Append( x0 + aSize, aSize );
+        set.Append( x0, aSize );
+
+        if( ii % 2 )
+        {
+            set.NewHole();
+            set.Append( x0 + aSize / 4, aSize / 4, -1, 0 );
+            set.Append( x0 + aSize / 4, 3 * aSize / 4, -1, 0 );
+            set.Append( x0 + 3 * aSize / 4, 3 * aSize / 4, -1, 0 );
+            set.Append( x0 + 3 * aSize / 4, aSize / 4, -1, 0 );
+        }
+    }
+
+    return set;
+}
+
+
+/**
+ * Sum of the areas of the triangles of a triangulated set.
+ */
+static double triangulatedArea( const SHAPE_POLY_SET& aSet )
+{
+    double area = 0.0;
+
+    for( unsigned int ii = 0; ii < aSet.TriangulatedPolyCount(); ii++ )
+    {
+        const SHAPE_POLY_SET::TRIANGULATED_POLYGON* tri = aSet.TriangulatedPolygon( ii );
+
+        for( int jj = 0; jj < tri->GetTriangleCount(); jj++ )
+        {
+            VECTOR2I a, b, c;
+            tri->GetTriangle( jj, a, b, c );
+            area += std::abs( (double) ( b - a ).Cross( c - a ) ) / 2.0;
+        }
+    }
+
+    return area;
+}
+
+
+BOOST_AUTO_TEST_SUITE( Triangulation )
+
+
+/**
+ * Checks the triangulation of outlines with and without holes.
+ */
+BOOST_AUTO_TEST_CASE( Area )
+{
+    const int size = 1000;
+    SHAPE_POLY_SET set = buildSquares( 9, size );
+
+    set.CacheTriangulation();
+
+    BOOST_CHECK( set.IsTriangulationUpToDate() );
+    BOOST_CHECK_EQUAL( set.TriangulatedPolyCount(), 9 );
+
+    // 5 plain squares and 4 squares with a hole of a quarter of their area
+    double expected = 5.0 * size * size + 4.0 * size * size * 3 / 4;
+
+    BOOST_CHECK_CLOSE( triangulatedArea( set ), expected, 1e-9 );
+}
+
+
+/**
+ * Checks that copies share the triangulation until they are edited.
+ */
+BOOST_AUTO_TEST_CASE( SharedByCopies )
+{
+    SHAPE_POLY_SET set = buildSquares( 4, 1000 );
+
+    set.CacheTriangulation();
+
+    SHAPE_POLY_SET copy( set );
+    SHAPE_POLY_SET assigned;
+    assigned = set;
+
+    BOOST_CHECK( copy.IsTriangulationUpToDate() );
+    BOOST_CHECK( assigned.IsTriangulationUpToDate() );
+    BOOST_CHECK( copy.GetHash() == set.GetHash() );
+
+    for( unsigned int ii = 0; ii < set.TriangulatedPolyCount(); ii++ )
+    {
+        BOOST_CHECK_EQUAL( copy.TriangulatedPolygon( ii ), set.TriangulatedPolygon( ii ) );
+        BOOST_CHECK_EQUAL( assigned.TriangulatedPolygon( ii ), set.TriangulatedPolygon( ii ) );
+    }
+
+    // caching again identical geometry keeps the shared triangles
+    const SHAPE_POLY_SET::TRIANGULATED_POLYGON* first = copy.TriangulatedPolygon( 0 );
+    copy.CacheTriangulation();
+    BOOST_CHECK_EQUAL( copy.TriangulatedPolygon( 0 ), first );
+
+    // an edited copy gets its own triangulation, the original keeps the shared one
+    copy.Move( VECTOR2I( 10, 20 ) );
+
+    BOOST_CHECK( !copy.IsTriangulationUpToDate() );
+    BOOST_CHECK( copy.GetHash() != set.GetHash() );
+
+    copy.CacheTriangulation();
+
+    BOOST_CHECK( copy.IsTriangulationUpToDate() );
+    BOOST_CHECK( set.IsTriangulationUpToDate() );
+    BOOST_CHECK( copy.TriangulatedPolygon( 0 ) != set.TriangulatedPolygon( 0 ) );
+    BOOST_CHECK_EQUAL( set.TriangulatedPolygon( 0 ), first );
+    BOOST_CHECK_CLOSE( triangulatedArea( copy ), triangulatedArea( set ), 1e-9 );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -264,6 +264,8 @@ static std::vector<BENCHMARK> benchmarkList =
     { 'F', bench_fstream_reuse, "std::fstream, reused" },
     { 'r', bench_line_reader<FILE_LINE_READER>, "RICHIO" },
     { 'R', bench_line_reader_reuse<FILE_LINE_READER>, "RICHIO, reused" },
+    { 'm', bench_line_reader<MAPPED_FILE_LINE_READER>, "RICHIO mapped" },
+    { 'M', bench_line_reader_reuse<MAPPED_FILE_LINE_READER>, "RICHIO mapped, reused" },
     { 'n', bench_line_reader<IFSTREAM_LINE_READER>, "std::ifstream L_R" },
     { 'N', bench_line_reader_reuse<IFSTREAM_LINE_READER>, "std::ifstream L_R, reused" },
     { 'w', bench_wxis<wxFileInputStream>, "wxFileIStream" },